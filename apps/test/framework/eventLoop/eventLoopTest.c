@@ -14,6 +14,15 @@ static le_event_Id_t EventIdC;
 
 static char EventContextA[] = "Context A";
 
+// Number of threads queueing functions to the main thread at the same time, and the number of
+// functions each of them queues.
+#define NUM_PRODUCERS 4
+#define NUM_QUEUED_PER_PRODUCER 10000
+
+static le_thread_Ref_t MainThread;
+static size_t NextSeqNum[NUM_PRODUCERS];
+static size_t NumQueuedReceived = 0;
+
 typedef struct
 {
     char str[10];
@@ -82,6 +91,46 @@ static void Destructor
 }
 
 
+static void CountQueuedFunction
+(
+    void* param1Ptr,    // Producer index.
+    void* param2Ptr     // Sequence number.
+)
+{
+    size_t producer = (size_t)param1Ptr;
+    size_t seqNum = (size_t)param2Ptr;
+
+    LE_ASSERT(producer < NUM_PRODUCERS);
+
+    // Functions queued by the same thread must arrive in the order they were queued.
+    LE_ASSERT(seqNum == NextSeqNum[producer]);
+    NextSeqNum[producer]++;
+
+    NumQueuedReceived++;
+    if (NumQueuedReceived == NUM_PRODUCERS * NUM_QUEUED_PER_PRODUCER)
+    {
+        LE_INFO("======== EVENT LOOP TEST COMPLETE (PASSED) ========");
+        exit(EXIT_SUCCESS);
+    }
+}
+
+
+static void* ProducerThreadMain
+(
+    void* contextPtr    // Producer index.
+)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_QUEUED_PER_PRODUCER; i++)
+    {
+        le_event_QueueFunctionToThread(MainThread, CountQueuedFunction, contextPtr, (void*)i);
+    }
+
+    return NULL;
+}
+
+
 static void CheckTestResults
 (
     void* param1Ptr,
@@ -95,8 +144,16 @@ static void CheckTestResults
     LE_ASSERT(TestBPassed);
     LE_ASSERT(TestCPassed);
 
-    LE_INFO("======== EVENT LOOP TEST COMPLETE (PASSED) ========");
-    exit(EXIT_SUCCESS);
+    // Now have several threads hammer the main thread's Event Queue at the same time.
+    size_t i;
+    for (i = 0; i < NUM_PRODUCERS; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "producer%zu", i);
+
+        le_thread_Ref_t threadRef = le_thread_Create(name, ProducerThreadMain, (void*)i);
+        le_thread_Start(threadRef);
+    }
 }
 
 
@@ -108,6 +165,8 @@ COMPONENT_INIT
 
     LE_INFO("%s called!", __func__);
 
+    MainThread = le_thread_GetCurrent();
+
     EventIdA = le_event_CreateId("Event A", sizeof(ReportA));
     EventIdB = le_event_CreateIdWithRefCounting("Event B");
     EventIdC = le_event_CreateIdWithRefCounting("Event C");
@@ -0,0 +1,102 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tests direct dispatch of fd events (le_fdMonitor_SetDirectDispatch()).
+ *
+ * Two pipes are made readable before the Event Loop starts, so their events arrive in the same
+ * epoll batch.  Whichever handler runs first deletes the other pipe's FD Monitor and creates a
+ * new one in its place (likely reusing the same memory), so the second event in the batch must be
+ * discarded.  The new FD Monitor's handler then checks that only one of the first two ran.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ **/
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+/// Read and write ends of the pipes.
+static int PipeFds[3][2];
+
+/// FD Monitors for the first two pipes.
+static le_fdMonitor_Ref_t MonitorRefs[2];
+
+/// Number of times the handlers for the first two pipes have been called.
+static int FirstHandlerCount = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler for the third pipe, created from inside the first pipe handler to run.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LastHandler
+(
+    int fd,
+    short events
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(events & POLLIN);
+    LE_ASSERT(fd == PipeFds[2][0]);
+
+    LE_INFO("First handlers called %d times.", FirstHandlerCount);
+    LE_ASSERT(FirstHandlerCount == 1);
+
+    LE_INFO("======== Test PASSED ========");
+    exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler for the first two pipes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FirstHandler
+(
+    int fd,
+    short events
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(events & POLLIN);
+
+    int index = (int)(size_t)le_fdMonitor_GetContextPtr();
+    int otherIndex = 1 - index;
+
+    LE_ASSERT(fd == PipeFds[index][0]);
+    LE_ASSERT(le_fdMonitor_GetMonitor() == MonitorRefs[index]);
+
+    FirstHandlerCount++;
+
+    // Stop monitoring both pipes.  The other one's event is already in the current epoll batch.
+    le_fdMonitor_Delete(MonitorRefs[otherIndex]);
+    le_fdMonitor_Delete(MonitorRefs[index]);
+
+    // Create a new FD Monitor that could reuse the deleted one's memory.
+    le_fdMonitor_Ref_t monitorRef = le_fdMonitor_Create("last", PipeFds[2][0], LastHandler, POLLIN);
+    le_fdMonitor_SetDirectDispatch(monitorRef, true);
+
+    LE_ASSERT(write(PipeFds[2][1], "c", 1) == 1);
+}
+
+
+COMPONENT_INIT
+{
+    int i;
+
+    LE_INFO("======== Starting FD Monitor Direct Dispatch Test ========");
+
+    for (i = 0; i < 3; i++)
+    {
+        LE_ASSERT(pipe(PipeFds[i]) == 0);
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        LE_ASSERT(write(PipeFds[i][1], "x", 1) == 1);
+
+        MonitorRefs[i] = le_fdMonitor_Create("first", PipeFds[i][0], FirstHandler, POLLIN);
+        le_fdMonitor_SetContextPtr(MonitorRefs[i], (void*)(size_t)i);
+        le_fdMonitor_SetDirectDispatch(MonitorRefs[i], true);
+    }
+}
@@ -12,7 +12,8 @@ void TestIntHashMap(le_hashmap_Ref_t map);
 void TestStringHashMap(le_hashmap_Ref_t map);
 void TestCustomHashMap(le_hashmap_Ref_t map);
 void TestHashFns(void);
-void TestNewIter();
+void TestNewIter(le_hashmap_Ref_t map10);
+void TestResizable(void);
 void TestTinyMap(le_hashmap_Ref_t map);
 void TestPointerMap(le_hashmap_Ref_t map);
 void* insertRetrieve(le_hashmap_Ref_t map, const void* key, const void* val);
@@ -59,9 +60,33 @@ COMPONENT_INIT
     TestCustomHashMap(map3);
     TestTinyMap(map4);
     TestPointerMap(map5);
-    TestNewIter();
+    LE_INFO("Creating int/int map for iter tests");
+    TestNewIter(le_hashmap_Create("Map10", 13, &le_hashmap_HashUInt32, &le_hashmap_EqualsUInt32));
     TestIterRemove(map1);
 
+    LE_INFO("***  Repeating the tests with resizable maps. ***");
+    map1 = le_hashmap_CreateResizable("RMap1", 200,
+                                      &le_hashmap_HashUInt32, &le_hashmap_EqualsUInt32);
+    map2 = le_hashmap_CreateResizable("RMap2", 200,
+                                      &le_hashmap_HashString, &le_hashmap_EqualsString);
+    map3 = le_hashmap_CreateResizable("RMap3", 200,
+                                      &le_hashmap_HashCustom, &le_hashmap_EqualsCustom);
+    map4 = le_hashmap_CreateResizable("RMap4", 1,
+                                      &le_hashmap_HashUInt32, &le_hashmap_EqualsUInt32);
+    map5 = le_hashmap_CreateResizable("RMap5", 1,
+                                      &le_hashmap_HashVoidPointer, &le_hashmap_EqualsVoidPointer);
+    LE_TEST(map1 && map2 && map3 && map4 && map5);
+
+    TestIntHashMap(map1);
+    TestStringHashMap(map2);
+    TestCustomHashMap(map3);
+    TestTinyMap(map4);
+    TestPointerMap(map5);
+    TestNewIter(le_hashmap_CreateResizable("RMap10", 2,
+                                           &le_hashmap_HashUInt32, &le_hashmap_EqualsUInt32));
+    TestIterRemove(map1);
+    TestResizable();
+
     LE_INFO("==== Hashmap Tests PASSED ====\n");
 
     LE_TEST_SUMMARY;
@@ -128,7 +153,9 @@ void TestIntHashMap(le_hashmap_Ref_t map)
         le_hashmap_GetValue(mapIt);
     }
     LE_INFO("Iterator count = %d", itercnt);
-    LE_TEST(itercnt == -1);
+    // Running past the end leaves the iterator on the last entry, so stepping back visits every
+    // entry but that one, once.
+    LE_TEST(itercnt == 1);
 
     // Cleanup the map again to allow it to be reused
     le_hashmap_RemoveAll(map);
@@ -282,11 +309,8 @@ bool le_hashmap_EqualsCustom(const void* firstPtr, const void* secondPtr)
     return ((k1->i == k2->i) && (le_hashmap_EqualsString(firstPtr, secondPtr)));
 }
 
-void TestNewIter()
+void TestNewIter(le_hashmap_Ref_t map10)
 {
-    LE_INFO("Creating int/int map for iter tests");
-    le_hashmap_Ref_t map10 = le_hashmap_Create("Map10", 13, &le_hashmap_HashUInt32, &le_hashmap_EqualsUInt32);
-
     uint32_t index = 0;
     uint32_t *iPtr = &index;
     uint32_t value = 0;
@@ -428,3 +452,102 @@ void TestIterRemove(le_hashmap_Ref_t map)
     LE_TEST(itercnt == 1000);
     LE_TEST(le_hashmap_Size(map) == 500);
 }
+
+void TestResizable(void)
+{
+    LE_INFO("*** Running resizable hashmap tests ***");
+
+    le_hashmap_Ref_t map = le_hashmap_CreateResizable("RMap11", 0, &le_hashmap_HashUInt32,
+                                                      &le_hashmap_EqualsUInt32);
+    static uint32_t keys[5000];
+    int j;
+    bool allFound = true;
+
+    // Grow from nothing, checking everything stays reachable while the index is migrating.
+    for (j = 0; j < 5000; j++)
+    {
+        keys[j] = j;
+        LE_ASSERT(le_hashmap_Put(map, &keys[j], &keys[j]) == NULL);
+        if (   (le_hashmap_Get(map, &keys[j / 2]) != &keys[j / 2])
+            || !le_hashmap_ContainsKey(map, &keys[0]) )
+        {
+            allFound = false;
+        }
+    }
+    LE_TEST(allFound && (le_hashmap_Size(map) == 5000));
+
+    // Remove most of them, making holes that have to be compacted away as more are added.
+    for (j = 0; j < 5000; j++)
+    {
+        if (j % 8 != 0)
+        {
+            LE_ASSERT(le_hashmap_Remove(map, &keys[j]) == &keys[j]);
+        }
+    }
+    LE_TEST(le_hashmap_Size(map) == 625);
+    LE_TEST(le_hashmap_Get(map, &keys[1]) == NULL);
+    LE_TEST(le_hashmap_Get(map, &keys[4000]) == &keys[4000]);
+
+    for (j = 0; j < 5000; j++)
+    {
+        if (j % 8 != 0)
+        {
+            le_hashmap_Put(map, &keys[j], &keys[j]);
+        }
+    }
+    LE_TEST(le_hashmap_Size(map) == 5000);
+
+    // Insertion order is kept, and removing or adding entries during iteration neither skips
+    // nor repeats the remaining ones, even if the additions cause compaction.
+    for (j = 0; j < 5000; j += 2)
+    {
+        le_hashmap_Remove(map, &keys[j]);
+    }
+
+    int count = 0;
+    uint32_t lastKey = 0;
+    bool inOrder = true;
+    le_hashmap_It_Ref_t mapIt = le_hashmap_GetIterator(map);
+    while (le_hashmap_NextNode(mapIt) == LE_OK)
+    {
+        const uint32_t* keyPtr = le_hashmap_GetKey(mapIt);
+        if (*keyPtr % 2 == 0)
+        {
+            // Stop at the re-added entries.
+            break;
+        }
+        if ((count > 0) && (*keyPtr < lastKey))
+        {
+            inOrder = false;
+        }
+        lastKey = *keyPtr;
+        count++;
+
+        le_hashmap_Remove(map, keyPtr);
+        LE_ASSERT(le_hashmap_GetKey(mapIt) == NULL);
+        if (count <= 1000)
+        {
+            le_hashmap_Put(map, &keys[count * 2], &keys[count * 2]);
+        }
+    }
+    LE_TEST(inOrder && (count == 2500));
+    LE_TEST(le_hashmap_Size(map) == 1000);
+
+    // Walking back from the end reaches the start.  Running past the end leaves the iterator on
+    // the last entry, so that one isn't visited again.
+    int backCount = 0;
+    mapIt = le_hashmap_GetIterator(map);
+    while (le_hashmap_NextNode(mapIt) == LE_OK)
+    {
+    }
+    while (le_hashmap_PrevNode(mapIt) == LE_OK)
+    {
+        backCount++;
+    }
+    LE_TEST(backCount == (int)le_hashmap_Size(map) - 1);
+
+    le_hashmap_RemoveAll(map);
+    LE_TEST(le_hashmap_isEmpty(map));
+    LE_TEST(le_hashmap_Put(map, &keys[7], &keys[7]) == NULL);
+    LE_TEST(le_hashmap_Get(map, &keys[7]) == &keys[7]);
+}
@@ -0,0 +1,136 @@
+/**
+ * Benchmark that measures le_mem allocate/release throughput with 1 to 8 threads all hammering
+ * the same pool, both with and without per-thread caches enabled for the pool.
+ *
+ * Prints one line per run, in the form:
+ *
+ *   memPoolBench threadCache=<objects> threads=<n> ops=<count> usec=<elapsed> opsPerSec=<rate>
+ *
+ * where an "op" is one allocation plus one release.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+
+/// Number of objects each thread holds at once.  Each thread allocates this many objects then
+/// releases them all again, over and over.
+#define OBJS_PER_BATCH      8
+
+/// Number of batches each thread allocates and releases.
+#define NUM_BATCHES         200000
+
+/// Maximum number of threads to run at once.
+#define MAX_THREADS         8
+
+/// Thread cache size used for the cached runs.
+#define THREAD_CACHE_SIZE   32
+
+typedef struct
+{
+    uint8_t payload[64];
+}
+Obj_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Worker thread.  Allocates and releases batches of objects from the pool passed in as context.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* WorkerMain
+(
+    void* contextPtr
+)
+{
+    le_mem_PoolRef_t pool = contextPtr;
+    Obj_t* objPtr[OBJS_PER_BATCH];
+    int batch;
+    int i;
+
+    for (batch = 0; batch < NUM_BATCHES; batch++)
+    {
+        for (i = 0; i < OBJS_PER_BATCH; i++)
+        {
+            objPtr[i] = le_mem_ForceAlloc(pool);
+            objPtr[i]->payload[0] = (uint8_t)i;
+        }
+
+        for (i = 0; i < OBJS_PER_BATCH; i++)
+        {
+            le_mem_Release(objPtr[i]);
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs the benchmark once with a given number of threads and prints the result.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunBenchmark
+(
+    size_t threadCacheSize,     ///< Thread cache size (0 = thread caching disabled).
+    int numThreads              ///< Number of worker threads.
+)
+{
+    char name[32];
+    le_thread_Ref_t threads[MAX_THREADS];
+    int i;
+
+    snprintf(name, sizeof(name), "Bench%zu-%d", threadCacheSize, numThreads);
+
+    le_mem_PoolRef_t pool = le_mem_CreatePool(name, sizeof(Obj_t));
+    if (threadCacheSize != 0)
+    {
+        le_mem_EnableThreadCache(pool, threadCacheSize);
+    }
+    le_mem_ExpandPool(pool, numThreads * (OBJS_PER_BATCH + threadCacheSize));
+
+    for (i = 0; i < numThreads; i++)
+    {
+        threads[i] = le_thread_Create(name, WorkerMain, pool);
+        le_thread_SetJoinable(threads[i]);
+    }
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < numThreads; i++)
+    {
+        le_thread_Start(threads[i]);
+    }
+    for (i = 0; i < numThreads; i++)
+    {
+        LE_ASSERT(le_thread_Join(threads[i], NULL) == LE_OK);
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    uint64_t usec = ((uint64_t)elapsed.sec * 1000000) + elapsed.usec;
+    uint64_t ops = (uint64_t)numThreads * NUM_BATCHES * OBJS_PER_BATCH;
+
+    printf("memPoolBench threadCache=%zu threads=%d ops=%" PRIu64 " usec=%" PRIu64
+           " opsPerSec=%.0f\n",
+           threadCacheSize,
+           numThreads,
+           ops,
+           usec,
+           (usec == 0) ? 0.0 : ((double)ops * 1000000.0 / (double)usec));
+}
+
+
+COMPONENT_INIT
+{
+    int numThreads;
+
+    for (numThreads = 1; numThreads <= MAX_THREADS; numThreads++)
+    {
+        RunBenchmark(0, numThreads);
+        RunBenchmark(THREAD_CACHE_SIZE, numThreads);
+    }
+
+    exit(EXIT_SUCCESS);
+}
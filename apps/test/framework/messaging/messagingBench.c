@@ -0,0 +1,693 @@
+/**
+ * Benchmark that measures the cost of Low-Level Messaging IPC between a client and a server in
+ * the same process (which still go through the Service Directory and a socket, or a shared memory
+ * transport, just like clients and servers in different processes do).
+ *
+ * Runs the following tests, for several payload sizes, over both the socket and the shared
+ * memory transport (le_msg_EnableSharedMemTransport()):
+ *
+ *  - oneway: the client sends messages with le_msg_Send(); latency is measured from the client
+ *            sending a message to the server's receive handler being called.
+ *  - sync:   the client does request-response transactions one at a time, with
+ *            le_msg_RequestSyncResponse().
+ *  - async:  the client keeps several request-response transactions going at once, with
+ *            le_msg_RequestResponse().
+ *
+ * Then it runs the sync test with a file descriptor sent with every request (fd), and with
+ * several client threads, each with its own session, doing sync transactions at the same time
+ * (clients).
+ *
+ * Prints one line per run, in the form:
+ *
+ *   messagingBench test=<name> transport=<socket|shm> clients=<n> payload=<bytes> msgs=<count>
+ *                  usec=<elapsed> msgsPerSec=<rate> bytesPerSec=<rate> p50Us=<latency>
+ *                  p90Us=<latency> p99Us=<latency> maxUs=<latency>
+ *
+ * (all on one line), where the latencies are one-way for the oneway test and round-trip for the
+ * others, and bytesPerSec counts the request payloads only.  The oneway client sends as fast as
+ * it can, so its latencies include the time messages spend queued up behind each other.
+ *
+ * Runs the testFwMessaging-Setup script first, to set up the binding.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+
+
+#define SERVICE_INSTANCE_NAME "messagingBench"
+
+#define PROTOCOL_ID_STR "messagingBench"
+
+/// Largest payload that is sent.
+#define MAX_PAYLOAD_SIZE    4096
+
+/// Number of messages sent by each client in each run.
+#define MSGS_PER_RUN        20000
+
+/// Number of request-response transactions that the async test keeps going at once.
+#define ASYNC_WINDOW        16
+
+/// Number of slots to ask for when using the shared memory transport.
+#define SHM_SLOT_COUNT      64
+
+/// Largest number of client threads in the clients test.
+#define MAX_CLIENTS         8
+
+/// Payload sizes to try.  They must all be big enough to hold a Header_t.
+static const size_t PayloadSizes[] = { 32, 256, 1024, MAX_PAYLOAD_SIZE };
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * What the server is asked to do with a message.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    KIND_ONE_WAY,       ///< Record the one-way latency.  No response.
+    KIND_ECHO,          ///< Respond with the same payload.
+    KIND_FLUSH          ///< Respond, once every message sent before it has been handled.
+}
+Kind_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start of every message's payload.  The rest of the payload is just filler.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    Kind_t          kind;       ///< What the server is asked to do with the message.
+    le_clk_Time_t   sentTime;   ///< When the client sent the message.
+}
+Header_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Results of a single client's part of a run.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t*   latencyUs;      ///< Latency of each message, in microseconds.
+    size_t      count;          ///< Number of latencies recorded so far.
+}
+Results_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Settings for a single client's part of a run.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct Client
+{
+    void (*runFunc)(struct Client*); ///< Function that runs the client's part of the test.
+    bool        useShm;         ///< true = ask for the shared memory transport.
+    bool        sendFd;         ///< true = send a file descriptor with every request.
+    size_t      payloadSize;    ///< Number of payload bytes in each message.
+    Results_t   results;        ///< Results of the run.
+
+    // Only used by event-driven clients:
+    void (*startFunc)(struct Client*); ///< Function that starts sending, once the session is open.
+    le_msg_SessionRef_t sessionRef; ///< Session with the service.
+    size_t      sentCount;      ///< Number of messages sent so far.
+    le_sem_Ref_t doneSem;       ///< Posted when the client is done.
+}
+Client_t;
+
+
+/// Protocol used by the benchmark.
+static le_msg_ProtocolRef_t ProtocolRef;
+
+/// One-way latencies recorded by the server.  Only accessed by the server thread while a oneway
+/// run is going on.
+static Results_t OneWayResults;
+
+/// File descriptor that the fd test sends copies of.
+static int BenchFd = -1;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the number of microseconds that have passed since a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GetUsSince
+(
+    le_clk_Time_t startTime
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return (uint32_t)((elapsed.sec * 1000000) + elapsed.usec);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message receive handler for the service.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ServerMsgRecvHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void*               contextPtr
+)
+{
+    Header_t* headerPtr = le_msg_GetPayloadPtr(msgRef);
+
+    int fd = le_msg_GetFd(msgRef);
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    switch (headerPtr->kind)
+    {
+        case KIND_ONE_WAY:
+            OneWayResults.latencyUs[OneWayResults.count++] = GetUsSince(headerPtr->sentTime);
+            le_msg_ReleaseMsg(msgRef);
+            break;
+
+        case KIND_ECHO:
+            le_msg_SetPayloadLength(msgRef, le_msg_GetPayloadLength(msgRef));
+            le_msg_Respond(msgRef);
+            break;
+
+        case KIND_FLUSH:
+            le_msg_SetPayloadLength(msgRef, sizeof(Header_t));
+            le_msg_Respond(msgRef);
+            break;
+
+        default:
+            LE_FATAL("Unexpected message kind %d.", headerPtr->kind);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the server thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ServerThreadMain
+(
+    void* contextPtr    ///< Semaphore to post once the service is advertised.
+)
+{
+    le_msg_ServiceRef_t serviceRef = le_msg_CreateService(ProtocolRef, SERVICE_INSTANCE_NAME);
+    le_msg_SetServiceRecvHandler(serviceRef, ServerMsgRecvHandler, NULL);
+    le_msg_AdvertiseService(serviceRef);
+
+    le_sem_Post(contextPtr);
+
+    le_event_RunLoop();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens a session with the service, in the calling thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_SessionRef_t OpenSession
+(
+    Client_t* clientPtr
+)
+{
+    le_msg_SessionRef_t sessionRef = le_msg_CreateSession(ProtocolRef, SERVICE_INSTANCE_NAME);
+
+    if (clientPtr->useShm)
+    {
+        le_msg_EnableSharedMemTransport(sessionRef, SHM_SLOT_COUNT);
+    }
+
+    le_msg_OpenSessionSync(sessionRef);
+
+    LE_FATAL_IF(clientPtr->useShm && !le_msg_IsSharedMemTransportActive(sessionRef),
+                "Shared memory transport could not be set up.");
+
+    return sessionRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a message to send to the server.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_MessageRef_t CreateMsg
+(
+    le_msg_SessionRef_t sessionRef,
+    Kind_t kind,
+    size_t payloadSize,
+    bool sendFd
+)
+{
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+    Header_t* headerPtr = le_msg_GetPayloadPtr(msgRef);
+
+    headerPtr->kind = kind;
+    le_msg_SetPayloadLength(msgRef, payloadSize);
+
+    if (sendFd)
+    {
+        le_msg_SetFd(msgRef, dup(BenchFd));
+    }
+
+    headerPtr->sentTime = le_clk_GetRelativeTime();
+
+    return msgRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs the sync test in the calling thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunSync
+(
+    Client_t* clientPtr
+)
+{
+    le_msg_SessionRef_t sessionRef = OpenSession(clientPtr);
+    size_t i;
+
+    for (i = 0; i < MSGS_PER_RUN; i++)
+    {
+        le_msg_MessageRef_t msgRef = CreateMsg(sessionRef,
+                                               KIND_ECHO,
+                                               clientPtr->payloadSize,
+                                               clientPtr->sendFd);
+        le_clk_Time_t sentTime = ((Header_t*)le_msg_GetPayloadPtr(msgRef))->sentTime;
+
+        msgRef = le_msg_RequestSyncResponse(msgRef);
+        LE_FATAL_IF(msgRef == NULL, "Request-response transaction failed.");
+
+        clientPtr->results.latencyUs[clientPtr->results.count++] = GetUsSince(sentTime);
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    le_msg_CloseSession(sessionRef);
+    le_msg_DeleteSession(sessionRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of an event-driven client's thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* EventClientThreadMain
+(
+    void* contextPtr
+)
+{
+    Client_t* clientPtr = contextPtr;
+
+    clientPtr->sessionRef = OpenSession(clientPtr);
+    clientPtr->sentCount = 0;
+
+    clientPtr->startFunc(clientPtr);
+
+    le_event_RunLoop();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs an event-driven client in a thread of its own, and waits for it to finish.
+ *
+ * Clients that send messages without waiting for them to be answered need an event loop, so
+ * the messages that don't fit in the socket can be sent later.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunEventClient
+(
+    Client_t* clientPtr,
+    void (*startFunc)(Client_t*)
+)
+{
+    clientPtr->startFunc = startFunc;
+    clientPtr->doneSem = le_sem_Create("ClientDone", 0);
+
+    le_thread_Start(le_thread_Create("EventClient", EventClientThreadMain, clientPtr));
+
+    le_sem_Wait(clientPtr->doneSem);
+    le_sem_Delete(clientPtr->doneSem);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ends an event-driven client's thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FinishEventClient
+(
+    Client_t* clientPtr
+)
+{
+    le_msg_CloseSession(clientPtr->sessionRef);
+    le_msg_DeleteSession(clientPtr->sessionRef);
+
+    le_sem_Post(clientPtr->doneSem);
+    le_thread_Exit(NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Completion callback for the flush request that ends the oneway test.  The server has handled
+ * all the messages by then.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OneWayFlushHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void*               contextPtr
+)
+{
+    Client_t* clientPtr = contextPtr;
+
+    LE_FATAL_IF(msgRef == NULL, "Flush failed.");
+    le_msg_ReleaseMsg(msgRef);
+
+    clientPtr->results.count = OneWayResults.count;
+
+    FinishEventClient(clientPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends all the messages of the oneway test, followed by a flush request.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartOneWay
+(
+    Client_t* clientPtr
+)
+{
+    size_t i;
+
+    OneWayResults.latencyUs = clientPtr->results.latencyUs;
+    OneWayResults.count = 0;
+
+    for (i = 0; i < MSGS_PER_RUN; i++)
+    {
+        le_msg_Send(CreateMsg(clientPtr->sessionRef, KIND_ONE_WAY, clientPtr->payloadSize, false));
+    }
+
+    le_msg_RequestResponse(CreateMsg(clientPtr->sessionRef, KIND_FLUSH, sizeof(Header_t), false),
+                           OneWayFlushHandler,
+                           clientPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs the oneway test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunOneWay
+(
+    Client_t* clientPtr
+)
+{
+    RunEventClient(clientPtr, StartOneWay);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends the next request of the async test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendAsyncRequest(Client_t* clientPtr);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Completion callback for the requests of the async test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AsyncResponseHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void*               contextPtr
+)
+{
+    Client_t* clientPtr = contextPtr;
+
+    LE_FATAL_IF(msgRef == NULL, "Request-response transaction failed.");
+
+    Header_t* headerPtr = le_msg_GetPayloadPtr(msgRef);
+    clientPtr->results.latencyUs[clientPtr->results.count++] = GetUsSince(headerPtr->sentTime);
+
+    le_msg_ReleaseMsg(msgRef);
+
+    if (clientPtr->sentCount < MSGS_PER_RUN)
+    {
+        SendAsyncRequest(clientPtr);
+    }
+    else if (clientPtr->results.count == MSGS_PER_RUN)
+    {
+        FinishEventClient(clientPtr);
+    }
+}
+
+
+static void SendAsyncRequest
+(
+    Client_t* clientPtr
+)
+{
+    le_msg_MessageRef_t msgRef = CreateMsg(clientPtr->sessionRef,
+                                           KIND_ECHO,
+                                           clientPtr->payloadSize,
+                                           false);
+    clientPtr->sentCount++;
+
+    le_msg_RequestResponse(msgRef, AsyncResponseHandler, clientPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts the async test, by sending the first window's worth of requests.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartAsync
+(
+    Client_t* clientPtr
+)
+{
+    size_t i;
+
+    for (i = 0; i < ASYNC_WINDOW; i++)
+    {
+        SendAsyncRequest(clientPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs the async test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunAsync
+(
+    Client_t* clientPtr
+)
+{
+    RunEventClient(clientPtr, StartAsync);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the client threads when a test is run with several clients at once.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ClientThreadMain
+(
+    void* contextPtr
+)
+{
+    Client_t* clientPtr = contextPtr;
+
+    clientPtr->runFunc(clientPtr);
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compares two latencies, for qsort().
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareLatencies
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    uint32_t a = *(const uint32_t*)aPtr;
+    uint32_t b = *(const uint32_t*)bPtr;
+
+    return (a > b) - (a < b);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs a test with a given number of clients at once, and prints the result.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunTest
+(
+    const char* testName,
+    void (*runFunc)(Client_t*), ///< Function that runs one client's part of the test.
+    size_t numClients,
+    bool useShm,
+    bool sendFd,
+    size_t payloadSize
+)
+{
+    Client_t clients[MAX_CLIENTS];
+    le_thread_Ref_t threads[MAX_CLIENTS];
+    size_t i;
+
+    // All the clients' latencies go in the same array, so they can be sorted together.
+    uint32_t* latencyUs = malloc(numClients * MSGS_PER_RUN * sizeof(uint32_t));
+    LE_ASSERT(latencyUs != NULL);
+
+    for (i = 0; i < numClients; i++)
+    {
+        memset(&clients[i], 0, sizeof(clients[i]));
+        clients[i].runFunc = runFunc;
+        clients[i].useShm = useShm;
+        clients[i].sendFd = sendFd;
+        clients[i].payloadSize = payloadSize;
+        clients[i].results.latencyUs = latencyUs + (i * MSGS_PER_RUN);
+    }
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    if (numClients == 1)
+    {
+        runFunc(&clients[0]);
+    }
+    else
+    {
+        for (i = 0; i < numClients; i++)
+        {
+            threads[i] = le_thread_Create("Client", ClientThreadMain, &clients[i]);
+            le_thread_SetJoinable(threads[i]);
+            le_thread_Start(threads[i]);
+        }
+        for (i = 0; i < numClients; i++)
+        {
+            LE_ASSERT(le_thread_Join(threads[i], NULL) == LE_OK);
+        }
+    }
+
+    uint64_t usec = GetUsSince(startTime);
+
+    // Gather up the latencies at the start of the array.
+    size_t count = 0;
+    for (i = 0; i < numClients; i++)
+    {
+        memmove(latencyUs + count, clients[i].results.latencyUs,
+                clients[i].results.count * sizeof(uint32_t));
+        count += clients[i].results.count;
+    }
+    LE_ASSERT(count == numClients * MSGS_PER_RUN);
+
+    qsort(latencyUs, count, sizeof(uint32_t), CompareLatencies);
+
+    double msgsPerSec = (usec == 0) ? 0.0 : ((double)count * 1000000.0 / (double)usec);
+
+    printf("messagingBench test=%s transport=%s clients=%zu payload=%zu msgs=%zu usec=%" PRIu64
+           " msgsPerSec=%.0f bytesPerSec=%.0f p50Us=%" PRIu32 " p90Us=%" PRIu32 " p99Us=%" PRIu32
+           " maxUs=%" PRIu32 "\n",
+           testName,
+           useShm ? "shm" : "socket",
+           numClients,
+           payloadSize,
+           count,
+           usec,
+           msgsPerSec,
+           msgsPerSec * payloadSize,
+           latencyUs[(count - 1) * 50 / 100],
+           latencyUs[(count - 1) * 90 / 100],
+           latencyUs[(count - 1) * 99 / 100],
+           latencyUs[count - 1]);
+    fflush(stdout);
+
+    free(latencyUs);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the thread that runs all the tests.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* BenchThreadMain
+(
+    void* contextPtr
+)
+{
+    size_t i;
+    size_t numClients;
+    int useShm;
+
+    for (useShm = 0; useShm <= 1; useShm++)
+    {
+        for (i = 0; i < NUM_ARRAY_MEMBERS(PayloadSizes); i++)
+        {
+            RunTest("oneway", RunOneWay, 1, useShm, false, PayloadSizes[i]);
+            RunTest("sync", RunSync, 1, useShm, false, PayloadSizes[i]);
+            RunTest("async", RunAsync, 1, useShm, false, PayloadSizes[i]);
+        }
+    }
+
+    RunTest("fd", RunSync, 1, false, true, PayloadSizes[0]);
+
+    for (numClients = 2; numClients <= MAX_CLIENTS; numClients *= 2)
+    {
+        RunTest("clients", RunSync, numClients, false, false, PayloadSizes[0]);
+        RunTest("clients", RunSync, numClients, true, false, PayloadSizes[0]);
+    }
+
+    exit(EXIT_SUCCESS);
+}
+
+
+COMPONENT_INIT
+{
+    LE_ASSERT(system("testFwMessaging-Setup > /dev/null") == 0);
+
+    BenchFd = open("/dev/null", O_RDONLY);
+    LE_ASSERT(BenchFd >= 0);
+
+    ProtocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, MAX_PAYLOAD_SIZE);
+
+    // Start the server and wait for it to advertise the service before starting the clients.
+    le_sem_Ref_t readySem = le_sem_Create("ServerReady", 0);
+    le_thread_Start(le_thread_Create("Server", ServerThreadMain, readySem));
+    le_sem_Wait(readySem);
+    le_sem_Delete(readySem);
+
+    le_thread_Start(le_thread_Create("Bench", BenchThreadMain, NULL));
+}
@@ -91,6 +91,7 @@ static void ClientResponseRecvHandler
         burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
         LE_INFO("Response %x received from server.", msgPtr->payload);
         LE_TEST(msgPtr->payload == 0xBEEFDEAD);
+        LE_TEST(le_msg_GetPayloadLength(msgRef) == sizeof(burger_Message_t));
 
         // Get the session reference before releasing the message.
         le_msg_SessionRef_t sessionRef = le_msg_GetSession(msgRef);
@@ -123,6 +124,7 @@ static void SendSomeStuffToServer
     msgRef = le_msg_CreateMsg(sessionRef);
     msgPtr = le_msg_GetPayloadPtr(msgRef);
     msgPtr->payload = 0xDEADBEEF;
+    le_msg_SetPayloadLength(msgRef, sizeof(msgPtr->payload));
     le_msg_RequestResponse(msgRef, ClientResponseRecvHandler, (void*)ClientRespContextStr);
 
     // Send a non-request message to the server.
@@ -0,0 +1,133 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Automated unit test for the Low-Level Messaging APIs.
+ *
+ * Test 4:
+ *  - Same as Test 1 (server and client in the same thread), but the client asks for its session
+ *    to use a shared memory transport.
+ *  - Tests that the transport gets set up without blocking the thread that serves the session.
+ *  - Sends more requests at once than the rings can hold, to test waking up the other side when
+ *    a slot is freed.
+ *  - Tests that an indication sent after the responses arrives after them.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "burgerProtocol.h"
+#include "burgerServer.h"
+
+
+#define SERVICE_INSTANCE_NAME "BoeufMort4"
+
+
+#define MAX_REQUEST_RESPONSE_TXNS 32
+
+
+#define SLOT_COUNT 8
+
+
+// ==================================
+//  CLIENT
+// ==================================
+
+static int ClientResponseCount = 0; // Count of the number of responses received from the server.
+
+
+// This function will be called whenever the server sends us an indication message (as opposed to
+// a response message).
+static void ClientIndicationRecvHandler
+(
+    le_msg_MessageRef_t  msgRef,    // Reference to the received message.
+    void*                contextPtr // contextPtr passed into le_msg_SetSessionRecvHandler().
+)
+{
+    burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+    LE_INFO("Indication message %x received from server.", msgPtr->payload);
+    LE_TEST(msgPtr->payload == 0xDEADDEAD);
+
+    LE_TEST(le_msg_IsSharedMemTransportActive(le_msg_GetSession(msgRef)));
+
+    le_msg_ReleaseMsg(msgRef);
+
+    // This is now the end of the test.  Check that we received all the responses first.
+    LE_TEST(ClientResponseCount == MAX_REQUEST_RESPONSE_TXNS);
+
+    LE_TEST_SUMMARY
+}
+
+
+// This function will be called whenever the server sends us a response message or our
+// request-response transaction fails.
+static void ClientResponseRecvHandler
+(
+    le_msg_MessageRef_t  msgRef,    // Reference to response message (NULL if transaction failed).
+    void*                contextPtr // contextPtr passed into le_msg_RequestResponse().
+)
+{
+    LE_TEST(msgRef != NULL);
+
+    if (msgRef != NULL)
+    {
+        ClientResponseCount++;
+
+        burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+        LE_TEST(msgPtr->payload == 0xBEEFDEAD);
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+}
+
+
+// This function will be called when the client-server session opens.
+static void SessionOpenHandlerFunc
+(
+    le_msg_SessionRef_t  sessionRef, // Reference to the session that opened.
+    void*                contextPtr  // contextPtr passed into le_msg_OpenSession().
+)
+{
+    LE_TEST(le_msg_IsSharedMemTransportActive(sessionRef));
+
+    // Send all the requests at once, so the client-to-server ring fills up.
+    int i;
+    for (i = 0; i < MAX_REQUEST_RESPONSE_TXNS; i++)
+    {
+        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+        burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+        msgPtr->payload = 0xDEADBEEF;
+        le_msg_RequestResponse(msgRef, ClientResponseRecvHandler, NULL);
+    }
+}
+
+
+// Start the client.
+static void ClientStart
+(
+    const char* serviceInstanceName
+)
+{
+    le_msg_ProtocolRef_t protocolRef;
+    le_msg_SessionRef_t sessionRef;
+
+    // Open a session that uses shared memory.
+    protocolRef = le_msg_GetProtocolRef(BURGER_PROTOCOL_ID_STR, sizeof(burger_Message_t));
+    sessionRef = le_msg_CreateSession(protocolRef, serviceInstanceName);
+    le_msg_SetSessionRecvHandler(sessionRef, ClientIndicationRecvHandler, NULL);
+    le_msg_EnableSharedMemTransport(sessionRef, SLOT_COUNT);
+    LE_TEST(!le_msg_IsSharedMemTransportActive(sessionRef));
+    le_msg_OpenSession(sessionRef, SessionOpenHandlerFunc, NULL);
+}
+
+
+// Component initialization function.
+COMPONENT_INIT
+{
+    LE_INFO("======= Test 4: Shared memory transport ========");
+
+    system("testFwMessaging-Setup");
+
+    burgerServer_Start(SERVICE_INSTANCE_NAME, MAX_REQUEST_RESPONSE_TXNS);
+
+    ClientStart(SERVICE_INSTANCE_NAME);
+}
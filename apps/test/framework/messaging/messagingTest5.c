@@ -0,0 +1,189 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Automated unit test for the Low-Level Messaging APIs.
+ *
+ * Test 5:
+ *  - Server and several clients in the same thread, but the service has a worker pool.
+ *  - Tests that requests are handled in the worker threads, not the server thread.
+ *  - Tests that requests from different sessions are handled at the same time.
+ *  - Tests that requests from the same session are handled, and responded to, in order.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "burgerProtocol.h"
+
+
+#define SERVICE_INSTANCE_NAME "BoeufMort5"
+
+
+#define WORKER_COUNT 2
+
+
+#define SESSION_COUNT WORKER_COUNT
+
+
+#define REQUESTS_PER_SESSION 4
+
+
+/// Time each request takes to handle, in microseconds.
+#define REQUEST_DELAY_US 100000
+
+
+// ==================================
+//  SERVER
+// ==================================
+
+static le_thread_Ref_t ServerThread;
+
+static int ActiveHandlerCount = 0;  // Number of requests being handled right now.
+static int MaxActiveHandlerCount = 0;
+
+
+// This function will be called by the worker threads whenever a client sends us a message.
+static void ServerMsgRecvHandler
+(
+    le_msg_MessageRef_t msgRef,     // Reference to the received message.
+    void*               contextPtr  // contextPtr passed to le_msg_SetServiceRecvHandler().
+)
+{
+    LE_TEST(le_thread_GetCurrent() != ServerThread);
+    LE_TEST(le_msg_GetServiceRxMsg() == msgRef);
+
+    int activeCount = __atomic_add_fetch(&ActiveHandlerCount, 1, __ATOMIC_SEQ_CST);
+    int maxCount = __atomic_load_n(&MaxActiveHandlerCount, __ATOMIC_SEQ_CST);
+    while (   (activeCount > maxCount)
+           && !__atomic_compare_exchange_n(&MaxActiveHandlerCount, &maxCount, activeCount,
+                                           false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    {
+    }
+
+    // Take a while, like a server waiting for some hardware would.
+    usleep(REQUEST_DELAY_US);
+
+    __atomic_sub_fetch(&ActiveHandlerCount, 1, __ATOMIC_SEQ_CST);
+
+    // Echo the request's sequence number back to the client.
+    LE_TEST(le_msg_NeedsResponse(msgRef));
+    le_msg_Respond(msgRef);
+}
+
+
+// Start the server.
+static void ServerStart
+(
+    const char* serviceInstanceName
+)
+{
+    le_msg_ProtocolRef_t protocolRef;
+    le_msg_ServiceRef_t serviceRef;
+
+    ServerThread = le_thread_GetCurrent();
+
+    protocolRef = le_msg_GetProtocolRef(BURGER_PROTOCOL_ID_STR, sizeof(burger_Message_t));
+    serviceRef = le_msg_CreateService(protocolRef, serviceInstanceName);
+    le_msg_SetServiceRecvHandler(serviceRef, ServerMsgRecvHandler, NULL);
+    le_msg_SetServiceWorkerPool(serviceRef, WORKER_COUNT);
+    le_msg_AdvertiseService(serviceRef);
+}
+
+
+// ==================================
+//  CLIENT
+// ==================================
+
+static uint32_t ResponseCounts[SESSION_COUNT];  // Responses received so far, per session.
+static int DoneSessionCount = 0;
+
+
+// This function will be called whenever the server sends us a response message or our
+// request-response transaction fails.
+static void ClientResponseRecvHandler
+(
+    le_msg_MessageRef_t  msgRef,    // Reference to response message (NULL if transaction failed).
+    void*                contextPtr // contextPtr passed into le_msg_RequestResponse().
+)
+{
+    uint32_t* countPtr = contextPtr;
+
+    LE_TEST(msgRef != NULL);
+
+    if (msgRef != NULL)
+    {
+        // Responses must come back in the order the requests were sent.
+        burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+        LE_TEST(msgPtr->payload == *countPtr);
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    (*countPtr)++;
+
+    if (*countPtr == REQUESTS_PER_SESSION)
+    {
+        DoneSessionCount++;
+    }
+
+    // This is the end of the test once all sessions are done.  With every session handled by its
+    // own worker, the requests must have been handled in parallel.
+    if (DoneSessionCount == SESSION_COUNT)
+    {
+        LE_INFO("At most %d requests were handled at the same time.", MaxActiveHandlerCount);
+        LE_TEST(MaxActiveHandlerCount == WORKER_COUNT);
+
+        LE_TEST_SUMMARY
+    }
+}
+
+
+// This function will be called when a client-server session opens.
+static void SessionOpenHandlerFunc
+(
+    le_msg_SessionRef_t  sessionRef, // Reference to the session that opened.
+    void*                contextPtr  // contextPtr passed into le_msg_OpenSession().
+)
+{
+    // Send all the requests at once, numbered so the order of the responses can be checked.
+    uint32_t i;
+    for (i = 0; i < REQUESTS_PER_SESSION; i++)
+    {
+        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+        burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+        msgPtr->payload = i;
+        le_msg_RequestResponse(msgRef, ClientResponseRecvHandler, contextPtr);
+    }
+}
+
+
+// Start the clients.
+static void ClientStart
+(
+    const char* serviceInstanceName
+)
+{
+    le_msg_ProtocolRef_t protocolRef;
+    int i;
+
+    protocolRef = le_msg_GetProtocolRef(BURGER_PROTOCOL_ID_STR, sizeof(burger_Message_t));
+
+    for (i = 0; i < SESSION_COUNT; i++)
+    {
+        le_msg_SessionRef_t sessionRef = le_msg_CreateSession(protocolRef, serviceInstanceName);
+        le_msg_OpenSession(sessionRef, SessionOpenHandlerFunc, &ResponseCounts[i]);
+    }
+}
+
+
+// Component initialization function.
+COMPONENT_INIT
+{
+    LE_INFO("======= Test 5: Service with a worker pool ========");
+
+    system("testFwMessaging-Setup");
+
+    ServerStart(SERVICE_INSTANCE_NAME);
+
+    ClientStart(SERVICE_INSTANCE_NAME);
+}
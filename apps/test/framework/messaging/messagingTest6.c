@@ -0,0 +1,175 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Automated unit test for the Low-Level Messaging APIs.
+ *
+ * Test 6:
+ *  - Server in its own thread, client opening several sessions in one open batch.
+ *  - Tests that a message sent, or a request made, on a session before the batch is finished
+ *    opens that session first and gets through.
+ *  - Tests that a session can be closed, or deleted, while its open is still pending, and that
+ *    finishing the batch afterwards doesn't wait for it.
+ *  - Tests that a session closed while pending can be opened again.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "burgerProtocol.h"
+#include "burgerServer.h"
+
+
+#define SERVICE_INSTANCE_NAME "BoeufMort6"
+
+
+/// High enough that the server never ends the test with an indication.
+#define MAX_REQUEST_RESPONSE_TXNS 100
+
+
+// ==================================
+//  SERVER
+// ==================================
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function for the server thread.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void* ServerThreadMain
+(
+    void* opaqueContextPtr  ///< not used
+)
+//--------------------------------------------------------------------------------------------------
+{
+    burgerServer_Start(SERVICE_INSTANCE_NAME, MAX_REQUEST_RESPONSE_TXNS);
+
+    le_event_RunLoop();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start the server thread.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void StartServer
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_thread_Start(le_thread_Create("MsgTest6Server", ServerThreadMain, NULL));
+}
+
+
+// ==================================
+//  CLIENT
+// ==================================
+
+/// Sessions opened in the batch, by what the test does with them before finishing the batch.
+enum
+{
+    SESSION_SEND,       ///< Sends a message that doesn't need a response.
+    SESSION_REQUEST,    ///< Does a synchronous request-response transaction.
+    SESSION_CLOSE,      ///< Is closed.
+    SESSION_DELETE,     ///< Is deleted.
+    SESSION_IDLE,       ///< Is left alone until the batch is finished.
+    SESSION_COUNT
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Does a synchronous request-response transaction on a session and checks the response.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void DoRequest
+(
+    le_msg_SessionRef_t sessionRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+    burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+    msgPtr->payload = 0xDEADBEEF;
+
+    msgRef = le_msg_RequestSyncResponse(msgRef);
+    LE_TEST(msgRef != NULL);
+
+    if (msgRef != NULL)
+    {
+        msgPtr = le_msg_GetPayloadPtr(msgRef);
+        LE_TEST(msgPtr->payload == 0xBEEFDEAD);
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the client.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void RunClient
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_ProtocolRef_t protocolRef;
+    le_msg_SessionRef_t sessionRefs[SESSION_COUNT];
+    int i;
+
+    protocolRef = le_msg_GetProtocolRef(BURGER_PROTOCOL_ID_STR, sizeof(burger_Message_t));
+
+    le_msg_StartOpenBatch();
+
+    for (i = 0; i < SESSION_COUNT; i++)
+    {
+        sessionRefs[i] = le_msg_CreateSession(protocolRef, SERVICE_INSTANCE_NAME);
+        le_msg_OpenSessionSync(sessionRefs[i]);
+    }
+
+    // Use some of the sessions before their opens are collected.
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRefs[SESSION_SEND]);
+    burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+    msgPtr->payload = 0xBEEFBEEF;
+    le_msg_Send(msgRef);
+
+    DoRequest(sessionRefs[SESSION_REQUEST]);
+
+    // Give up on some of the others.
+    le_msg_CloseSession(sessionRefs[SESSION_CLOSE]);
+    le_msg_DeleteSession(sessionRefs[SESSION_DELETE]);
+
+    le_msg_FinishOpenBatch();
+
+    // Every session that is still around can be used now, and the closed one can be reopened.
+    DoRequest(sessionRefs[SESSION_SEND]);
+    DoRequest(sessionRefs[SESSION_REQUEST]);
+    DoRequest(sessionRefs[SESSION_IDLE]);
+
+    le_msg_OpenSessionSync(sessionRefs[SESSION_CLOSE]);
+    DoRequest(sessionRefs[SESSION_CLOSE]);
+
+    // A new batch can be started once the last one is finished, even an empty one.
+    le_msg_StartOpenBatch();
+    le_msg_FinishOpenBatch();
+
+    LE_TEST_SUMMARY
+}
+
+
+// Component initialization function.
+COMPONENT_INIT
+{
+    LE_INFO("======= Test 6: Batched session opens ========");
+
+    system("testFwMessaging-Setup");
+
+    StartServer();
+
+    RunClient();
+}
@@ -0,0 +1,239 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Automated unit test for the Low-Level Messaging APIs.
+ *
+ * Test 7:
+ *  - Server and several clients in the same thread, but the service has a worker pool.
+ *  - Tests that a worker thread can kill a client with LE_KILL_CLIENT, and can release a request
+ *    without responding to it, and that both close the client's session.
+ *  - Tests that the server's close handler is called by the server thread when that happens.
+ *  - Tests that the server carries on serving its other clients afterwards.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "burgerProtocol.h"
+
+
+#define SERVICE_INSTANCE_NAME "BoeufMort7"
+
+
+#define WORKER_COUNT 2
+
+
+/// Sessions opened by the client, by what their request asks the server to do.
+enum
+{
+    SESSION_KILL,       ///< Kill the client with LE_KILL_CLIENT.
+    SESSION_ABANDON,    ///< Release the request without responding.
+    SESSION_ECHO,       ///< Respond (only once the other sessions are closed).
+    SESSION_COUNT
+};
+
+
+// ==================================
+//  SERVER
+// ==================================
+
+static le_thread_Ref_t ServerThread;
+
+static int ServerCloseCount = 0;    // Number of times the server's close handler was called.
+
+
+// This function will be called by the worker threads whenever a client sends us a message.
+static void ServerMsgRecvHandler
+(
+    le_msg_MessageRef_t msgRef,     // Reference to the received message.
+    void*               contextPtr  // contextPtr passed to le_msg_SetServiceRecvHandler().
+)
+{
+    LE_TEST(le_thread_GetCurrent() != ServerThread);
+
+    burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+
+    switch (msgPtr->payload)
+    {
+        case SESSION_KILL:
+            // This is what generated server code does when a client sends something invalid.
+            LE_KILL_CLIENT("Killing client on purpose.");
+            le_msg_ReleaseMsg(msgRef);
+            break;
+
+        case SESSION_ABANDON:
+            le_msg_ReleaseMsg(msgRef);
+            break;
+
+        default:
+            le_msg_Respond(msgRef);
+            break;
+    }
+}
+
+
+// This function will be called whenever a session with one of our clients closes.
+static void ServerSessionCloseHandler
+(
+    le_msg_SessionRef_t sessionRef, // Reference to the session that closed.
+    void*               contextPtr  // contextPtr passed to le_msg_AddServiceCloseHandler().
+)
+{
+    LE_TEST(le_thread_GetCurrent() == ServerThread);
+
+    ServerCloseCount++;
+}
+
+
+// Start the server.
+static void ServerStart
+(
+    const char* serviceInstanceName
+)
+{
+    le_msg_ProtocolRef_t protocolRef;
+    le_msg_ServiceRef_t serviceRef;
+
+    ServerThread = le_thread_GetCurrent();
+
+    protocolRef = le_msg_GetProtocolRef(BURGER_PROTOCOL_ID_STR, sizeof(burger_Message_t));
+    serviceRef = le_msg_CreateService(protocolRef, serviceInstanceName);
+    le_msg_SetServiceRecvHandler(serviceRef, ServerMsgRecvHandler, NULL);
+    le_msg_AddServiceCloseHandler(serviceRef, ServerSessionCloseHandler, NULL);
+    le_msg_SetServiceWorkerPool(serviceRef, WORKER_COUNT);
+    le_msg_AdvertiseService(serviceRef);
+}
+
+
+// ==================================
+//  CLIENT
+// ==================================
+
+static le_msg_SessionRef_t SessionRefs[SESSION_COUNT];
+static int OpenSessionCount = 0;
+static int ClosedSessionCount = 0;
+
+
+// Sends a request, numbered with the session's index, through one of the sessions.
+static void SendRequest
+(
+    int sessionIndex,
+    le_msg_ResponseCallback_t handlerFunc
+)
+{
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(SessionRefs[sessionIndex]);
+    burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+    msgPtr->payload = sessionIndex;
+    le_msg_RequestResponse(msgRef, handlerFunc, NULL);
+}
+
+
+// This function will be called when the server responds to the request sent once the other
+// sessions were closed.  This is the end of the test.
+static void EchoResponseHandler
+(
+    le_msg_MessageRef_t  msgRef,    // Reference to response message (NULL if transaction failed).
+    void*                contextPtr // contextPtr passed into le_msg_RequestResponse().
+)
+{
+    LE_TEST(msgRef != NULL);
+
+    if (msgRef != NULL)
+    {
+        burger_Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+        LE_TEST(msgPtr->payload == SESSION_ECHO);
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    // Each closed session must have been reported to the server.
+    LE_TEST(ServerCloseCount >= SESSION_ECHO);
+
+    LE_TEST_SUMMARY
+}
+
+
+// This function will be called if the server ever responds to one of the requests that make it
+// close the session.
+static void UnexpectedResponseHandler
+(
+    le_msg_MessageRef_t  msgRef,    // Reference to response message (NULL if transaction failed).
+    void*                contextPtr // contextPtr passed into le_msg_RequestResponse().
+)
+{
+    LE_TEST(msgRef == NULL);
+
+    if (msgRef != NULL)
+    {
+        le_msg_ReleaseMsg(msgRef);
+    }
+}
+
+
+// This function will be called when the server closes one of the sessions.
+static void ClientSessionCloseHandler
+(
+    le_msg_SessionRef_t  sessionRef, // Reference to the session that closed.
+    void*                contextPtr  // contextPtr passed into le_msg_SetSessionCloseHandler().
+)
+{
+    LE_TEST(sessionRef != SessionRefs[SESSION_ECHO]);
+
+    ClosedSessionCount++;
+
+    // Once the server has closed both sessions, make sure it still serves the last one.
+    if (ClosedSessionCount == SESSION_ECHO)
+    {
+        SendRequest(SESSION_ECHO, EchoResponseHandler);
+    }
+}
+
+
+// This function will be called when a client-server session opens.
+static void SessionOpenHandlerFunc
+(
+    le_msg_SessionRef_t  sessionRef, // Reference to the session that opened.
+    void*                contextPtr  // contextPtr passed into le_msg_OpenSession().
+)
+{
+    OpenSessionCount++;
+
+    if (OpenSessionCount == SESSION_COUNT)
+    {
+        SendRequest(SESSION_KILL, UnexpectedResponseHandler);
+        SendRequest(SESSION_ABANDON, UnexpectedResponseHandler);
+    }
+}
+
+
+// Start the clients.
+static void ClientStart
+(
+    const char* serviceInstanceName
+)
+{
+    le_msg_ProtocolRef_t protocolRef;
+    int i;
+
+    protocolRef = le_msg_GetProtocolRef(BURGER_PROTOCOL_ID_STR, sizeof(burger_Message_t));
+
+    for (i = 0; i < SESSION_COUNT; i++)
+    {
+        SessionRefs[i] = le_msg_CreateSession(protocolRef, serviceInstanceName);
+        le_msg_SetSessionCloseHandler(SessionRefs[i], ClientSessionCloseHandler, NULL);
+        le_msg_OpenSession(SessionRefs[i], SessionOpenHandlerFunc, NULL);
+    }
+}
+
+
+// Component initialization function.
+COMPONENT_INIT
+{
+    LE_INFO("======= Test 7: Worker pool closing sessions ========");
+
+    system("testFwMessaging-Setup");
+
+    ServerStart(SERVICE_INSTANCE_NAME);
+
+    ClientStart(SERVICE_INSTANCE_NAME);
+}
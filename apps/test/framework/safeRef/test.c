@@ -64,6 +64,57 @@ COMPONENT_INIT
     LE_ASSERT(le_ref_Lookup(mapRef1, &mapRef1) == NULL);
     LE_INFO("Looking up a pointer value failed, as expected");
 
+    LE_INFO("Checking deleted references stay invalid when their slots are reused.");
+    le_ref_DeleteRef(mapRef1, safeRef2);
+    void* safeRef5 = le_ref_CreateRef(mapRef1, (void*)0x1005);
+    LE_ASSERT(safeRef5 != safeRef2);
+    LE_ASSERT(le_ref_Lookup(mapRef1, safeRef2) == NULL);
+    LE_ASSERT(le_ref_Lookup(mapRef1, safeRef5) == (void*)0x1005);
+    LE_INFO("Deleting a stale reference (expect ERROR)");
+    le_ref_DeleteRef(mapRef1, safeRef2);
+    LE_ASSERT(le_ref_Lookup(mapRef1, safeRef5) == (void*)0x1005);
+
+    le_ref_MapRef_t mapRef2 = le_ref_CreateMap("Map 2", 4);
+    LE_ASSERT(le_ref_Lookup(mapRef2, safeRef1) == NULL);
+    LE_INFO("Looking up a reference from another map failed, as expected");
+
+    LE_INFO("Growing map %p past its expected size.", mapRef2);
+    static void* refs[1000];
+    int i;
+    for (i = 0; i < 1000; i++)
+    {
+        refs[i] = le_ref_CreateRef(mapRef2, &refs[i]);
+        LE_ASSERT(((uintptr_t)refs[i] & 1) == 1);
+    }
+    for (i = 0; i < 1000; i++)
+    {
+        LE_ASSERT(le_ref_Lookup(mapRef2, refs[i]) == &refs[i]);
+    }
+
+    LE_INFO("Deleting every other reference while iterating.");
+    int count = 0;
+    le_ref_IterRef_t iterRef = le_ref_GetIterator(mapRef2);
+    LE_ASSERT(le_ref_GetSafeRef(iterRef) == NULL);
+    while (le_ref_NextNode(iterRef) == LE_OK)
+    {
+        void* safeRef = (void*)le_ref_GetSafeRef(iterRef);
+        void** valuePtr = le_ref_GetValue(iterRef);
+        LE_ASSERT(le_ref_Lookup(mapRef2, safeRef) == valuePtr);
+        LE_ASSERT(*valuePtr == safeRef);
+
+        if (count % 2 == 0)
+        {
+            le_ref_DeleteRef(mapRef2, safeRef);
+            LE_ASSERT(le_ref_GetSafeRef(iterRef) == NULL);
+        }
+        count++;
+    }
+    LE_ASSERT(count == 1000);
+    for (i = 0; i < 1000; i++)
+    {
+        LE_ASSERT(le_ref_Lookup(mapRef2, refs[i]) == ((i % 2 == 0) ? NULL : &refs[i]));
+    }
+
 
     LE_INFO("======== SAFE REFERENCES TEST COMPLETE (PASSED) ========");
     exit(EXIT_SUCCESS);
@@ -0,0 +1,162 @@
+/**
+ * Benchmark that measures how many times a thread has to wake up to service a set of repeating
+ * timers with staggered intervals, with different amounts of timer slack (le_timer_SetSlack()).
+ *
+ * Prints one line per run, in the form:
+ *
+ *   timerSlackBench slackMs=<slack> timers=<n> expiries=<count> wakeups=<count> usec=<elapsed>
+ *
+ * where "wakeups" is the number of voluntary context switches the thread made during the run
+ * (i.e., the number of times its event loop went to sleep waiting for the next timer).
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include <sys/resource.h>
+
+/// Number of repeating timers running at once.
+#define NUM_TIMERS      100
+
+/// How long each run lasts, in milliseconds.
+#define RUN_TIME_MS     2000
+
+/// Slack values to try, in milliseconds.
+static const uint32_t SlackMs[] = { 0, 5, 20, 50 };
+
+/// The repeating timers.
+static le_timer_Ref_t Timers[NUM_TIMERS];
+
+/// The timer that ends each run.
+static le_timer_Ref_t RunTimer;
+
+/// Index into SlackMs[] of the current run.
+static size_t RunIndex = 0;
+
+/// Number of times the repeating timers have expired during the current run.
+static uint64_t ExpiryCount;
+
+/// Voluntary context switch count and time at the start of the current run.
+static long StartSwitches;
+static le_clk_Time_t StartTime;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of voluntary context switches made by the calling thread so far.
+ */
+//--------------------------------------------------------------------------------------------------
+static long GetSwitches
+(
+    void
+)
+{
+    struct rusage usage;
+
+    LE_ASSERT(getrusage(RUSAGE_THREAD, &usage) == 0);
+
+    return usage.ru_nvcsw;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Repeating timer expiry handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TimerExpired
+(
+    le_timer_Ref_t timerRef
+)
+{
+    (void)timerRef;
+
+    ExpiryCount++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a run using the slack at RunIndex.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartRun
+(
+    void
+)
+{
+    int i;
+
+    ExpiryCount = 0;
+    StartTime = le_clk_GetRelativeTime();
+    StartSwitches = GetSwitches();
+
+    for (i = 0; i < NUM_TIMERS; i++)
+    {
+        LE_ASSERT(le_timer_SetSlack(Timers[i], SlackMs[RunIndex]) == LE_OK);
+        LE_ASSERT(le_timer_Start(Timers[i]) == LE_OK);
+    }
+
+    LE_ASSERT(le_timer_Start(RunTimer) == LE_OK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run timer expiry handler.  Prints the results of the run and starts the next one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunFinished
+(
+    le_timer_Ref_t timerRef
+)
+{
+    (void)timerRef;
+
+    long switches = GetSwitches() - StartSwitches;
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+    int i;
+
+    for (i = 0; i < NUM_TIMERS; i++)
+    {
+        LE_ASSERT(le_timer_Stop(Timers[i]) == LE_OK);
+    }
+
+    printf("timerSlackBench slackMs=%" PRIu32 " timers=%d expiries=%" PRIu64
+           " wakeups=%ld usec=%" PRIu64 "\n",
+           SlackMs[RunIndex],
+           NUM_TIMERS,
+           ExpiryCount,
+           switches,
+           (uint64_t)elapsed.sec * 1000000 + elapsed.usec);
+
+    RunIndex++;
+    if (RunIndex >= NUM_ARRAY_MEMBERS(SlackMs))
+    {
+        exit(EXIT_SUCCESS);
+    }
+
+    StartRun();
+}
+
+
+COMPONENT_INIT
+{
+    int i;
+
+    // Give the timers staggered intervals between 20 and 49 ms, so that without slack their
+    // expiries are spread out.
+    for (i = 0; i < NUM_TIMERS; i++)
+    {
+        Timers[i] = le_timer_Create("bench");
+        LE_ASSERT(le_timer_SetMsInterval(Timers[i], 20 + ((i * 13) % 30)) == LE_OK);
+        LE_ASSERT(le_timer_SetRepeat(Timers[i], 0) == LE_OK);
+        LE_ASSERT(le_timer_SetHandler(Timers[i], TimerExpired) == LE_OK);
+    }
+
+    RunTimer = le_timer_Create("run");
+    LE_ASSERT(le_timer_SetMsInterval(RunTimer, RUN_TIME_MS) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(RunTimer, RunFinished) == LE_OK);
+
+    StartRun();
+}
@@ -240,12 +240,104 @@ void timerEventLoopTest(void)
 }
 
 
+// Number of timers used to check the order in which many active timers expire.
+#define NUM_ORDER_TEST_TIMERS 200
+
+// Timers used by the order test.
+static le_timer_Ref_t OrderTestTimers[NUM_ORDER_TEST_TIMERS];
+
+// Number of order test timers that are expected to expire, and have expired.
+static int OrderTestExpected = 0;
+static int OrderTestExpired = 0;
+
+// The index of the order test timer that expired most recently, or -1.
+static int OrderTestLastIndex = -1;
+
+
+// Interval for order test timer i, in milliseconds.  Many timers share the same interval.
+static uint32_t OrderTestInterval
+(
+    int i
+)
+{
+    return (((i * 37) % 20) + 1) * 10;
+}
+
+
+void OrderTestExpiryHandler
+(
+    le_timer_Ref_t timerRef    ///< This timer has expired
+)
+{
+    int i = (int)(size_t)le_timer_GetContextPtr(timerRef);
+
+    // Stopped timers must never expire.
+    LE_FATAL_IF((i % 3) == 0, "TEST FAILED: stopped timer %d expired", i);
+
+    // Timers must expire in order of interval, and in the order they were started for timers
+    // with the same interval.
+    if (OrderTestLastIndex != -1)
+    {
+        uint32_t lastInterval = OrderTestInterval(OrderTestLastIndex);
+
+        LE_FATAL_IF(   (OrderTestInterval(i) < lastInterval)
+                    || ((OrderTestInterval(i) == lastInterval) && (i < OrderTestLastIndex)),
+                    "TEST FAILED: timer %d expired after timer %d", i, OrderTestLastIndex);
+    }
+    OrderTestLastIndex = i;
+
+    OrderTestExpired++;
+    if (OrderTestExpired == OrderTestExpected)
+    {
+        LE_INFO("ORDER TEST PASSED: %d timers expired in order", OrderTestExpired);
+
+        for (i = 0; i < NUM_ORDER_TEST_TIMERS; i++)
+        {
+            le_timer_Delete(OrderTestTimers[i]);
+        }
+
+        timerEventLoopTest();
+    }
+}
+
+
+void timerOrderTest(void)
+{
+    int i;
+
+    // Start a lot of timers, then stop every third one.
+    for (i = 0; i < NUM_ORDER_TEST_TIMERS; i++)
+    {
+        OrderTestTimers[i] = le_timer_Create("order timer");
+
+        le_timer_SetMsInterval(OrderTestTimers[i], OrderTestInterval(i));
+        le_timer_SetContextPtr(OrderTestTimers[i], (void*)(size_t)i);
+        le_timer_SetHandler(OrderTestTimers[i], OrderTestExpiryHandler);
+
+        le_timer_Start(OrderTestTimers[i]);
+    }
+
+    for (i = 0; i < NUM_ORDER_TEST_TIMERS; i++)
+    {
+        if ((i % 3) == 0)
+        {
+            LE_FATAL_IF(le_timer_Stop(OrderTestTimers[i]) != LE_OK, "TEST FAILED: stop failed");
+        }
+        else
+        {
+            OrderTestExpected++;
+        }
+    }
+}
+
+
 COMPONENT_INIT
 {
     LE_INFO("\n");
     LE_INFO("====  Unit test for le_timer module. ====");
 
-    timerEventLoopTest();
+    // The order test runs the rest of the tests when it has finished.
+    timerOrderTest();
 
     LE_INFO("==== Timer Tests Started ====\n");
 }
@@ -294,9 +294,11 @@ static le_mem_PoolRef_t ActionHandlerDataPoolRef = NULL;
 /**
  * This pool is used for the string representation of a LWM2M address, which is used as a key in a
  * hashmap, e.g. (appName, assetId) to be used with AssetMap. Initialized in assetData_Init().
+ *
+ * Addresses are usually much shorter than the maximum, so a variable-size pool is used.
  */
 //--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t AddressStringPoolRef = NULL;
+static le_mem_VarPoolRef_t AddressStringPoolRef = NULL;
 
 
 //--------------------------------------------------------------------------------------------------
@@ -846,8 +848,8 @@ static le_result_t AddAssetData
 )
 {
     AssetData_t* assetDataPtr;
-    char* appNameAssetIdPtr;
-    char* appNameAssetNamePtr;
+    char appNameAssetId[100];
+    char appNameAssetName[100];
 
     assetDataPtr = le_mem_ForceAlloc(AssetDataPoolRef);
     assetDataPtr->assetId = assetId;
@@ -861,21 +863,26 @@ static le_result_t AddAssetData
 
     // Put (appName, assetId) key in AssetMap, pointing to the assetData block
     // Put (appName, assetName) key in AssetMapByName, pointing to the same assetData block
-    appNameAssetIdPtr = le_mem_ForceAlloc(AddressStringPoolRef);
-    appNameAssetNamePtr = le_mem_ForceAlloc(AddressStringPoolRef);
-
-    if ( ( FormatString(appNameAssetIdPtr, 100, "%s/%i", appNamePtr, assetId) != LE_OK ) ||
-         ( FormatString(appNameAssetNamePtr, 100, "%s/%s", appNamePtr, assetNamePtr) != LE_OK ) )
+    if ( ( FormatString(appNameAssetId,
+                        sizeof(appNameAssetId),
+                        "%s/%i",
+                        appNamePtr,
+                        assetId) != LE_OK ) ||
+         ( FormatString(appNameAssetName,
+                        sizeof(appNameAssetName),
+                        "%s/%s",
+                        appNamePtr,
+                        assetNamePtr) != LE_OK ) )
     {
         le_mem_Release(assetDataPtr);
-        le_mem_Release(appNameAssetIdPtr);
-        le_mem_Release(appNameAssetNamePtr);
         return LE_FAULT;
     }
 
     // todo: 'Put' returns a value, but not sure what it's for.
-    le_hashmap_Put(AssetMap, appNameAssetIdPtr, assetDataPtr);
-    le_hashmap_Put(AssetMapByName, appNameAssetNamePtr, assetDataPtr);
+    le_hashmap_Put(AssetMap, le_mem_StrDup(AddressStringPoolRef, appNameAssetId), assetDataPtr);
+    le_hashmap_Put(AssetMapByName,
+                   le_mem_StrDup(AddressStringPoolRef, appNameAssetName),
+                   assetDataPtr);
 
     // Return the pointer to the newly allocated block
     *assetDataPtrPtr = assetDataPtr;
@@ -4533,7 +4540,7 @@ le_result_t assetData_Init
     CborBufferPoolRef = le_mem_CreatePool("CBOR buffer pool", MAX_CBOR_BUFFER_NUMBYTES);
 
     StringValuePoolRef = le_mem_CreatePool("String value pool", STRING_VALUE_NUMBYTES);
-    AddressStringPoolRef = le_mem_CreatePool("Address pool", 100);
+    AddressStringPoolRef = le_mem_CreateVarPool("Address pool", 100);
 
     // Create AssetMap that maps (appName, assetId) to an AssetData block.
     AssetMap = le_hashmap_Create("Asset Map", 31, le_hashmap_HashString, le_hashmap_EqualsString);
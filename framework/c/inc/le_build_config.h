@@ -19,6 +19,13 @@
  * switches to use malloc/free per-block.  This way, tools like valgrind can be used on a Legato
  * executable.
  *
+ * @section bld_cfg_log_min_level LE_LOG_MIN_LEVEL
+ *
+ * When @c LE_LOG_MIN_LEVEL is defined to a severity level (e.g., @c LE_LOG_INFO), logging macro
+ * call sites below that level are compiled out of the framework and of everything built with this
+ * file (see @ref c_log_min_level).  It can also be set for a single app or executable by passing
+ * @c -DLE_LOG_MIN_LEVEL=LE_LOG_INFO to the mk tools' @c -C option.
+ *
  * @section bld_cfg_disable_SMACK LE_SMACK_DISABLE
  *
  * Legato provides the ability to disable the SMACK API. We don’t recommend disabling SMACK:
@@ -74,6 +81,11 @@
 
 
 
+// Uncomment this define to compile out LE_DEBUG(), LE_DUMP() and LE_TRACE() calls.
+//#define LE_LOG_MIN_LEVEL LE_LOG_INFO
+
+
+
 // Uncomment this define to disable SMACK.
 //#define LE_SMACK_DISABLE
 
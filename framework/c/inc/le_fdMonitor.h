@@ -255,6 +255,19 @@ static void ConnectionEventHandler(int fd, int event)
  * le_fdMonitor_SetDeferrable() with @c isDeferrable flag set to 'true'.
  *
  *
+ * @section c_fdMonitorDirectDispatch Direct Dispatch
+ *
+ * Normally, when the Event Loop sees an event on a monitored fd, it queues the handler call to the
+ * thread's Event Queue and calls it from there, in order with any other queued functions and
+ * events.  Servers that handle a lot of fd traffic can call le_fdMonitor_SetDirectDispatch()
+ * to have the Event Loop call the handler as soon as epoll reports the event instead.  This costs
+ * less CPU time per event and reduces latency, but the handler must not depend on running after
+ * work that was queued to the thread before the fd became ready.
+ *
+ * It's safe to delete any FD Monitor from inside a directly dispatched handler; pending events for
+ * the deleted FD Monitor are discarded.
+ *
+ *
  * @section c_fdMonitorThreading Threading
  *
  * fd monitoring is performed by the Event Loop of the thread that
@@ -443,6 +456,25 @@ void le_fdMonitor_SetDeferrable
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets whether the handler for a given fd is called directly by the Event Loop when epoll(7)
+ * reports events, or (the default) via the thread's Event Queue.
+ *
+ * Direct dispatch avoids an Event Queue round trip and a safe reference look-up for every fd
+ * event, but the handler may then run ahead of Event Reports that were queued before the fd event
+ * was detected.
+ *
+ * See @ref c_fdMonitorDirectDispatch.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_fdMonitor_SetDirectDispatch
+(
+    le_fdMonitor_Ref_t monitorRef,  ///< [in] Reference to the File Descriptor Monitor object.
+    bool               isDirect     ///< [in] true (direct) or false (queued).
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets the Context Pointer for File Descriptor Monitor's handler function.  This can be retrieved
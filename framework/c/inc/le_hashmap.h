@@ -15,11 +15,15 @@
  * type of key that you intend to store. It's unwise to mix types in a single table because
  * implementation of the table has no way to detect this behaviour.
  *
- * Choose the initial size should carefully as the index size remains fixed. The best
+ * Choose the initial size should carefully as the index size of a map created by
+ * le_hashmap_Create() remains fixed. The best
  * choice for the initial size is a prime number slightly larger than the
  * maximum expected capacity. If a too small size is chosen, there will be an
  * increase in collisions that degrade performance over time.
  *
+ * If the number of entries can't be predicted, use @c le_hashmap_CreateResizable() instead
+ * (see @ref c_hashmap_resizable).
+ *
  * All hashmaps have names for diagnostic purposes.
  *
  * @section c_hashmap_insert Adding key-value pairs
@@ -56,6 +60,19 @@
  * storing. The hash function should provide a good distribution of values. It
  * is not required that they be unique.
  *
+ * @section c_hashmap_resizable Resizable maps
+ *
+ * A map created by le_hashmap_CreateResizable() grows as entries are added, so its capacity
+ * parameter is only a hint.  Instead of chaining pool-allocated entries into buckets, it stores
+ * keys, values and hashes inline in an array and finds them through an open-addressed index that
+ * uses Robin Hood probing, which keeps lookups short and cache-friendly even when the index is
+ * nearly full.  When the index fills up, it is replaced by one twice the size, and the old index
+ * is migrated a few slots at a time by subsequent insertions and removals, so no single call pays
+ * for rehashing the whole map.
+ *
+ * Resizable maps support the whole API, including iterators, with the same semantics as other
+ * maps.  Iteration visits entries in insertion order.
+ *
  * @section c_hashmap_iterating Iterating over a map
  *
  * This API allows the user of the map to iterate over the entire
@@ -256,6 +273,23 @@ le_hashmap_Ref_t le_hashmap_Create
     le_hashmap_EqualsFunc_t    equalsFunc        ///< [in] Equality function
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a HashMap that grows as entries are added.  See @ref c_hashmap_resizable.
+ *
+ * @return  Returns a reference to the map.
+ *
+ * @note Terminates the process on failure, so no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_hashmap_Ref_t le_hashmap_CreateResizable
+(
+    const char*                nameStr,          ///< [in] Name of the HashMap
+    size_t                     capacity,         ///< [in] Expected initial number of entries
+    le_hashmap_HashFunc_t      hashFunc,         ///< [in] Hash function
+    le_hashmap_EqualsFunc_t    equalsFunc        ///< [in] Equality function
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a key-value pair to a HashMap. If the key already exists in the map, the previous value
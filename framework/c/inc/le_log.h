@@ -194,6 +194,35 @@
  * }
  * @endcode
  *
+ * @subsection c_log_rate_limiting Rate Limiting
+ *
+ * To stop a misbehaving component from flooding the log (e.g., with an LE_ERROR() in a tight
+ * loop), each logging macro call site is rate limited.  By default, a call site can log
+ * 100 messages in a burst, after which it can log 20 messages per second; anything more is
+ * suppressed.  Nothing is lost silently: the number of messages suppressed at a call site is
+ * logged every few seconds, as coming from that call site.
+ *
+ * Identical messages logged one after the other by the same call site can also be suppressed,
+ * by setting the @c LE_LOG_SUPPRESS_REPEATS environment variable (see
+ * @ref c_log_control_env_suppress_repeats).  A run of identical messages then ends with
+ * "Last message repeated N times.".
+ *
+ * CRITICAL and EMERGENCY messages (including the ones from LE_FATAL() and LE_ASSERT()) are never
+ * suppressed.  The limits can be changed, or rate limiting turned off, for each component with
+ * the log control tool (see @ref c_log_control_tool) or for a whole process with the
+ * @c LE_LOG_RATE_LIMIT environment variable (see @ref c_log_control_env_rate_limit).
+ *
+ * @subsection c_log_min_level Compiling Out Debug Logging
+ *
+ * Logging macro call sites below the level @c LE_LOG_MIN_LEVEL are compiled out entirely: their
+ * arguments are not evaluated, and neither their format strings nor any code for them ends up in
+ * the program.  By default, @c LE_LOG_MIN_LEVEL is @c LE_LOG_DEBUG, so nothing is compiled out.
+ * A release build can set it to @c LE_LOG_INFO (in @c le_build_config.h, or with
+ * @c -DLE_LOG_MIN_LEVEL=LE_LOG_INFO in the C flags, e.g., @c mkapp @c -C) to drop its LE_DEBUG(),
+ * LE_DEBUG_IF() and LE_DUMP() calls.  LE_TRACE() calls are dropped along with the debug messages,
+ * and LE_IS_TRACE_ENABLED() is then always false.  Messages that are compiled out can't be turned
+ * back on with the log control tool.
+ *
  *
  * @section c_log_controlling Log Controls
  *
@@ -234,6 +263,17 @@ $ log trace foo myProc/myComp
  * called "myProc":
  * @verbatim
 $ log stoptrace foo myProc/myComp
+@endverbatim
+ *
+ * To let each call site in the component "myComp" in processes called "myProc" log 50 messages
+ * per second, in bursts of up to 200 messages (see @ref c_log_rate_limiting):
+ * @verbatim
+$ log limit 50,200 myProc/myComp
+@endverbatim
+ *
+ * To turn rate limiting off for the component "myComp" in the process with PID 1234:
+ * @verbatim
+$ log limit off 1234/myComp
 @endverbatim
  *
  * With all of the above examples "*" can be used in place of the process name or a component
@@ -281,6 +321,56 @@ $ export LE_LOG_LEVEL=DEBUG
  * @verbatim
 $ export LE_LOG_TRACE=framework/fdMonitor:framework/logControl
 @endverbatim
+ *
+ * @subsubsection c_log_control_env_rate_limit LE_LOG_RATE_LIMIT
+ *
+ * @c LE_LOG_RATE_LIMIT can be used to set the default rate limit for all components in the
+ * process (see @ref c_log_rate_limiting).  The value is either @c off, the number of messages per
+ * second allowed from each call site, or that number followed by a comma and the number of
+ * messages allowed in a burst.  If the burst is left out, it is the same as the rate.
+ *
+ * For example,
+ * @verbatim
+$ export LE_LOG_RATE_LIMIT=100,1000
+@endverbatim
+ *
+ * @subsubsection c_log_control_env_suppress_repeats LE_LOG_SUPPRESS_REPEATS
+ *
+ * Setting @c LE_LOG_SUPPRESS_REPEATS to anything other than @c 0 turns on the suppression of
+ * identical messages logged one after the other by the same call site, less than five seconds
+ * apart, in every component of the process that is rate limited (see
+ * @ref c_log_rate_limiting).  It is off by default.
+ *
+ * For example,
+ * @verbatim
+$ export LE_LOG_SUPPRESS_REPEATS=1
+@endverbatim
+ *
+ * @subsubsection c_log_control_env_deferred LE_LOG_DEFERRED
+ *
+ * Formatting a log message and writing it to the log takes a lot longer than most of the code
+ * around a typical LE_DEBUG() or LE_INFO().  Setting @c LE_LOG_DEFERRED turns on deferred
+ * formatting for the process: the logging macros just copy the message's arguments into a
+ * ring buffer belonging to the calling thread, and a background thread formats the messages and
+ * writes them to the log.  The value is the size of each thread's ring buffer, in kilobytes
+ * (any other non-zero value uses the default of 16 KB).
+ *
+ * For example,
+ * @verbatim
+$ export LE_LOG_DEFERRED=64
+@endverbatim
+ *
+ * Things to be aware of when deferred formatting is on:
+ *  - Messages from different threads can appear out of order relative to each other.
+ *  - If a thread logs faster than its messages can be written, messages are dropped, and a
+ *    warning saying how many were dropped is logged.
+ *  - String arguments are copied when the message is logged, but other pointer arguments
+ *    (e.g., for @c %p) are only printed, so the pointed-to data doesn't need to stay valid.
+ *  - CRITICAL and EMERGENCY messages (including the ones from LE_FATAL() and LE_ASSERT()) are
+ *    written right away, after all the messages that are waiting.  Waiting messages are also
+ *    written when the process calls exit().
+ *  - Messages whose format strings aren't string literals (e.g., a format built in a buffer),
+ *    or use @c * field widths or precisions, or positional arguments, are written right away.
  *
  * @subsection c_log_control_functions Programmatic Log Control
  *
@@ -394,6 +484,18 @@ typedef struct le_log_Session* le_log_SessionRef_t;
 
 typedef struct le_log_Trace* le_log_TraceRef_t;
 
+// Static information about a logging macro call site.
+typedef struct
+{
+    const char* filenamePtr;        // The name of the source file.
+    unsigned int lineNumber;        // The line number in the source file.
+    bool isFormatLiteral;           // true if the format string is a string literal (its text
+                                    // can be read again after the call returns).
+    void* formatInfoPtr;            // Set by the logging system the first time the site logs.
+    void* limitInfoPtr;             // Rate limiting state, set the first time the site logs.
+}
+le_log_CallSite_t;
+
 void _le_log_Send
 (
     const le_log_Level_t level,
@@ -406,6 +508,17 @@ void _le_log_Send
     ...
 ) __attribute__ ((format (printf, 7, 8)));
 
+void _le_log_SendFromSite
+(
+    const le_log_Level_t level,
+    const le_log_TraceRef_t traceRef,
+    le_log_SessionRef_t logSession,
+    le_log_CallSite_t* sitePtr,
+    const char* functionNamePtr,
+    const char* formatPtr,
+    ...
+) __attribute__ ((format (printf, 6, 7)));
+
 le_log_TraceRef_t _le_log_GetTraceRef
 (
     le_log_SessionRef_t logSession,
@@ -458,6 +571,16 @@ LE_SHARED le_log_Level_t* LE_LOG_LEVEL_FILTER_PTR;
 /// @endcond
 //--------------------------------------------------------------------------------------------------
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Lowest severity level compiled into the program (see @ref c_log_min_level).  Logging macro call
+ * sites below this level compile to nothing.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef LE_LOG_MIN_LEVEL
+#define LE_LOG_MIN_LEVEL    LE_LOG_DEBUG
+#endif
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Internal macro to filter out messages that do not meet the current filtering level.
@@ -465,9 +588,15 @@ LE_SHARED le_log_Level_t* LE_LOG_LEVEL_FILTER_PTR;
 //--------------------------------------------------------------------------------------------------
 #define _LE_LOG_MSG(level, formatString, ...) \
     do { \
-        if ((LE_LOG_LEVEL_FILTER_PTR == NULL) || (level >= *LE_LOG_LEVEL_FILTER_PTR)) \
-            _le_log_Send(level, NULL, LE_LOG_SESSION, STRINGIZE(LE_FILENAME), __func__, __LINE__, \
+        if (((level) >= LE_LOG_MIN_LEVEL) && \
+            ((LE_LOG_LEVEL_FILTER_PTR == NULL) || (level >= *LE_LOG_LEVEL_FILTER_PTR))) \
+        { \
+            static le_log_CallSite_t _leLogCallSite = \
+                    { STRINGIZE(LE_FILENAME), __LINE__, \
+                      __builtin_constant_p(formatString), NULL, NULL }; \
+            _le_log_SendFromSite(level, NULL, LE_LOG_SESSION, &_leLogCallSite, __func__, \
                     formatString, ##__VA_ARGS__); \
+        } \
     } while(0)
 
 
@@ -483,7 +612,13 @@ LE_SHARED le_log_Level_t* LE_LOG_LEVEL_FILTER_PTR;
 /** @copydoc LE_LOG_DEBUG */
 #define LE_DEBUG(formatString, ...)     _LE_LOG_MSG(LE_LOG_DEBUG, formatString, ##__VA_ARGS__)
 /** @copydoc LE_LOG_DATA */
-#define LE_DUMP(dataPtr, dataLength)    _le_LogData(dataPtr, dataLength, STRINGIZE(LE_FILENAME), __func__, __LINE__)
+#define LE_DUMP(dataPtr, dataLength) \
+        do { \
+            if (LE_LOG_DEBUG >= LE_LOG_MIN_LEVEL) \
+            { \
+                _le_LogData(dataPtr, dataLength, STRINGIZE(LE_FILENAME), __func__, __LINE__); \
+            } \
+        } while(0)
 /** @copydoc LE_LOG_INFO */
 #define LE_INFO(formatString, ...)      _LE_LOG_MSG(LE_LOG_INFO, formatString, ##__VA_ARGS__)
 /** @copydoc LE_LOG_WARN */
@@ -603,7 +738,8 @@ const char* _le_log_GetResultCodeString
  *      false otherwise.
  */
 //--------------------------------------------------------------------------------------------------
-#define LE_IS_TRACE_ENABLED(traceRef)  (le_log_IsTraceEnabled(traceRef))
+#define LE_IS_TRACE_ENABLED(traceRef) \
+        ((LE_LOG_DEBUG >= LE_LOG_MIN_LEVEL) && le_log_IsTraceEnabled(traceRef))
 
 
 //--------------------------------------------------------------------------------------------------
@@ -612,14 +748,16 @@ const char* _le_log_GetResultCodeString
  */
 //--------------------------------------------------------------------------------------------------
 #define LE_TRACE(traceRef, string, ...)         \
-        if (le_log_IsTraceEnabled(traceRef))    \
+        if (LE_IS_TRACE_ENABLED(traceRef))      \
         {                                       \
-            _le_log_Send((le_log_Level_t)-1,    \
+            static le_log_CallSite_t _leLogCallSite =           \
+                { STRINGIZE(LE_FILENAME), __LINE__,             \
+                  __builtin_constant_p(string), NULL, NULL };   \
+            _le_log_SendFromSite((le_log_Level_t)-1,            \
                     traceRef,                   \
                     LE_LOG_SESSION,             \
-                    STRINGIZE(LE_FILENAME),     \
+                    &_leLogCallSite,            \
                     __func__,                   \
-                    __LINE__,                   \
                     string,                     \
                     ##__VA_ARGS__);             \
         }
@@ -43,6 +43,10 @@
  *  - destructors
  *  - statistics
  *  - multi-threading
+ *  - per-thread caches
+ *  - slab pools (compact pools for large numbers of small objects)
+ *  - variable-size pools (for strings and other objects whose size isn't known until run-time)
+ *  - trimming (giving unused memory back to the OS)
  *  - sub-pools (pools that can be deleted).
  *
  * The following sections describe these, beginning with the most basic usage and working up to more
@@ -231,6 +235,7 @@
  *  - Number of allocations.
  *  - Number of currently free objects.
  *  - Number of overflows (times that le_mem_ForceAlloc() had to expand the pool).
+ *  - Number of bytes given back to the OS by @ref mem_trimming "trimming" the pool.
  *
  * Statistics (and other pool properties) can be checked using functions:
  *  - @c le_mem_GetStats()
@@ -295,6 +300,114 @@
  * the data structure, then the mutex must be held by the thread that calls le_mem_Release() to
  * ensure there's no other thread accessing the data structure when the destructor runs.
  *
+ * @section mem_thread_caches Per-Thread Caches
+ *
+ * Internally, the memory pools are protected by a single mutex that is shared by all the pools
+ * in the process.  If a pool is heavily used by several threads at the same time, those threads
+ * can end up spending a lot of time waiting for each other on that mutex, even if they are
+ * actually using different pools.
+ *
+ * Calling @c le_mem_EnableThreadCache() on such a pool gives every thread that uses the pool its
+ * own private cache of free objects from that pool.  Allocating and releasing objects then
+ * normally doesn't involve the mutex at all.  Only when a thread's cache runs empty (or gets too
+ * full) is the mutex taken, to move a batch of free objects between the thread's cache and
+ * the pool.
+ *
+ * @code
+ * MessagePool = le_mem_CreatePool("Messages", sizeof(Message_t));
+ * le_mem_ExpandPool(MessagePool, MAX_MESSAGES);
+ * le_mem_EnableThreadCache(MessagePool, 32);
+ * @endcode
+ *
+ * The trade-off is that free objects sitting in one thread's cache can't be allocated by another
+ * thread, so a pool with thread caching enabled may need to be expanded a little more than
+ * it would otherwise.  Objects in thread caches are still counted as free in the pool's
+ * statistics.  When a thread dies, the free objects in its caches are given back to their pools.
+ *
+ * Thread caching should be enabled right after the pool is created, before any objects are
+ * allocated from it, and can't be disabled again.  Sub-pools can't have thread caches.
+ *
+ * @section mem_slab_pools Slab Pools
+ *
+ * Every object allocated from a normal pool carries some hidden overhead: a link used while the
+ * object is free, a pointer back to its pool, and its reference count.  For pools that hold tens
+ * of thousands of small objects, this overhead can add up to more memory than the objects
+ * themselves.
+ *
+ * Pools created using @c le_mem_CreateSlabPool() get their memory from the kernel in large,
+ * contiguous "slabs" (one per expansion) instead of from the C runtime heap.  Objects in a slab
+ * pool only carry their reference count; the pool an object belongs to is worked out from the
+ * object's address.  Keeping the objects packed together in slabs also makes better use of the
+ * CPU cache when iterating over them.
+ *
+ * The following options can be ORed together and passed to @c le_mem_CreateSlabPool():
+ *  - @c LE_MEM_SLAB_CACHE_ALIGNED - Align every object on a CPU cache line boundary, so that
+ *                                    no two objects share a cache line.
+ *  - @c LE_MEM_SLAB_HUGE_PAGES - Ask the kernel to back the slabs with huge pages, if it can.
+ *
+ * @code
+ * EntryPool = le_mem_CreateSlabPool("Entries", sizeof(Entry_t), LE_MEM_SLAB_CACHE_ALIGNED);
+ * le_mem_ExpandPool(EntryPool, MAX_ENTRIES);
+ * @endcode
+ *
+ * Slabs are made up of 64 KB chunks and a slab pool is always expanded by a whole number of chunks,
+ * so it may end up with more objects than were asked for.  For this reason, slab pools are
+ * best suited to pools holding large numbers of small objects.  Objects that don't fit in a chunk
+ * can't be allocated from a slab pool, and slab pools can't have sub-pools.
+ *
+ * @section mem_trimming Trimming Pools
+ *
+ * Once a pool has been expanded, its objects normally stay in the pool until the process dies.
+ * If @c le_mem_ForceAlloc() had to expand a pool to get through a short burst of activity, this
+ * can leave a lot of memory tied up in free objects that won't be needed again for a long time.
+ *
+ * @c le_mem_Trim() gives the memory used by a pool's free objects back to the OS, as far as it can,
+ * and returns the number of bytes given back.  The pool is never shrunk below the total number of
+ * objects that were added to it using @c le_mem_ExpandPool(), so only the expansions done by
+ * @c le_mem_ForceAlloc() are undone.  Memory can only be given back a whole slab at a time, so
+ * only @ref mem_slab_pools "slab pools" can be trimmed (trimming any other pool does nothing), and
+ * a slab is only given back once all of its objects are free.
+ *
+ * Instead of calling @c le_mem_Trim() directly, @c le_mem_EnableIdleTrim() can be used to have the
+ * pool trimmed automatically.  After a pool with idle trimming enabled has been expanded by
+ * @c le_mem_ForceAlloc(), the next thread whose Event Loop has had nothing to do for a second
+ * will trim it.
+ *
+ * @code
+ * MsgPool = le_mem_CreateSlabPool("Messages", sizeof(Msg_t), 0);
+ * le_mem_ExpandPool(MsgPool, NORMAL_NUM_MSGS);
+ * le_mem_EnableIdleTrim(MsgPool);
+ * @endcode
+ *
+ * @section mem_var_pools Variable-Size Pools
+ *
+ * Pools hand out objects of one fixed size, so a pool of strings has to make every string as
+ * big as the longest one it could ever hold.  When most strings are much shorter than that,
+ * most of the pool's memory is wasted.
+ *
+ * A variable-size pool, created using @c le_mem_CreateVarPool(), is a set of ordinary pools
+ * (one per "size class").  The smallest size class holds 16 byte objects, each one after that holds
+ * objects twice as big as the one before, and the largest holds objects of the maximum size
+ * given when the variable-size pool was created.  @c le_mem_VarAlloc() allocates an object from
+ * the smallest size class that it fits in, expanding that class's pool if it has no free objects
+ * left (just like @c le_mem_ForceAlloc()).  @c le_mem_StrDup() is a shortcut for allocating a copy
+ * of a string.
+ *
+ * @code
+ * NamePool = le_mem_CreateVarPool("Names", MAX_NAME_BYTES);
+ *
+ * char* namePtr = le_mem_StrDup(NamePool, nameStr);
+ * ...
+ * le_mem_Release(namePtr);
+ * @endcode
+ *
+ * Objects allocated from a variable-size pool are normal pool objects, so they are released using
+ * @c le_mem_Release(), and support reference counting.  Each size class shows up as a separate
+ * pool, named after the variable-size pool and its object size (e.g., "Names-64"), so the
+ * statistics for each size class can be seen using the inspect tool.
+ *
+ * Asking for an object that is bigger than the pool's maximum size is a fatal error.
+ *
  * @section mem_pool_sizes Managing Pool Sizes
  *
  * We know it's possible to have pools automatically expand
@@ -414,6 +527,15 @@
 typedef struct le_mem_Pool* le_mem_PoolRef_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Objects of this type are used to refer to a variable-size pool created using
+ * le_mem_CreateVarPool().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_mem_VarPool* le_mem_VarPoolRef_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Prototype for destructor functions.
@@ -445,6 +567,7 @@ typedef struct
     size_t      numOverflows;       ///< Number of times le_mem_ForceAlloc() had to expand the pool.
     uint64_t    numAllocs;          ///< Number of times an object has been allocated from this pool.
     size_t      numFree;            ///< Number of free objects currently available in this pool.
+    size_t      numBytesReclaimed;  ///< Number of bytes given back to the OS by trimming the pool.
 }
 le_mem_PoolStats_t;
 
@@ -536,6 +659,66 @@ static inline le_mem_PoolRef_t le_mem_CreatePool
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Slab pool option: align every object on a CPU cache line boundary.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_MEM_SLAB_CACHE_ALIGNED   BIT0
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Slab pool option: ask the kernel to back the pool's slabs with huge pages, if possible.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_MEM_SLAB_HUGE_PAGES      BIT1
+
+
+//--------------------------------------------------------------------------------------------------
+/** @cond HIDDEN_IN_USER_DOCS
+ *
+ * Internal function used to implement le_mem_CreateSlabPool() with automatic component scoping
+ * of pool names.
+ */
+//--------------------------------------------------------------------------------------------------
+le_mem_PoolRef_t _le_mem_CreateSlabPool
+(
+    const char* componentName,  ///< [IN] Name of the component.
+    const char* name,           ///< [IN] Name of the pool inside the component.
+    size_t      objSize,        ///< [IN] Size of the individual objects to be allocated from this
+                                ///       pool (in bytes), e.g., sizeof(MyObject_t).
+    uint32_t    options         ///< [IN] Bit mask of LE_MEM_SLAB_xxx options.
+);
+/// @endcond
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an empty slab pool.
+ *
+ * See @ref mem_slab_pools for more information.
+ *
+ * @return
+ *      Reference to the memory pool object.
+ *
+ * @note
+ *      On failure, the process exits, so you don't have to worry about checking the returned
+ *      reference for validity.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline le_mem_PoolRef_t le_mem_CreateSlabPool
+(
+    const char* name,       ///< [IN] Name of the pool (will be copied into the Pool).
+    size_t      objSize,    ///< [IN] Size of the individual objects to be allocated from this pool
+                            /// (in bytes), e.g., sizeof(MyObject_t).
+    uint32_t    options     ///< [IN] Bit mask of LE_MEM_SLAB_xxx options (0 for none).
+)
+{
+    return _le_mem_CreateSlabPool(STRINGIZE(LE_COMPONENT_NAME), name, objSize, options);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Expands the size of a memory pool.
@@ -553,6 +736,36 @@ le_mem_PoolRef_t le_mem_ExpandPool
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gives the memory used by a pool's free objects back to the OS, without shrinking the pool
+ * below the number of objects added to it using le_mem_ExpandPool().
+ *
+ * See @ref mem_trimming for more information.
+ *
+ * @return  Number of bytes given back to the OS.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t le_mem_Trim
+(
+    le_mem_PoolRef_t    pool        ///< [IN] Pool to be trimmed.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enables automatic trimming of a pool when the process has been idle for a while after the pool
+ * was expanded by le_mem_ForceAlloc().
+ *
+ * See @ref mem_trimming for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_mem_EnableIdleTrim
+(
+    le_mem_PoolRef_t    pool        ///< [IN] Pool to be trimmed automatically.
+);
+
+
 
 #ifndef LE_MEM_TRACE
     //----------------------------------------------------------------------------------------------
@@ -665,6 +878,28 @@ void le_mem_SetNumObjsToForce
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enables per-thread caching of free objects for a specified pool.  Must be called before any
+ * objects are allocated from the pool.
+ *
+ * See @ref mem_thread_caches for more information.
+ *
+ * @return
+ *      Nothing.
+ *
+ * @note
+ *      Not allowed for sub-pools.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_mem_EnableThreadCache
+(
+    le_mem_PoolRef_t    pool,       ///< [IN] Pool to enable thread caching for.
+    size_t              numObjects  ///< [IN] Maximum number of free objects that each thread
+                                    ///       may keep in its cache for this pool.
+);
+
+
 #ifndef LE_MEM_TRACE
     //----------------------------------------------------------------------------------------------
     /**
@@ -945,4 +1180,102 @@ void le_mem_DeleteSubPool
 );
 
 
+
+//--------------------------------------------------------------------------------------------------
+/** @cond HIDDEN_IN_USER_DOCS
+ *
+ * Internal function used to implement le_mem_CreateVarPool() with automatic component scoping
+ * of pool names.
+ */
+//--------------------------------------------------------------------------------------------------
+le_mem_VarPoolRef_t _le_mem_CreateVarPool
+(
+    const char* componentName,  ///< [IN] Name of the component.
+    const char* name,           ///< [IN] Name of the pool inside the component.
+    size_t      maxSize         ///< [IN] Size of the largest object that can be allocated from
+                                ///       this pool (in bytes).
+);
+/// @endcond
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an empty variable-size pool.
+ *
+ * See @ref mem_var_pools for more information.
+ *
+ * @return
+ *      Reference to the variable-size pool.
+ *
+ * @note
+ *      On failure, the process exits, so you don't have to worry about checking the returned
+ *      reference for validity.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline le_mem_VarPoolRef_t le_mem_CreateVarPool
+(
+    const char* name,       ///< [IN] Name of the pool (will be copied into the Pool).
+    size_t      maxSize     ///< [IN] Size of the largest object that can be allocated from this
+                            ///       pool (in bytes).
+)
+{
+    return _le_mem_CreateVarPool(STRINGIZE(LE_COMPONENT_NAME), name, maxSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocates an object of a given size from a variable-size pool.  The object comes from the
+ * smallest size class that it fits in.  If that size class has no free objects left, it will be
+ * expanded, the same as le_mem_ForceAlloc() does.
+ *
+ * See @ref mem_var_pools for more information.
+ *
+ * @return  Pointer to the allocated object.
+ *
+ * @note    On failure (including asking for more than the pool's maximum size), the process exits,
+ *          so you don't have to worry about checking the returned pointer for validity.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_mem_VarAlloc
+(
+    le_mem_VarPoolRef_t pool,   ///< [IN] Variable-size pool to allocate from.
+    size_t              size    ///< [IN] Number of bytes needed.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocates a copy of a null-terminated string from a variable-size pool.
+ *
+ * See @ref mem_var_pools for more information.
+ *
+ * @return  Pointer to the copy of the string.  Release it using le_mem_Release().
+ *
+ * @note    On failure (including a string that doesn't fit in the pool's maximum size), the
+ *          process exits, so you don't have to worry about checking the returned pointer for
+ *          validity.
+ */
+//--------------------------------------------------------------------------------------------------
+char* le_mem_StrDup
+(
+    le_mem_VarPoolRef_t pool,   ///< [IN] Variable-size pool to allocate from.
+    const char*         str     ///< [IN] String to copy.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expands every size class of a variable-size pool.
+ *
+ * @return  Reference to the variable-size pool (the same value passed into it).
+ */
+//--------------------------------------------------------------------------------------------------
+le_mem_VarPoolRef_t le_mem_ExpandVarPool
+(
+    le_mem_VarPoolRef_t pool,       ///< [IN] Variable-size pool to be expanded.
+    size_t              numObjects  ///< [IN] Number of objects to add to each size class.
+);
+
+
 #endif // LEGATO_MEM_INCLUDE_GUARD
@@ -128,6 +128,21 @@
  * it's bound to is not currently advertised by the server, then le_msg_TryOpenSessionSync()
  * will return an error code.
  *
+ * Each le_msg_OpenSessionSync() call waits for a full round trip through the Service Directory
+ * and the server before returning.  A thread that has to open several sessions (e.g., all of its
+ * required client interfaces at start-up) can overlap those round trips by bracketing the calls
+ * with le_msg_StartOpenBatch() and le_msg_FinishOpenBatch().  Inside the batch,
+ * le_msg_OpenSessionSync() sends the open request and returns right away; the responses are
+ * collected by le_msg_FinishOpenBatch(), which returns once all the sessions are open.  A
+ * session that is used before the batch is finished is finished opening on first use.
+ *
+ * @code
+ *     le_msg_StartOpenBatch();
+ *     le_msg_OpenSessionSync(firstSessionRef);
+ *     le_msg_OpenSessionSync(secondSessionRef);
+ *     le_msg_FinishOpenBatch();
+ * @endcode
+ *
  * @subsection c_messagingClientSending Sending a Message
  *
  * Before sending a message, the client must first allocate the message from the session's message
@@ -182,6 +197,19 @@
  *     le_msg_ReleaseMsg(responseMsgRef);
  * @endcode
  *
+ * @subsection c_messagingPayloadLength Payload Length
+ *
+ * By default, the whole payload buffer is sent, however little of it is used, and every message
+ * is cleared to all zeros when it is created.  If the client or server calls
+ * le_msg_SetPayloadLength() before sending a message, only that many bytes at the start of the
+ * payload are sent.  From then on, new messages in that protocol are not cleared, so the payload
+ * length must be set on every message sent in that protocol.  Code generated by ifgen does this.
+ *
+ * A receiver can always find out how many payload bytes were actually received by calling
+ * le_msg_GetPayloadLength().  Unless the receiver itself sets payload lengths in that protocol,
+ * the rest of the payload buffer is cleared, so receivers that don't know about payload lengths
+ * see the same thing they would if the whole buffer had been sent.
+ *
  * @subsection c_messagingClientReceiving Receiving a Non-Response Message
  *
  * When a server sends a message to the client that is not a response to a request from the client,
@@ -590,6 +618,23 @@
  * To work around this, you could move the service to another thread that that runs the Legato event
  * loop.
  *
+ * A service whose handler functions can take a long time (e.g., because they wait for a modem)
+ * would make every client wait for the slowest one.  The server can avoid this by calling
+ * le_msg_SetServiceWorkerPool() to have the messages received by the service handled by a pool
+ * of worker threads instead:
+ *
+ * @code
+ *     le_msg_SetServiceWorkerPool(serviceRef, 4);
+ * @endcode
+ *
+ * Each session is given to one of the worker threads when its first message arrives, and all of
+ * that session's messages are handled by that worker, in the order they were received.  Messages
+ * from different sessions may be handled at the same time, so the receive handler must be thread
+ * safe.  Responses (and any other messages) can be sent from the worker threads; they are passed
+ * to the server thread to be sent.  Sessions can be closed from the worker threads too (e.g., by
+ * LE_KILL_CLIENT), in which case they are closed by the server thread once it has sent whatever
+ * the worker sent before closing.  Open and close handlers are still called by the server thread.
+ *
  * @subsection c_messagingServerExample Sample Code
  *
  * @code
@@ -766,6 +811,30 @@
  * @warning DO NOT SEND DIRECTORY FILE DESCRIPTORS.  That can be exploited to break out of chroot()
  * jails.
  *
+ * @section c_messagingSharedMem Shared Memory Transport
+ *
+ * By default, every message goes through the session's Unix domain socket, which costs a pair
+ * of system calls per message.  A client that exchanges a lot of messages with a server can ask
+ * for its session to use shared memory instead, by calling le_msg_EnableSharedMemTransport()
+ * before opening the session:
+ *
+ * @code
+ *     sessionRef = le_msg_CreateSession(protocolRef, "myInterface");
+ *     le_msg_EnableSharedMemTransport(sessionRef, 64);
+ *     le_msg_OpenSessionSync(sessionRef);
+ * @endcode
+ *
+ * When the session opens, the client passes the server a block of shared memory holding two
+ * rings of message slots (one for each direction), and the two sides then exchange messages
+ * through the rings.  A side only makes a system call to wake up the other side when the other
+ * side has gone to sleep waiting for messages.  Nothing changes for the server or for the
+ * message API.
+ *
+ * Messages that carry a file descriptor still go through the socket (in order with the others),
+ * and the socket still detects when the other side closes the session or dies.  If the shared
+ * memory can't be set up, the session just carries on using the socket.
+ * le_msg_IsSharedMemTransportActive() tells which is being used.
+ *
  * @section c_messagingFutureEnhancements Future Enhancements
  *
  * As an optimization to reduce the number of copies in cases where the sender of a message
@@ -1158,6 +1227,36 @@ le_result_t le_msg_TryOpenSessionSync
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a batch of session opens on the calling thread.  Until le_msg_FinishOpenBatch() is
+ * called, le_msg_OpenSessionSync() only sends the open request and returns without waiting for
+ * the session to open.
+ *
+ * @note    Batches can't be nested.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_StartOpenBatch
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finishes the calling thread's batch of session opens, blocking until every session opened
+ * in the batch is open.
+ *
+ * This function logs a fatal error and terminates the calling process if the thread hasn't
+ * started a batch.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_FinishOpenBatch
+(
+    void
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Terminates a session.
@@ -1169,6 +1268,35 @@ void le_msg_CloseSession
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asks for a session to exchange its messages through shared memory instead of its socket,
+ * once it is open.  See @ref c_messagingSharedMem.
+ *
+ * @note    This is a client-only function, and the session must not be open.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_EnableSharedMemTransport
+(
+    le_msg_SessionRef_t sessionRef, ///< [in] Reference to the session.
+    size_t              slotCount   ///< [in] Number of messages each side can have in flight
+                                    ///       (rounded up to a power of two).  0 = use the socket.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a session is exchanging its messages through shared memory.
+ *
+ * @return true if it is, false if it is using its socket (or is not open).
+ */
+//--------------------------------------------------------------------------------------------------
+bool le_msg_IsSharedMemTransportActive
+(
+    le_msg_SessionRef_t sessionRef  ///< [in] Reference to the session.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches a reference to the protocol that is being used for a given session.
@@ -1336,6 +1464,36 @@ size_t le_msg_GetMaxPayloadSize
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the number of bytes at the start of the payload buffer that are to be sent.
+ *
+ * Once this has been called on a message, messages in the same protocol are no longer cleared
+ * when they are created, and only the payload length is sent, so it must be set on every message
+ * sent in that protocol from then on.  See @ref c_messagingPayloadLength.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_SetPayloadLength
+(
+    le_msg_MessageRef_t msgRef,     ///< [in] Reference to the message.
+    size_t              length      ///< [in] Number of payload bytes to send.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the number of payload bytes in a message.  For a received message, this is the number of
+ * payload bytes that were received.
+ *
+ * @return The length, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t le_msg_GetPayloadLength
+(
+    le_msg_MessageRef_t msgRef      ///< [in] Reference to the message.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets the file descriptor to be sent with this message.
@@ -1555,6 +1713,22 @@ void le_msg_SetServiceRecvHandler
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes a service hand the messages that it receives to a pool of worker threads, instead of
+ * handling them all in the server thread.  See @ref c_messagingServerMultithreading.
+ *
+ * @note    Server-only function.  Can only be called once for a given service, with a thread count
+ *          of at most 16.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_SetServiceWorkerPool
+(
+    le_msg_ServiceRef_t serviceRef, ///< [in] Reference to the service.
+    size_t              threadCount ///< [in] Number of worker threads.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Associates an opaque context value (void pointer) with a given service that can be retrieved
@@ -56,6 +56,15 @@
  * created by calling @c le_ref_CreateMap().  It takes a single argument, the maximum number
  * of mappings expected to track of at any time.
  *
+ * The map grows if more mappings than that are created, but it never shrinks.  Creating, looking
+ * up and deleting Safe References all take constant time, however many mappings the map holds.
+ *
+ * A map can hold up to 65536 mappings on 32-bit targets, and up to 16777216 on 64-bit targets.
+ * A deleted Safe Reference is detected as invalid until the mapping's slot in the map has been
+ * reused 32768 times on 32-bit targets (about 5.5e11 times on 64-bit targets).  Slots are reused
+ * in the order they were freed, so a map with N free slots has to create 32768 times N
+ * Safe References before that happens.
+ *
  * @section c_safeRef_multithreading Multithreading
  *
  * This API's functions are reentrant, but not thread safe. If there's the slightest
@@ -265,8 +274,8 @@ void le_ref_DeleteRef
  * per map, and calling this function resets the iterator position to the start of the map.  The
  * iterator is not ready for data access until le_ref_NextNode() has been called at least once.
  *
- * @return  Returns A reference to a hashmap iterator which is ready for le_hashmap_NextNode() to be
- *          called on it.
+ * @return  Returns A reference to an iterator which is ready for le_ref_NextNode() to be called
+ *          on it.
  */
 //--------------------------------------------------------------------------------------------------
 le_ref_IterRef_t le_ref_GetIterator
@@ -293,7 +302,7 @@ le_result_t le_ref_NextNode
 //--------------------------------------------------------------------------------------------------
 /**
  * Retrieves a pointer to the safe ref iterator is currently pointing at.  If the iterator has just
- * been initialized and le_hashmap_NextNode() has not been called, or if the iterator has been
+ * been initialized and le_ref_NextNode() has not been called, or if the iterator has been
  * invalidated then this will return NULL.
  *
  * @return  A pointer to the current key, or NULL if the iterator has been invalidated or is not ready.
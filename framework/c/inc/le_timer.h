@@ -21,6 +21,7 @@
  *  - @ref le_timer_SetHandler
  *  - @ref le_timer_SetInterval
  *  - @ref le_timer_SetRepeat
+ *  - @ref le_timer_SetSlack
  *  - @ref le_timer_SetContextPtr
  *
  * The repeat count defaults to 1, so that the timer is initially a one-shot timer. All the other
@@ -61,6 +62,19 @@
  * The number of times that a timer has expired can be retrieved by @ref le_timer_GetExpiryCount. This
  * count is independent of whether there is an expiry handler for the timer.
  *
+ * @section le_timer_slack Timer Slack
+ *
+ * Every time one of a thread's timers expires, the thread has to wake up.  On battery-powered
+ * devices, it can save a lot of power if timers that expire close together are all handled in the
+ * same wake-up.  @ref le_timer_SetSlack allows a timer to expire up to a given number of
+ * milliseconds late.  When the thread wakes up, all of its timers whose intervals have elapsed are
+ * expired together, so timers with slack tend to be batched with other timers instead of waking
+ * the thread up on their own.
+ *
+ * Slack defaults to 0, which means the timer expires as close to the end of its interval as
+ * possible.  A repeating timer's expiry times are still based on its interval, so slack doesn't
+ * make a repeating timer drift.
+ *
  * @section le_timer_thread Thread Support
  *
  * A timer should only be used by the thread that created it. It's not safe for a thread to use
@@ -89,6 +103,7 @@
  *     - @ref le_timer_SetHandler
  *     - @ref le_timer_SetInterval
  *     - @ref le_timer_SetRepeat
+ *     - @ref le_timer_SetSlack
  *     - @ref le_timer_Start
  *     - @ref le_timer_Stop
  *     - @ref le_timer_Restart
@@ -258,6 +273,28 @@ le_result_t le_timer_SetRepeat
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the timer slack using milliseconds.
+ *
+ * The timer may expire up to this long after its interval has elapsed, so that its expiry can be
+ * handled in the same wake-up as other timers of the same thread.  The default is 0.
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_BUSY if the timer is currently running
+ *
+ * @note
+ *      If an invalid timer object is given, the process exits.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_timer_SetSlack
+(
+    le_timer_Ref_t timerRef,     ///< [IN] Set slack for this timer object.
+    uint32_t slack               ///< [IN] Timer slack in milliseconds.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set context pointer for the timer.
@@ -2791,10 +2791,10 @@ void tdb_Init
                                           le_hashmap_HashString,
                                           le_hashmap_EqualsString);
 
-    HandlerRegistrationMap = le_hashmap_Create(CFG_HANDLER_REG_NAME,
-                                               31,
-                                               le_hashmap_HashString,
-                                               le_hashmap_EqualsString);
+    HandlerRegistrationMap = le_hashmap_CreateResizable(CFG_HANDLER_REG_NAME,
+                                                        31,
+                                                        le_hashmap_HashString,
+                                                        le_hashmap_EqualsString);
 
     HandlerSafeRefMap = le_ref_CreateMap(CFG_HANDLER_REF_MAP, 5);
 
@@ -65,20 +65,22 @@
  * Included in the set of file descriptors that are being monitored by epoll is an eventfd
  * (see 'man eventfd') monitored in "level-triggered" mode.
  *
- * Whenever an Event Report is added to the Event Queue for a thread, the number 1 is written to
- * that thread's eventfd.  When Event Reports are popped off a thread's Event Queue, that thread's
- * eventfd is read to decrement it.  As long as the eventfd's value is greater than 0, epoll_wait()
- * will return immediately, reporting that there is something to read from that fd.
+ * Whenever an Event Report is added to an empty Event Queue, the number 1 is written to
+ * that thread's eventfd.  Before Event Reports are popped off a thread's Event Queue, that thread's
+ * eventfd is read to reset it.  As long as the eventfd's value is greater than 0, epoll_wait()
+ * will return immediately, reporting that there is something to read from that fd.  Reports
+ * added to a queue that isn't empty don't touch the eventfd at all, because the Event Loop has
+ * already been woken up (or is about to be), so bursts of reports only cost one system call.
  *
  * The Event Loop is an infinite loop that calls epoll_wait() and then responds to any fd events
  * that epoll_wait() reports.  If epoll_wait() reports an event on the eventfd, then an Event Report
  * is popped off the Event Queue and processed.  If epoll_wait() reports an event on any other fd,
- * FD Event Reports are created and pushed onto Event Queues according to what handlers are
- * registered for those events.  All pending Event Reports are processed until the Event Queue is
- * empty before returning to epoll_wait().  (NOTE: This choice was made to save system call
- * overhead in times of heavy load.  Unfortunately, it also means that if event handlers always add
- * new events to the queue, then epoll_wait() will never be called and therefore fd events will
- * never be detected.)
+ * the FD Monitor for that fd either calls its handler straight away (direct dispatch) or pushes an
+ * FD Event Report onto the Event Queue (see fdMonitor.c).  All pending Event Reports are processed
+ * until the Event Queue is empty before returning to epoll_wait().  (NOTE: This choice was made to
+ * save system call overhead in times of heavy load.  Unfortunately, it also means that if event
+ * handlers always add new events to the queue, then epoll_wait() will never be called and
+ * therefore fd events will never be detected.)
  *
  * ----
  *
@@ -88,6 +90,12 @@
  * multithreaded race conditions.  A Mutex is provided for that purpose, and it can be locked
  * and unlocked using the functions Lock() and Unlock().
  *
+ * The exception is the Event Queues.  Any thread can add Event Reports to any thread's Event
+ * Queue, but only the thread itself takes them off again, so each Event Queue is a lock-free
+ * multiple-producer, single-consumer queue (see PushReport() and PopReport()).  A count of
+ * the reports on the queue is kept alongside it; the thread that raises the count from zero is the
+ * one that writes to the eventfd.
+ *
  * ----
  *
  * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
@@ -99,8 +107,10 @@
 #include "fdMonitor.h"
 #include "limit.h"
 #include "fileDescriptor.h"
+#include "mem.h"
 
 #include <pthread.h>
+#include <sched.h>
 #include <sys/eventfd.h>
 
 // ==============================================
@@ -110,6 +120,10 @@
 /// Maximum number of events that can be received from epoll_wait() at one time.
 #define MAX_EPOLL_EVENTS 32
 
+/// Number of milliseconds an Event Loop must be idle before it trims memory pools that have
+/// idle trimming enabled (see le_mem_EnableIdleTrim()).
+#define IDLE_TRIM_DELAY_MS 1000
+
 /// The default number of objects in the process-wide Queued Function Report Pool, from which
 /// Queued Function reports are allocated.
 /// @todo Make this configurable.
@@ -337,12 +351,12 @@ static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mute
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Guards against thread cancellation and locks the mutex.
+ * Guards against thread cancellation.
  *
  * @return Old state of cancelability.
  **/
 //--------------------------------------------------------------------------------------------------
-static int Lock
+static int DisableCancel
 (
     void
 )
@@ -354,6 +368,43 @@ static int Lock
 
     LE_FATAL_IF(err != 0, "pthread_setcancelstate() failed (%s)", strerror(err));
 
+    return oldState;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Releases the thread cancellation guard created by DisableCancel().
+ **/
+//--------------------------------------------------------------------------------------------------
+static void RestoreCancel
+(
+    int restoreTo   ///< Old state of cancellability to be restored.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int junk;
+
+    int err = pthread_setcancelstate(restoreTo, &junk);
+    LE_FATAL_IF(err != 0, "pthread_setcancelstate() failed (%s)", strerror(err));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Guards against thread cancellation and locks the mutex.
+ *
+ * @return Old state of cancelability.
+ **/
+//--------------------------------------------------------------------------------------------------
+static int Lock
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int oldState = DisableCancel();
+
     LE_ASSERT(pthread_mutex_lock(&Mutex) == 0);
 
     return oldState;
@@ -371,12 +422,9 @@ static void Unlock
 )
 //--------------------------------------------------------------------------------------------------
 {
-    int junk;
-
     LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
 
-    int err = pthread_setcancelstate(restoreTo, &junk);
-    LE_FATAL_IF(err != 0, "pthread_setcancelstate() failed (%s)", strerror(err));
+    RestoreCancel(restoreTo);
 }
 
 
@@ -486,9 +534,10 @@ static void DeleteHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Write to a thread's Event File Descriptor.  This increments it by one.
+ * Write to a thread's Event File Descriptor.  This increments it by one, which wakes up the
+ * thread's Event Loop.
  *
- * This must be done exactly once for each Event Report pushed onto the thread's Event Queue.
+ * This must be done whenever an Event Report is pushed onto an empty Event Queue.
  */
 //--------------------------------------------------------------------------------------------------
 static void WriteEventFd
@@ -547,6 +596,12 @@ static uint64_t ReadEventFd
         {
             return readBuff;
         }
+        // The eventfd is non-blocking, because directly dispatched fd events can wake the
+        // Event Loop up without anything having been written to it.
+        else if ((readSize == -1) && (errno == EAGAIN))
+        {
+            return 0;
+        }
         else
         {
             if ((readSize == -1) && (errno != EINTR))
@@ -562,9 +617,139 @@ static uint64_t ReadEventFd
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize a thread's Event Queue.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InitEventQueue
+(
+    event_PerThreadRec_t* perThreadRecPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The queue always contains at least one link, which starts out being the stub.
+    perThreadRecPtr->eventQueueStub = LE_SLS_LINK_INIT;
+    perThreadRecPtr->eventQueueHeadPtr = &perThreadRecPtr->eventQueueStub;
+    perThreadRecPtr->eventQueueTailPtr = &perThreadRecPtr->eventQueueStub;
+    perThreadRecPtr->eventQueueCount = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a link to the tail of a thread's Event Queue.  Can be called by any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushLink
+(
+    event_PerThreadRec_t* perThreadRecPtr,
+    le_sls_Link_t* linkPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    linkPtr->nextPtr = NULL;
+
+    // Claim the tail position, then link the previous tail to us.  Until that second step is
+    // done, the consumer can't see this link (or any link added after it).
+    le_sls_Link_t* prevLinkPtr = __atomic_exchange_n(&perThreadRecPtr->eventQueueTailPtr,
+                                                     linkPtr,
+                                                     __ATOMIC_ACQ_REL);
+
+    __atomic_store_n(&prevLinkPtr->nextPtr, linkPtr, __ATOMIC_RELEASE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add an Event Report to a thread's Event Queue, and wake up the thread if its queue was empty.
+ * Can be called by any thread.
+ *
+ * @warning Assumes the calling thread is protected from cancellation.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushReport
+(
+    event_PerThreadRec_t* perThreadRecPtr,
+    Report_t* reportPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    PushLink(perThreadRecPtr, &reportPtr->link);
+
+    // Only the report that makes the queue non-empty needs to wake up the Event Loop.
+    if (__atomic_fetch_add(&perThreadRecPtr->eventQueueCount, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        WriteEventFd(perThreadRecPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take the Event Report at the head of the calling thread's Event Queue off the queue.
+ *
+ * @return Pointer to the Report, or NULL if the queue is empty or the thread adding the report at
+ *         the head of the queue hasn't finished doing so yet.
+ *
+ * @warning Only the thread that owns the Event Queue may call this.
+ */
+//--------------------------------------------------------------------------------------------------
+static Report_t* PopReport
+(
+    event_PerThreadRec_t* perThreadRecPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_sls_Link_t* stubPtr = &perThreadRecPtr->eventQueueStub;
+    le_sls_Link_t* headPtr = perThreadRecPtr->eventQueueHeadPtr;
+    le_sls_Link_t* nextPtr = __atomic_load_n(&headPtr->nextPtr, __ATOMIC_ACQUIRE);
+
+    // Skip over the stub.
+    if (headPtr == stubPtr)
+    {
+        if (nextPtr == NULL)
+        {
+            return NULL;
+        }
+
+        perThreadRecPtr->eventQueueHeadPtr = nextPtr;
+        headPtr = nextPtr;
+        nextPtr = __atomic_load_n(&headPtr->nextPtr, __ATOMIC_ACQUIRE);
+    }
+
+    // If the head isn't the last link, it can just be taken.
+    if (nextPtr != NULL)
+    {
+        perThreadRecPtr->eventQueueHeadPtr = nextPtr;
+        return CONTAINER_OF(headPtr, Report_t, link);
+    }
+
+    // The head is the last linked link.  If it isn't the tail, another link is still being added.
+    if (headPtr != __atomic_load_n(&perThreadRecPtr->eventQueueTailPtr, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+
+    // Put the stub back behind the head, so the queue won't be left without any links.
+    PushLink(perThreadRecPtr, stubPtr);
+
+    nextPtr = __atomic_load_n(&headPtr->nextPtr, __ATOMIC_ACQUIRE);
+    if (nextPtr != NULL)
+    {
+        perThreadRecPtr->eventQueueHeadPtr = nextPtr;
+        return CONTAINER_OF(headPtr, Report_t, link);
+    }
+
+    return NULL;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Process one event report from the calling thread's Event Queue.
+ *
+ * @warning The Event Queue must have at least one Report counted on it.
  **/
 //--------------------------------------------------------------------------------------------------
 static void ProcessOneEventReport
@@ -573,25 +758,17 @@ static void ProcessOneEventReport
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_sls_Link_t* linkPtr;
     Report_t* reportObjPtr;
     Handler_t* handlerPtr;
+    int oldState;
 
-    int oldState = Lock();
-
-    // Pop an Event Report off the head of the Event Queue (inside a critical section).
-    linkPtr = le_sls_Pop(&perThreadRecPtr->eventQueue);
-
-    Unlock(oldState);
-
-    if (linkPtr == NULL)
+    // Pop an Event Report off the head of the Event Queue.  The report is known to be there, so if
+    // it can't be popped yet, the thread that queued it is in the middle of linking it in.
+    while ((reportObjPtr = PopReport(perThreadRecPtr)) == NULL)
     {
-        return;
+        sched_yield();
     }
 
-    // Convert the link pointer into a pointer to the Report base class.
-    reportObjPtr = CONTAINER_OF(linkPtr, Report_t, link);
-
     // If it's a queued function report,
     if (reportObjPtr->type == LE_EVENT_REPORT_QUEUED_FUNC)
     {
@@ -674,18 +851,27 @@ static void ProcessEventReports
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Read the eventfd to fetch the number of Reports on the Event Queue and reset the count
-    // to zero.
-    uint64_t numReports = ReadEventFd(perThreadRecPtr);
+    // Read the eventfd to reset it to zero, then fetch the number of Reports on the Event Queue.
+    (void)ReadEventFd(perThreadRecPtr);
+
+    size_t numReports = __atomic_load_n(&perThreadRecPtr->eventQueueCount, __ATOMIC_ACQUIRE);
+    size_t i;
 
     // Process only those event reports that are already on the queue.  Anything reported by the
     // event handlers will have to wait until next time ProcessEventReports() is called.
     // This approach ensures that event handlers that re-queue events to the event
     // queue don't cause fd events to be starved.
-    for (; numReports > 0; numReports--)
+    for (i = 0; i < numReports; i++)
     {
         ProcessOneEventReport(perThreadRecPtr);
     }
+
+    // Reports that were added while we were busy didn't wake us up, because the queue wasn't
+    // empty, so make sure we come back for them.
+    if (__atomic_sub_fetch(&perThreadRecPtr->eventQueueCount, numReports, __ATOMIC_ACQ_REL) > 0)
+    {
+        WriteEventFd(perThreadRecPtr);
+    }
 }
 
 
@@ -718,7 +904,7 @@ static void PubSubHandlerFunc
  * Queue a function onto a specific thread's Event Queue (could belong to the calling thread or
  * could belong to some other thread).
  *
- * @warning Assumes the mutex is locked and the thread is protected from cancellation.
+ * @warning Assumes the thread is protected from cancellation.
  */
 //--------------------------------------------------------------------------------------------------
 static void QueueFunction
@@ -740,11 +926,8 @@ static void QueueFunction
     reportPtr->param1Ptr = param1Ptr;
     reportPtr->param2Ptr = param2Ptr;
 
-    // Queue it to the Event Queue.
-    le_sls_Queue(&perThreadRecPtr->eventQueue, &reportPtr->baseClass.link);
-
-    // Write to the eventfd to notify the Event Loop that there is something on the queue.
-    WriteEventFd(perThreadRecPtr);
+    // Queue it to the Event Queue.  This notifies the Event Loop, if necessary.
+    PushReport(perThreadRecPtr, &reportPtr->baseClass);
 }
 
 
@@ -838,7 +1021,7 @@ void event_InitThread
     event_PerThreadRec_t* recPtr = thread_GetEventRecPtr();
 
     // Initialize the various thread-specific lists and queues.
-    recPtr->eventQueue = LE_SLS_LIST_INIT;
+    InitEventQueue(recPtr);
     recPtr->handlerList = LE_DLS_LIST_INIT;
     recPtr->fdMonitorList = LE_DLS_LIST_INIT;
 
@@ -849,7 +1032,7 @@ void event_InitThread
 
     // Open an eventfd for this thread.  This will be uses to signal to the epoll fd that there
     // are Event Reports on the Event Queue.
-    recPtr->eventQueueFd = eventfd(0, 0);
+    recPtr->eventQueueFd = eventfd(0, EFD_NONBLOCK);
     LE_FATAL_IF(recPtr->eventQueueFd < 0, "eventfd() failed with errno %d (%m).", errno);
 
     // Add the eventfd to the list of file descriptors to wait for using epoll_wait().
@@ -916,7 +1099,7 @@ void event_DestructThread
 {
     event_PerThreadRec_t* perThreadRecPtr = thread_GetEventRecPtr();
     le_dls_Link_t* doubleLinkPtr;
-    le_sls_Link_t* singleLinkPtr;
+    Report_t* reportPtr;
 
     // Some other thread could be accessing the Event List or structures under it, and we need
     // to access those to remove all of this thread's Handlers from all Events objects'
@@ -946,10 +1129,8 @@ void event_DestructThread
     fdMon_DestructThread(perThreadRecPtr);
 
     // Discard everything on the Event Queue.
-    while (NULL != (singleLinkPtr = le_sls_Pop(&perThreadRecPtr->eventQueue)))
+    while (NULL != (reportPtr = PopReport(perThreadRecPtr)))
     {
-        Report_t* reportPtr = CONTAINER_OF(singleLinkPtr, Report_t, link);
-
         // If it is carrying a pointer to a reference-counted object from a memory pool,
         // release that thing first.
         if (reportPtr->type == LE_EVENT_REPORT_COUNTED_REF)
@@ -1221,11 +1402,10 @@ void le_event_Report
         reportObjPtr->handlerRef = handlerPtr->safeRef;
         memset(reportObjPtr->payload, 0, eventPtr->payloadSize);
         memcpy(reportObjPtr->payload, payloadPtr, payloadSize);
-        le_sls_Queue(&perThreadRecPtr->eventQueue, &reportObjPtr->baseClass.link);
 
-        // Increment the eventfd for the handler's thread's Event Queue.
-        // This will wake up the thread and tell it that it has something on its Event Queue.
-        WriteEventFd(perThreadRecPtr);
+        // This will wake up the thread, if it doesn't already know it has something on its
+        // Event Queue.
+        PushReport(perThreadRecPtr, &reportObjPtr->baseClass);
 
         linkPtr = le_dls_PeekNext(&eventPtr->handlerList, linkPtr);
     }
@@ -1282,11 +1462,10 @@ void le_event_ReportWithRefCounting
         reportObjPtr->handlerRef = handlerPtr->safeRef;
         reportObjPtr->payload[0] = objectPtr;
         le_mem_AddRef(objectPtr);
-        le_sls_Queue(&perThreadRecPtr->eventQueue, &reportObjPtr->baseClass.link);
 
-        // Increment the eventfd for the handler's thread's Event Queue.
-        // This will wake up the thread and tell it that it has something on its Event Queue.
-        WriteEventFd(perThreadRecPtr);
+        // This will wake up the thread, if it doesn't already know it has something on its
+        // Event Queue.
+        PushReport(perThreadRecPtr, &reportObjPtr->baseClass);
 
         linkPtr = le_dls_PeekNext(&eventPtr->handlerList, linkPtr);
     }
@@ -1366,11 +1545,12 @@ void le_event_QueueFunction
 )
 //--------------------------------------------------------------------------------------------------
 {
-    int oldState = Lock();
+    // The Event Queue is lock-free, but we mustn't be cancelled while adding to it.
+    int oldState = DisableCancel();
 
     QueueFunction(thread_GetEventRecPtr(), func, param1Ptr, param2Ptr);
 
-    Unlock(oldState);
+    RestoreCancel(oldState);
 }
 
 
@@ -1389,11 +1569,12 @@ void le_event_QueueFunctionToThread
 )
 //--------------------------------------------------------------------------------------------------
 {
-    int oldState = Lock();
+    // The Event Queue is lock-free, but we mustn't be cancelled while adding to it.
+    int oldState = DisableCancel();
 
     QueueFunction(thread_GetOtherEventRecPtr(thread), func, param1Ptr, param2Ptr);
 
-    Unlock(oldState);
+    RestoreCancel(oldState);
 }
 
 
@@ -1429,9 +1610,16 @@ void le_event_RunLoop
     // Enter the infinite loop itself.
     for (;;)
     {
+        // If memory pools are waiting to be trimmed, only wait for a while, so they can be
+        // trimmed if nothing happens in the meantime.
+        int timeout = (mem_IsIdleTrimPending() ? IDLE_TRIM_DELAY_MS : -1);
+
         // Wait for something to happen on one of the file descriptors that we are monitoring
         // using our epoll fd.
-        int result = epoll_wait(epollFd, epollEventList, NUM_ARRAY_MEMBERS(epollEventList), -1);
+        int result = epoll_wait(epollFd,
+                                epollEventList,
+                                NUM_ARRAY_MEMBERS(epollEventList),
+                                timeout);
 
         // If something happened on one or more of the monitored file descriptors,
         if (result > 0)
@@ -1441,25 +1629,29 @@ void le_event_RunLoop
             // Check if someone has cancelled the thread and terminate the thread now, if so.
             pthread_testcancel();
 
-            // For each fd event reported by epoll_wait(), if it is any file descriptor other
-            // than the eventfd (which is used to indicate that there is something on the
-            // Event Queue), queue an Event Report to the Event Queue for that fd.
+            // Pass the fd events reported by epoll_wait() to the FD Monitors.  Events on the
+            // eventfd (which is used to indicate that there is something on the Event Queue)
+            // are skipped.  Depending on the FD Monitor, its handler is either called now or
+            // an Event Report is queued for it.
+            fdMon_ReportEvents(epollEventList, result);
+
+            // If the eventfd was readable, or the fd events queued Event Reports, process all
+            // the Event Reports on the Event Queue.  The eventfd has a NULL data pointer.
+            bool isEventQueueReady = false;
             for (i = 0; i < result; i++)
             {
-                // Get the pointer that we registered with epoll_ctl(2) along with this fd.
-                // The value of this pointer will either be NULL or a Safe Reference for an
-                // FD Monitor object.  If it is NULL, then the Event Queue's eventfd is the
-                // fd that experienced the event.
-                void* safeRef = epollEventList[i].data.ptr;
-
-                if (safeRef != NULL)
+                if (epollEventList[i].data.ptr == NULL)
                 {
-                    fdMon_Report(safeRef, epollEventList[i].events);
+                    isEventQueueReady = true;
+                    break;
                 }
             }
 
-            // Process all the Event Reports on the Event Queue.
-            ProcessEventReports(perThreadRecPtr);
+            if (isEventQueueReady
+                || (__atomic_load_n(&perThreadRecPtr->eventQueueCount, __ATOMIC_ACQUIRE) > 0))
+            {
+                ProcessEventReports(perThreadRecPtr);
+            }
         }
         // Otherwise, if an epoll_wait() reported an error, hopefully it's just an interruption
         // by a signal (EINTR).  Anything else is a fatal error.
@@ -1474,8 +1666,13 @@ void le_event_RunLoop
             // check if someone has cancelled the thread and terminate the thread now, if so.
             pthread_testcancel();
         }
+        // Otherwise, if epoll_wait() timed out, we have been idle for a while, so trim the pools.
+        else if (timeout != -1)
+        {
+            mem_TrimIdlePools();
+        }
         // Otherwise, if epoll_wait() returned zero, something has gone horribly wrong, because
-        // it should never return zero.
+        // it should never return zero when waiting forever.
         else
         {
             LE_FATAL("epoll_wait() returned zero!");
@@ -1538,27 +1735,13 @@ le_result_t le_event_ServiceLoop
     // If something happened on one or more of the monitored file descriptors,
     if (result > 0)
     {
-        int i;
-
         // Check if someone has cancelled the thread and terminate the thread now, if so.
         pthread_testcancel();
 
-        // For each fd event reported by epoll_wait(), if it is any file descriptor other
-        // than the eventfd (which is used to indicate that there is something on the
-        // Event Queue), queue an Event Report to the Event Queue for that fd.
-        for (i = 0; i < result; i++)
-        {
-            // Get the pointer that we registered with epoll_ctl(2) along with this fd.
-            // The value of this pointer will either be NULL or a Safe Reference for an
-            // FD Monitor object.  If it is NULL, then the Event Queue's eventfd is the
-            // fd that experienced the event, which we will deal with later in this function.
-            void* safeRef = epollEventList[i].data.ptr;
-
-            if (safeRef != NULL)
-            {
-                fdMon_Report(safeRef, epollEventList[i].events);
-            }
-        }
+        // Pass the fd events reported by epoll_wait() to the FD Monitors.  Events on the
+        // eventfd (which is used to indicate that there is something on the Event Queue)
+        // are skipped; we will deal with those later in this function.
+        fdMon_ReportEvents(epollEventList, result);
     }
     // Otherwise, if an epoll_wait() reported an error, hopefully it's just an interruption
     // by a signal (EINTR).  Anything else is a fatal error.
@@ -1589,27 +1772,21 @@ le_result_t le_event_ServiceLoop
     (void)ReadEventFd(perThreadRecPtr);
 
     // If there is something on the Event Queue, process one thing.
-    int oldState = Lock();
-
-    if (!le_sls_IsEmpty(&perThreadRecPtr->eventQueue))
+    if (__atomic_load_n(&perThreadRecPtr->eventQueueCount, __ATOMIC_ACQUIRE) > 0)
     {
-        Unlock(oldState);
-
-        ProcessOneEventReport(perThreadRecPtr); // This function assumes the mutex is NOT locked.
+        ProcessOneEventReport(perThreadRecPtr);
 
-        oldState = Lock();
-    }
+        // The caller needs to know if there is more stuff waiting on the Event Queue.  If there is,
+        // keep the eventfd readable, because reports added to a non-empty queue don't write to it.
+        if (__atomic_sub_fetch(&perThreadRecPtr->eventQueueCount, 1, __ATOMIC_ACQ_REL) > 0)
+        {
+            WriteEventFd(perThreadRecPtr);
 
-    // The caller needs to know if there is more stuff waiting on the Event Queue.
-    le_result_t returnCode = LE_OK;
-    if (le_sls_IsEmpty(&perThreadRecPtr->eventQueue))
-    {
-        returnCode = LE_WOULD_BLOCK;
+            return LE_OK;
+        }
     }
 
-    Unlock(oldState);
-
-    return returnCode;
+    return LE_WOULD_BLOCK;
 }
 
 
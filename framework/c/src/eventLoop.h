@@ -51,7 +51,13 @@ event_LoopState_t;
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    le_sls_List_t       eventQueue;         ///< The thread's event queue.
+    le_sls_Link_t*      eventQueueTailPtr;  ///< Last link added to the thread's Event Queue
+                                            ///  (updated atomically by any thread).
+    le_sls_Link_t*      eventQueueHeadPtr;  ///< First link on the thread's Event Queue
+                                            ///  (only accessed by the thread itself).
+    le_sls_Link_t       eventQueueStub;     ///< Placeholder link used when the queue is empty.
+    size_t              eventQueueCount;    ///< Number of Event Reports on the Event Queue
+                                            ///  (updated atomically by any thread).
     le_dls_List_t       handlerList;        ///< List of handlers registered with this thread.
     le_dls_List_t       fdMonitorList;      ///< List of FD Monitors created by this thread.
     int                 epollFd;            ///< epoll(7) file descriptor.
@@ -10,12 +10,27 @@
  *
  * @section fdMonitor_Algorithm     Algorithm
  *
- * When a file descriptor event is detected by the Event Loop, fdMon_Report() is called with
- * the FD Monitor Reference (a safe reference) and a bit map containing the events that were
- * detected.  fdMon_Report() queues a function call (DispatchToHandler()) to the calling thread.
- * When that function gets called, it does a look-up of the safe reference.  If it finds an
- * FD Monitor object matching that reference (it could have been deleted in the meantime), then
- * it calls its registered handler function for that event.
+ * Each fd is registered with epoll(7) using a pointer to its FD Monitor object as the epoll data.
+ * When epoll_wait() returns a batch of events, the Event Loop passes the whole batch to
+ * fdMon_ReportEvents().  That first records the generation number of every FD Monitor in the
+ * batch, then reports each event in turn, skipping any FD Monitor whose generation number has
+ * changed since (because an earlier handler in the same batch deleted it, and possibly reused its
+ * memory for another FD Monitor).
+ *
+ * By default, an event is reported by queueing a function call (DispatchToHandler()) to the calling
+ * thread, with the FD Monitor Reference (a safe reference) and a bit map containing the events that
+ * were detected.  When that function gets called, it does a look-up of the safe reference.  If it
+ * finds an FD Monitor object matching that reference (it could have been deleted in the meantime),
+ * then it calls its registered handler function for that event.
+ *
+ * If direct dispatch has been enabled for the FD Monitor (see le_fdMonitor_SetDirectDispatch()),
+ * fdMon_ReportEvents() calls the handler function right away instead, saving the Event Queue
+ * round trip and the safe reference look-up.  The generation check is what makes that safe.
+ *
+ * Generation numbers come from a process-wide counter, so they are never reused by another
+ * FD Monitor while an old one could still be in an epoll batch.  Zero is never handed out;
+ * deleted FD Monitors get it.  FD Monitor objects come from a pool that is never trimmed, so
+ * reading the generation number of a deleted FD Monitor is always safe.
  *
  * The reason it was decided not to use Publish-Subscribe Events for this feature is that Event IDs
  * can't be deleted, and yet FD Monitors can.
@@ -85,7 +100,9 @@ typedef struct FdMonitor
     int                     fd;                 ///< File descriptor being monitored.
     uint32_t                epollEvents;        ///< epoll(7) flags for events being monitored.
     bool                    isAlwaysReady;      ///< Don't use epoll(7).  Treat as always ready.
-    le_fdMonitor_Ref_t safeRef;            ///< Safe Reference for this object.
+    bool                    isDirect;           ///< Call handler straight from the epoll batch.
+    uint32_t                generation;         ///< Changes when deleted.  0 = deleted.
+    le_fdMonitor_Ref_t      safeRef;            ///< Safe Reference for this object.
     event_PerThreadRec_t*   threadRecPtr;       ///< Ptr to per-thread data for monitoring thread.
 
     le_fdMonitor_HandlerFunc_t  handlerFunc;    ///< Handler function.
@@ -116,6 +133,14 @@ static le_mem_PoolRef_t FdMonitorPool;
 static le_ref_MapRef_t FdMonitorRefMap;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Source of FD Monitor generation numbers.  Accessed atomically, so it doesn't need the Mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t NextGeneration = 1;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mutex used to protect shared data structures in this module.
@@ -375,39 +400,47 @@ static void DeleteFdMonitor
     // Tell epoll(7) to stop monitoring this fd.
     StopMonitoringFd(fdMonitorPtr);
 
+    // Make sure any events for this FD Monitor that are still in the Event Loop's current epoll
+    // batch get discarded.
+    __atomic_store_n(&fdMonitorPtr->generation, 0, __ATOMIC_RELAXED);
+
     // Release the object back to it's pool.
     le_mem_Release(fdMonitorPtr);
 }
 
 
+static void DispatchToHandler(void* param1Ptr, void* param2Ptr);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
- * Dispatch an FD Event to the appropriate registered handler function.
+ * Queue an FD Event to the calling thread's Event Queue, to be passed to the handler function
+ * by DispatchToHandler().
  */
 //--------------------------------------------------------------------------------------------------
-static void DispatchToHandler
+static void QueueReport
 (
-    void* param1Ptr,    ///< FD Monitor safe reference.
-    void* param2Ptr     ///< epoll() event flags.
+    le_fdMonitor_Ref_t  safeRef,        ///< [in] Safe Reference for the FD Monitor object.
+    uint32_t            eventFlags      ///< [in] OR'd together epoll() event flags.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    uint32_t epollEventFlags = (uint32_t)(size_t)param2Ptr;
-
-    LOCK
-
-    // Get a pointer to the FD Monitor object for this fd.
-    FdMonitor_t* fdMonitorPtr = le_ref_Lookup(FdMonitorRefMap, param1Ptr);
-
-    UNLOCK
+    le_event_QueueFunction(DispatchToHandler, safeRef, (void*)(ssize_t)eventFlags);
+}
 
-    // If the FD Monitor object has been deleted, we can just ignore this.
-    if (fdMonitorPtr == NULL)
-    {
-        TRACE("Discarding events for non-existent FD Monitor %p.", param1Ptr);
-        return;
-    }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call an FD Monitor's registered handler function for some FD Events.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallHandler
+(
+    FdMonitor_t*    fdMonitorPtr,       ///< [in] The FD Monitor.  Must not have been deleted.
+    uint32_t        epollEventFlags     ///< [in] epoll() event flags.
+)
+//--------------------------------------------------------------------------------------------------
+{
     // Sanity check: The FD monitor must belong to the current thread.
     LE_ASSERT(thread_GetEventRecPtr() == fdMonitorPtr->threadRecPtr);
 
@@ -421,7 +454,7 @@ static void DispatchToHandler
         //       we will only end up in here if both POLLIN and POLLOUT are disabled, in which case
         //       returning now will prevent re-queuing of DispatchToHandler(), which is what we
         //       want.  When either POLLIN or POLLOUT are re-enabled, le_fdMonitor_Enable() will
-        //       call fdMon_Report() to get things going again.
+        //       call QueueReport() to get things going again.
         return;
     }
 
@@ -460,7 +493,7 @@ static void DispatchToHandler
     // when one of them is re-enabled.
     if ((fdMonitorPtr->isAlwaysReady) && (fdMonitorPtr->epollEvents & (EPOLLIN | EPOLLOUT)))
     {
-        fdMon_Report(fdMonitorPtr->safeRef, fdMonitorPtr->epollEvents & (EPOLLIN | EPOLLOUT));
+        QueueReport(fdMonitorPtr->safeRef, fdMonitorPtr->epollEvents & (EPOLLIN | EPOLLOUT));
     }
 
     // Release our reference.  We don't need the Monitor object anymore.
@@ -468,6 +501,36 @@ static void DispatchToHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Dispatch a queued FD Event to the appropriate registered handler function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DispatchToHandler
+(
+    void* param1Ptr,    ///< FD Monitor safe reference.
+    void* param2Ptr     ///< epoll() event flags.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LOCK
+
+    // Get a pointer to the FD Monitor object for this fd.
+    FdMonitor_t* fdMonitorPtr = le_ref_Lookup(FdMonitorRefMap, param1Ptr);
+
+    UNLOCK
+
+    // If the FD Monitor object has been deleted, we can just ignore this.
+    if (fdMonitorPtr == NULL)
+    {
+        TRACE("Discarding events for non-existent FD Monitor %p.", param1Ptr);
+        return;
+    }
+
+    CallHandler(fdMonitorPtr, (uint32_t)(size_t)param2Ptr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Update the epoll(7) FD for a given FD Monitor object.
@@ -487,7 +550,7 @@ static void UpdateEpollFd
     struct epoll_event ev;
     memset(&ev, 0, sizeof(ev));
     ev.events = monitorPtr->epollEvents;
-    ev.data.ptr = monitorPtr->safeRef;
+    ev.data.ptr = monitorPtr;
 
     int epollFd = monitorPtr->threadRecPtr->epollFd;
 
@@ -570,18 +633,57 @@ void fdMon_InitThread
 /**
  * Report FD Events.
  *
- * This is called by the Event Loop when it detects events on a file descriptor that is being
- * monitored.
+ * This is called by the Event Loop with the batch of events returned by epoll_wait().  Entries
+ * whose epoll data pointer is NULL (the Event Queue's eventfd) are ignored.
  */
 //--------------------------------------------------------------------------------------------------
-void fdMon_Report
+void fdMon_ReportEvents
 (
-    void*       safeRef,        ///< [in] Safe Reference for the FD Monitor object for the fd.
-    uint32_t    eventFlags      ///< [in] OR'd together event flags from epoll_wait().
+    const struct epoll_event*   eventList,  ///< [in] Events returned by epoll_wait().
+    int                         numEvents   ///< [in] Number of entries in eventList.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_event_QueueFunction(DispatchToHandler, safeRef, (void*)(ssize_t)eventFlags);
+    uint32_t generations[numEvents];
+    int i;
+
+    // Every FD Monitor in the batch was alive when epoll_wait() returned, so record their
+    // generation numbers before any handlers get a chance to delete them.
+    for (i = 0; i < numEvents; i++)
+    {
+        FdMonitor_t* fdMonitorPtr = eventList[i].data.ptr;
+
+        if (fdMonitorPtr != NULL)
+        {
+            generations[i] = __atomic_load_n(&fdMonitorPtr->generation, __ATOMIC_RELAXED);
+        }
+    }
+
+    for (i = 0; i < numEvents; i++)
+    {
+        FdMonitor_t* fdMonitorPtr = eventList[i].data.ptr;
+
+        if (fdMonitorPtr == NULL)
+        {
+            continue;
+        }
+
+        // If a handler that ran earlier in this batch deleted this FD Monitor, drop its events.
+        if (__atomic_load_n(&fdMonitorPtr->generation, __ATOMIC_RELAXED) != generations[i])
+        {
+            TRACE("Discarding events for FD Monitor deleted during dispatch (%p).", fdMonitorPtr);
+            continue;
+        }
+
+        if (fdMonitorPtr->isDirect)
+        {
+            CallHandler(fdMonitorPtr, eventList[i].events);
+        }
+        else
+        {
+            QueueReport(fdMonitorPtr->safeRef, eventList[i].events);
+        }
+    }
 }
 
 
@@ -662,6 +764,13 @@ le_fdMonitor_Ref_t le_fdMonitor_Create
     fdMonitorPtr->fd = fd;
     fdMonitorPtr->epollEvents = PollToEPoll(events) | EPOLLWAKEUP;  // Non-deferrable by default.
     fdMonitorPtr->isAlwaysReady = false;
+    fdMonitorPtr->isDirect = false;
+    fdMonitorPtr->generation = __atomic_fetch_add(&NextGeneration, 1, __ATOMIC_RELAXED);
+    if (fdMonitorPtr->generation == 0)
+    {
+        // Zero means deleted, so skip it when the counter wraps around.
+        fdMonitorPtr->generation = __atomic_fetch_add(&NextGeneration, 1, __ATOMIC_RELAXED);
+    }
     fdMonitorPtr->threadRecPtr = perThreadRecPtr;
     fdMonitorPtr->handlerFunc = handlerFunc;
     fdMonitorPtr->contextPtr = NULL;
@@ -684,7 +793,7 @@ le_fdMonitor_Ref_t le_fdMonitor_Create
     struct epoll_event ev;
     memset(&ev, 0, sizeof(ev));
     ev.events = fdMonitorPtr->epollEvents;
-    ev.data.ptr = fdMonitorPtr->safeRef;
+    ev.data.ptr = fdMonitorPtr;
     if (epoll_ctl(perThreadRecPtr->epollFd, EPOLL_CTL_ADD, fd, &ev) == -1)
     {
         if (errno == EPERM)
@@ -696,7 +805,7 @@ le_fdMonitor_Ref_t le_fdMonitor_Create
             uint32_t epollEvents = fdMonitorPtr->epollEvents & (EPOLLIN | EPOLLOUT);
             if (epollEvents != 0)
             {
-                fdMon_Report(fdMonitorPtr->safeRef, epollEvents);
+                QueueReport(fdMonitorPtr->safeRef, epollEvents);
             }
         }
         else
@@ -775,7 +884,7 @@ void le_fdMonitor_Enable
         if ((handlerMonitorPtr == NULL) || (handlerMonitorPtr->safeRef == monitorRef))
         {
             // Queue up DispatchToHandler() for this fd.
-            fdMon_Report(monitorRef, epollEvents & (EPOLLIN | EPOLLOUT));
+            QueueReport(monitorRef, epollEvents & (EPOLLIN | EPOLLOUT));
         }
     }
 
@@ -886,6 +995,42 @@ void le_fdMonitor_SetDeferrable
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets whether the handler for a given fd is called directly by the Event Loop when epoll(7)
+ * reports events, or (the default) via the thread's Event Queue.
+ *
+ * Direct dispatch avoids an Event Queue round trip and a safe reference look-up for every fd
+ * event, but the handler may then run ahead of Event Reports that were queued before the fd event
+ * was detected.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_fdMonitor_SetDirectDispatch
+(
+    le_fdMonitor_Ref_t monitorRef,  ///< [in] Reference to the File Descriptor Monitor object.
+    bool               isDirect     ///< [in] true (direct) or false (queued).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Look up the File Descriptor Monitor object using the safe reference provided.
+    // Note that the safe reference map is shared by all threads in the process, so it
+    // must be protected using the mutex.  The File Descriptor Monitor objects, on the other
+    // hand, are only allowed to be accessed by the one thread that created them, so it is
+    // safe to unlock the mutex after doing the safe reference lookup.
+    LOCK
+    FdMonitor_t* monitorPtr = le_ref_Lookup(FdMonitorRefMap, monitorRef);
+    UNLOCK
+
+    LE_FATAL_IF(monitorPtr == NULL, "File Descriptor Monitor %p doesn't exist!", monitorRef);
+    LE_FATAL_IF(thread_GetEventRecPtr() != monitorPtr->threadRecPtr,
+                "FD Monitor '%s' (fd %d) is owned by another thread.",
+                monitorPtr->name,
+                monitorPtr->fd);
+
+    monitorPtr->isDirect = isDirect;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets the Context Pointer for File Descriptor Monitor's handler function.  This can be retrieved
@@ -57,14 +57,14 @@ void fdMon_InitThread
 /**
  * Report FD Events.
  *
- * This is called by the Event Loop when it detects events on a file descriptor that is being
- * monitored.
+ * This is called by the Event Loop with the batch of events returned by epoll_wait().  Entries
+ * whose epoll data pointer is NULL (the Event Queue's eventfd) are ignored.
  */
 //--------------------------------------------------------------------------------------------------
-void fdMon_Report
+void fdMon_ReportEvents
 (
-    void*       safeRef,        ///< [in] Safe Reference for the FD Monitor object for the fd.
-    uint32_t    eventFlags      ///< [in] OR'd together event flags from epoll_wait().
+    const struct epoll_event*   eventList,  ///< [in] Events returned by epoll_wait().
+    int                         numEvents   ///< [in] Number of entries in eventList.
 );
 
 
@@ -140,6 +140,545 @@ static inline bool EqualKeys
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/*
+ * Resizable maps (created by le_hashmap_CreateResizable()) keep their key/value pairs inline in an
+ * entry array, in insertion order, instead of in pool-allocated entries chained into buckets.
+ * Lookups go through a separate open-addressed index of entry positions that uses Robin Hood
+ * probing: an entry being inserted takes over the slot of any entry that is closer to its home
+ * slot, which keeps probe sequences short even when the index is quite full.
+ *
+ * Removing a pair leaves a hole in the entry array, so entries never move under an iterator, and
+ * drops the pair from the index by shifting the following slots in its probe sequence back by one.
+ *
+ * When the index gets too full, a new one twice the size is allocated and the old one is migrated
+ * into it a few slots at a time by later insertions and removals, rather than all at once.  Until
+ * the migration is finished, lookups check both.  Slots that have been migrated out of (or removed
+ * from) the old index are marked INDEX_SLOT_MOVED, so that lookups in the old index still probe
+ * past them.
+ *
+ * When the entry array is full, it is compacted if at least a quarter of it is holes, or doubled
+ * in size otherwise.  Compaction rebuilds the index and adjusts the map's iterator.
+ */
+//--------------------------------------------------------------------------------------------------
+
+/// Index slot value for a slot that has never been used.
+#define INDEX_SLOT_EMPTY    UINT32_MAX
+
+/// Index slot value for a slot in the old index that has been migrated or removed.
+#define INDEX_SLOT_MOVED    (UINT32_MAX - 1)
+
+/// Smallest number of slots in an index.  Must be a power of 2.
+#define MIN_INDEX_SLOTS     8
+
+/// Number of old index slots migrated by each insertion or removal.
+#define INDEX_MIGRATE_STEP  8
+
+/// Smallest number of entries allocated for an entry array.
+#define MIN_ENTRY_CAPACITY  4
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate an index with all its slots empty.
+ *
+ * @return  Pointer to the first slot.
+ */
+//--------------------------------------------------------------------------------------------------
+static IndexSlot_t* CreateIndex
+(
+    size_t slotCount
+)
+{
+    IndexSlot_t* indexPtr = malloc(slotCount * sizeof(IndexSlot_t));
+    LE_ASSERT(indexPtr);
+
+    size_t i;
+    for (i = 0; i < slotCount; i++)
+    {
+        indexPtr[i].entryIndex = INDEX_SLOT_EMPTY;
+    }
+
+    return indexPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Calculate how far an index slot's occupant is from its home slot.
+ *
+ * @return  The probe distance.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t ProbeDistance
+(
+    const IndexSlot_t* slotPtr,
+    size_t pos,
+    size_t slotCount
+)
+{
+    return (pos - CalculateIndex(slotCount, slotPtr->hash)) & (slotCount - 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add an entry position to an index.  The index must not be the old index of a migration, and
+ * must have at least one empty slot.
+ */
+//--------------------------------------------------------------------------------------------------
+static void IndexInsert
+(
+    IndexSlot_t* indexPtr,
+    size_t slotCount,
+    uint32_t entryIndex,
+    uint32_t hash
+)
+{
+    IndexSlot_t carried = { .entryIndex = entryIndex, .hash = hash };
+    size_t pos = CalculateIndex(slotCount, hash);
+    size_t dist = 0;
+
+    for (;;)
+    {
+        IndexSlot_t* slotPtr = &indexPtr[pos];
+
+        if (slotPtr->entryIndex == INDEX_SLOT_EMPTY)
+        {
+            *slotPtr = carried;
+            return;
+        }
+
+        // Rob from the rich: if the occupant is closer to home than we are, take its slot and
+        // carry on looking for somewhere to put it instead.
+        size_t occupantDist = ProbeDistance(slotPtr, pos, slotCount);
+        if (occupantDist < dist)
+        {
+            IndexSlot_t temp = *slotPtr;
+            *slotPtr = carried;
+            carried = temp;
+            dist = occupantDist;
+        }
+
+        pos = (pos + 1) & (slotCount - 1);
+        dist++;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look up a key in one of a resizable map's indexes.
+ *
+ * @return  The slot position, or -1 if the key is not in the index.
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t IndexFind
+(
+    Hashmap_t* mapRef,
+    const IndexSlot_t* indexPtr,
+    size_t slotCount,
+    const void* keyPtr,
+    size_t hash
+)
+{
+    size_t pos = CalculateIndex(slotCount, hash);
+    size_t dist;
+
+    for (dist = 0; dist < slotCount; dist++)
+    {
+        const IndexSlot_t* slotPtr = &indexPtr[pos];
+
+        // Robin Hood ordering means the key can't be any further along than an empty slot or an
+        // occupant that is closer to its home than we are to ours.
+        if (   (slotPtr->entryIndex == INDEX_SLOT_EMPTY)
+            || (ProbeDistance(slotPtr, pos, slotCount) < dist) )
+        {
+            return -1;
+        }
+
+        if ((slotPtr->entryIndex != INDEX_SLOT_MOVED) && (slotPtr->hash == (uint32_t)hash))
+        {
+            const DenseEntry_t* entryPtr = &mapRef->entriesPtr[slotPtr->entryIndex];
+
+            if (   (entryPtr->hash == hash)
+                && ((entryPtr->keyPtr == keyPtr) || mapRef->equalsFuncPtr(entryPtr->keyPtr, keyPtr)))
+            {
+                return pos;
+            }
+        }
+
+        pos = (pos + 1) & (slotCount - 1);
+    }
+
+    return -1;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the occupant of a slot from an index by shifting the rest of its probe sequence back.
+ * The index must not be the old index of a migration.
+ */
+//--------------------------------------------------------------------------------------------------
+static void IndexRemoveAt
+(
+    IndexSlot_t* indexPtr,
+    size_t slotCount,
+    size_t pos
+)
+{
+    for (;;)
+    {
+        size_t next = (pos + 1) & (slotCount - 1);
+        IndexSlot_t* nextPtr = &indexPtr[next];
+
+        if (   (nextPtr->entryIndex == INDEX_SLOT_EMPTY)
+            || (ProbeDistance(nextPtr, next, slotCount) == 0) )
+        {
+            indexPtr[pos].entryIndex = INDEX_SLOT_EMPTY;
+            return;
+        }
+
+        indexPtr[pos] = *nextPtr;
+        pos = next;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look up a key in a resizable map.
+ *
+ * @return  The entry position, or -1 if the key is not in the map.
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t ResizableFind
+(
+    Hashmap_t* mapRef,
+    const void* keyPtr,
+    size_t hash,
+    IndexSlot_t** slotPtrPtr        ///< [out] The index slot that refers to the entry.  Optional.
+)
+{
+    ssize_t pos = IndexFind(mapRef, mapRef->indexPtr, mapRef->indexSlotCount, keyPtr, hash);
+    IndexSlot_t* slotPtr = NULL;
+
+    if (pos >= 0)
+    {
+        slotPtr = &mapRef->indexPtr[pos];
+    }
+    else if (mapRef->oldIndexPtr != NULL)
+    {
+        pos = IndexFind(mapRef, mapRef->oldIndexPtr, mapRef->oldIndexSlotCount, keyPtr, hash);
+        if (pos >= 0)
+        {
+            slotPtr = &mapRef->oldIndexPtr[pos];
+        }
+    }
+
+    if (slotPtr == NULL)
+    {
+        return -1;
+    }
+
+    if (slotPtrPtr != NULL)
+    {
+        *slotPtrPtr = slotPtr;
+    }
+
+    return slotPtr->entryIndex;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Migrate some slots of a resizable map's old index into its current index, if it's migrating.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MigrateIndex
+(
+    Hashmap_t* mapRef,
+    size_t numSlots             ///< [in] Maximum number of old index slots to migrate.
+)
+{
+    while ((mapRef->oldIndexPtr != NULL) && (numSlots > 0))
+    {
+        IndexSlot_t* slotPtr = &mapRef->oldIndexPtr[mapRef->migratePos];
+
+        if (slotPtr->entryIndex < INDEX_SLOT_MOVED)
+        {
+            IndexInsert(mapRef->indexPtr, mapRef->indexSlotCount, slotPtr->entryIndex, slotPtr->hash);
+            slotPtr->entryIndex = INDEX_SLOT_MOVED;
+        }
+
+        mapRef->migratePos++;
+        numSlots--;
+
+        if (mapRef->migratePos == mapRef->oldIndexSlotCount)
+        {
+            free(mapRef->oldIndexPtr);
+            mapRef->oldIndexPtr = NULL;
+            mapRef->oldIndexSlotCount = 0;
+
+            HASHMAP_TRACE(mapRef, "Hashmap %s: Index migration complete", mapRef->nameStr);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start migrating a resizable map's index into a new index twice the size.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GrowIndex
+(
+    Hashmap_t* mapRef
+)
+{
+    // Finish any migration that is still in progress first.
+    MigrateIndex(mapRef, SIZE_MAX);
+
+    mapRef->oldIndexPtr = mapRef->indexPtr;
+    mapRef->oldIndexSlotCount = mapRef->indexSlotCount;
+    mapRef->migratePos = 0;
+
+    mapRef->indexSlotCount *= 2;
+    mapRef->indexPtr = CreateIndex(mapRef->indexSlotCount);
+    mapRef->bucketCount = mapRef->indexSlotCount;
+
+    HASHMAP_TRACE(
+        mapRef,
+        "Hashmap %s: Index grown to %zu slots",
+        mapRef->nameStr,
+        mapRef->indexSlotCount
+    );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Squeeze the holes out of a resizable map's entry array and rebuild its index to match.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CompactEntries
+(
+    Hashmap_t* mapRef
+)
+{
+    HashmapIt_t* iteratorPtr = mapRef->iteratorPtr;
+    int32_t newIteratorIndex = -1;
+    size_t i;
+    size_t j = 0;
+
+    for (i = 0; i < mapRef->entryCount; i++)
+    {
+        // Keep the iterator where it was relative to the remaining entries.  If its entry has
+        // been removed, back it up to the previous remaining entry so le_hashmap_NextNode() still
+        // moves on to the right one.
+        if ((int32_t)i == iteratorPtr->currentIndex)
+        {
+            newIteratorIndex = (mapRef->entriesPtr[i].isUsed ? (int32_t)j : (int32_t)j - 1);
+        }
+
+        if (mapRef->entriesPtr[i].isUsed)
+        {
+            mapRef->entriesPtr[j] = mapRef->entriesPtr[i];
+            j++;
+        }
+    }
+
+    if (iteratorPtr->currentIndex >= (int32_t)mapRef->entryCount)
+    {
+        // Past the end.
+        iteratorPtr->currentIndex = j;
+    }
+    else if (iteratorPtr->currentIndex >= 0)
+    {
+        iteratorPtr->currentIndex = newIteratorIndex;
+    }
+
+    mapRef->entryCount = j;
+
+    // Rebuild the index from scratch.
+    free(mapRef->oldIndexPtr);
+    mapRef->oldIndexPtr = NULL;
+    mapRef->oldIndexSlotCount = 0;
+
+    for (i = 0; i < mapRef->indexSlotCount; i++)
+    {
+        mapRef->indexPtr[i].entryIndex = INDEX_SLOT_EMPTY;
+    }
+
+    for (i = 0; i < mapRef->entryCount; i++)
+    {
+        IndexInsert(mapRef->indexPtr, mapRef->indexSlotCount, i, mapRef->entriesPtr[i].hash);
+    }
+
+    HASHMAP_TRACE(mapRef, "Hashmap %s: Entries compacted", mapRef->nameStr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make sure there is room at the end of a resizable map's entry array for another entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeEntryRoom
+(
+    Hashmap_t* mapRef
+)
+{
+    if (mapRef->entryCount < mapRef->entryCapacity)
+    {
+        return;
+    }
+
+    if ((mapRef->entryCount - mapRef->size) >= (mapRef->entryCapacity / 4))
+    {
+        CompactEntries(mapRef);
+    }
+    else
+    {
+        mapRef->entryCapacity *= 2;
+        mapRef->entriesPtr = realloc(mapRef->entriesPtr,
+                                     mapRef->entryCapacity * sizeof(DenseEntry_t));
+        LE_ASSERT(mapRef->entriesPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * le_hashmap_Put() for resizable maps.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ResizablePut
+(
+    Hashmap_t* mapRef,
+    const void* keyPtr,
+    const void* valuePtr
+)
+{
+    size_t hash = HashKey(mapRef, keyPtr);
+
+    MigrateIndex(mapRef, INDEX_MIGRATE_STEP);
+
+    ssize_t entryIndex = ResizableFind(mapRef, keyPtr, hash, NULL);
+    if (entryIndex >= 0)
+    {
+        DenseEntry_t* entryPtr = &mapRef->entriesPtr[entryIndex];
+        const void* oldValue = entryPtr->valuePtr;
+        entryPtr->valuePtr = valuePtr;
+
+        HASHMAP_TRACE(
+            mapRef,
+            "Hashmap %s: Replaced entry %zd. Total map size now %zu",
+            mapRef->nameStr,
+            entryIndex,
+            mapRef->size
+        );
+
+        return (void*)oldValue;
+    }
+
+    MakeEntryRoom(mapRef);
+
+    // Keep the index no more than 7/8 full.
+    if (((mapRef->size + 1) * 8) > (mapRef->indexSlotCount * 7))
+    {
+        GrowIndex(mapRef);
+    }
+
+    DenseEntry_t* entryPtr = &mapRef->entriesPtr[mapRef->entryCount];
+    entryPtr->keyPtr = keyPtr;
+    entryPtr->valuePtr = valuePtr;
+    entryPtr->hash = hash;
+    entryPtr->isUsed = true;
+
+    IndexInsert(mapRef->indexPtr, mapRef->indexSlotCount, mapRef->entryCount, hash);
+
+    mapRef->entryCount++;
+    mapRef->size++;
+
+    HASHMAP_TRACE(
+        mapRef,
+        "Hashmap %s: Added entry %zu. Total map size now %zu",
+        mapRef->nameStr,
+        mapRef->entryCount - 1,
+        mapRef->size
+    );
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * le_hashmap_Remove() for resizable maps.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ResizableRemove
+(
+    Hashmap_t* mapRef,
+    const void* keyPtr
+)
+{
+    size_t hash = HashKey(mapRef, keyPtr);
+    IndexSlot_t* slotPtr;
+
+    MigrateIndex(mapRef, INDEX_MIGRATE_STEP);
+
+    ssize_t entryIndex = ResizableFind(mapRef, keyPtr, hash, &slotPtr);
+    if (entryIndex < 0)
+    {
+        HASHMAP_TRACE(mapRef, "Hashmap %s: Key not found", mapRef->nameStr);
+        return NULL;
+    }
+
+    if (   (mapRef->oldIndexPtr != NULL)
+        && (slotPtr >= mapRef->oldIndexPtr)
+        && (slotPtr < mapRef->oldIndexPtr + mapRef->oldIndexSlotCount) )
+    {
+        // Later probes in the old index have to get past this slot, so it can't be emptied.
+        slotPtr->entryIndex = INDEX_SLOT_MOVED;
+    }
+    else
+    {
+        IndexRemoveAt(mapRef->indexPtr, mapRef->indexSlotCount, slotPtr - mapRef->indexPtr);
+    }
+
+    if (mapRef->iteratorPtr->currentIndex == entryIndex)
+    {
+        mapRef->iteratorPtr->isValueValid = false;
+    }
+
+    DenseEntry_t* entryPtr = &mapRef->entriesPtr[entryIndex];
+    entryPtr->isUsed = false;
+    mapRef->size--;
+
+    HASHMAP_TRACE(mapRef, "Hashmap %s: Removing key from map", mapRef->nameStr);
+
+    return (void*)entryPtr->valuePtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the next entry in a resizable map's entry array that is in use.
+ *
+ * @return  The entry position, or -1 if there are no more.
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t NextUsedEntry
+(
+    Hashmap_t* mapRef,
+    ssize_t entryIndex          ///< [in] Start looking after this position (-1 = from the start).
+)
+{
+    size_t i;
+
+    for (i = entryIndex + 1; i < mapRef->entryCount; i++)
+    {
+        if (mapRef->entriesPtr[i].isUsed)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Create a HashMap
@@ -165,6 +704,10 @@ le_hashmap_Ref_t le_hashmap_Create
     LE_ASSERT(mapRef);
 
     mapRef->traceRef = NULL;
+    mapRef->isResizable = false;
+    mapRef->entriesPtr = NULL;
+    mapRef->indexPtr = NULL;
+    mapRef->oldIndexPtr = NULL;
 
     /**
      * 0.75 load factor. We have more buckets than expected keys as we want
@@ -220,6 +763,59 @@ le_hashmap_Ref_t le_hashmap_Create
     return mapRef;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a HashMap that grows as entries are added.
+ *
+ * @return  Returns a reference to the map.
+ *
+ * @note Terminates the process on failure, so no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_hashmap_Ref_t le_hashmap_CreateResizable
+(
+    const char*                nameStr,          ///< [in] Name of the HashMap
+    size_t                     capacity,         ///< [in] Expected initial capacity of the map
+    le_hashmap_HashFunc_t      hashFunc,         ///< [in] The hash function
+    le_hashmap_EqualsFunc_t    equalsFunc        ///< [in] The equality function
+)
+{
+    LE_ASSERT(hashFunc);
+    LE_ASSERT(equalsFunc);
+
+    // It is ok to use malloc here as we will not be destroying the map
+    le_hashmap_Ref_t mapRef = malloc(sizeof(Hashmap_t));
+    LE_ASSERT(mapRef);
+    memset(mapRef, 0, sizeof(Hashmap_t));
+
+    mapRef->isResizable = true;
+    mapRef->hashFuncPtr = hashFunc;
+    mapRef->equalsFuncPtr = equalsFunc;
+    mapRef->nameStr = nameStr;
+
+    mapRef->entryCapacity = (capacity < MIN_ENTRY_CAPACITY) ? MIN_ENTRY_CAPACITY : capacity;
+    mapRef->entriesPtr = malloc(mapRef->entryCapacity * sizeof(DenseEntry_t));
+    LE_ASSERT(mapRef->entriesPtr);
+
+    // Size the index so the expected capacity fits without growing it.
+    mapRef->indexSlotCount = MIN_INDEX_SLOTS;
+    while ((mapRef->indexSlotCount * 7) < (mapRef->entryCapacity * 8))
+    {
+        mapRef->indexSlotCount <<= 1;
+    }
+    mapRef->indexPtr = CreateIndex(mapRef->indexSlotCount);
+    mapRef->bucketCount = mapRef->indexSlotCount;
+
+    mapRef->iteratorPtr = malloc(sizeof(HashmapIt_t));
+    LE_ASSERT(mapRef->iteratorPtr);
+    memset(mapRef->iteratorPtr, 0, sizeof(HashmapIt_t));
+    mapRef->iteratorPtr->theMapPtr = mapRef;
+    mapRef->iteratorPtr->currentIndex = -1;
+    mapRef->iteratorPtr->isValueValid = true;
+
+    return mapRef;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a key-value pair to a HashMap. If the key already exists in the map then the previous value
@@ -237,6 +833,11 @@ void* le_hashmap_Put
     const void* valuePtr       ///< [in] Pointer to the value to be stored
 )
 {
+    if (mapRef->isResizable)
+    {
+        return ResizablePut(mapRef, keyPtr, valuePtr);
+    }
+
     size_t hash = HashKey(mapRef, keyPtr);
     size_t index = CalculateIndex(mapRef->bucketCount, hash);
 
@@ -346,6 +947,12 @@ void* le_hashmap_Get
     const void* keyPtr         ///< [in] Pointer to the key to be retrieved
 )
 {
+    if (mapRef->isResizable)
+    {
+        ssize_t entryIndex = ResizableFind(mapRef, keyPtr, HashKey(mapRef, keyPtr), NULL);
+        return (entryIndex < 0) ? NULL : (void*)mapRef->entriesPtr[entryIndex].valuePtr;
+    }
+
     size_t hash = HashKey(mapRef, keyPtr);
     size_t index = CalculateIndex(mapRef->bucketCount, hash);
     HASHMAP_TRACE(
@@ -408,6 +1015,12 @@ void* le_hashmap_GetStoredKey
     const void* keyPtr         ///< [in] Pointer to the key to be retrieved.
 )
 {
+    if (mapRef->isResizable)
+    {
+        ssize_t entryIndex = ResizableFind(mapRef, keyPtr, HashKey(mapRef, keyPtr), NULL);
+        return (entryIndex < 0) ? NULL : (void*)mapRef->entriesPtr[entryIndex].keyPtr;
+    }
+
     size_t hash = HashKey(mapRef, keyPtr);
     size_t index = CalculateIndex(mapRef->bucketCount, hash);
     HASHMAP_TRACE(
@@ -473,6 +1086,11 @@ void* le_hashmap_Remove
    const void* keyPtr       ///< [in] Pointer to the key to be removed
 )
 {
+    if (mapRef->isResizable)
+    {
+        return ResizableRemove(mapRef, keyPtr);
+    }
+
     int hash = HashKey(mapRef, keyPtr);
     size_t index = CalculateIndex(mapRef->bucketCount, hash);
 
@@ -577,6 +1195,11 @@ bool le_hashmap_ContainsKey
     const void* keyPtr        ///< [in] Pointer to the key to be searched for
 )
 {
+    if (mapRef->isResizable)
+    {
+        return (ResizableFind(mapRef, keyPtr, HashKey(mapRef, keyPtr), NULL) >= 0);
+    }
+
     int hash = HashKey(mapRef, keyPtr);
     size_t index = CalculateIndex(mapRef->bucketCount, hash);
 
@@ -642,6 +1265,24 @@ void le_hashmap_RemoveAll
     mapRef->iteratorPtr->currentEntryPtr = NULL;
 
     uint32_t i;
+
+    if (mapRef->isResizable)
+    {
+        free(mapRef->oldIndexPtr);
+        mapRef->oldIndexPtr = NULL;
+        mapRef->oldIndexSlotCount = 0;
+
+        for (i = 0; i < mapRef->indexSlotCount; i++)
+        {
+            mapRef->indexPtr[i].entryIndex = INDEX_SLOT_EMPTY;
+        }
+        mapRef->entryCount = 0;
+        mapRef->size = 0;
+
+        HASHMAP_TRACE(mapRef, "Hashmap %s: All entries deleted from map", mapRef->nameStr);
+        return;
+    }
+
     for (i = 0; i < mapRef->bucketCount; i++) {
         le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[i]);
         le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
@@ -682,6 +1323,20 @@ void le_hashmap_ForEach
     void* context                            ///< [in] Pointer to a context to be supplied to the callback
 )
 {
+    if (mapRef->isResizable)
+    {
+        ssize_t entryIndex = -1;
+        while ((entryIndex = NextUsedEntry(mapRef, entryIndex)) >= 0)
+        {
+            const DenseEntry_t* entryPtr = &mapRef->entriesPtr[entryIndex];
+            if (!forEachFn(entryPtr->keyPtr, entryPtr->valuePtr, context))
+            {
+                return;
+            }
+        }
+        return;
+    }
+
     uint32_t i;
     for (i = 0; i < mapRef->bucketCount; i++) {
         le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[i]);
@@ -746,7 +1401,22 @@ le_result_t le_hashmap_NextNode
         return LE_NOT_FOUND;
     }
 
+    if (iteratorRef->theMapPtr->isResizable)
+    {
+        ssize_t entryIndex = NextUsedEntry(iteratorRef->theMapPtr, iteratorRef->currentIndex);
+        if (entryIndex < 0)
+        {
+            // Like other maps, leave the iterator on the last entry, so le_hashmap_PrevNode()
+            // goes to the one before it.
+            iteratorRef->isValueValid = false;
+            return LE_NOT_FOUND;
+        }
+        iteratorRef->currentIndex = entryIndex;
+        return LE_OK;
+    }
+
     le_dls_Link_t* theLinkPtr = NULL;
+    int32_t lastIndex = iteratorRef->currentIndex;
 
     // -1 indicates the iterator is new
     if (iteratorRef->currentIndex != -1) {
@@ -797,7 +1467,9 @@ le_result_t le_hashmap_NextNode
         return LE_OK;
     }
 
-    // At the end without finding another entry, need to invalidate the iterator
+    // At the end without finding another entry, need to invalidate the iterator.  It stays on the
+    // last entry, in that entry's bucket, so le_hashmap_PrevNode() doesn't visit the bucket twice.
+    iteratorRef->currentIndex = lastIndex;
     iteratorRef->isValueValid = false;
     return LE_NOT_FOUND;
 }
@@ -830,6 +1502,23 @@ le_result_t le_hashmap_PrevNode
         return LE_NOT_FOUND;
     }
 
+    if (iteratorRef->theMapPtr->isResizable)
+    {
+        const DenseEntry_t* entriesPtr = iteratorRef->theMapPtr->entriesPtr;
+
+        for (iteratorRef->currentIndex = iteratorRef->currentIndex - 1;
+             iteratorRef->currentIndex >= 0;
+             iteratorRef->currentIndex--)
+        {
+            if (entriesPtr[iteratorRef->currentIndex].isUsed)
+            {
+                return LE_OK;
+            }
+        }
+        iteratorRef->isValueValid = false;
+        return LE_NOT_FOUND;
+    }
+
     le_dls_Link_t* theLinkPtr = le_dls_PeekPrev(iteratorRef->currentListPtr,
                                                 iteratorRef->currentLinkPtr);
 
@@ -897,6 +1586,11 @@ const void* le_hashmap_GetKey
 {
     if (!iteratorRef->isValueValid || (iteratorRef->currentIndex == -1)) return NULL;
 
+    if (iteratorRef->theMapPtr->isResizable)
+    {
+        return iteratorRef->theMapPtr->entriesPtr[iteratorRef->currentIndex].keyPtr;
+    }
+
     return iteratorRef->currentEntryPtr->keyPtr;
 }
 
@@ -916,6 +1610,11 @@ void* le_hashmap_GetValue
     if (!iteratorRef->isValueValid || (iteratorRef->currentIndex == -1)) return NULL;
 
     // Need to cast away the const
+    if (iteratorRef->theMapPtr->isResizable)
+    {
+        return (void*)iteratorRef->theMapPtr->entriesPtr[iteratorRef->currentIndex].valuePtr;
+    }
+
     return (void*)iteratorRef->currentEntryPtr->valuePtr;
 }
 
@@ -952,6 +1651,17 @@ le_result_t le_hashmap_GetFirstNode
         return LE_BAD_PARAMETER;
     }
 
+    if (mapRef->isResizable)
+    {
+        const DenseEntry_t* entryPtr = &mapRef->entriesPtr[NextUsedEntry(mapRef, -1)];
+        *firstKeyPtr = (void *)entryPtr->keyPtr;
+        if (NULL != firstValuePtr)
+        {
+            *firstValuePtr = (void *)entryPtr->valuePtr;
+        }
+        return LE_OK;
+    }
+
     // Find the first list head
     size_t index = 0;
     for (
@@ -1005,6 +1715,28 @@ le_result_t le_hashmap_GetNodeAfter
         return LE_BAD_PARAMETER;
     }
 
+    if (mapRef->isResizable)
+    {
+        ssize_t entryIndex = ResizableFind(mapRef, keyPtr, HashKey(mapRef, keyPtr), NULL);
+        if (entryIndex < 0)
+        {
+            return LE_BAD_PARAMETER;
+        }
+
+        entryIndex = NextUsedEntry(mapRef, entryIndex);
+        if (entryIndex < 0)
+        {
+            return LE_NOT_FOUND;
+        }
+
+        *nextKeyPtr = (void *)mapRef->entriesPtr[entryIndex].keyPtr;
+        if (NULL != nextValuePtr)
+        {
+            *nextValuePtr = (void *)mapRef->entriesPtr[entryIndex].valuePtr;
+        }
+        return LE_OK;
+    }
+
     // Find the node pointed to by the key
     size_t hash = HashKey(mapRef, keyPtr);
     size_t index = CalculateIndex(mapRef->bucketCount, hash);
@@ -1102,6 +1834,31 @@ size_t le_hashmap_CountCollisions
 )
 {
     size_t i, collCount = 0;
+
+    if (mapRef->isResizable)
+    {
+        // Count the entries that aren't in their home slot.
+        for (i = 0; i < mapRef->indexSlotCount; i++)
+        {
+            const IndexSlot_t* slotPtr = &mapRef->indexPtr[i];
+            if (   (slotPtr->entryIndex < INDEX_SLOT_MOVED)
+                && (ProbeDistance(slotPtr, i, mapRef->indexSlotCount) > 0) )
+            {
+                collCount++;
+            }
+        }
+        for (i = 0; i < mapRef->oldIndexSlotCount; i++)
+        {
+            const IndexSlot_t* slotPtr = &mapRef->oldIndexPtr[i];
+            if (   (slotPtr->entryIndex < INDEX_SLOT_MOVED)
+                && (ProbeDistance(slotPtr, i, mapRef->oldIndexSlotCount) > 0) )
+            {
+                collCount++;
+            }
+        }
+        return collCount;
+    }
+
     for (i = 0; i < mapRef->bucketCount; i++) {
         if (mapRef->chainLengthPtr[i] > 1) {
             collCount += mapRef->chainLengthPtr[i] - 1;
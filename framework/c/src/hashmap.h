@@ -20,6 +20,30 @@ struct Entry {
     le_dls_Link_t entryListLink;
 };
 
+/**
+ * An entry in a resizable hashmap's entry array.  Entries never move while they are in the map,
+ * except when the array is compacted.
+ */
+typedef struct
+{
+    const void* keyPtr;
+    const void* valuePtr;
+    size_t hash;
+    bool isUsed;            ///< false if the entry has been removed (or never used).
+}
+DenseEntry_t;
+
+/**
+ * A slot in a resizable hashmap's index.  Each used slot holds the position of an entry in the
+ * entry array, plus the low 32 bits of its hash, so that most probes don't touch the entry itself.
+ */
+typedef struct
+{
+    uint32_t entryIndex;    ///< Position in the entry array, or one of the INDEX_SLOT_ values.
+    uint32_t hash;          ///< Low 32 bits of the entry's hash.
+}
+IndexSlot_t;
+
 /**
  * A hashmap iterator
  */
@@ -47,6 +71,19 @@ typedef struct le_hashmap {
     const char* nameStr;
     HashmapIt_t* iteratorPtr;
     le_log_TraceRef_t traceRef;
+
+    // The following are only used by resizable maps (see le_hashmap_CreateResizable()), which
+    // keep their entries in entriesPtr and don't use the buckets.  bucketCount is kept equal to
+    // indexSlotCount for tracing.
+    bool isResizable;
+    DenseEntry_t* entriesPtr;       ///< Entry array, in insertion order, with holes.
+    size_t entryCount;              ///< Number of entries used so far, including holes.
+    size_t entryCapacity;           ///< Number of entries allocated.
+    IndexSlot_t* indexPtr;          ///< Robin Hood index (power of 2 slots).
+    size_t indexSlotCount;
+    IndexSlot_t* oldIndexPtr;       ///< Index being migrated into indexPtr, or NULL.
+    size_t oldIndexSlotCount;
+    size_t migratePos;              ///< Next oldIndexPtr slot to migrate.
 }
 Hashmap_t;
 
@@ -237,6 +237,14 @@
 #define LIMIT_MAX_EVENT_NAME_BYTES              LIMIT_MAX_EVENT_HANDLER_NAME_BYTES + 15
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of threads in an IPC service's worker pool.
+ **/
+//--------------------------------------------------------------------------------------------------
+#define LIMIT_MAX_IPC_SERVICE_WORKERS           16
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Size of a MD5 string.
@@ -9,17 +9,13 @@
 
 #include "legato.h"
 #include "log.h"
+#include "logRing.h"
+#include "logLimit.h"
+#include "logShm.h"
 #include "logDaemon/logDaemon.h"
 #include "limit.h"
 #include "messagingSession.h"
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Maximum length of log messages.
- */
-//--------------------------------------------------------------------------------------------------
-#define MAX_MSG_SIZE            256
-
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -62,7 +58,7 @@ typedef struct le_log_Session
     const char* componentNamePtr;       ///< A pointer to the component's name.
     le_log_Level_t level;               ///< The component's severity level filter.
                                         ///  Log messages with severity less than this are ignored.
-    le_sls_List_t keywordList;          ///< The list of keywords for this component.
+    log_RateLimit_t rateLimit;          ///< The component's per-call-site rate limit.
     le_sls_Link_t link;                 ///< The link used for linking with the SessionList.
 }
 LogSession_t;
@@ -76,6 +72,15 @@ LogSession_t;
 static le_sls_List_t SessionList = LE_SLS_LIST_INIT;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map of log sessions, keyed by component name.  Used to find a component's session when a
+ * setting arrives from the Log Control Daemon.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t SessionMapRef;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * A memory pool for the log sessions.
@@ -93,25 +98,48 @@ static le_mem_PoolRef_t SessionMemPool;
 static LogSession_t DefaultLogSession =    {
                                             .componentNamePtr="<invalid>",
                                             .level=LOG_DEFAULT_LOG_FILTER,
-                                            .keywordList=LE_SLS_LIST_INIT,
+                                            .rateLimit={ .rate=LOG_DEFAULT_RATE_LIMIT,
+                                                         .burst=LOG_DEFAULT_BURST_LIMIT },
                                             .link=LE_SLS_LINK_INIT
                                         };
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * A keyword object that contains the keyword string and can be attached to the keyword list.
+ * Key of a trace keyword in the KeywordMap.  Keywords are scoped to a component, so the key is the
+ * component's log session and the keyword string.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const LogSession_t* sessionPtr;            // The session the keyword belongs to.
+    const char* keywordPtr;                    // The keyword.
+}
+KeywordKey_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A keyword object that contains the keyword string and can be put in the keyword map.
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    le_sls_Link_t link;                        // The link in the keyword list.
+    KeywordKey_t key;                          // The key in the keyword map.
     char keyword[LIMIT_MAX_LOG_KEYWORD_BYTES]; // The keyword.
     bool isEnabled;                            // true if the keyword is enabled.  false otherwise.
 }
 KeywordObj_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map of the trace keywords of all components, keyed by KeywordKey_t.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t KeywordMapRef;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * A memory pool where we get the memory for the keyword objects.
@@ -180,6 +208,46 @@ static inline void Unlock
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hashes a trace keyword's key.
+ *
+ * @return The hash value.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t HashKeyword
+(
+    const void* keyPtr      // Pointer to the KeywordKey_t.
+)
+{
+    const KeywordKey_t* keywordKeyPtr = keyPtr;
+
+    return le_hashmap_HashString(keywordKeyPtr->keywordPtr) * 31
+           + le_hashmap_HashVoidPointer(keywordKeyPtr->sessionPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compares two trace keywords' keys.
+ *
+ * @return true if the keys are the same.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool KeywordsEqual
+(
+    const void* firstKeyPtr,    // Pointer to the first KeywordKey_t.
+    const void* secondKeyPtr    // Pointer to the second KeywordKey_t.
+)
+{
+    const KeywordKey_t* firstPtr = firstKeyPtr;
+    const KeywordKey_t* secondPtr = secondKeyPtr;
+
+    return (firstPtr->sessionPtr == secondPtr->sessionPtr)
+           && (strcmp(firstPtr->keywordPtr, secondPtr->keywordPtr) == 0);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a new Keyword Object for a given session.
@@ -211,10 +279,11 @@ static KeywordObj_t* CreateKeyword
 
     // Init the keyword object.
     keywordObjPtr->isEnabled = false;
-    keywordObjPtr->link = LE_SLS_LINK_INIT;
+    keywordObjPtr->key.sessionPtr = logSessionPtr;
+    keywordObjPtr->key.keywordPtr = keywordObjPtr->keyword;
 
-    // Add the object to the list of keywords.
-    le_sls_Queue(&(logSessionPtr->keywordList), &(keywordObjPtr->link));
+    // Add the object to the map of keywords.
+    le_hashmap_Put(KeywordMapRef, &(keywordObjPtr->key), keywordObjPtr);
 
     return keywordObjPtr;
 }
@@ -232,25 +301,12 @@ static KeywordObj_t* CreateKeyword
 static KeywordObj_t* GetKeywordObj
 (
     const char* keywordPtr,         // The keyword to search for.
-    le_sls_List_t* keywordList      // The keyword list to search in.
+    const LogSession_t* sessionPtr  // The session whose keywords to search in.
 )
 {
-    // Search the keyword list for the keyword.
-    le_sls_Link_t* keywordLinkPtr = le_sls_Peek(keywordList);
+    KeywordKey_t key = { .sessionPtr = sessionPtr, .keywordPtr = keywordPtr };
 
-    while (keywordLinkPtr)
-    {
-        // Get the keyword object.
-        KeywordObj_t* keywordObjPtr = CONTAINER_OF(keywordLinkPtr, KeywordObj_t, link);
-
-        if (strcmp(keywordObjPtr->keyword, keywordPtr) == 0)
-        {
-            return keywordObjPtr;
-        }
-        keywordLinkPtr = le_sls_PeekNext(keywordList, keywordLinkPtr);
-    }
-
-    return NULL;
+    return le_hashmap_Get(KeywordMapRef, &key);
 }
 
 
@@ -268,24 +324,7 @@ static LogSession_t* GetSession
     const char* componentNamePtr
 )
 {
-    // Find the component's session.
-    le_sls_Link_t* sessionLinkPtr = le_sls_Peek(&SessionList);
-
-    while (sessionLinkPtr != NULL)
-    {
-        // Get the session.
-        LogSession_t* sessionPtr = CONTAINER_OF(sessionLinkPtr, LogSession_t, link);
-
-        if (strcmp(componentNamePtr, sessionPtr->componentNamePtr) == 0)
-        {
-            // Found the session.
-            return sessionPtr;
-        }
-
-        sessionLinkPtr = le_sls_PeekNext(&SessionList, sessionLinkPtr);
-    }
-
-    return NULL;
+    return le_hashmap_Get(SessionMapRef, componentNamePtr);
 }
 
 
@@ -308,7 +347,7 @@ static void EnableTrace
     if (sessionPtr)
     {
         // Search for the keyword.
-        KeywordObj_t* keywordObjPtr = GetKeywordObj(keywordPtr, &(sessionPtr->keywordList));
+        KeywordObj_t* keywordObjPtr = GetKeywordObj(keywordPtr, sessionPtr);
 
         if (keywordObjPtr == NULL)
         {
@@ -343,7 +382,7 @@ static void DisableTrace
     if (sessionPtr)
     {
         // Search the keyword list for the keyword.
-        KeywordObj_t* keywordObjPtr = GetKeywordObj(keywordPtr, &(sessionPtr->keywordList));
+        KeywordObj_t* keywordObjPtr = GetKeywordObj(keywordPtr, sessionPtr);
 
         if (keywordObjPtr)
         {
@@ -382,6 +421,33 @@ static void SetLogLevelFilter
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the per-call-site rate limit for a specific component.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetRateLimit
+(
+    const char* componentNamePtr,   // The name of the component.
+    const log_RateLimit_t* limitPtr // The rate limit.
+)
+{
+    Lock();
+
+    // Find the session to apply the limit to.
+    LogSession_t* sessionPtr = GetSession(componentNamePtr);
+
+    if (sessionPtr)
+    {
+        // The logging macros read the limit without locking the mutex.
+        __atomic_store_n(&sessionPtr->rateLimit.burst, limitPtr->burst, __ATOMIC_RELAXED);
+        __atomic_store_n(&sessionPtr->rateLimit.rate, limitPtr->rate, __ATOMIC_RELAXED);
+    }
+
+    Unlock();
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Create a log session.
@@ -400,7 +466,7 @@ static LogSession_t* CreateSession
     // Initialize the log session.
     logSessionPtr->componentNamePtr = componentNamePtr;
     logSessionPtr->level = DefaultLogSession.level;
-    logSessionPtr->keywordList = LE_SLS_LIST_INIT;
+    logSessionPtr->rateLimit = DefaultLogSession.rateLimit;
     logSessionPtr->link = LE_SLS_LINK_INIT;
 
     Lock();
@@ -408,6 +474,13 @@ static LogSession_t* CreateSession
     // Add it to the list of log sessions.
     le_sls_Queue(&SessionList, &(logSessionPtr->link));
 
+    // Settings for a component name that was registered more than once go to the first session
+    // registered under it.
+    if (!le_hashmap_ContainsKey(SessionMapRef, componentNamePtr))
+    {
+        le_hashmap_Put(SessionMapRef, componentNamePtr, logSessionPtr);
+    }
+
     Unlock();
 
     return logSessionPtr;
@@ -443,6 +516,29 @@ static void ReadLevelFromEnv
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Loads the default rate limit from the environment, if present.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ReadRateLimitFromEnv
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* envStrPtr = getenv("LE_LOG_RATE_LIMIT");
+
+    if (envStrPtr != NULL)
+    {
+        if (log_StrToRateLimit(envStrPtr, &DefaultLogSession.rateLimit) != LE_OK)
+        {
+            LE_ERROR("LE_LOG_RATE_LIMIT environment variable has invalid value '%s'.", envStrPtr);
+        }
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Loads the default list of enabled trace keywords from the environment, if present.
@@ -661,6 +757,21 @@ static void ProcessLogCmd
                 DisableTrace(componentName, commandDataPtr);
                 break;
 
+            case LOG_CMD_SET_RATE_LIMIT:
+            {
+                log_RateLimit_t limit;
+
+                if (log_StrToRateLimit(commandDataPtr, &limit) == LE_OK)
+                {
+                    SetRateLimit(componentName, &limit);
+                }
+                else
+                {
+                    LE_ERROR("Invalid rate limit '%s'.", commandDataPtr);
+                }
+                break;
+            }
+
             default:
                 LE_ERROR("Invalid command character '%c'.", command);
                 break;
@@ -751,6 +862,10 @@ void log_Init
 
     // Load the default log level filter and output destination settings from the environment.
     ReadLevelFromEnv();
+    ReadRateLimitFromEnv();
+
+    // Get ready to report messages suppressed by rate limiting.
+    logLimit_Init();
 
     // Create the keyword memory pool.
     KeywordMemPool = le_mem_CreatePool("TraceKeys", sizeof(KeywordObj_t));
@@ -760,6 +875,16 @@ void log_Init
     SessionMemPool = le_mem_CreatePool("LogSession", sizeof(LogSession_t));
     le_mem_ExpandPool(SessionMemPool, 10);  /// @todo Make this configurable.
 
+    // Create the session and keyword maps.
+    SessionMapRef = le_hashmap_CreateResizable("LogSessions",
+                                               10,      /// @todo Make this configurable.
+                                               le_hashmap_HashString,
+                                               le_hashmap_EqualsString);
+    KeywordMapRef = le_hashmap_CreateResizable("TraceKeys",
+                                               10,      /// @todo Make this configurable.
+                                               HashKeyword,
+                                               KeywordsEqual);
+
     // Register the framework as a component.
     LE_LOG_SESSION = log_RegComponent(STRINGIZE(LE_COMPONENT_NAME), &LE_LOG_LEVEL_FILTER_PTR);
 
@@ -771,6 +896,9 @@ void log_Init
 
     // Set the syslog format.
     openlog("Legato", 0, LOG_USER);
+
+    // Turn on deferred formatting, if asked for in the environment.
+    logRing_Init();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -859,6 +987,9 @@ void log_ConnectToControlDaemon
 
             linkPtr = le_sls_PeekNext(&SessionList, linkPtr);
         }
+
+        // Write log messages into shared memory from now on, if the daemon stores them.
+        logShm_Open(IpcSessionRef);
     }
 }
 
@@ -978,6 +1109,63 @@ const char* log_SeverityLevelToStr
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Translates a rate limit string to a rate limit.  The string is "off", "RATE" (the burst limit
+ * is then the same as the rate) or "RATE,BURST".
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if the string is an invalid rate limit.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t log_StrToRateLimit
+(
+    const char* limitStr,           ///< [IN] The rate limit string.
+    log_RateLimit_t* limitPtr       ///< [OUT] The rate limit.
+)
+{
+    if (strcmp(limitStr, LOG_RATE_LIMIT_OFF_STR) == 0)
+    {
+        limitPtr->rate = 0;
+        limitPtr->burst = 0;
+        return LE_OK;
+    }
+
+    if (!isdigit((unsigned char)limitStr[0]))
+    {
+        return LE_FAULT;
+    }
+
+    char* endPtr;
+    unsigned long rate = strtoul(limitStr, &endPtr, 10);
+    unsigned long burst = rate;
+
+    if (*endPtr == ',')
+    {
+        if (!isdigit((unsigned char)endPtr[1]))
+        {
+            return LE_FAULT;
+        }
+        burst = strtoul(endPtr + 1, &endPtr, 10);
+    }
+
+    // A rate of 0 is the same as "off", but a burst of 0 would suppress everything.
+    if (   (*endPtr != '\0')
+        || (rate > LOG_MAX_RATE_LIMIT)
+        || (burst > LOG_MAX_RATE_LIMIT)
+        || ((rate != 0) && (burst == 0)) )
+    {
+        return LE_FAULT;
+    }
+
+    limitPtr->rate = rate;
+    limitPtr->burst = (rate == 0) ? 0 : burst;
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Converts the legato log levels to the syslog priority levels.
@@ -1019,46 +1207,22 @@ static int ConvertToSyslogLevel
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Builds the log message and sends it to the logging system.
+ * Gets the string that marks a message in the log: either its severity level or its trace
+ * keyword.
+ *
+ * @return Pointer to the string.
  */
 //--------------------------------------------------------------------------------------------------
-void _le_log_Send
+static const char* GetLevelStr
 (
     const le_log_Level_t level,         // The severity level. Set to -1 if this is a Trace log.
-    const le_log_TraceRef_t traceRef,   // The Trace reference. Set to NULL if this is not a Trace log.
-    le_log_SessionRef_t logSession,     // The log session.
-    const char* filenamePtr,            // The name of the source file that logged the message.
-    const char* functionNamePtr,        // The name of the function that logged the message.
-    const unsigned int lineNumber,      // The line number in the source file that logged the message.
-    const char* formatPtr, ...          // The user message format and options.
+    const le_log_TraceRef_t traceRef    // The Trace reference, or NULL if this is not a Trace log.
 )
 {
-    // Save the current errno to be used in the log message because some of the system calls below
-    // may change errno.
-    int savedErrno = errno;
-
-    // If the logging function was called from code that doesn't have a log session reference,
-    if (logSession == NULL)
-    {
-        // Use the default log session.
-        logSession = &DefaultLogSession;
-
-        // Check that the message's log level is actually higher than the default filtering
-        // level, since the logging macros probably weren't provided with a valid pointer
-        // to a filtering level.
-        if ((level < logSession->level) && (level != (le_log_Level_t)-1))
-        {
-            return;
-        }
-    }
-
-    // Get either the log level or the trace keyword.
-    const char* levelPtr;
-
     if ( (level <= LOG_DEBUG) && (level >= LOG_EMERG) )
     {
         // Use the severity level.
-        levelPtr = SeverityStr[level];
+        return SeverityStr[level];
     }
     else
     {
@@ -1066,10 +1230,31 @@ void _le_log_Send
         //       keyword object.
         KeywordObj_t* keywordObjPtr = CONTAINER_OF(traceRef, KeywordObj_t, isEnabled);
 
-        // Add the trace keyword.
-        levelPtr = keywordObjPtr->keyword;
+        // Use the trace keyword.
+        return keywordObjPtr->keyword;
     }
+}
+
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds the log message and writes it out to the log right away.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendNow
+(
+    const le_log_Level_t level,         // The severity level. Set to -1 if this is a Trace log.
+    const char* levelPtr,               // The severity level string or trace keyword.
+    le_log_SessionRef_t logSession,     // The log session.
+    const le_log_CallSite_t* sitePtr,   // The call site that logged the message (NULL if unknown).
+    const char* filenamePtr,            // The name of the source file that logged the message.
+    const char* functionNamePtr,        // The name of the function that logged the message.
+    const unsigned int lineNumber,      // The line number in the source file that logged it.
+    int savedErrno,                     // The errno value to report for %m.
+    const char* formatPtr,              // The user message format.
+    va_list varParams                   // The user message options.
+)
+{
     // Get the component name.
     // NOTE: The component name won't change, so it's safe to read this without locking the mutex.
     const char* compNamePtr = logSession->componentNamePtr;
@@ -1080,18 +1265,8 @@ void _le_log_Send
     // Get the thread name.
     const char* threadNamePtr = le_thread_GetMyName();
 
-    // Get the process name.
-    const char* procNamePtr = le_arg_GetProgramName();
-    if (procNamePtr == NULL)
-    {
-        procNamePtr = "n/a";
-    }
-
     // Get the user message.
-    char msg[MAX_MSG_SIZE] = "";
-
-    va_list varParams;
-    va_start(varParams, formatPtr);
+    char msg[LOG_MAX_MSG_SIZE] = "";
 
     // Reset the errno to ensure that we report the proper errno value.
     errno = savedErrno;
@@ -1100,23 +1275,63 @@ void _le_log_Send
     // it.  If there was a truncation then that'll just show up in the logs.
     vsnprintf(msg, sizeof(msg), formatPtr, varParams);
 
-    va_end(varParams);
+    // Drop the message if its call site just logged the same thing.
+    if ((sitePtr != NULL) && logLimit_IsRepeat(sitePtr, threadNamePtr, msg))
+    {
+        return;
+    }
+
+    log_EmitMsg(level, levelPtr, compNamePtr, threadNamePtr, baseFileNamePtr, functionNamePtr,
+                lineNumber, time(NULL), msg);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a formatted log message out to the log.
+ */
+//--------------------------------------------------------------------------------------------------
+void log_EmitMsg
+(
+    le_log_Level_t level,           ///< [IN] Severity level (-1 if this is a trace).
+    const char* levelStrPtr,        ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,        ///< [IN] Name of the component that logged the message.
+    const char* threadNamePtr,      ///< [IN] Name of the thread that logged the message.
+    const char* baseFileNamePtr,    ///< [IN] Name of the source file (without its directory).
+    const char* functionNamePtr,    ///< [IN] Name of the function that logged the message.
+    unsigned int lineNumber,        ///< [IN] Line number in the source file.
+    time_t timestamp,               ///< [IN] Time the message was logged.
+    const char* msgPtr              ///< [IN] The formatted user message.
+)
+{
+    // If the Log Control Daemon is storing this process's messages, hand it the message.
+    if (logShm_Write(level, levelStrPtr, compNamePtr, threadNamePtr, baseFileNamePtr,
+                     functionNamePtr, lineNumber, timestamp, msgPtr))
+    {
+        return;
+    }
+
+    // Get the process name.
+    const char* procNamePtr = le_arg_GetProgramName();
+    if (procNamePtr == NULL)
+    {
+        procNamePtr = "n/a";
+    }
 
     // If running on an embedded target, write the message out to the log.
 #ifdef LEGATO_EMBEDDED
 
     syslog(ConvertToSyslogLevel(level), "%s | %s[%d]/%s T=%s | %s %s() %d | %s\n",
-           levelPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr, baseFileNamePtr,
-           functionNamePtr, lineNumber, msg);
+           levelStrPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr, baseFileNamePtr,
+           functionNamePtr, lineNumber, msgPtr);
 
     // If running on a PC, write the message to standard error with a timestamp added.
 #else
 
-    time_t now;
     char timeStamp[26] = "";
     char* timeStampPtr = timeStamp;
 
-    if ( (time(&now) != ((time_t)-1)) && (ctime_r(&now, timeStamp) != NULL) )
+    if ( (timestamp != ((time_t)-1)) && (ctime_r(&timestamp, timeStamp) != NULL) )
     {
         // Tue Jan 14 18:01:56 2014
         // 0123456789012345678901234
@@ -1125,13 +1340,138 @@ void _le_log_Send
     }
 
     fprintf(stderr, "%s : %s | %s[%d]/%s T=%s | %s %s() %d | %s\n",
-            timeStampPtr, levelPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr,
-            baseFileNamePtr, functionNamePtr, lineNumber, msg);
+            timeStampPtr, levelStrPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr,
+            baseFileNamePtr, functionNamePtr, lineNumber, msgPtr);
 
 #endif
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the string that marks messages of a given severity level in the log.
+ *
+ * @return Pointer to a string constant.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* log_GetSeverityStr
+(
+    le_log_Level_t level        ///< [IN] Severity level.
+)
+{
+    return SeverityStr[level];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds the log message and sends it to the logging system.
+ */
+//--------------------------------------------------------------------------------------------------
+void _le_log_Send
+(
+    const le_log_Level_t level,         // The severity level. Set to -1 if this is a Trace log.
+    const le_log_TraceRef_t traceRef,   // The Trace reference, or NULL if this is not a Trace log.
+    le_log_SessionRef_t logSession,     // The log session.
+    const char* filenamePtr,            // The name of the source file that logged the message.
+    const char* functionNamePtr,        // The name of the function that logged the message.
+    const unsigned int lineNumber,      // The line number in the source file that logged it.
+    const char* formatPtr, ...          // The user message format and options.
+)
+{
+    // Save the current errno to be used in the log message because some of the system calls below
+    // may change errno.
+    int savedErrno = errno;
+
+    // If the logging function was called from code that doesn't have a log session reference,
+    if (logSession == NULL)
+    {
+        // Use the default log session.
+        logSession = &DefaultLogSession;
+
+        // Check that the message's log level is actually higher than the default filtering
+        // level, since the logging macros probably weren't provided with a valid pointer
+        // to a filtering level.
+        if ((level < logSession->level) && (level != (le_log_Level_t)-1))
+        {
+            return;
+        }
+    }
+
+    va_list varParams;
+    va_start(varParams, formatPtr);
+
+    SendNow(level, GetLevelStr(level, traceRef), logSession, NULL, filenamePtr, functionNamePtr,
+            lineNumber, savedErrno, formatPtr, varParams);
+
+    va_end(varParams);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a log message from one of the logging macros to the logging system, unless its call site
+ * has used up its rate limit.  If deferred formatting is on, the message is recorded in the
+ * calling thread's log ring to be formatted later, unless it is CRITICAL or EMERGENCY (the
+ * process may be about to die) or can't be deferred.
+ */
+//--------------------------------------------------------------------------------------------------
+void _le_log_SendFromSite
+(
+    const le_log_Level_t level,         // The severity level. Set to -1 if this is a Trace log.
+    const le_log_TraceRef_t traceRef,   // The Trace reference, or NULL if this is not a Trace log.
+    le_log_SessionRef_t logSession,     // The log session.
+    le_log_CallSite_t* sitePtr,         // The call site that logged the message.
+    const char* functionNamePtr,        // The name of the function that logged the message.
+    const char* formatPtr, ...          // The user message format and options.
+)
+{
+    // Save the current errno to be used in the log message because some of the system calls below
+    // may change errno.
+    int savedErrno = errno;
+
+    // If the logging function was called from code that doesn't have a log session reference,
+    if (logSession == NULL)
+    {
+        // Use the default log session, checking the level against its filter (see _le_log_Send()).
+        logSession = &DefaultLogSession;
+
+        if ((level < logSession->level) && (level != (le_log_Level_t)-1))
+        {
+            return;
+        }
+    }
+
+    const char* levelPtr = GetLevelStr(level, traceRef);
+
+    // Drop the message if its call site has used up its rate limit.
+    if (!logLimit_Admit(sitePtr, level, levelPtr, logSession->componentNamePtr, functionNamePtr,
+                        &logSession->rateLimit))
+    {
+        return;
+    }
+
+    va_list varParams;
+    va_start(varParams, formatPtr);
+
+    if (   ((level == (le_log_Level_t)-1) || (level < LE_LOG_CRIT))
+        && logRing_Record(sitePtr, level, levelPtr, logSession->componentNamePtr,
+                          functionNamePtr, formatPtr, savedErrno, varParams))
+    {
+        va_end(varParams);
+        return;
+    }
+
+    // Get everything that was logged before this out first.
+    logRing_Flush();
+
+    SendNow(level, levelPtr, logSession, sitePtr, sitePtr->filenamePtr, functionNamePtr,
+            sitePtr->lineNumber, savedErrno, formatPtr, varParams);
+
+    va_end(varParams);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get a null-terminated, printable string representing an le_result_t value.
@@ -1221,7 +1561,7 @@ le_log_TraceRef_t _le_log_GetTraceRef
 
     Lock();
 
-    KeywordObj_t* keywordObjPtr = GetKeywordObj(keywordPtr, &(logSession->keywordList));
+    KeywordObj_t* keywordObjPtr = GetKeywordObj(keywordPtr, logSession);
 
     if (keywordObjPtr == NULL)
     {
@@ -44,6 +44,45 @@
 #define LOG_DEFAULT_LOG_FILTER      LE_LOG_INFO
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of log messages (including the null terminator).
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_MAX_MSG_SIZE            256
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default rate limit for sessions when they are first created: the number of messages per second
+ * that each logging call site may log, and the number of messages it may log in a burst.
+ **/
+//--------------------------------------------------------------------------------------------------
+#define LOG_DEFAULT_RATE_LIMIT      20
+#define LOG_DEFAULT_BURST_LIMIT     100
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest rate or burst limit that can be set.
+ **/
+//--------------------------------------------------------------------------------------------------
+#define LOG_MAX_RATE_LIMIT          10000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A component's per-call-site rate limit.  A rate of 0 means that rate limiting is off.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t rate;      ///< Messages per second allowed from each call site.
+    uint32_t burst;     ///< Messages allowed from a call site in a burst.
+}
+log_RateLimit_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initialize the logging system.  This must be called VERY early in the process initialization.
@@ -140,6 +179,23 @@ const char* log_SeverityLevelToStr
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Translates a rate limit string to a rate limit.  The string is "off", "RATE" (the burst limit
+ * is then the same as the rate) or "RATE,BURST".
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if the string is an invalid rate limit.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t log_StrToRateLimit
+(
+    const char* limitStr,           ///< [IN] The rate limit string.
+    log_RateLimit_t* limitPtr       ///< [OUT] The rate limit.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Log messages from the framework.  Used for testing only.
@@ -164,4 +220,36 @@ void log_LogGenericMsg
     const char* msgPtr          ///< [IN] Message.
 );
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the string that marks messages of a given severity level in the log.
+ *
+ * @return Pointer to a string constant.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* log_GetSeverityStr
+(
+    le_log_Level_t level        ///< [IN] Severity level.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a formatted log message out to the log.
+ */
+//--------------------------------------------------------------------------------------------------
+void log_EmitMsg
+(
+    le_log_Level_t level,           ///< [IN] Severity level (-1 if this is a trace).
+    const char* levelStrPtr,        ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,        ///< [IN] Name of the component that logged the message.
+    const char* threadNamePtr,      ///< [IN] Name of the thread that logged the message.
+    const char* baseFileNamePtr,    ///< [IN] Name of the source file (without its directory).
+    const char* functionNamePtr,    ///< [IN] Name of the function that logged the message.
+    unsigned int lineNumber,        ///< [IN] Line number in the source file.
+    time_t timestamp,               ///< [IN] Time the message was logged.
+    const char* msgPtr              ///< [IN] The formatted user message.
+);
+
 #endif // LOG_INCLUDE_GUARD
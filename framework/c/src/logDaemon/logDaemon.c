@@ -59,6 +59,12 @@
  * running process that belongs to an IPC session reference when the IPC system reports that
  * a session closed.  This is how the Log Control Daemon finds out that a client process died.
  *
+ * If persistent log storage is turned on (see logStore.h), each Running Process object can also
+ * have a shared memory Log Ring (see logDaemon.h) that the process writes its log messages into.
+ * The Log Control Daemon empties the ring into the log store whenever the process wakes it up,
+ * and one last time when the process's IPC session closes, so that the last words of a process
+ * that crashed are kept.
+ *
  * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
  */
 
@@ -67,6 +73,22 @@
 #include "logDaemon.h"
 #include "../limit.h"
 #include "../fileDescriptor.h"
+#include "logStore.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
 
 
 //--------------------------------------------------------------------------------------------------
@@ -97,6 +119,33 @@
 #define MAX_EXPECTED_TRACES 20
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the data area of each process's shared memory Log Ring, in bytes.  Must be a power of
+ * two.
+ *
+ * @todo Make this configurable.
+ **/
+//--------------------------------------------------------------------------------------------------
+#define LOG_RING_DATA_BYTES (16 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if log messages are being stored in the log store (see logStore.h).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsStoring = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path of the directory holding the log store, if IsStoring is true.
+ */
+//--------------------------------------------------------------------------------------------------
+static char StoreDirPath[LIMIT_MAX_PATH_BYTES];
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Hash map of Process Name objects, keyed by process name string.
@@ -139,8 +188,9 @@ static le_hashmap_Ref_t ProcessIdMapRef;
 typedef struct
 {
     le_dls_Link_t       link;                   ///< Link in the Process Name's component name list.
-    char name[LIMIT_MAX_COMPONENT_NAME_BYTES];  ///< The component name.
+    char*               name;                   ///< The component name (from NamePoolRef).
     le_log_Level_t      level;                  ///< The log level setting.
+    log_RateLimit_t     rateLimit;              ///< The rate limit setting.
     le_dls_List_t       enabledTracesList;      ///< List of enabled trace keywords.
 }
 ComponentName_t;
@@ -162,7 +212,7 @@ static le_mem_PoolRef_t ComponentNamePoolRef;
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    char    name[LIMIT_MAX_PROCESS_NAME_BYTES]; ///< The process name.
+    char*           name;                       ///< The process name (from NamePoolRef).
     le_dls_List_t   componentNameList;          ///< List of component names with settings.
     le_dls_List_t   runningProcessesList;       ///< List of running processes with this name.
 }
@@ -177,6 +227,24 @@ ProcessName_t;
 static le_mem_PoolRef_t ProcessNamePoolRef;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which the names of Process Name and Component Name objects are allocated.  Most
+ * names are much shorter than the maximum, so they are allocated from size classes that fit them.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_VarPoolRef_t NamePoolRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the largest name that can be allocated from the Name Pool.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_NAME_BYTES  (  (LIMIT_MAX_PROCESS_NAME_BYTES > LIMIT_MAX_COMPONENT_NAME_BYTES) \
+                         ? LIMIT_MAX_PROCESS_NAME_BYTES : LIMIT_MAX_COMPONENT_NAME_BYTES)
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Trace Name objects are used to hold trace keywords that have been enabled for all processes
@@ -223,10 +291,12 @@ typedef struct
     pid_t               pid;            ///< The process ID.
     le_msg_SessionRef_t ipcSessionRef;  ///< Reference to the IPC session connected to this process.
     le_dls_List_t       logSessionList; ///< List of log sessions in this process.
-/* TODO: Implement shared memory.
-    void*               sharedMemAddr;  ///< Address of base of memory region shared with
-                                        ///  this process.
- */
+    logShm_RingHeader_t* ringPtr;       ///< Shared memory Log Ring, or NULL if none.
+    uint32_t            ringTail;       ///< Our own copy of the ring's tail (the process could
+                                        ///  overwrite the one in shared memory).
+    uint32_t            ringDroppedCount; ///< Ring's dropped message count when last reported.
+    int                 ringWakeFd;     ///< eventfd the process writes to to wake us up.
+    le_fdMonitor_Ref_t  ringMonitorRef; ///< Monitors ringWakeFd.
 }
 RunningProcess_t;
 
@@ -251,6 +321,7 @@ typedef struct
     le_dls_Link_t       link;               ///< Link in the Running Process's log session list.
     char componentName[LIMIT_MAX_COMPONENT_NAME_BYTES];  ///< The component name.
     le_log_Level_t      level;              ///< This session's log level.
+    log_RateLimit_t     rateLimit;          ///< This session's rate limit.
     le_dls_List_t       traceList;          ///< List of Trace objects for this log session.
 }
 LogSession_t;
@@ -335,6 +406,15 @@ static le_mem_PoolRef_t FdLogPoolRef;
 #define MAX_MSG_SIZE            256
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rate value used in a rate limit setting to indicate that the rate limit isn't set (so the
+ * process's default applies).
+ */
+//--------------------------------------------------------------------------------------------------
+#define RATE_LIMIT_NOT_SET      UINT32_MAX
+
+
 
 // ========================================
 //  FUNCTIONS
@@ -434,6 +514,30 @@ static const char* GetLevelString
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats a rate limit as a string, as used in the CommandData part of SET_RATE_LIMIT commands.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void GetRateLimitString
+(
+    const log_RateLimit_t* limitPtr,
+    char* bufferPtr,
+    size_t bufferSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (limitPtr->rate == 0)
+    {
+        snprintf(bufferPtr, bufferSize, "%s", LOG_RATE_LIMIT_OFF_STR);
+    }
+    else
+    {
+        snprintf(bufferPtr, bufferSize, "%" PRIu32 ",%" PRIu32, limitPtr->rate, limitPtr->burst);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Find a Process Name object for a given process name.
@@ -479,6 +583,7 @@ static void DeleteAllComponentNamesForProcessName
             le_mem_Release(traceNameObjPtr);
         }
 
+        le_mem_Release(compNameObjPtr->name);
         le_mem_Release(compNameObjPtr);
     }
 }
@@ -499,6 +604,7 @@ static void DeleteProcessName
 
     DeleteAllComponentNamesForProcessName(procNameObjPtr);
 
+    le_mem_Release(procNameObjPtr->name);
     le_mem_Release(procNameObjPtr);
 }
 
@@ -539,6 +645,41 @@ static ComponentName_t* FindComponentName
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate a copy of a process or component name from the Name Pool, truncating it if it is
+ * longer than allowed.
+ *
+ * @return
+ *      A pointer to the copy (release it using le_mem_Release()).
+ */
+//--------------------------------------------------------------------------------------------------
+static char* CreateName
+(
+    const char* nameStr,    ///< [IN] The name to copy.
+    size_t maxBytes,        ///< [IN] Maximum size of the copy, including the null terminator.
+    const char* kindStr     ///< [IN] Kind of name, for the warning message ("Process", etc.).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t numBytes = strlen(nameStr) + 1;
+
+    if (numBytes > maxBytes)
+    {
+        numBytes = maxBytes;
+    }
+
+    char* namePtr = le_mem_VarAlloc(NamePoolRef, numBytes);
+
+    if (le_utf8_Copy(namePtr, nameStr, numBytes, NULL) != LE_OK)
+    {
+        LE_WARN("%s name '%s' truncated to '%s'.", kindStr, nameStr, namePtr);
+    }
+
+    return namePtr;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Create a Component Name object for a given Process Name object.
@@ -556,12 +697,11 @@ static ComponentName_t* CreateComponentName
 {
     ComponentName_t* objPtr = le_mem_ForceAlloc(ComponentNamePoolRef);
 
-    if (le_utf8_Copy(objPtr->name, componentNamePtr, sizeof(objPtr->name), NULL) != LE_OK)
-    {
-        LE_WARN("Component name '%s' truncated to '%s'.", componentNamePtr, objPtr->name);
-    }
+    objPtr->name = CreateName(componentNamePtr, LIMIT_MAX_COMPONENT_NAME_BYTES, "Component");
 
     objPtr->level = -1;
+    objPtr->rateLimit.rate = RATE_LIMIT_NOT_SET;
+    objPtr->rateLimit.burst = 0;
     objPtr->enabledTracesList = LE_DLS_LIST_INIT;
 
     objPtr->link = LE_DLS_LINK_INIT;
@@ -617,10 +757,7 @@ static ProcessName_t* CreateProcessName
 {
     ProcessName_t* objPtr = le_mem_ForceAlloc(ProcessNamePoolRef);
 
-    if (le_utf8_Copy(objPtr->name, processNameStr, sizeof(objPtr->name), NULL) != LE_OK)
-    {
-        LE_WARN("Process name '%s' truncated to '%s'.", processNameStr, objPtr->name);
-    }
+    objPtr->name = CreateName(processNameStr, LIMIT_MAX_PROCESS_NAME_BYTES, "Process");
 
     objPtr->componentNameList = LE_DLS_LIST_INIT;
     objPtr->runningProcessesList = LE_DLS_LIST_INIT;
@@ -730,7 +867,9 @@ static RunningProcess_t* CreateRunningProcess
 
     objPtr->pid = pid;
     objPtr->ipcSessionRef = ipcSessionRef;
-//    objPtr->sharedMemAddr = NULL;   // TODO: Implement shared memory.
+    objPtr->ringPtr = NULL;
+    objPtr->ringWakeFd = -1;
+    objPtr->ringMonitorRef = NULL;
 
     le_hashmap_Put(ProcessIdMapRef, &objPtr->pid, objPtr);
     le_hashmap_Put(IpcSessionMapRef, &objPtr->ipcSessionRef, objPtr);
@@ -802,6 +941,8 @@ static LogSession_t* CreateLogSession
     }
 
     objPtr->level = -1;     // Indicates unknown state.
+    objPtr->rateLimit.rate = RATE_LIMIT_NOT_SET;
+    objPtr->rateLimit.burst = 0;
     objPtr->traceList = LE_DLS_LIST_INIT;
     // TODO: implement shared memory.
 
@@ -951,8 +1092,10 @@ static bool ParseCmdPacket
     }
     packetPtr++;
 
-    // The "list" command has no parameters.
-    if (commandCode == LOG_CMD_LIST_COMPONENTS)
+    // The "list", "open ring" and "flush store" commands have no parameters.
+    if (   (commandCode == LOG_CMD_LIST_COMPONENTS)
+        || (commandCode == LOG_CMD_OPEN_RING)
+        || (commandCode == LOG_CMD_FLUSH_STORE) )
     {
         return true;
     }
@@ -1097,6 +1240,47 @@ static void SendToLogTool
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a client a command to update one of its log session's settings.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void SendSessionCommand
+(
+    RunningProcess_t* runningProcObjPtr,
+    LogSession_t* logSessionPtr,
+    char commandChar,
+    const char* commandDataPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(runningProcObjPtr->ipcSessionRef);
+    char* payloadPtr = le_msg_GetPayloadPtr(msgRef);
+    size_t maxSize = le_msg_GetMaxPayloadSize(msgRef);
+
+    size_t byteCount = snprintf(payloadPtr,
+                                maxSize,
+                                "%c%s/%s",
+                                commandChar,
+                                logSessionPtr->componentName,
+                                commandDataPtr);
+
+    if (byteCount >= maxSize)
+    {
+        LE_CRIT("Message too long (%zu bytes) to send to component '%s' in process '%s' (pid %d).",
+                byteCount,
+                logSessionPtr->componentName,
+                runningProcObjPtr->procNameObjPtr->name,
+                runningProcObjPtr->pid);
+        le_msg_ReleaseMsg(msgRef);
+    }
+    else
+    {
+        le_msg_Send(msgRef);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sends a client an update to its log session settings.
@@ -1109,38 +1293,23 @@ static void UpdateClientSessionSettings
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_msg_MessageRef_t msgRef;
-    char* payloadPtr;
-    size_t maxSize;
-    size_t byteCount;
-
     // First send the level update, if it's not -1 (default).
     if (logSessionPtr->level != (le_log_Level_t)-1)
     {
-        msgRef = le_msg_CreateMsg(runningProcObjPtr->ipcSessionRef);
-        payloadPtr = le_msg_GetPayloadPtr(msgRef);
-        maxSize = le_msg_GetMaxPayloadSize(msgRef);
+        SendSessionCommand(runningProcObjPtr,
+                           logSessionPtr,
+                           LOG_CMD_SET_LEVEL,
+                           GetLevelString(logSessionPtr->level));
+    }
 
-        byteCount = snprintf(payloadPtr,
-                             maxSize,
-                             "%c%s/%s",
-                             LOG_CMD_SET_LEVEL,
-                             logSessionPtr->componentName,
-                             GetLevelString(logSessionPtr->level));
+    // Then send the rate limit update, if it's set.
+    if (logSessionPtr->rateLimit.rate != RATE_LIMIT_NOT_SET)
+    {
+        char limitStr[32];
 
-        if (byteCount >= maxSize)
-        {
-            LE_CRIT("Message too long (%zu bytes) to send to component '%s' in process '%s' (pid %d).",
-                    byteCount,
-                    logSessionPtr->componentName,
-                    runningProcObjPtr->procNameObjPtr->name,
-                    runningProcObjPtr->pid);
-            le_msg_ReleaseMsg(msgRef);
-        }
-        else
-        {
-            le_msg_Send(msgRef);
-        }
+        GetRateLimitString(&logSessionPtr->rateLimit, limitStr, sizeof(limitStr));
+
+        SendSessionCommand(runningProcObjPtr, logSessionPtr, LOG_CMD_SET_RATE_LIMIT, limitStr);
     }
 }
 
@@ -1210,6 +1379,7 @@ static void CopyComponentSettings
 )
 {
     logSessionPtr->level = compNameObjPtr->level;
+    logSessionPtr->rateLimit = compNameObjPtr->rateLimit;
 
     UpdateClientSessionSettings(runningProcObjPtr, logSessionPtr);
 
@@ -1444,6 +1614,339 @@ static void RegComponent
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops reading a process's shared memory Log Ring and unmaps it.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void CloseRing
+(
+    RunningProcess_t* runningProcObjPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (runningProcObjPtr->ringPtr != NULL)
+    {
+        le_fdMonitor_Delete(runningProcObjPtr->ringMonitorRef);
+        runningProcObjPtr->ringMonitorRef = NULL;
+
+        fd_Close(runningProcObjPtr->ringWakeFd);
+        runningProcObjPtr->ringWakeFd = -1;
+
+        munmap(runningProcObjPtr->ringPtr, sizeof(logShm_RingHeader_t) + LOG_RING_DATA_BYTES);
+        runningProcObjPtr->ringPtr = NULL;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stores a log message record copied out of a process's Log Ring, checking it first.
+ *
+ * @return true if the record was good, false if it was malformed.
+ **/
+//--------------------------------------------------------------------------------------------------
+static bool StoreRingRecord
+(
+    RunningProcess_t* runningProcObjPtr,    ///< [IN] The process that wrote the record.
+    const uint8_t* recordPtr,               ///< [IN] Copy of the record.
+    uint32_t recordSize                     ///< [IN] Size of the record.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    logShm_RecordHeader_t header;
+    const char* strings[6];
+    size_t pos = sizeof(header);
+    int i;
+
+    memcpy(&header, recordPtr, sizeof(header));
+
+    if ((header.level < -1) || (header.level > LE_LOG_EMERG))
+    {
+        return false;
+    }
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(strings); i++)
+    {
+        const uint8_t* endPtr = memchr(recordPtr + pos, '\0', recordSize - pos);
+        if (endPtr == NULL)
+        {
+            return false;
+        }
+
+        strings[i] = (const char*)(recordPtr + pos);
+        pos = (endPtr - recordPtr) + 1;
+    }
+
+    logStore_Record_t record = { .timestamp = header.timestamp,
+                                 .pid = runningProcObjPtr->pid,
+                                 .level = (le_log_Level_t)header.level,
+                                 .lineNumber = header.lineNumber,
+                                 .levelStrPtr = strings[0],
+                                 .procNamePtr = runningProcObjPtr->procNameObjPtr->name,
+                                 .compNamePtr = strings[1],
+                                 .threadNamePtr = strings[2],
+                                 .fileNamePtr = strings[3],
+                                 .funcNamePtr = strings[4],
+                                 .msgPtr = strings[5] };
+
+    logStore_Append(&record);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves everything in a process's shared memory Log Ring into the log store, then asks the
+ * process to wake us up when it writes more.
+ *
+ * The process can write anything at all into the ring, so each record is copied out before it
+ * is checked.  If the ring turns out to be corrupt, we stop reading it.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void DrainRing
+(
+    RunningProcess_t* runningProcObjPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    logShm_RingHeader_t* ringPtr = runningProcObjPtr->ringPtr;
+    uint8_t* dataPtr = (uint8_t*)(ringPtr + 1);
+    uint32_t tail = runningProcObjPtr->ringTail;
+    uint8_t record[LOG_SHM_MAX_RECORD_BYTES];
+
+    for (;;)
+    {
+        uint32_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE);
+
+        if (head == tail)
+        {
+            // Ask for a wake-up, then check once more for a record written in the meantime.
+            __atomic_store_n(&ringPtr->consumerWaiting, 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+            if (__atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE) == tail)
+            {
+                break;
+            }
+
+            __atomic_store_n(&ringPtr->consumerWaiting, 0, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        uint32_t offset = tail & (LOG_RING_DATA_BYTES - 1);
+        uint32_t size = 0;
+        uint8_t type = 0;
+
+        // Only the size and type fields of a padding record are sure to be inside the ring.
+        memcpy(&size, dataPtr + offset, sizeof(size));
+        memcpy(&type, dataPtr + offset + offsetof(logShm_RecordHeader_t, type), sizeof(type));
+
+        if (   (head - tail > LOG_RING_DATA_BYTES)
+            || (size < 8)
+            || ((size & 7) != 0)
+            || (size > LOG_RING_DATA_BYTES - offset)
+            || (size > head - tail) )
+        {
+            LE_ERROR("Log Ring of process '%s' (pid %d) is corrupt.",
+                     runningProcObjPtr->procNameObjPtr->name,
+                     runningProcObjPtr->pid);
+            CloseRing(runningProcObjPtr);
+            return;
+        }
+
+        if (type == LOG_SHM_RECORD_MSG)
+        {
+            if (   (size < sizeof(logShm_RecordHeader_t))
+                || (size > sizeof(record)) )
+            {
+                LE_ERROR("Bad record size %u in Log Ring of process '%s' (pid %d).",
+                         size,
+                         runningProcObjPtr->procNameObjPtr->name,
+                         runningProcObjPtr->pid);
+                CloseRing(runningProcObjPtr);
+                return;
+            }
+
+            memcpy(record, dataPtr + offset, size);
+
+            if (!StoreRingRecord(runningProcObjPtr, record, size))
+            {
+                LE_ERROR("Malformed record in Log Ring of process '%s' (pid %d).",
+                         runningProcObjPtr->procNameObjPtr->name,
+                         runningProcObjPtr->pid);
+            }
+        }
+        else if (type != LOG_SHM_RECORD_PAD)
+        {
+            LE_ERROR("Bad record type %u in Log Ring of process '%s' (pid %d).",
+                     type,
+                     runningProcObjPtr->procNameObjPtr->name,
+                     runningProcObjPtr->pid);
+            CloseRing(runningProcObjPtr);
+            return;
+        }
+
+        tail += size;
+        runningProcObjPtr->ringTail = tail;
+        __atomic_store_n(&ringPtr->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    // Report messages that the process had to drop because the ring was full.
+    uint32_t droppedCount = __atomic_load_n(&ringPtr->droppedCount, __ATOMIC_RELAXED);
+    if (droppedCount != runningProcObjPtr->ringDroppedCount)
+    {
+        char msg[64];
+        snprintf(msg,
+                 sizeof(msg),
+                 "%u log messages dropped (log ring full).",
+                 droppedCount - runningProcObjPtr->ringDroppedCount);
+        runningProcObjPtr->ringDroppedCount = droppedCount;
+
+        logStore_Record_t dropRecord = { .timestamp = time(NULL),
+                                         .pid = runningProcObjPtr->pid,
+                                         .level = LE_LOG_WARN,
+                                         .lineNumber = 0,
+                                         .levelStrPtr = log_GetSeverityStr(LE_LOG_WARN),
+                                         .procNamePtr = runningProcObjPtr->procNameObjPtr->name,
+                                         .compNamePtr = "",
+                                         .threadNamePtr = "",
+                                         .fileNamePtr = "",
+                                         .funcNamePtr = "",
+                                         .msgPtr = msg };
+
+        logStore_Append(&dropRecord);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handles a process waking us up to read its Log Ring.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void RingWakeUpHandler
+(
+    int fd,
+    short events
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RunningProcess_t* runningProcObjPtr = le_fdMonitor_GetContextPtr();
+
+    if (events & POLLIN)
+    {
+        uint64_t count;
+        ssize_t result;
+
+        do
+        {
+            result = read(fd, &count, sizeof(count));
+        }
+        while ((result == -1) && (errno == EINTR));
+    }
+
+    DrainRing(runningProcObjPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets up a shared memory Log Ring for a client process, in response to an "Open Ring" request.
+ * The request carries the eventfd that the process will use to wake us up.  The response
+ * carries the memfd holding the ring, or no fd if log storage is off or the ring couldn't be
+ * created.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void OpenRing
+(
+    le_msg_MessageRef_t msgRef      ///< [IN] The request.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int wakeFd = le_msg_GetFd(msgRef);
+    RunningProcess_t* runningProcObjPtr = FindProcessByIpcSession(le_msg_GetSession(msgRef));
+
+    if (!IsStoring)
+    {
+        goto refuse;
+    }
+
+    if ((wakeFd < 0) || (runningProcObjPtr == NULL) || (runningProcObjPtr->ringPtr != NULL))
+    {
+        LE_ERROR("Unexpected Log Ring request.");
+        goto refuse;
+    }
+
+    size_t ringBytes = sizeof(logShm_RingHeader_t) + LOG_RING_DATA_BYTES;
+
+    int memFd = syscall(SYS_memfd_create, "le_log", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memFd < 0)
+    {
+        LE_ERROR("Failed to create memfd (%m).");
+        goto refuse;
+    }
+
+    // Seal the size, so that the process can't shrink the memory out from under us.
+    if (   (ftruncate(memFd, ringBytes) != 0)
+        || (fcntl(memFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) )
+    {
+        LE_ERROR("Failed to size and seal Log Ring memfd (%m).");
+        fd_Close(memFd);
+        goto refuse;
+    }
+
+    logShm_RingHeader_t* ringPtr = mmap(NULL,
+                                        ringBytes,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_SHARED,
+                                        memFd,
+                                        0);
+    if (ringPtr == MAP_FAILED)
+    {
+        LE_ERROR("Failed to map Log Ring (%m).");
+        fd_Close(memFd);
+        goto refuse;
+    }
+
+    // The memfd starts out zeroed.  Start out waiting, so the first message wakes us up.
+    ringPtr->magic = LOG_SHM_RING_MAGIC;
+    ringPtr->dataSize = LOG_RING_DATA_BYTES;
+    ringPtr->consumerWaiting = 1;
+
+    runningProcObjPtr->ringPtr = ringPtr;
+    runningProcObjPtr->ringTail = 0;
+    runningProcObjPtr->ringDroppedCount = 0;
+    runningProcObjPtr->ringWakeFd = wakeFd;
+
+    char monitorName[LIMIT_MAX_PROCESS_NAME_BYTES + 8];
+    snprintf(monitorName,
+             sizeof(monitorName),
+             "%sLogRing",
+             runningProcObjPtr->procNameObjPtr->name);
+    runningProcObjPtr->ringMonitorRef = le_fdMonitor_Create(monitorName,
+                                                            wakeFd,
+                                                            RingWakeUpHandler,
+                                                            POLLIN);
+    le_fdMonitor_SetContextPtr(runningProcObjPtr->ringMonitorRef, runningProcObjPtr);
+
+    le_msg_SetFd(msgRef, memFd);
+    le_msg_Respond(msgRef);
+
+    return;
+
+refuse:
+
+    if (wakeFd >= 0)
+    {
+        fd_Close(wakeFd);
+    }
+
+    le_msg_Respond(msgRef);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handle the closing of a client IPC session, which signals the death of a process.
@@ -1474,6 +1977,13 @@ static void ClientIpcSessionClosed
              procNameObjPtr->name,
              runningProcObjPtr->pid);
 
+    // Keep whatever the process managed to write into its Log Ring before it went away.
+    if (runningProcObjPtr->ringPtr != NULL)
+    {
+        DrainRing(runningProcObjPtr);
+        CloseRing(runningProcObjPtr);
+    }
+
     // Remove the process from the PID and IPC Session hash maps.
     le_hashmap_Remove(ProcessIdMapRef, &runningProcObjPtr->pid);
     le_hashmap_Remove(IpcSessionMapRef, &ipcSessionRef);
@@ -1525,7 +2035,8 @@ static void SetForRunningProcess
 (
     RunningProcess_t* runningProcObjPtr,
     const char* componentName,
-    le_log_Level_t* levelPtr                ///< [IN] Ptr log level, or NULL if not being set.
+    le_log_Level_t* levelPtr,               ///< [IN] Ptr log level, or NULL if not being set.
+    const log_RateLimit_t* rateLimitPtr     ///< [IN] Ptr rate limit, or NULL if not being set.
 )
 //--------------------------------------------------------------------------------------------------
 {
@@ -1542,6 +2053,10 @@ static void SetForRunningProcess
             {
                 logSessionObjPtr->level = *levelPtr;
             }
+            if (rateLimitPtr != NULL)
+            {
+                logSessionObjPtr->rateLimit = *rateLimitPtr;
+            }
 
             UpdateClientSessionSettings(runningProcObjPtr, logSessionObjPtr);
 
@@ -1559,6 +2074,10 @@ static void SetForRunningProcess
             {
                 logSessionObjPtr->level = *levelPtr;
             }
+            if (rateLimitPtr != NULL)
+            {
+                logSessionObjPtr->rateLimit = *rateLimitPtr;
+            }
 
             UpdateClientSessionSettings(runningProcObjPtr, logSessionObjPtr);
         }
@@ -1576,6 +2095,7 @@ static void SetByPid
     pid_t pid,
     const char* componentName,
     le_log_Level_t* levelPtr,               ///< [IN] Ptr log level, or NULL if not being set.
+    const log_RateLimit_t* rateLimitPtr,    ///< [IN] Ptr rate limit, or NULL if not being set.
     le_msg_SessionRef_t toolIpcSessionRef   ///< [IN] Reference to log control tool's IPC session.
 )
 //--------------------------------------------------------------------------------------------------
@@ -1591,7 +2111,7 @@ static void SetByPid
     }
     else
     {
-        SetForRunningProcess(runningProcObjPtr, componentName, levelPtr);
+        SetForRunningProcess(runningProcObjPtr, componentName, levelPtr, rateLimitPtr);
     }
 }
 
@@ -1605,7 +2125,8 @@ static void SetByPid
 static void SetForAllProcesses
 (
     const char* componentName,
-    le_log_Level_t* levelPtr                ///< [IN] Ptr log level, or NULL if not being set.
+    le_log_Level_t* levelPtr,               ///< [IN] Ptr log level, or NULL if not being set.
+    const log_RateLimit_t* rateLimitPtr     ///< [IN] Ptr rate limit, or NULL if not being set.
 )
 //--------------------------------------------------------------------------------------------------
 {
@@ -1646,6 +2167,10 @@ static void SetForAllProcesses
                 {
                     compNameObjPtr->level = *levelPtr;
                 }
+                if (rateLimitPtr != NULL)
+                {
+                    compNameObjPtr->rateLimit = *rateLimitPtr;
+                }
 
                 linkPtr = le_dls_PeekNext(&procNameObjPtr->componentNameList, linkPtr);
             }
@@ -1661,6 +2186,10 @@ static void SetForAllProcesses
                 {
                     compNameObjPtr->level = *levelPtr;
                 }
+                if (rateLimitPtr != NULL)
+                {
+                    compNameObjPtr->rateLimit = *rateLimitPtr;
+                }
             }
         }
 
@@ -1670,7 +2199,7 @@ static void SetForAllProcesses
         {
             RunningProcess_t* runningProcObjPtr = CONTAINER_OF(linkPtr, RunningProcess_t, link);
 
-            SetForRunningProcess(runningProcObjPtr, componentName, levelPtr);
+            SetForRunningProcess(runningProcObjPtr, componentName, levelPtr, rateLimitPtr);
 
             linkPtr = le_dls_PeekNext(&procNameObjPtr->runningProcessesList, linkPtr);
         }
@@ -1729,7 +2258,8 @@ static void SetByProcessName
 (
     const char* processName,
     const char* componentName,
-    le_log_Level_t* levelPtr                ///< [IN] Ptr log level, or NULL if not being set.
+    le_log_Level_t* levelPtr,               ///< [IN] Ptr log level, or NULL if not being set.
+    const log_RateLimit_t* rateLimitPtr     ///< [IN] Ptr rate limit, or NULL if not being set.
 )
 //--------------------------------------------------------------------------------------------------
 {
@@ -1766,6 +2296,10 @@ static void SetByProcessName
             {
                 compNameObjPtr->level = *levelPtr;
             }
+            if (rateLimitPtr != NULL)
+            {
+                compNameObjPtr->rateLimit = *rateLimitPtr;
+            }
 
             linkPtr = le_dls_PeekNext(&procNameObjPtr->componentNameList, linkPtr);
         }
@@ -1784,6 +2318,10 @@ static void SetByProcessName
         {
             compNameObjPtr->level = *levelPtr;
         }
+        if (rateLimitPtr != NULL)
+        {
+            compNameObjPtr->rateLimit = *rateLimitPtr;
+        }
     }
 
     // Now update all the actual running processes that share this process name.
@@ -1792,7 +2330,7 @@ static void SetByProcessName
     {
         RunningProcess_t* runningProcObjPtr = CONTAINER_OF(linkPtr, RunningProcess_t, link);
 
-        SetForRunningProcess(runningProcObjPtr, componentName, levelPtr);
+        SetForRunningProcess(runningProcObjPtr, componentName, levelPtr, rateLimitPtr);
 
         linkPtr = le_dls_PeekNext(&procNameObjPtr->runningProcessesList, linkPtr);
     }
@@ -1809,6 +2347,7 @@ static void ApplySettings
     const char* processName,
     const char* componentName,
     le_log_Level_t* levelPtr,               ///< [IN] Ptr log level, or NULL if not being set.
+    const log_RateLimit_t* rateLimitPtr,    ///< [IN] Ptr rate limit, or NULL if not being set.
     le_msg_SessionRef_t toolIpcSessionRef   ///< [IN] Reference to log control tool's IPC session.
 
 )
@@ -1818,18 +2357,18 @@ static void ApplySettings
     pid_t pid = StringToPid(processName);
     if (pid > 0)
     {
-        SetByPid(pid, componentName, levelPtr, toolIpcSessionRef);
+        SetByPid(pid, componentName, levelPtr, rateLimitPtr, toolIpcSessionRef);
     }
     // If the process name is "*",
     else if (strcmp(processName, "*") == 0)
     {
         // This setting applies to ALL PROCESSES.
-        SetForAllProcesses(componentName, levelPtr);
+        SetForAllProcesses(componentName, levelPtr, rateLimitPtr);
     }
     else
     {
         // This setting applies to processes sharing a specific name.
-        SetByProcessName(processName, componentName, levelPtr);
+        SetByProcessName(processName, componentName, levelPtr, rateLimitPtr);
     }
 }
 
@@ -1861,7 +2400,7 @@ static void SetLevel
     }
     else
     {
-        ApplySettings(processName, componentName, &level, toolIpcSessionRef);
+        ApplySettings(processName, componentName, &level, NULL, toolIpcSessionRef);
         snprintf(message,
                  sizeof(message),
                  "Set filtering level for '%s/%s' to '%s'.",
@@ -1873,6 +2412,45 @@ static void SetLevel
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the per-call-site rate limit for a given process/component.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void SetRateLimit
+(
+    const char* processName,
+    const char* componentName,
+    const char* limitStr,
+    le_msg_SessionRef_t toolIpcSessionRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char message[128];
+
+    // Parse the command data payload to get the rate limit setting.
+    log_RateLimit_t limit;
+
+    if (log_StrToRateLimit(limitStr, &limit) != LE_OK)
+    {
+        snprintf(message, sizeof(message), "***ERROR: Invalid rate limit '%s'.", limitStr);
+        LE_WARN("%s", message);
+        SendToLogTool(toolIpcSessionRef, message);
+    }
+    else
+    {
+        ApplySettings(processName, componentName, NULL, &limit, toolIpcSessionRef);
+        snprintf(message,
+                 sizeof(message),
+                 "Set rate limit for '%s/%s' to '%s'.",
+                 processName,
+                 componentName,
+                 limitStr);
+        SendToLogTool(toolIpcSessionRef, message);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets (enables or disables) a trace for a specific component name.
@@ -2238,13 +2816,14 @@ static void SendTraceNameToLogTool
 //--------------------------------------------------------------------------------------------------
 /**
  * Sends a message to the log tool containing a printable, null-terminated, UTF-8 string containing
- * the name of a component and its associated log level.
+ * the name of a component and its associated log level and rate limit (if set).
  **/
 //--------------------------------------------------------------------------------------------------
 static void SendComponentInfoToLogTool
 (
     const char* componentName,
     le_log_Level_t level,
+    const log_RateLimit_t* rateLimitPtr,
     le_msg_SessionRef_t ipcSessionRef
 )
 //--------------------------------------------------------------------------------------------------
@@ -2253,11 +2832,19 @@ static void SendComponentInfoToLogTool
 
     char* payloadPtr = le_msg_GetPayloadPtr(msgRef);
 
+    char limitStr[32] = "";
+    if (rateLimitPtr->rate != RATE_LIMIT_NOT_SET)
+    {
+        GetRateLimitString(rateLimitPtr, limitStr, sizeof(limitStr));
+    }
+
     snprintf(payloadPtr,
              le_msg_GetMaxPayloadSize(msgRef),
-             "      /%s @ %s",
+             "      /%s @ %s%s%s",
              componentName,
-             GetLevelString(level));
+             GetLevelString(level),
+             (limitStr[0] != '\0') ? ", limit " : "",
+             limitStr);
 
     le_msg_Send(msgRef);
 }
@@ -2279,6 +2866,7 @@ static void GenerateComponentList
 {
     SendComponentInfoToLogTool(compNameObjPtr->name,
                                compNameObjPtr->level,
+                               &compNameObjPtr->rateLimit,
                                ipcSessionRef);
 
     le_dls_Link_t* linkPtr = le_dls_Peek(&compNameObjPtr->enabledTracesList);
@@ -2308,6 +2896,7 @@ static void GenerateLogSessionList
 {
     SendComponentInfoToLogTool(logSessionObjPtr->componentName,
                                logSessionObjPtr->level,
+                               &logSessionObjPtr->rateLimit,
                                ipcSessionRef);
 
     le_dls_Link_t* linkPtr = le_dls_Peek(&logSessionObjPtr->traceList);
@@ -2458,6 +3047,41 @@ static void ForgetProcess
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves everything waiting in the processes' Log Rings and in memory out to the log files, and
+ * then tells the log control tool where the log files are, so that it can read them.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void FlushStore
+(
+    le_msg_SessionRef_t toolIpcSessionRef   ///< [IN] Log control tool's current IPC session.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsStoring)
+    {
+        SendToLogTool(toolIpcSessionRef, "***ERROR: Persistent log storage is off.");
+        return;
+    }
+
+    le_hashmap_It_Ref_t iteratorRef = le_hashmap_GetIterator(ProcessIdMapRef);
+    while (le_hashmap_NextNode(iteratorRef) == LE_OK)
+    {
+        RunningProcess_t* runningProcObjPtr = (RunningProcess_t*)le_hashmap_GetValue(iteratorRef);
+
+        if (runningProcObjPtr->ringPtr != NULL)
+        {
+            DrainRing(runningProcObjPtr);
+        }
+    }
+
+    logStore_Flush();
+
+    SendToLogTool(toolIpcSessionRef, StoreDirPath);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Process a message received from a connected log session client.
@@ -2491,11 +3115,19 @@ static void ClientMsgReceiveHandler
 
                 return;
 
+            case LOG_CMD_OPEN_RING:
+
+                OpenRing(msgRef);
+
+                return;
+
             case LOG_CMD_SET_LEVEL:
             case LOG_CMD_ENABLE_TRACE:
             case LOG_CMD_DISABLE_TRACE:
+            case LOG_CMD_SET_RATE_LIMIT:
             case LOG_CMD_LIST_COMPONENTS:
             case LOG_CMD_FORGET_PROCESS:
+            case LOG_CMD_FLUSH_STORE:
 
                 LE_ERROR("Client attempted to issue a log control command (%c)!", command);
 
@@ -2565,7 +3197,20 @@ static void ControlToolMsgReceiveHandler
 
                 break;
 
+            case LOG_CMD_SET_RATE_LIMIT:
+
+                SetRateLimit(processName, componentName, commandDataPtr, ipcSessionRef);
+
+                break;
+
+            case LOG_CMD_FLUSH_STORE:
+
+                FlushStore(ipcSessionRef);
+
+                break;
+
             case LOG_CMD_REG_COMPONENT:
+            case LOG_CMD_OPEN_RING:
 
                 LE_ERROR("Unexpected command '%c' from log control tool.", command);
 
@@ -2634,14 +3279,14 @@ static void LogFdMessages
 
     if (events & POLLIN)
     {
-        // Read the data from the fd.
+        // Read the data from the fd, leaving room for a terminator.
         char msg[MAX_MSG_SIZE] = {'\0'};
 
         int c;
 
         do
         {
-            c = read(fd, msg, sizeof(msg));
+            c = read(fd, msg, sizeof(msg) - 1);
         }
         while ( (c == -1) && (errno == EINTR) );
 
@@ -2656,7 +3301,26 @@ static void LogFdMessages
         // Log the data.
         // TODO: Don't log the app name for now so that it matches all the other log formats.  Add
         //       the app name to all log messages at the same time.
-        log_LogGenericMsg(fdLogPtr->level, fdLogPtr->procName, fdLogPtr->pid, msg);
+        if (IsStoring)
+        {
+            logStore_Record_t record = { .timestamp = time(NULL),
+                                         .pid = fdLogPtr->pid,
+                                         .level = fdLogPtr->level,
+                                         .lineNumber = 0,
+                                         .levelStrPtr = log_GetSeverityStr(fdLogPtr->level),
+                                         .procNamePtr = fdLogPtr->procName,
+                                         .compNamePtr = "",
+                                         .threadNamePtr = "",
+                                         .fileNamePtr = "",
+                                         .funcNamePtr = "",
+                                         .msgPtr = msg };
+
+            logStore_Append(&record);
+        }
+        else
+        {
+            log_LogGenericMsg(fdLogPtr->level, fdLogPtr->procName, fdLogPtr->pid, msg);
+        }
     }
 
     if ( (events & POLLRDHUP) || (events & POLLERR) || (events & POLLHUP) )
@@ -2702,6 +3366,7 @@ static void CreateFdLogMonitor
 
     // Create the fd monitor.
     fdLogPtr->monitorRef = le_fdMonitor_Create(monitorNamePtr, fd, LogFdMessages, 0);
+    le_fdMonitor_SetDirectDispatch(fdLogPtr->monitorRef, true);
 
     // Set the fd monitor context.
     le_fdMonitor_SetContextPtr(fdLogPtr->monitorRef, fdLogPtr);
@@ -2796,6 +3461,7 @@ COMPONENT_INIT
     // Create the memory pools.
     ProcessNamePoolRef = le_mem_CreatePool("ProcessName", sizeof(ProcessName_t));
     ComponentNamePoolRef = le_mem_CreatePool("ComponentName", sizeof(ComponentName_t));
+    NamePoolRef = le_mem_CreateVarPool("Names", MAX_NAME_BYTES);
     TraceNamePoolRef = le_mem_CreatePool("TraceName", sizeof(TraceName_t));
     RunningProcessPoolRef = le_mem_CreatePool("RunningProcess", sizeof(RunningProcess_t));
     LogSessionPoolRef = le_mem_CreatePool("LogSession", sizeof(LogSession_t));
@@ -2813,18 +3479,34 @@ COMPONENT_INIT
     le_mem_ExpandPool(FdLogPoolRef, MAX_EXPECTED_PROCESSES * 2); // Generally 2 fds per process (stderr, stdout).
 
     // Create the hash maps.
-    ProcessNameMapRef = le_hashmap_Create("ProcessName",
-                                          MAX_EXPECTED_PROCESSES,
-                                          le_hashmap_HashString,
-                                          le_hashmap_EqualsString);
-    IpcSessionMapRef  = le_hashmap_Create("IPCSession",
-                                          MAX_EXPECTED_PROCESSES,
-                                          IpcSessionHash,
-                                          IpcSessionEquals);
-    ProcessIdMapRef   = le_hashmap_Create("ProcessID",
-                                          MAX_EXPECTED_PROCESSES,
-                                          ProcessIdHash,
-                                          ProcessIdEquals);
+    ProcessNameMapRef = le_hashmap_CreateResizable("ProcessName",
+                                                   MAX_EXPECTED_PROCESSES,
+                                                   le_hashmap_HashString,
+                                                   le_hashmap_EqualsString);
+    IpcSessionMapRef  = le_hashmap_CreateResizable("IPCSession",
+                                                   MAX_EXPECTED_PROCESSES,
+                                                   IpcSessionHash,
+                                                   IpcSessionEquals);
+    ProcessIdMapRef   = le_hashmap_CreateResizable("ProcessID",
+                                                   MAX_EXPECTED_PROCESSES,
+                                                   ProcessIdHash,
+                                                   ProcessIdEquals);
+
+    // Turn on persistent log storage, if asked for in the environment.
+    const char* storeDirPtr = getenv("LE_LOG_STORE");
+    if ((storeDirPtr != NULL) && (storeDirPtr[0] != '\0'))
+    {
+        if (   (le_utf8_Copy(StoreDirPath, storeDirPtr, sizeof(StoreDirPath), NULL) == LE_OK)
+            && (logStore_Open(StoreDirPath) == LE_OK) )
+        {
+            IsStoring = true;
+            LE_INFO("Storing log messages in '%s'.", StoreDirPath);
+        }
+        else
+        {
+            LE_ERROR("Persistent log storage is off.");
+        }
+    }
 
     // Get a reference to the Log Control Protocol identification.
     le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(LOG_CONTROL_PROTOCOL_ID,
@@ -25,6 +25,13 @@
  *
  * @todo Change to use shared memory to control log sessions instead.
  *
+ * If the Log Control Daemon has persistent log storage turned on (see logStore.h), a log client
+ * can also ask it for a shared memory Log Ring by sending an "Open Ring" request carrying an
+ * eventfd.  The Log Control Daemon responds with a sealed memfd holding the ring (or with no fd
+ * if log storage is off).  From then on the client writes its log messages into that ring
+ * instead of sending them to syslog, and writes to the eventfd to wake the Log Control Daemon
+ * when the daemon has said it is waiting for more.  See logShm_RingHeader_t.
+ *
  * Log tools connect and send in a log control command.  The Log Control Daemon responds
  * by sending printable strings to the log control tool.  The log control tool simply prints
  * these strings to stdout when it receives them.  The Log Control Daemon closes the IPC
@@ -86,6 +93,7 @@
 #define LOG_CMD_SET_LEVEL               'l' // CommandData = level string (see below)
 #define LOG_CMD_ENABLE_TRACE            'e' // CommandData = keyword string
 #define LOG_CMD_DISABLE_TRACE           'd' // CommandData = keyword string
+#define LOG_CMD_SET_RATE_LIMIT          'q' // CommandData = rate limit string (see below)
 
 
 //--------------------------------------------------------------------------------------------------
@@ -94,6 +102,7 @@
  */
 //--------------------------------------------------------------------------------------------------
 #define LOG_CMD_REG_COMPONENT           'r' // CommandData = string containing the process ID.
+#define LOG_CMD_OPEN_RING               'm' // No ProcessName, ComponentName, or CommandData
 
 
 //--------------------------------------------------------------------------------------------------
@@ -103,6 +112,7 @@
 //--------------------------------------------------------------------------------------------------
 #define LOG_CMD_LIST_COMPONENTS         'c' // No ProcessName, ComponentName, or CommandData
 #define LOG_CMD_FORGET_PROCESS          'x' // No ComponentName or CommandData
+#define LOG_CMD_FLUSH_STORE             'f' // No ProcessName, ComponentName, or CommandData
 
 
 // =======================================================
@@ -117,6 +127,14 @@
 #define LOG_SET_LEVEL_DEBUG_STR "DEBUG"
 
 
+// ===================================================================
+//  RATE LIMITS (CommandData part of SET_RATE_LIMIT commands)
+// ===================================================================
+
+// Either "RATE,BURST" (decimal numbers of messages, see log_RateLimit_t) or this string.
+#define LOG_RATE_LIMIT_OFF_STR  "off"
+
+
 // =========================================================================
 //  LOG OUTPUT LOCATION NAMES (CommandData part of SET_OUTPUT_LOC commands)
 // =========================================================================
@@ -125,4 +143,85 @@
 #define LOG_OUTPUT_LOC_SYSLOG_STR "syslog"
 
 
+// =========================================================================
+//  SHARED MEMORY LOG RING
+// =========================================================================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of the magic number at the start of a Log Ring.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_SHM_RING_MAGIC              0x4C524E47
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of a Log Ring's shared memory.  The ring's data area follows it.
+ *
+ * The ring has a single producer (the client process, which serializes its own threads) and a
+ * single consumer (the Log Control Daemon).  head and tail are free-running byte counts (they
+ * are only reduced modulo dataSize when used as offsets), so the ring is empty when they are
+ * equal.  The producer advances head (release) after writing a record and the consumer advances
+ * tail (release) after reading one.
+ *
+ * Before the consumer goes idle, it sets consumerWaiting.  A producer that finds it set after
+ * writing a record clears it and writes to the ring's eventfd.
+ *
+ * The client can write anything at all into the ring, so the Log Control Daemon copies each
+ * record out before checking it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    magic;              ///< LOG_SHM_RING_MAGIC.  Set by the Log Control Daemon.
+    uint32_t    dataSize;           ///< Size of the data area (a power of two).  Set by the daemon.
+    uint32_t    head;               ///< Bytes ever written.  Written by the client.
+    uint32_t    tail;               ///< Bytes ever read.  Written by the Log Control Daemon.
+    uint32_t    droppedCount;       ///< Messages dropped because the ring was full.  Written by
+                                    ///  the client.
+    uint32_t    consumerWaiting;    ///< 1 = the Log Control Daemon wants a wake-up.
+    uint8_t     reserved[40];       ///< Pads the header out to 64 bytes.
+}
+logShm_RingHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Types of records in a Log Ring.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_SHM_RECORD_MSG              1   ///< A log message.
+#define LOG_SHM_RECORD_PAD              2   ///< Skips the rest of the data area (wraps around).
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of a record in a Log Ring.  Records start on 8-byte boundaries and never wrap around
+ * the end of the data area.  A log message record's header is followed by six NUL-terminated
+ * strings: the severity level string (or trace keyword), component name, thread name, source
+ * file name, function name and message.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    size;           ///< Size of the record, including this header and padding.
+    uint8_t     type;           ///< LOG_SHM_RECORD_MSG or LOG_SHM_RECORD_PAD.
+    int8_t      level;          ///< le_log_Level_t, or -1 for a trace.
+    uint16_t    reserved;
+    uint32_t    lineNumber;     ///< Line number in the source file.
+    uint32_t    reserved2;
+    int64_t     timestamp;      ///< Time the message was logged (seconds since the Epoch).
+}
+logShm_RecordHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest record that may be written into a Log Ring, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_SHM_MAX_RECORD_BYTES        1024
+
+
 #endif // LOG_DAEMON_INCLUDE_GUARD
@@ -0,0 +1,1380 @@
+/** @file logStore.c
+ *
+ * Implementation of persistent log storage.  See logStore.h for an overview and the file format.
+ *
+ * Blocks are compressed with a small LZ77 coder that suits the repetitive text of log messages
+ * (the same process, component, file and function names over and over) without needing an
+ * external compression library.  The compressed data is a series of sequences, each of which is:
+ *
+ * @verbatim
+    token | [literal length bytes] | literals | offset | [match length bytes]
+@endverbatim
+ *
+ * The token's upper four bits are the number of literals and its lower four bits are the match
+ * length minus MIN_MATCH.  A value of 15 in either means more length bytes follow, each adding
+ * its value, until one that is less than 255.  The match is a copy of the bytes found "offset"
+ * bytes back in the uncompressed data; the offset is two bytes, little endian.  The last sequence
+ * ends after its literals.
+ *
+ * The writer (the Log Control Daemon) and the reader (the log tool) are never in the same
+ * process, so the reader borrows the writer's buffers.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "logStore.h"
+#include "../limit.h"
+#include "../fileDescriptor.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size at which the current log file is rotated out, in bytes.
+ *
+ * @todo Make this configurable.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FILE_ROTATE_BYTES       (256 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of log files kept, including the current one.
+ *
+ * @todo Make this configurable.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FILE_COUNT              4
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Longest time a message waits in memory before its block is written out, in seconds.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FLUSH_INTERVAL_SECS     5
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Most log files that the reader will look for.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_READ_FILES          1000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Longest source file name or function name stored, including the terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_SOURCE_NAME_BYTES   128
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Longest message stored, including the terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_MSG_BYTES           512
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest record, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_RECORD_BYTES        (  sizeof(logStore_RecordHeader_t)      \
+                                 + LIMIT_MAX_LOG_KEYWORD_BYTES          \
+                                 + LIMIT_MAX_PROCESS_NAME_BYTES         \
+                                 + LIMIT_MAX_COMPONENT_NAME_BYTES       \
+                                 + LIMIT_MAX_THREAD_NAME_BYTES          \
+                                 + (2 * MAX_SOURCE_NAME_BYTES)          \
+                                 + MAX_MSG_BYTES )
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of strings following each record header.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RECORD_STRING_COUNT     7
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Shortest match the compressor looks for.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MIN_MATCH               4
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bits in the compressor's hash table index.
+ */
+//--------------------------------------------------------------------------------------------------
+#define HASH_BITS               12
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Most bytes that compressing a given number of bytes can produce.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_COMPRESSED_BYTES(n) ((n) + ((n) / 255) + 16)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path of the directory the log files are written to.
+ */
+//--------------------------------------------------------------------------------------------------
+static char DirPath[LIMIT_MAX_PATH_BYTES];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Current log file, or -1 if it couldn't be opened.
+ */
+//--------------------------------------------------------------------------------------------------
+static int FileFd = -1;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the current log file.
+ */
+//--------------------------------------------------------------------------------------------------
+static off_t FileSize;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Uncompressed data of the block being built up.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t BlockBuff[LOG_STORE_BLOCK_BYTES];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes used in BlockBuff.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t BlockUsed;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index information for the block being built up.
+ */
+//--------------------------------------------------------------------------------------------------
+static logStore_BlockHeader_t BlockIndex;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Block header and compressed data, ready to be written out.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t OutBuff[  sizeof(logStore_BlockHeader_t)
+                       + MAX_COMPRESSED_BYTES(LOG_STORE_BLOCK_BYTES)];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer that writes out a block that has been waiting too long.  NULL if log storage hasn't been
+ * started.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t FlushTimerRef = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Table used to compute CRC-32s.  Filled in on first use.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t CrcTable[256];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the CRC-32 (IEEE 802.3) of some data, continuing from a previous CRC.
+ *
+ * @return The new CRC.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t Crc32
+(
+    uint32_t crc,               ///< [IN] CRC of the data so far (0 to start).
+    const void* dataPtr,        ///< [IN] Data.
+    size_t len                  ///< [IN] Number of bytes of data.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const uint8_t* bytePtr = dataPtr;
+
+    if (CrcTable[1] == 0)
+    {
+        uint32_t i;
+        for (i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            int bit;
+            for (bit = 0; bit < 8; bit++)
+            {
+                c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+            }
+            CrcTable[i] = c;
+        }
+    }
+
+    crc = ~crc;
+    while (len-- > 0)
+    {
+        crc = CrcTable[(crc ^ *bytePtr++) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the two bits that a name sets in a block's name Bloom filter.  Process names and
+ * component names are hashed differently, so that they don't match each other.
+ *
+ * @return The Bloom filter bits.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetBloomBits
+(
+    char kind,                  ///< [IN] 'p' for a process name, 'c' for a component name.
+    const char* namePtr         ///< [IN] The name.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // FNV-1a.  This is part of the file format, so it must never change.
+    uint32_t hash = 2166136261U;
+
+    hash = (hash ^ (uint8_t)kind) * 16777619U;
+    while (*namePtr != '\0')
+    {
+        hash = (hash ^ (uint8_t)*namePtr++) * 16777619U;
+    }
+
+    return (((uint64_t)1) << (hash & 63)) | (((uint64_t)1) << ((hash >> 6) & 63));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the bit that a severity level sets in a block's level mask.
+ *
+ * @return The level mask bit.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint8_t GetLevelBit
+(
+    le_log_Level_t level        ///< [IN] Severity level (-1 if this is a trace).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (level == (le_log_Level_t)-1)
+    {
+        return LOG_STORE_TRACE_BIT;
+    }
+
+    return (uint8_t)(1 << level);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a 32-bit value from a possibly unaligned address.
+ *
+ * @return The value.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint32_t Read32
+(
+    const uint8_t* ptr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t value;
+
+    memcpy(&value, ptr, sizeof(value));
+
+    return value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes the extra bytes of a literal or match length that didn't fit in a token.
+ *
+ * @return Pointer to the byte following the length bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t* PutLength
+(
+    uint8_t* outPtr,            ///< [OUT] Where to write the length bytes.
+    size_t len                  ///< [IN] Length, less the 15 that the token holds.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while (len >= 255)
+    {
+        *outPtr++ = 255;
+        len -= 255;
+    }
+    *outPtr++ = (uint8_t)len;
+
+    return outPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a sequence of compressed data.
+ *
+ * @return Pointer to the byte following the sequence.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t* PutSequence
+(
+    uint8_t* outPtr,            ///< [OUT] Where to write the sequence.
+    const uint8_t* litPtr,      ///< [IN] The literals.
+    size_t litLen,              ///< [IN] Number of literals.
+    size_t offset,              ///< [IN] Match offset, or 0 if this is the last sequence.
+    size_t matchLen             ///< [IN] Match length (ignored if this is the last sequence).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t matchCode = (offset == 0) ? 0 : (matchLen - MIN_MATCH);
+
+    *outPtr++ = (uint8_t)(((litLen < 15 ? litLen : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+
+    if (litLen >= 15)
+    {
+        outPtr = PutLength(outPtr, litLen - 15);
+    }
+
+    memcpy(outPtr, litPtr, litLen);
+    outPtr += litLen;
+
+    if (offset != 0)
+    {
+        *outPtr++ = (uint8_t)(offset & 0xFF);
+        *outPtr++ = (uint8_t)(offset >> 8);
+
+        if (matchCode >= 15)
+        {
+            outPtr = PutLength(outPtr, matchCode - 15);
+        }
+    }
+
+    return outPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compresses some data.  The output buffer must hold at least MAX_COMPRESSED_BYTES(srcLen) bytes.
+ * At most 64 KB of data can be compressed at once.
+ *
+ * @return Number of bytes of compressed data.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t Compress
+(
+    const uint8_t* srcPtr,      ///< [IN] Data to compress.
+    size_t srcLen,              ///< [IN] Number of bytes of data.
+    uint8_t* destPtr            ///< [OUT] Where to write the compressed data.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Position + 1 of the last place each hashed 4-byte sequence was seen (0 = not seen).
+    static uint32_t hashTable[1 << HASH_BITS];
+
+    uint8_t* outPtr = destPtr;
+    size_t pos = 0;
+    size_t anchor = 0;
+
+    memset(hashTable, 0, sizeof(hashTable));
+
+    while (pos + MIN_MATCH <= srcLen)
+    {
+        uint32_t sequence = Read32(srcPtr + pos);
+        uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+        size_t candidate = hashTable[hash];
+
+        hashTable[hash] = pos + 1;
+
+        if ((candidate != 0) && (Read32(srcPtr + candidate - 1) == sequence))
+        {
+            size_t matchPos = candidate - 1;
+            size_t matchLen = MIN_MATCH;
+
+            while (   (pos + matchLen < srcLen)
+                   && (srcPtr[matchPos + matchLen] == srcPtr[pos + matchLen]))
+            {
+                matchLen++;
+            }
+
+            outPtr = PutSequence(outPtr, srcPtr + anchor, pos - anchor, pos - matchPos, matchLen);
+
+            pos += matchLen;
+            anchor = pos;
+        }
+        else
+        {
+            pos++;
+        }
+    }
+
+    outPtr = PutSequence(outPtr, srcPtr + anchor, srcLen - anchor, 0, 0);
+
+    return outPtr - destPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the extra bytes of a literal or match length from compressed data.
+ *
+ * @return true if successful, false if the data ran out.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetLength
+(
+    const uint8_t* srcPtr,      ///< [IN] Compressed data.
+    size_t srcLen,              ///< [IN] Number of bytes of compressed data.
+    size_t* posPtr,             ///< [IN/OUT] Position in the compressed data.
+    size_t* lenPtr              ///< [IN/OUT] Length to add to.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint8_t byte;
+
+    do
+    {
+        if ((*posPtr >= srcLen) || (*lenPtr > LOG_STORE_BLOCK_BYTES))
+        {
+            return false;
+        }
+
+        byte = srcPtr[(*posPtr)++];
+        *lenPtr += byte;
+    }
+    while (byte == 255);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decompresses some data, checking that it is well formed.
+ *
+ * @return true if successful, false if the data is damaged or doesn't decompress to exactly
+ *         destLen bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool Decompress
+(
+    const uint8_t* srcPtr,      ///< [IN] Compressed data.
+    size_t srcLen,              ///< [IN] Number of bytes of compressed data.
+    uint8_t* destPtr,           ///< [OUT] Where to write the uncompressed data.
+    size_t destLen              ///< [IN] Expected number of bytes of uncompressed data.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t inPos = 0;
+    size_t outPos = 0;
+
+    for (;;)
+    {
+        if (inPos >= srcLen)
+        {
+            return false;
+        }
+
+        uint8_t token = srcPtr[inPos++];
+
+        size_t litLen = token >> 4;
+        if ((litLen == 15) && !GetLength(srcPtr, srcLen, &inPos, &litLen))
+        {
+            return false;
+        }
+
+        if ((litLen > srcLen - inPos) || (litLen > destLen - outPos))
+        {
+            return false;
+        }
+
+        memcpy(destPtr + outPos, srcPtr + inPos, litLen);
+        inPos += litLen;
+        outPos += litLen;
+
+        // The last sequence has no match.
+        if (inPos == srcLen)
+        {
+            return (outPos == destLen);
+        }
+
+        if (srcLen - inPos < 2)
+        {
+            return false;
+        }
+
+        size_t offset = srcPtr[inPos] | (srcPtr[inPos + 1] << 8);
+        inPos += 2;
+
+        size_t matchLen = token & 0x0F;
+        if ((matchLen == 15) && !GetLength(srcPtr, srcLen, &inPos, &matchLen))
+        {
+            return false;
+        }
+        matchLen += MIN_MATCH;
+
+        if ((offset == 0) || (offset > outPos) || (matchLen > destLen - outPos))
+        {
+            return false;
+        }
+
+        // The match may overlap the bytes it produces, so copy one byte at a time.
+        const uint8_t* matchPtr = destPtr + outPos - offset;
+        while (matchLen-- > 0)
+        {
+            destPtr[outPos++] = *matchPtr++;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the path of one of the log files.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetFilePath
+(
+    const char* dirPathPtr,     ///< [IN] Directory holding the log files.
+    unsigned int index,         ///< [IN] 0 for the current file, 1 for the one before it, etc.
+    char* pathPtr               ///< [OUT] Buffer of LIMIT_MAX_PATH_BYTES bytes for the path.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(snprintf(pathPtr, LIMIT_MAX_PATH_BYTES, "%s/log.%u", dirPathPtr, index)
+              < LIMIT_MAX_PATH_BYTES);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads from a given position in a file.
+ *
+ * @return true if all the bytes were read, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadAt
+(
+    int fd,                     ///< [IN] File to read.
+    void* buffPtr,              ///< [OUT] Where to put the bytes.
+    size_t len,                 ///< [IN] Number of bytes to read.
+    off_t offset                ///< [IN] Where to read from.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint8_t* bytePtr = buffPtr;
+
+    while (len > 0)
+    {
+        ssize_t result = pread(fd, bytePtr, len, offset);
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        if (result == 0)
+        {
+            return false;
+        }
+
+        bytePtr += result;
+        len -= result;
+        offset += result;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes all of a buffer to a file.
+ *
+ * @return true if successful, false otherwise (errno is set).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool WriteAll
+(
+    int fd,                     ///< [IN] File to write.
+    const void* buffPtr,        ///< [IN] Bytes to write.
+    size_t len                  ///< [IN] Number of bytes to write.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const uint8_t* bytePtr = buffPtr;
+
+    while (len > 0)
+    {
+        ssize_t result = write(fd, bytePtr, len);
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        bytePtr += result;
+        len -= result;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads and checks a log file's header.
+ *
+ * @return true if the file has a good header, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadFileHeader
+(
+    int fd                      ///< [IN] The log file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    logStore_FileHeader_t header;
+
+    return (   ReadAt(fd, &header, sizeof(header), 0)
+            && (header.magic == LOG_STORE_FILE_MAGIC)
+            && (header.version == LOG_STORE_VERSION) );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads and checks the header of a block.
+ *
+ * @return true if there is a block with a sane header at the given position, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadBlockHeader
+(
+    int fd,                             ///< [IN] The log file.
+    off_t offset,                       ///< [IN] Position of the block in the file.
+    off_t fileSize,                     ///< [IN] Size of the file.
+    logStore_BlockHeader_t* headerPtr   ///< [OUT] The block header.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (offset + (off_t)sizeof(*headerPtr) > fileSize)
+    {
+        return false;
+    }
+
+    return (   ReadAt(fd, headerPtr, sizeof(*headerPtr), offset)
+            && (headerPtr->magic == LOG_STORE_BLOCK_MAGIC)
+            && (headerPtr->rawSize <= LOG_STORE_BLOCK_BYTES)
+            && (headerPtr->compressedSize <= MAX_COMPRESSED_BYTES(LOG_STORE_BLOCK_BYTES))
+            && (offset + (off_t)sizeof(*headerPtr) + headerPtr->compressedSize <= fileSize) );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a block's compressed data and checks the block's CRC.
+ *
+ * @return true if the block is intact, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadBlockData
+(
+    int fd,                                 ///< [IN] The log file.
+    off_t offset,                           ///< [IN] Position of the block in the file.
+    const logStore_BlockHeader_t* headerPtr,///< [IN] The block header.
+    uint8_t* buffPtr                        ///< [OUT] Where to put the compressed data.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!ReadAt(fd, buffPtr, headerPtr->compressedSize, offset + sizeof(*headerPtr)))
+    {
+        return false;
+    }
+
+    logStore_BlockHeader_t header = *headerPtr;
+    header.crc = 0;
+
+    uint32_t crc = Crc32(0, &header, sizeof(header));
+    crc = Crc32(crc, buffPtr, headerPtr->compressedSize);
+
+    return (crc == headerPtr->crc);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a new, empty current log file, replacing any existing one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CreateFile
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+    GetFilePath(DirPath, 0, path);
+
+    do
+    {
+        FileFd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP);
+    }
+    while ((FileFd == -1) && (errno == EINTR));
+
+    if (FileFd == -1)
+    {
+        LE_ERROR("Failed to create log file '%s' (%m).", path);
+        return;
+    }
+
+    logStore_FileHeader_t header = { .magic = LOG_STORE_FILE_MAGIC,
+                                     .version = LOG_STORE_VERSION,
+                                     .blockBytes = LOG_STORE_BLOCK_BYTES };
+
+    if (!WriteAll(FileFd, &header, sizeof(header)))
+    {
+        LE_ERROR("Failed to write log file '%s' (%m).", path);
+        fd_Close(FileFd);
+        FileFd = -1;
+        return;
+    }
+
+    FileSize = sizeof(header);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens the current log file to add to it.  If it ends with a damaged block, the damaged block
+ * is cut off.  If the file doesn't exist or is unusable, a new one is created.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OpenFile
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+    GetFilePath(DirPath, 0, path);
+
+    int fd;
+    do
+    {
+        fd = open(path, O_RDWR | O_CLOEXEC);
+    }
+    while ((fd == -1) && (errno == EINTR));
+
+    struct stat st;
+    if ((fd == -1) || (fstat(fd, &st) != 0) || !ReadFileHeader(fd))
+    {
+        if (fd != -1)
+        {
+            LE_WARN("Log file '%s' is damaged. Replacing it.", path);
+            fd_Close(fd);
+        }
+
+        CreateFile();
+        return;
+    }
+
+    // Find the end of the last good block.
+    off_t offset = sizeof(logStore_FileHeader_t);
+    logStore_BlockHeader_t header;
+
+    while (   ReadBlockHeader(fd, offset, st.st_size, &header)
+           && ReadBlockData(fd, offset, &header, OutBuff) )
+    {
+        offset += sizeof(header) + header.compressedSize;
+    }
+
+    if (offset < st.st_size)
+    {
+        LE_WARN("Discarding %lld damaged bytes at the end of log file '%s'.",
+                (long long)(st.st_size - offset),
+                path);
+
+        if (ftruncate(fd, offset) != 0)
+        {
+            LE_ERROR("Failed to truncate log file '%s' (%m).", path);
+        }
+    }
+
+    if (lseek(fd, offset, SEEK_SET) != offset)
+    {
+        LE_ERROR("Failed to seek in log file '%s' (%m).", path);
+        fd_Close(fd);
+        CreateFile();
+        return;
+    }
+
+    FileFd = fd;
+    FileSize = offset;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rotates the log files: the oldest one is deleted, the others are each renamed to the next
+ * older name, and a new current file is created.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RotateFiles
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char oldPath[LIMIT_MAX_PATH_BYTES];
+    char newPath[LIMIT_MAX_PATH_BYTES];
+    unsigned int i;
+
+    if (FileFd != -1)
+    {
+        fd_Close(FileFd);
+        FileFd = -1;
+    }
+
+    GetFilePath(DirPath, FILE_COUNT - 1, oldPath);
+    if ((unlink(oldPath) != 0) && (errno != ENOENT))
+    {
+        LE_WARN("Failed to delete log file '%s' (%m).", oldPath);
+    }
+
+    for (i = FILE_COUNT - 1; i > 0; i--)
+    {
+        GetFilePath(DirPath, i - 1, oldPath);
+        GetFilePath(DirPath, i, newPath);
+
+        if ((rename(oldPath, newPath) != 0) && (errno != ENOENT))
+        {
+            LE_WARN("Failed to rename log file '%s' (%m).", oldPath);
+        }
+    }
+
+    CreateFile();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes out the block being built up when it has waited long enough.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushTimerExpired
+(
+    le_timer_Ref_t timerRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    logStore_Flush();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies a string into a record, truncating it if necessary.
+ *
+ * @return Pointer to the byte following the copied string's terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t* CopyString
+(
+    uint8_t* destPtr,           ///< [OUT] Where to copy the string to.
+    const char* strPtr,         ///< [IN] The string.
+    size_t maxBytes             ///< [IN] Most bytes to use, including the terminator.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t len = strnlen(strPtr, maxBytes - 1);
+
+    memcpy(destPtr, strPtr, len);
+    destPtr[len] = '\0';
+
+    return destPtr + len + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts storing log messages in a given directory, creating it if necessary.  If the current
+ * log file ends with a damaged block, that block is discarded.  Must be called at most once, by
+ * the Log Control Daemon.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_FAULT if the directory or the current log file couldn't be opened or created.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t logStore_Open
+(
+    const char* dirPathPtr          ///< [IN] Path of the directory to keep the log files in.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(FlushTimerRef == NULL);
+
+    if (le_utf8_Copy(DirPath, dirPathPtr, sizeof(DirPath), NULL) != LE_OK)
+    {
+        LE_ERROR("Log storage directory path '%s' is too long.", dirPathPtr);
+        return LE_FAULT;
+    }
+
+    if (le_dir_MakePath(DirPath, S_IRWXU | S_IRGRP | S_IXGRP) != LE_OK)
+    {
+        LE_ERROR("Failed to create log storage directory '%s'.", DirPath);
+        return LE_FAULT;
+    }
+
+    OpenFile();
+    if (FileFd == -1)
+    {
+        return LE_FAULT;
+    }
+
+    FlushTimerRef = le_timer_Create("LogStoreFlush");
+    le_clk_Time_t interval = { .sec = FLUSH_INTERVAL_SECS, .usec = 0 };
+    LE_ASSERT(le_timer_SetInterval(FlushTimerRef, interval) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(FlushTimerRef, FlushTimerExpired) == LE_OK);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds a log message to the block being built up, writing the block out first if the message
+ * doesn't fit.  Strings that are too long are truncated.
+ */
+//--------------------------------------------------------------------------------------------------
+void logStore_Append
+(
+    const logStore_Record_t* recordPtr  ///< [IN] The log message.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(FlushTimerRef != NULL);
+
+    uint8_t record[MAX_RECORD_BYTES];
+
+    logStore_RecordHeader_t header = { .timestamp = recordPtr->timestamp,
+                                       .pid = recordPtr->pid,
+                                       .lineNumber = recordPtr->lineNumber,
+                                       .level = (int8_t)recordPtr->level };
+    memcpy(record, &header, sizeof(header));
+
+    uint8_t* endPtr = record + sizeof(header);
+    endPtr = CopyString(endPtr, recordPtr->levelStrPtr, LIMIT_MAX_LOG_KEYWORD_BYTES);
+    endPtr = CopyString(endPtr, recordPtr->procNamePtr, LIMIT_MAX_PROCESS_NAME_BYTES);
+    endPtr = CopyString(endPtr, recordPtr->compNamePtr, LIMIT_MAX_COMPONENT_NAME_BYTES);
+    endPtr = CopyString(endPtr, recordPtr->threadNamePtr, LIMIT_MAX_THREAD_NAME_BYTES);
+    endPtr = CopyString(endPtr, recordPtr->fileNamePtr, MAX_SOURCE_NAME_BYTES);
+    endPtr = CopyString(endPtr, recordPtr->funcNamePtr, MAX_SOURCE_NAME_BYTES);
+    endPtr = CopyString(endPtr, recordPtr->msgPtr, MAX_MSG_BYTES);
+
+    size_t recordSize = endPtr - record;
+
+    if (BlockUsed + recordSize > sizeof(BlockBuff))
+    {
+        logStore_Flush();
+    }
+
+    memcpy(BlockBuff + BlockUsed, record, recordSize);
+    BlockUsed += recordSize;
+
+    // Update the block's index information.
+    if (BlockIndex.recordCount == 0)
+    {
+        BlockIndex.firstTime = recordPtr->timestamp;
+        BlockIndex.lastTime = recordPtr->timestamp;
+    }
+    else if (recordPtr->timestamp < BlockIndex.firstTime)
+    {
+        BlockIndex.firstTime = recordPtr->timestamp;
+    }
+    else if (recordPtr->timestamp > BlockIndex.lastTime)
+    {
+        BlockIndex.lastTime = recordPtr->timestamp;
+    }
+    BlockIndex.recordCount++;
+    BlockIndex.levelMask |= GetLevelBit(recordPtr->level);
+    BlockIndex.nameBloom |= GetBloomBits('p', recordPtr->procNamePtr)
+                          | GetBloomBits('c', recordPtr->compNamePtr);
+
+    // A CRITICAL or EMERGENCY message may be the last thing a process (or the system) says, so
+    // write it out right away.
+    if ((recordPtr->level != (le_log_Level_t)-1) && (recordPtr->level >= LE_LOG_CRIT))
+    {
+        logStore_Flush();
+    }
+    else if (!le_timer_IsRunning(FlushTimerRef))
+    {
+        LE_ASSERT(le_timer_Start(FlushTimerRef) == LE_OK);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compresses the block being built up, if it isn't empty, and writes it to the current log file.
+ */
+//--------------------------------------------------------------------------------------------------
+void logStore_Flush
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (BlockUsed == 0)
+    {
+        return;
+    }
+
+    le_timer_Stop(FlushTimerRef);
+
+    logStore_BlockHeader_t header = BlockIndex;
+    uint8_t* dataPtr = OutBuff + sizeof(header);
+
+    header.magic = LOG_STORE_BLOCK_MAGIC;
+    header.compressedSize = Compress(BlockBuff, BlockUsed, dataPtr);
+    header.rawSize = BlockUsed;
+    header.crc = 0;
+
+    uint32_t crc = Crc32(0, &header, sizeof(header));
+    header.crc = Crc32(crc, dataPtr, header.compressedSize);
+
+    memcpy(OutBuff, &header, sizeof(header));
+
+    BlockUsed = 0;
+    memset(&BlockIndex, 0, sizeof(BlockIndex));
+
+    // If the current file couldn't be created, try again.
+    if (FileFd == -1)
+    {
+        CreateFile();
+
+        if (FileFd == -1)
+        {
+            return;
+        }
+    }
+
+    size_t outSize = sizeof(header) + header.compressedSize;
+
+    if (!WriteAll(FileFd, OutBuff, outSize) || (fdatasync(FileFd) != 0))
+    {
+        LE_ERROR("Failed to write log block (%m).  %zu bytes of log messages lost.",
+                 (size_t)header.rawSize);
+
+        // Don't leave part of a block behind.
+        if (   (ftruncate(FileFd, FileSize) != 0)
+            || (lseek(FileFd, FileSize, SEEK_SET) != FileSize) )
+        {
+            fd_Close(FileFd);
+            FileFd = -1;
+        }
+
+        return;
+    }
+
+    FileSize += outSize;
+
+    if (FileSize >= FILE_ROTATE_BYTES)
+    {
+        RotateFiles();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a block's index information says that it could hold messages that a filter
+ * selects.
+ *
+ * @return false if the block can be skipped.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool BlockMayMatch
+(
+    const logStore_BlockHeader_t* headerPtr,    ///< [IN] The block header.
+    const logStore_Filter_t* filterPtr,         ///< [IN] The filter.
+    uint64_t bloomBits                          ///< [IN] Bloom filter bits of the names wanted.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((headerPtr->lastTime < filterPtr->startTime) || (headerPtr->firstTime > filterPtr->endTime))
+    {
+        return false;
+    }
+
+    // Bits of the levels at least as severe as the one wanted.  Traces count as debug messages.
+    uint8_t levelMask = 0x3F & ~((1 << filterPtr->minLevel) - 1);
+    if (filterPtr->minLevel <= LE_LOG_DEBUG)
+    {
+        levelMask |= LOG_STORE_TRACE_BIT;
+    }
+
+    if ((headerPtr->levelMask & levelMask) == 0)
+    {
+        return false;
+    }
+
+    return ((headerPtr->nameBloom & bloomBits) == bloomBits);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a filter selects a log message.
+ *
+ * @return true if the message is wanted.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool RecordMatches
+(
+    const logStore_Record_t* recordPtr,     ///< [IN] The log message.
+    const logStore_Filter_t* filterPtr      ///< [IN] The filter.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_log_Level_t level = recordPtr->level;
+    if (level == (le_log_Level_t)-1)
+    {
+        level = LE_LOG_DEBUG;
+    }
+
+    return (   (recordPtr->timestamp >= filterPtr->startTime)
+            && (recordPtr->timestamp <= filterPtr->endTime)
+            && (level >= filterPtr->minLevel)
+            && (   (filterPtr->procNamePtr == NULL)
+                || (strcmp(recordPtr->procNamePtr, filterPtr->procNamePtr) == 0) )
+            && (   (filterPtr->compNamePtr == NULL)
+                || (strcmp(recordPtr->compNamePtr, filterPtr->compNamePtr) == 0) ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Passes the log messages in a block's uncompressed data that match a filter to a handler.
+ *
+ * @return true if the data was well formed, false if it was damaged.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadRecords
+(
+    const uint8_t* dataPtr,                 ///< [IN] Uncompressed block data.
+    size_t dataLen,                         ///< [IN] Number of bytes of data.
+    const logStore_Filter_t* filterPtr,     ///< [IN] Selects the log messages wanted.
+    logStore_RecordHandler_t handlerFunc,   ///< [IN] Function to pass the log messages to.
+    void* contextPtr                        ///< [IN] Context pointer to pass to the handler.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t pos = 0;
+
+    while (pos < dataLen)
+    {
+        logStore_RecordHeader_t header;
+        const char* strings[RECORD_STRING_COUNT];
+        int i;
+
+        if (dataLen - pos < sizeof(header))
+        {
+            return false;
+        }
+        memcpy(&header, dataPtr + pos, sizeof(header));
+        pos += sizeof(header);
+
+        for (i = 0; i < RECORD_STRING_COUNT; i++)
+        {
+            const uint8_t* endPtr = memchr(dataPtr + pos, '\0', dataLen - pos);
+            if (endPtr == NULL)
+            {
+                return false;
+            }
+
+            strings[i] = (const char*)(dataPtr + pos);
+            pos = (endPtr - dataPtr) + 1;
+        }
+
+        logStore_Record_t record = { .timestamp = header.timestamp,
+                                     .pid = header.pid,
+                                     .level = (le_log_Level_t)header.level,
+                                     .lineNumber = header.lineNumber,
+                                     .levelStrPtr = strings[0],
+                                     .procNamePtr = strings[1],
+                                     .compNamePtr = strings[2],
+                                     .threadNamePtr = strings[3],
+                                     .fileNamePtr = strings[4],
+                                     .funcNamePtr = strings[5],
+                                     .msgPtr = strings[6] };
+
+        if (RecordMatches(&record, filterPtr))
+        {
+            handlerFunc(&record, contextPtr);
+        }
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the log messages in one log file, passing the ones that match a filter to a handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadFile
+(
+    const char* pathPtr,                    ///< [IN] Path of the log file.
+    const logStore_Filter_t* filterPtr,     ///< [IN] Selects the log messages wanted.
+    uint64_t bloomBits,                     ///< [IN] Bloom filter bits of the names wanted.
+    logStore_RecordHandler_t handlerFunc,   ///< [IN] Function to pass the log messages to.
+    void* contextPtr                        ///< [IN] Context pointer to pass to the handler.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd;
+    do
+    {
+        fd = open(pathPtr, O_RDONLY | O_CLOEXEC);
+    }
+    while ((fd == -1) && (errno == EINTR));
+
+    if (fd == -1)
+    {
+        LE_WARN("Failed to open log file '%s' (%m).", pathPtr);
+        return;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || !ReadFileHeader(fd))
+    {
+        LE_WARN("'%s' is not a log file.", pathPtr);
+        fd_Close(fd);
+        return;
+    }
+
+    off_t offset = sizeof(logStore_FileHeader_t);
+    logStore_BlockHeader_t header;
+
+    while (ReadBlockHeader(fd, offset, st.st_size, &header))
+    {
+        if (BlockMayMatch(&header, filterPtr, bloomBits))
+        {
+            if (   !ReadBlockData(fd, offset, &header, OutBuff)
+                || !Decompress(OutBuff, header.compressedSize, BlockBuff, header.rawSize)
+                || !ReadRecords(BlockBuff, header.rawSize, filterPtr, handlerFunc, contextPtr) )
+            {
+                LE_WARN("Damaged block at offset %lld in log file '%s'.",
+                        (long long)offset,
+                        pathPtr);
+            }
+        }
+
+        offset += sizeof(header) + header.compressedSize;
+    }
+
+    fd_Close(fd);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the log messages stored in a directory, oldest first, passing the ones that match a
+ * filter to a handler function.  Damaged blocks are skipped.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the directory holds no log files.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t logStore_Read
+(
+    const char* dirPathPtr,                 ///< [IN] Path of the directory holding the log files.
+    const logStore_Filter_t* filterPtr,     ///< [IN] Selects the log messages wanted.
+    logStore_RecordHandler_t handlerFunc,   ///< [IN] Function to pass the log messages to.
+    void* contextPtr                        ///< [IN] Context pointer to pass to the handler.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+    unsigned int fileCount = 0;
+    struct stat st;
+
+    // Count the log files.  The writer may have kept more or fewer than FILE_COUNT.
+    while (fileCount < MAX_READ_FILES)
+    {
+        GetFilePath(dirPathPtr, fileCount, path);
+
+        if (stat(path, &st) != 0)
+        {
+            break;
+        }
+
+        fileCount++;
+    }
+
+    if (fileCount == 0)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    uint64_t bloomBits = 0;
+    if (filterPtr->procNamePtr != NULL)
+    {
+        bloomBits |= GetBloomBits('p', filterPtr->procNamePtr);
+    }
+    if (filterPtr->compNamePtr != NULL)
+    {
+        bloomBits |= GetBloomBits('c', filterPtr->compNamePtr);
+    }
+
+    // Oldest first.
+    while (fileCount > 0)
+    {
+        fileCount--;
+
+        GetFilePath(dirPathPtr, fileCount, path);
+        ReadFile(path, filterPtr, bloomBits, handlerFunc, contextPtr);
+    }
+
+    return LE_OK;
+}
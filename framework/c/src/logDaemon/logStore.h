@@ -0,0 +1,239 @@
+/** @file logStore.h
+ *
+ * Persistent log storage, shared by the Log Control Daemon (which writes it) and the log tool
+ * (which reads it).
+ *
+ * Persistent log storage is turned on by starting the Log Control Daemon with the LE_LOG_STORE
+ * environment variable set to the path of the directory to keep the log files in.  Log messages
+ * that processes write into their shared memory Log Rings (see logDaemon.h), and the standard
+ * output and standard error messages that the Log Control Daemon captures, are then stored in
+ * that directory instead of being sent to syslog.
+ *
+ * Messages are collected in memory until a block's worth has built up, a few seconds have gone
+ * by, or a CRITICAL or EMERGENCY message arrives.  The block is then compressed and appended to
+ * the current log file with a single write.  When the current log file is full, the log files
+ * are rotated: "log.0" is the current file, "log.1" the one before it, and so on, and the oldest
+ * is deleted.
+ *
+ * Each log file starts with a logStore_FileHeader_t, followed by the blocks.  Each block is a
+ * logStore_BlockHeader_t followed by the compressed block data.  The block headers index the
+ * blocks by time, severity level and process and component names, so a reader can skip blocks
+ * that can't hold any messages it wants without decompressing them.  A block that was cut short
+ * (e.g., by a power failure) fails its checksum, and is discarded when the Log Control Daemon
+ * restarts.
+ *
+ * Uncompressed block data is a sequence of records, each of which is a logStore_RecordHeader_t
+ * followed by seven NUL-terminated strings: the severity level string (or trace keyword),
+ * process name, component name, thread name, source file name, function name and message.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#ifndef LOG_STORE_INCLUDE_GUARD
+#define LOG_STORE_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of the magic number at the start of a log file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_STORE_FILE_MAGIC        0x4C455354
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of the magic number at the start of a block.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_STORE_BLOCK_MAGIC       0x4C45424B
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Version of the log file format.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_STORE_VERSION           1
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest amount of uncompressed data in a block, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_STORE_BLOCK_BYTES       (32 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Bit set in a block's level mask if the block contains trace messages.  Severity levels use
+ * bits 0 (LE_LOG_DEBUG) to 5 (LE_LOG_EMERG).
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_STORE_TRACE_BIT         0x80
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of a log file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    magic;              ///< LOG_STORE_FILE_MAGIC.
+    uint32_t    version;            ///< LOG_STORE_VERSION.
+    uint32_t    blockBytes;         ///< Largest amount of uncompressed data in a block.
+    uint32_t    reserved;
+}
+logStore_FileHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of a block.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    magic;              ///< LOG_STORE_BLOCK_MAGIC.
+    uint32_t    compressedSize;     ///< Number of bytes of compressed data following the header.
+    uint32_t    rawSize;            ///< Number of bytes of data after decompression.
+    uint32_t    recordCount;        ///< Number of records in the block.
+    int64_t     firstTime;          ///< Earliest record timestamp (seconds since the Epoch).
+    int64_t     lastTime;           ///< Latest record timestamp (seconds since the Epoch).
+    uint64_t    nameBloom;          ///< Bloom filter of the process and component names.
+    uint8_t     levelMask;          ///< Severity levels present (see LOG_STORE_TRACE_BIT).
+    uint8_t     reserved[3];
+    uint32_t    crc;                ///< CRC-32 of the header (with this field zeroed) and data.
+}
+logStore_BlockHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of a record in uncompressed block data.  Records are packed, so this header isn't
+ * necessarily aligned.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int64_t     timestamp;          ///< Time the message was logged (seconds since the Epoch).
+    int32_t     pid;                ///< PID of the process that logged the message.
+    uint32_t    lineNumber;         ///< Line number in the source file.
+    int8_t      level;              ///< le_log_Level_t, or -1 for a trace.
+    uint8_t     reserved[7];
+}
+logStore_RecordHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A log message, as stored and read back.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int64_t         timestamp;      ///< Time the message was logged (seconds since the Epoch).
+    pid_t           pid;            ///< PID of the process that logged the message.
+    le_log_Level_t  level;          ///< Severity level (-1 if this is a trace).
+    unsigned int    lineNumber;     ///< Line number in the source file (0 if not known).
+    const char*     levelStrPtr;    ///< Severity level string or trace keyword.
+    const char*     procNamePtr;    ///< Name of the process.
+    const char*     compNamePtr;    ///< Name of the component ("" if not known).
+    const char*     threadNamePtr;  ///< Name of the thread ("" if not known).
+    const char*     fileNamePtr;    ///< Name of the source file ("" if not known).
+    const char*     funcNamePtr;    ///< Name of the function ("" if not known).
+    const char*     msgPtr;         ///< The message.
+}
+logStore_Record_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Selects the log messages to be read.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int64_t         startTime;      ///< Earliest timestamp wanted (INT64_MIN for no limit).
+    int64_t         endTime;        ///< Latest timestamp wanted (INT64_MAX for no limit).
+    le_log_Level_t  minLevel;       ///< Least severe level wanted.  Traces count as LE_LOG_DEBUG.
+    const char*     procNamePtr;    ///< Process name wanted, or NULL for all processes.
+    const char*     compNamePtr;    ///< Component name wanted, or NULL for all components.
+}
+logStore_Filter_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called by logStore_Read() for each log message selected.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*logStore_RecordHandler_t)
+(
+    const logStore_Record_t* recordPtr,     ///< [IN] The log message.
+    void* contextPtr                        ///< [IN] Context pointer given to logStore_Read().
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts storing log messages in a given directory, creating it if necessary.  If the current
+ * log file ends with a damaged block, that block is discarded.  Must be called at most once, by
+ * the Log Control Daemon.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_FAULT if the directory or the current log file couldn't be opened or created.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t logStore_Open
+(
+    const char* dirPathPtr          ///< [IN] Path of the directory to keep the log files in.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds a log message to the block being built up, writing the block out first if the message
+ * doesn't fit.  Strings that are too long are truncated.
+ */
+//--------------------------------------------------------------------------------------------------
+void logStore_Append
+(
+    const logStore_Record_t* recordPtr  ///< [IN] The log message.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compresses the block being built up, if it isn't empty, and writes it to the current log file.
+ */
+//--------------------------------------------------------------------------------------------------
+void logStore_Flush
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the log messages stored in a directory, oldest first, passing the ones that match a
+ * filter to a handler function.  Damaged blocks are skipped.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the directory holds no log files.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t logStore_Read
+(
+    const char* dirPathPtr,                 ///< [IN] Path of the directory holding the log files.
+    const logStore_Filter_t* filterPtr,     ///< [IN] Selects the log messages wanted.
+    logStore_RecordHandler_t handlerFunc,   ///< [IN] Function to pass the log messages to.
+    void* contextPtr                        ///< [IN] Context pointer to pass to the handler.
+);
+
+
+#endif // LOG_STORE_INCLUDE_GUARD
@@ -0,0 +1,637 @@
+/** @file logLimit.c
+ *
+ * Implementation of the log module's "Rate Limiting" feature.  See logLimit.h for an overview.
+ *
+ * The token bucket is a single 64-bit word, holding the time it was last refilled (in
+ * milliseconds) and the number of tokens in it (in thousandths of a token), so it can be updated
+ * with a compare-and-swap without locking.  Everything else is protected by the mutex.
+ *
+ * Everything here is allocated with calloc() rather than from memory pools, because the Memory
+ * module logs while holding its own lock.  Nothing here may use the logging macros, except at
+ * CRITICAL and EMERGENCY levels (which are never rate limited).
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "log.h"
+#include "logLimit.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of seconds between reports of suppressed messages.
+ *
+ * @todo Make this configurable.
+ */
+//--------------------------------------------------------------------------------------------------
+#define REPORT_INTERVAL_SECS    5
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A message is only a repeat if its call site logged the same message less than this many
+ * milliseconds before it.  Messages that are legitimately logged over and over again, but not
+ * very often (e.g., by a retry timer), are not suppressed.
+ */
+//--------------------------------------------------------------------------------------------------
+#define REPEAT_WINDOW_MS        (REPORT_INTERVAL_SECS * 1000)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name the reporter thread uses in the log messages it logs.
+ */
+//--------------------------------------------------------------------------------------------------
+#define REPORTER_THREAD_NAME    "logReporter"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Layout of a token bucket word: the low TOKEN_BITS hold the number of thousandths of a token in
+ * the bucket, and the rest hold the time it was last refilled, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TOKEN_BITS              24
+#define TOKEN_MASK              ((UINT64_C(1) << TOKEN_BITS) - 1)
+#define MILLI_TOKENS            1000
+
+
+_Static_assert((uint64_t)LOG_MAX_RATE_LIMIT * MILLI_TOKENS <= TOKEN_MASK,
+               "token bucket can't hold the largest burst limit");
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rate limiting state of a call site.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct SiteInfo
+{
+    struct SiteInfo*        nextPtr;            ///< Next call site on the Pending List.
+    struct SiteInfo*        allNextPtr;         ///< Next call site on the Site List.
+    le_log_CallSite_t*      sitePtr;            ///< The call site.
+    le_log_Level_t          level;              ///< Severity level (-1 if this is a trace).
+    const char*             levelStrPtr;        ///< Severity level string or trace keyword.
+    const char*             compNamePtr;        ///< Name of the component.
+    const char*             functionNamePtr;    ///< Name of the function.
+    const log_RateLimit_t*  limitPtr;           ///< The component's rate limit.
+    uint64_t                bucket;             ///< The token bucket (see TOKEN_BITS).
+    uint32_t                suppressedCount;    ///< Messages suppressed by the rate limit and not
+                                                ///  reported yet.
+    uint32_t                repeatCount;        ///< Repeats suppressed and not reported yet.
+    uint64_t                lastMsgHash;        ///< Hash of the last message logged.
+    uint64_t                lastMsgMs;          ///< When the last message was logged.
+    bool                    hasLastMsg;         ///< true if lastMsgHash and lastMsgMs are valid.
+    bool                    isPending;          ///< true if on the Pending List.
+}
+SiteInfo_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of call sites with suppressed messages that haven't been reported yet.
+ */
+//--------------------------------------------------------------------------------------------------
+static SiteInfo_t* PendingListPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of all the call sites that have rate limiting state.
+ */
+//--------------------------------------------------------------------------------------------------
+static SiteInfo_t* SiteListPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if repeated messages are to be suppressed (see the LE_LOG_SUPPRESS_REPEATS environment
+ * variable).  Set once by logLimit_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsRepeatSuppressionOn = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if the reporter thread has been started.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsReporterRunning = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Protects everything in this module except the token buckets and suppressed counts.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Locks the mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void Lock
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(pthread_mutex_lock(&Mutex) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unlocks the mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void Unlock
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the time from a cheap, millisecond resolution monotonic clock.
+ *
+ * @return The time, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t GetTimeMs
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct timespec now;
+
+    LE_ASSERT(clock_gettime(CLOCK_MONOTONIC_COARSE, &now) == 0);
+
+    return ((uint64_t)now.tv_sec * 1000) + (now.tv_nsec / 1000000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes a 64-bit FNV-1a hash of a message.
+ *
+ * @return The hash.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t HashMsg
+(
+    const char* msgPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+    while (*msgPtr != '\0')
+    {
+        hash ^= (uint8_t)*msgPtr++;
+        hash *= UINT64_C(0x100000001b3);
+    }
+
+    return hash;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a call site's rate limiting state, creating it the first time.
+ *
+ * @return Pointer to the state, or NULL if it couldn't be allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static SiteInfo_t* GetSiteInfo
+(
+    le_log_CallSite_t* sitePtr,
+    le_log_Level_t level,
+    const char* levelStrPtr,
+    const char* compNamePtr,
+    const char* functionNamePtr,
+    const log_RateLimit_t* limitPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    SiteInfo_t* infoPtr = __atomic_load_n(&sitePtr->limitInfoPtr, __ATOMIC_ACQUIRE);
+
+    if (infoPtr == NULL)
+    {
+        Lock();
+
+        infoPtr = sitePtr->limitInfoPtr;
+        if (infoPtr == NULL)
+        {
+            infoPtr = calloc(1, sizeof(SiteInfo_t));
+            if (infoPtr != NULL)
+            {
+                infoPtr->sitePtr = sitePtr;
+                infoPtr->level = level;
+                infoPtr->levelStrPtr = levelStrPtr;
+                infoPtr->compNamePtr = compNamePtr;
+                infoPtr->functionNamePtr = functionNamePtr;
+                infoPtr->limitPtr = limitPtr;
+
+                // Start with a full bucket.
+                infoPtr->bucket = (GetTimeMs() << TOKEN_BITS)
+                                | ((uint64_t)LOG_MAX_RATE_LIMIT * MILLI_TOKENS);
+
+                infoPtr->allNextPtr = SiteListPtr;
+                SiteListPtr = infoPtr;
+
+                __atomic_store_n(&sitePtr->limitInfoPtr, infoPtr, __ATOMIC_RELEASE);
+            }
+        }
+
+        Unlock();
+    }
+
+    return infoPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a message saying how many messages were suppressed at a call site, as coming from that
+ * call site.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Report
+(
+    const SiteInfo_t* infoPtr,
+    const char* threadNamePtr,
+    const char* msgPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    log_EmitMsg(infoPtr->level,
+                infoPtr->levelStrPtr,
+                infoPtr->compNamePtr,
+                threadNamePtr,
+                le_path_GetBasenamePtr(infoPtr->sitePtr->filenamePtr, "/"),
+                infoPtr->functionNamePtr,
+                infoPtr->sitePtr->lineNumber,
+                time(NULL),
+                msgPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reports the messages suppressed at all the call sites on the Pending List, and empties the list.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportPending
+(
+    const char* threadNamePtr       ///< [IN] Name of the thread to log the reports as coming from.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char msg[LOG_MAX_MSG_SIZE];
+
+    Lock();
+
+    SiteInfo_t* infoPtr = PendingListPtr;
+    PendingListPtr = NULL;
+
+    while (infoPtr != NULL)
+    {
+        // A call site that suppresses another message after this will go back on the list.
+        infoPtr->isPending = false;
+
+        uint32_t suppressedCount = __atomic_exchange_n(&infoPtr->suppressedCount,
+                                                       0,
+                                                       __ATOMIC_RELAXED);
+        if (suppressedCount != 0)
+        {
+            snprintf(msg,
+                     sizeof(msg),
+                     "%" PRIu32 " messages suppressed by rate limit.",
+                     suppressedCount);
+            Report(infoPtr, threadNamePtr, msg);
+        }
+
+        if (infoPtr->repeatCount != 0)
+        {
+            snprintf(msg,
+                     sizeof(msg),
+                     "Last message repeated %" PRIu32 " times.",
+                     infoPtr->repeatCount);
+            Report(infoPtr, threadNamePtr, msg);
+
+            infoPtr->repeatCount = 0;
+        }
+
+        infoPtr = infoPtr->nextPtr;
+    }
+
+    Unlock();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the reporter thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ReporterMain
+(
+    void* unused
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (;;)
+    {
+        struct timespec interval = { .tv_sec = REPORT_INTERVAL_SECS, .tv_nsec = 0 };
+
+        while ((nanosleep(&interval, &interval) == -1) && (errno == EINTR))
+        {
+        }
+
+        ReportPending(REPORTER_THREAD_NAME);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Puts a call site on the Pending List, if it isn't already on it, and starts the reporter
+ * thread if it isn't running yet.
+ *
+ * @warning Assumes that the mutex is locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MarkPending
+(
+    SiteInfo_t* infoPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!infoPtr->isPending)
+    {
+        infoPtr->isPending = true;
+        infoPtr->nextPtr = PendingListPtr;
+        PendingListPtr = infoPtr;
+    }
+
+    if (!IsReporterRunning)
+    {
+        pthread_t reporter;
+        pthread_attr_t attr;
+        LE_ASSERT(pthread_attr_init(&attr) == 0);
+        LE_ASSERT(pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) == 0);
+
+        // If the thread can't be started, the counts will be reported at exit.
+        if (pthread_create(&reporter, &attr, ReporterMain, NULL) == 0)
+        {
+            pthread_setname_np(reporter, REPORTER_THREAD_NAME);
+            IsReporterRunning = true;
+        }
+
+        pthread_attr_destroy(&attr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reports the suppressed messages that haven't been reported yet when the process exits.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportAtExit
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ReportPending(le_thread_GetMyName());
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resets the module in a child process created by fork().  The reporter thread isn't copied into
+ * the child, and the messages suppressed before the fork will be reported by the parent.  The
+ * child's first message from each call site is never taken as a repeat of the parent's.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResetInChild
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    pthread_mutex_init(&Mutex, NULL);
+
+    SiteInfo_t* infoPtr = SiteListPtr;
+    while (infoPtr != NULL)
+    {
+        infoPtr->isPending = false;
+        infoPtr->suppressedCount = 0;
+        infoPtr->repeatCount = 0;
+        infoPtr->hasLastMsg = false;
+        infoPtr->lastMsgHash = 0;
+
+        infoPtr = infoPtr->allNextPtr;
+    }
+
+    PendingListPtr = NULL;
+    IsReporterRunning = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module, turning repeat suppression on if the LE_LOG_SUPPRESS_REPEATS
+ * environment variable asks for it.  Must be called only once, by log_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+void logLimit_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* envStrPtr = getenv("LE_LOG_SUPPRESS_REPEATS");
+
+    IsRepeatSuppressionOn = (   (envStrPtr != NULL)
+                             && (envStrPtr[0] != '\0')
+                             && (strcmp(envStrPtr, "0") != 0) );
+
+    LE_ASSERT(atexit(ReportAtExit) == 0);
+    LE_ASSERT(pthread_atfork(NULL, NULL, ResetInChild) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes a token from a call site's token bucket.  CRITICAL and EMERGENCY messages are always
+ * admitted, without taking a token.
+ *
+ * @return
+ *  - true if the message may be logged.
+ *  - false if the message must be suppressed (it has been counted).
+ */
+//--------------------------------------------------------------------------------------------------
+bool logLimit_Admit
+(
+    le_log_CallSite_t* sitePtr,         ///< [IN] Call site that is logging the message.
+    le_log_Level_t level,               ///< [IN] Severity level (-1 if this is a trace).
+    const char* levelStrPtr,            ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,            ///< [IN] Name of the component logging the message.
+    const char* functionNamePtr,        ///< [IN] Name of the function logging the message.
+    const log_RateLimit_t* limitPtr     ///< [IN] The component's rate limit.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((level != (le_log_Level_t)-1) && (level >= LE_LOG_CRIT))
+    {
+        return true;
+    }
+
+    SiteInfo_t* infoPtr = GetSiteInfo(sitePtr, level, levelStrPtr, compNamePtr, functionNamePtr,
+                                      limitPtr);
+    if (infoPtr == NULL)
+    {
+        return true;
+    }
+
+    // The limit can be changed by the log control tool at any time.
+    uint64_t rate = __atomic_load_n(&limitPtr->rate, __ATOMIC_RELAXED);
+    uint64_t capacity = (uint64_t)__atomic_load_n(&limitPtr->burst, __ATOMIC_RELAXED)
+                      * MILLI_TOKENS;
+    if (rate == 0)
+    {
+        return true;
+    }
+
+    uint64_t nowMs = GetTimeMs();
+    uint64_t oldBucket = __atomic_load_n(&infoPtr->bucket, __ATOMIC_RELAXED);
+    bool isAdmitted;
+
+    for (;;)
+    {
+        uint64_t lastMs = oldBucket >> TOKEN_BITS;
+        uint64_t tokens = oldBucket & TOKEN_MASK;
+
+        // Another thread may have refilled the bucket with a later time than ours.
+        if (nowMs > lastMs)
+        {
+            tokens += (nowMs - lastMs) * rate;
+            lastMs = nowMs;
+        }
+        if (tokens > capacity)
+        {
+            tokens = capacity;
+        }
+
+        isAdmitted = (tokens >= MILLI_TOKENS);
+        if (isAdmitted)
+        {
+            tokens -= MILLI_TOKENS;
+        }
+
+        if (__atomic_compare_exchange_n(&infoPtr->bucket,
+                                        &oldBucket,
+                                        (lastMs << TOKEN_BITS) | tokens,
+                                        false,
+                                        __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+
+    // The first message suppressed since the last report puts the call site on the list.
+    if (   !isAdmitted
+        && (__atomic_fetch_add(&infoPtr->suppressedCount, 1, __ATOMIC_RELAXED) == 0) )
+    {
+        Lock();
+        MarkPending(infoPtr);
+        Unlock();
+    }
+
+    return isAdmitted;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a formatted message is the same as the one its call site logged just before it.
+ * If it isn't, and repeats of the previous message were suppressed, how many were suppressed is
+ * logged first.  Nothing is ever a repeat unless repeat suppression is on.
+ *
+ * @return
+ *  - true if the message is a repeat, and must be suppressed (it has been counted).
+ *  - false if the message must be logged.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logLimit_IsRepeat
+(
+    const le_log_CallSite_t* sitePtr,   ///< [IN] Call site that logged the message.
+    const char* threadNamePtr,          ///< [IN] Name of the thread that logged the message.
+    const char* msgPtr                  ///< [IN] The formatted user message.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsRepeatSuppressionOn)
+    {
+        return false;
+    }
+
+    SiteInfo_t* infoPtr = __atomic_load_n(&sitePtr->limitInfoPtr, __ATOMIC_ACQUIRE);
+
+    // Call sites that were never rate limited (e.g., CRITICAL messages), or whose component has
+    // rate limiting off, don't suppress repeats either.
+    if ((infoPtr == NULL) || (__atomic_load_n(&infoPtr->limitPtr->rate, __ATOMIC_RELAXED) == 0))
+    {
+        return false;
+    }
+
+    uint64_t hash = HashMsg(msgPtr);
+    uint64_t nowMs = GetTimeMs();
+
+    Lock();
+
+    bool isRepeat = (   infoPtr->hasLastMsg
+                     && (infoPtr->lastMsgHash == hash)
+                     && (nowMs - infoPtr->lastMsgMs < REPEAT_WINDOW_MS) );
+
+    infoPtr->lastMsgHash = hash;
+    infoPtr->lastMsgMs = nowMs;
+    infoPtr->hasLastMsg = true;
+
+    if (isRepeat)
+    {
+        infoPtr->repeatCount++;
+        MarkPending(infoPtr);
+    }
+    else if (infoPtr->repeatCount != 0)
+    {
+        // Say how many times the previous message was repeated before logging a different one.
+        char msg[LOG_MAX_MSG_SIZE];
+        snprintf(msg,
+                 sizeof(msg),
+                 "Last message repeated %" PRIu32 " times.",
+                 infoPtr->repeatCount);
+        Report(infoPtr, threadNamePtr, msg);
+
+        infoPtr->repeatCount = 0;
+    }
+
+    Unlock();
+
+    return isRepeat;
+}
@@ -0,0 +1,77 @@
+/** @file logLimit.h
+ *
+ * Log module's "Rate Limiting" inter-module interface definitions.
+ *
+ * Each logging macro call site is rate limited with a token bucket (see @ref c_log_rate_limiting).
+ * The bucket holds up to a component's burst limit of tokens, and is refilled at its rate limit
+ * of tokens per second.  Each message takes a token, and a message that finds the bucket empty is
+ * suppressed and counted.  If the LE_LOG_SUPPRESS_REPEATS environment variable turns it on, a
+ * message that is the same as the one the same call site logged just before it is also
+ * suppressed and counted.
+ *
+ * The call site's state is kept in an object hung off its static le_log_CallSite_t object the
+ * first time the site logs.  Call sites with suppressed messages are put on a list, and a
+ * background "reporter" thread, started the first time anything is suppressed, periodically
+ * logs how many messages were suppressed at each of them.  Anything not yet reported is also
+ * logged when the process calls exit().
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_LOG_LIMIT_H_INCLUDE_GUARD
+#define LEGATO_LOG_LIMIT_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module, turning repeat suppression on if the LE_LOG_SUPPRESS_REPEATS
+ * environment variable asks for it.  Must be called only once, by log_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+void logLimit_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes a token from a call site's token bucket.  CRITICAL and EMERGENCY messages are always
+ * admitted, without taking a token.
+ *
+ * @return
+ *  - true if the message may be logged.
+ *  - false if the message must be suppressed (it has been counted).
+ */
+//--------------------------------------------------------------------------------------------------
+bool logLimit_Admit
+(
+    le_log_CallSite_t* sitePtr,         ///< [IN] Call site that is logging the message.
+    le_log_Level_t level,               ///< [IN] Severity level (-1 if this is a trace).
+    const char* levelStrPtr,            ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,            ///< [IN] Name of the component logging the message.
+    const char* functionNamePtr,        ///< [IN] Name of the function logging the message.
+    const log_RateLimit_t* limitPtr     ///< [IN] The component's rate limit.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a formatted message is the same as the one its call site logged just before it.
+ * If it isn't, and repeats of the previous message were suppressed, how many were suppressed is
+ * logged first.  Nothing is ever a repeat unless repeat suppression is on.
+ *
+ * @return
+ *  - true if the message is a repeat, and must be suppressed (it has been counted).
+ *  - false if the message must be logged.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logLimit_IsRepeat
+(
+    const le_log_CallSite_t* sitePtr,   ///< [IN] Call site that logged the message.
+    const char* threadNamePtr,          ///< [IN] Name of the thread that logged the message.
+    const char* msgPtr                  ///< [IN] The formatted user message.
+);
+
+
+#endif // LEGATO_LOG_LIMIT_H_INCLUDE_GUARD
@@ -0,0 +1,1252 @@
+/** @file logRing.c
+ *
+ * Implementation of the log module's "Deferred Formatting" feature.  See logRing.h for an
+ * overview.
+ *
+ * A log ring is a circular buffer of variable-length records, each starting with a
+ * RecordHeader_t that is followed by the message's format arguments, packed one after the other.
+ * The owning thread is the only producer, and the drainer is the only consumer (threads that
+ * flush the rings take the drainer's place by locking the same mutex).  The producer only moves
+ * the ring's head, and the consumer only moves its tail, so no locking is needed between them.
+ * A record never wraps around the end of the buffer; if it doesn't fit in the space left before
+ * the end, that space is filled with a padding record and the real record starts at the
+ * beginning of the buffer.
+ *
+ * Everything here is allocated with calloc() rather than from memory pools, because the Memory
+ * module logs while holding its own lock.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "log.h"
+#include "logRing.h"
+#include "logLimit.h"
+#include "limit.h"
+#include <semaphore.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of each thread's log ring, in bytes, if LE_LOG_DEFERRED doesn't specify one.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_RING_BYTES      (16 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Smallest log ring size allowed, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MIN_RING_BYTES          (4 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of format arguments that a deferred log message can have.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_ARGS                16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Level value used to mark padding records.
+ */
+//--------------------------------------------------------------------------------------------------
+#define PADDING_LEVEL           ((int32_t)-2)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Length value used to record a NULL string argument.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NULL_STR_LEN            UINT16_MAX
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rounds a record size up to keep records 8-byte aligned.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RECORD_ALIGN(size)      (((size) + 7) & ~((size_t)7))
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Types of format arguments, as far as va_arg() is concerned.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    ARG_NONE,           ///< No argument (the trailing text after the last conversion).
+    ARG_INT,            ///< int (including promoted char and short).
+    ARG_LONG,           ///< long.
+    ARG_LONG_LONG,      ///< long long.
+    ARG_DOUBLE,         ///< double (including promoted float).
+    ARG_LONG_DOUBLE,    ///< long double.
+    ARG_PTR,            ///< void*.
+    ARG_STR             ///< Null-terminated string, copied into the record.
+}
+ArgType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A piece of a format string containing at most one conversion specification, at its end.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint16_t    start;          ///< Offset of the segment in the format string.
+    uint16_t    len;            ///< Length of the segment, in bytes.
+    uint16_t    maxStrLen;      ///< For ARG_STR, the precision (maximum bytes printed) if any.
+    uint8_t     argType;        ///< Type of the conversion's argument (ArgType_t).
+}
+Segment_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parsed format string, cached in a call site's formatInfoPtr.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* formatPtr;              ///< The format string that was parsed.
+    bool        isDeferrable;           ///< false if messages must be formatted right away.
+    size_t      segmentCount;           ///< Number of segments (arguments + 1).
+    Segment_t   segments[MAX_ARGS + 1]; ///< The format string, split after each conversion.
+}
+FormatInfo_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of a log ring record.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t                    size;           ///< Bytes taken up by the record (header too).
+    int32_t                     level;          ///< Severity level, or PADDING_LEVEL.
+    int32_t                     savedErrno;     ///< errno value at the time of logging.
+    uint32_t                    reserved;       ///< Keeps the pointers 8-byte aligned.
+    const FormatInfo_t*         formatInfoPtr;  ///< Parsed format string.
+    const le_log_CallSite_t*    sitePtr;        ///< Call site (file name and line number).
+    const char*                 levelStrPtr;    ///< Severity level string or trace keyword.
+    const char*                 compNamePtr;    ///< Component name.
+    const char*                 functionNamePtr;///< Function name.
+    time_t                      timestamp;      ///< Time of logging.
+}
+RecordHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Log ring.  One is created for each thread that logs while deferred formatting is on.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t   link;           ///< Link in the RingList.
+    uint32_t        head;           ///< Bytes ever written (only moved by the producer).
+    uint32_t        tail;           ///< Bytes ever consumed (only moved by the consumer).
+    uint32_t        droppedCount;   ///< Messages dropped because the ring was full (producer).
+    uint32_t        reportedCount;  ///< Value of droppedCount last reported (consumer).
+    bool            isOrphaned;     ///< true once the owning thread has exited.
+    char            threadName[LIMIT_MAX_THREAD_NAME_BYTES]; ///< Name of the owning thread.
+    uint8_t         data[] __attribute__((aligned(8)));      ///< RingBytes bytes of records.
+}
+Ring_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if deferred formatting is on.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsEnabled = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of each log ring's data buffer, in bytes (a power of two).
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t RingBytes = DEFAULT_RING_BYTES;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key used to find the calling thread's log ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_key_t RingKey;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of all the log rings in the process.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t RingList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex protecting the RingList and the consumer side of the rings.  Also used to serialize the
+ * parsing of call sites' format strings.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Semaphore that the drainer thread waits on when all the rings are empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static sem_t WakeUpSem;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true while the drainer thread is (or is about to be) waiting on the WakeUpSem.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsDrainerIdle = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Lock the mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void Lock
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(pthread_mutex_lock(&Mutex) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unlock the mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void Unlock
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Works out the argument type for an integer conversion with a given length modifier.
+ */
+//--------------------------------------------------------------------------------------------------
+static ArgType_t IntArgType
+(
+    size_t argSize      ///< [IN] Size of the argument the length modifier calls for (0 = int).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (argSize == sizeof(long long) && argSize != sizeof(long))
+    {
+        return ARG_LONG_LONG;
+    }
+    if (argSize == sizeof(long) && argSize != sizeof(int))
+    {
+        return ARG_LONG;
+    }
+    return ARG_INT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parses a format string, splitting it into segments that each hold at most one conversion.
+ *
+ * @return true if messages using this format can be deferred, false if they can't.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ParseFormat
+(
+    FormatInfo_t* infoPtr           ///< [IN/OUT] Format info with formatPtr set.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* fmtPtr = infoPtr->formatPtr;
+    size_t segStart = 0;
+    size_t i = 0;
+
+    infoPtr->segmentCount = 0;
+
+    while (fmtPtr[i] != '\0')
+    {
+        if (fmtPtr[i++] != '%')
+        {
+            continue;
+        }
+
+        if (fmtPtr[i] == '%')
+        {
+            i++;
+            continue;
+        }
+
+        // Flags.
+        while ((fmtPtr[i] != '\0') && (strchr("-+ #0'I", fmtPtr[i]) != NULL))
+        {
+            i++;
+        }
+
+        // Field width.  '*' widths and positional arguments ("%1$d") are not supported.
+        while (isdigit((unsigned char)fmtPtr[i]))
+        {
+            i++;
+        }
+        if ((fmtPtr[i] == '*') || (fmtPtr[i] == '$'))
+        {
+            return false;
+        }
+
+        // Precision.
+        long precision = -1;
+        if (fmtPtr[i] == '.')
+        {
+            i++;
+            if (fmtPtr[i] == '*')
+            {
+                return false;
+            }
+            precision = 0;
+            while (isdigit((unsigned char)fmtPtr[i]))
+            {
+                if (precision < LOG_MAX_MSG_SIZE)
+                {
+                    precision = (precision * 10) + (fmtPtr[i] - '0');
+                }
+                i++;
+            }
+        }
+
+        // Length modifier.
+        size_t argSize = 0;
+        bool isLongDouble = false;
+        switch (fmtPtr[i])
+        {
+            case 'h':
+                i += (fmtPtr[i + 1] == 'h') ? 2 : 1;
+                break;
+            case 'l':
+                if (fmtPtr[i + 1] == 'l')
+                {
+                    argSize = sizeof(long long);
+                    i += 2;
+                }
+                else
+                {
+                    argSize = sizeof(long);
+                    i += 1;
+                }
+                break;
+            case 'q':
+                argSize = sizeof(long long);
+                i++;
+                break;
+            case 'j':
+                argSize = sizeof(intmax_t);
+                i++;
+                break;
+            case 'z':
+                argSize = sizeof(size_t);
+                i++;
+                break;
+            case 't':
+                argSize = sizeof(ptrdiff_t);
+                i++;
+                break;
+            case 'L':
+                isLongDouble = true;
+                argSize = sizeof(long long);
+                i++;
+                break;
+        }
+
+        // Conversion.
+        ArgType_t argType;
+        switch (fmtPtr[i])
+        {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                argType = IntArgType(argSize);
+                break;
+            case 'c':
+                argType = ARG_INT;
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                argType = isLongDouble ? ARG_LONG_DOUBLE : ARG_DOUBLE;
+                break;
+            case 's':
+                if (argSize != 0)
+                {
+                    return false;   // Wide strings.
+                }
+                argType = ARG_STR;
+                break;
+            case 'p':
+                argType = ARG_PTR;
+                break;
+            case 'm':
+                // Takes no argument; the errno is restored before formatting.
+                i++;
+                continue;
+            default:
+                // %n, or something we don't understand.
+                return false;
+        }
+        i++;
+
+        if ((infoPtr->segmentCount == MAX_ARGS) || (i > UINT16_MAX))
+        {
+            return false;
+        }
+
+        Segment_t* segPtr = &infoPtr->segments[infoPtr->segmentCount++];
+        segPtr->start = segStart;
+        segPtr->len = i - segStart;
+        segPtr->argType = argType;
+        segPtr->maxStrLen = ((precision >= 0) && (precision < LOG_MAX_MSG_SIZE)) ?
+                            precision : LOG_MAX_MSG_SIZE - 1;
+
+        segStart = i;
+    }
+
+    if (i > UINT16_MAX)
+    {
+        return false;
+    }
+
+    Segment_t* segPtr = &infoPtr->segments[infoPtr->segmentCount++];
+    segPtr->start = segStart;
+    segPtr->len = i - segStart;
+    segPtr->argType = ARG_NONE;
+    segPtr->maxStrLen = 0;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a call site's parsed format string, parsing it the first time.
+ *
+ * @return Pointer to the format info, or NULL if messages from this call site can't be deferred.
+ */
+//--------------------------------------------------------------------------------------------------
+static const FormatInfo_t* GetFormatInfo
+(
+    le_log_CallSite_t* sitePtr,
+    const char* formatPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The drainer reads the format string after the call returns, so only a literal will do.  A
+    // buffer could be changed or freed by then.
+    if (!sitePtr->isFormatLiteral)
+    {
+        return NULL;
+    }
+
+    FormatInfo_t* infoPtr = __atomic_load_n(&sitePtr->formatInfoPtr, __ATOMIC_ACQUIRE);
+
+    if (infoPtr == NULL)
+    {
+        Lock();
+
+        infoPtr = sitePtr->formatInfoPtr;
+        if (infoPtr == NULL)
+        {
+            infoPtr = calloc(1, sizeof(FormatInfo_t));
+            if (infoPtr != NULL)
+            {
+                infoPtr->formatPtr = formatPtr;
+                infoPtr->isDeferrable = ParseFormat(infoPtr);
+
+                __atomic_store_n(&sitePtr->formatInfoPtr, infoPtr, __ATOMIC_RELEASE);
+            }
+        }
+
+        Unlock();
+
+        if (infoPtr == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    if (!infoPtr->isDeferrable)
+    {
+        return NULL;
+    }
+
+    return infoPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor for the RingKey.  Marks the exiting thread's ring as orphaned, so the drainer will
+ * delete it once it's empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OrphanRing
+(
+    void* ringPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    __atomic_store_n(&((Ring_t*)ringPtr)->isOrphaned, true, __ATOMIC_RELEASE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the calling thread's log ring, creating it if the thread doesn't have one yet.
+ *
+ * @return Pointer to the ring, or NULL if it couldn't be created.
+ */
+//--------------------------------------------------------------------------------------------------
+static Ring_t* GetRing
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Ring_t* ringPtr = pthread_getspecific(RingKey);
+
+    if (ringPtr == NULL)
+    {
+        ringPtr = calloc(1, sizeof(Ring_t) + RingBytes);
+        if (ringPtr == NULL)
+        {
+            return NULL;
+        }
+
+        ringPtr->link = LE_DLS_LINK_INIT;
+        le_utf8_Copy(ringPtr->threadName, le_thread_GetMyName(), sizeof(ringPtr->threadName), NULL);
+
+        Lock();
+        le_dls_Queue(&RingList, &ringPtr->link);
+        Unlock();
+
+        LE_ASSERT(pthread_setspecific(RingKey, ringPtr) == 0);
+    }
+
+    return ringPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Works out how many bytes a record for a given message will take up.
+ *
+ * @return The record size.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetRecordSize
+(
+    const FormatInfo_t* infoPtr,
+    va_list args
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t size = sizeof(RecordHeader_t);
+    size_t i;
+
+    for (i = 0; i < infoPtr->segmentCount; i++)
+    {
+        switch (infoPtr->segments[i].argType)
+        {
+            case ARG_NONE:
+                break;
+            case ARG_INT:
+                (void)va_arg(args, int);
+                size += sizeof(int);
+                break;
+            case ARG_LONG:
+                (void)va_arg(args, long);
+                size += sizeof(long);
+                break;
+            case ARG_LONG_LONG:
+                (void)va_arg(args, long long);
+                size += sizeof(long long);
+                break;
+            case ARG_DOUBLE:
+                (void)va_arg(args, double);
+                size += sizeof(double);
+                break;
+            case ARG_LONG_DOUBLE:
+                (void)va_arg(args, long double);
+                size += sizeof(long double);
+                break;
+            case ARG_PTR:
+                (void)va_arg(args, void*);
+                size += sizeof(void*);
+                break;
+            case ARG_STR:
+            {
+                const char* strPtr = va_arg(args, const char*);
+                size += sizeof(uint16_t);
+                if (strPtr != NULL)
+                {
+                    size += strnlen(strPtr, infoPtr->segments[i].maxStrLen) + 1;
+                }
+                break;
+            }
+        }
+    }
+
+    return RECORD_ALIGN(size);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies a message's format arguments into a record.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteArgs
+(
+    const FormatInfo_t* infoPtr,
+    uint8_t* destPtr,
+    va_list args
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    for (i = 0; i < infoPtr->segmentCount; i++)
+    {
+        switch (infoPtr->segments[i].argType)
+        {
+            case ARG_NONE:
+                break;
+            case ARG_INT:
+            {
+                int value = va_arg(args, int);
+                memcpy(destPtr, &value, sizeof(value));
+                destPtr += sizeof(value);
+                break;
+            }
+            case ARG_LONG:
+            {
+                long value = va_arg(args, long);
+                memcpy(destPtr, &value, sizeof(value));
+                destPtr += sizeof(value);
+                break;
+            }
+            case ARG_LONG_LONG:
+            {
+                long long value = va_arg(args, long long);
+                memcpy(destPtr, &value, sizeof(value));
+                destPtr += sizeof(value);
+                break;
+            }
+            case ARG_DOUBLE:
+            {
+                double value = va_arg(args, double);
+                memcpy(destPtr, &value, sizeof(value));
+                destPtr += sizeof(value);
+                break;
+            }
+            case ARG_LONG_DOUBLE:
+            {
+                long double value = va_arg(args, long double);
+                memcpy(destPtr, &value, sizeof(value));
+                destPtr += sizeof(value);
+                break;
+            }
+            case ARG_PTR:
+            {
+                void* value = va_arg(args, void*);
+                memcpy(destPtr, &value, sizeof(value));
+                destPtr += sizeof(value);
+                break;
+            }
+            case ARG_STR:
+            {
+                const char* strPtr = va_arg(args, const char*);
+                uint16_t len = NULL_STR_LEN;
+                if (strPtr != NULL)
+                {
+                    len = strnlen(strPtr, infoPtr->segments[i].maxStrLen);
+                }
+                memcpy(destPtr, &len, sizeof(len));
+                destPtr += sizeof(len);
+                if (strPtr != NULL)
+                {
+                    memcpy(destPtr, strPtr, len);
+                    destPtr[len] = '\0';
+                    destPtr += len + 1;
+                }
+                break;
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats one segment of a message.  Not declared as printf-like, because the format strings
+ * are pieces of the call sites' format strings and can't be checked here.
+ *
+ * @return The number of bytes that vsnprintf() wanted to write.
+ */
+//--------------------------------------------------------------------------------------------------
+static int FormatSegment
+(
+    char* bufPtr,
+    size_t bufSize,
+    const char* formatPtr,
+    ...
+)
+//--------------------------------------------------------------------------------------------------
+{
+    va_list args;
+    va_start(args, formatPtr);
+    int n = vsnprintf(bufPtr, bufSize, formatPtr, args);
+    va_end(args);
+
+    return n;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats the message in a record.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FormatRecord
+(
+    const RecordHeader_t* hdrPtr,
+    char* msgPtr                    ///< [OUT] Buffer of LOG_MAX_MSG_SIZE bytes.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const FormatInfo_t* infoPtr = hdrPtr->formatInfoPtr;
+    const uint8_t* argPtr = (const uint8_t*)(hdrPtr + 1);
+    char segFormat[LOG_MAX_MSG_SIZE * 2];
+    size_t used = 0;
+    size_t i;
+
+    msgPtr[0] = '\0';
+
+    for (i = 0; (i < infoPtr->segmentCount) && (used < LOG_MAX_MSG_SIZE - 1); i++)
+    {
+        const Segment_t* segPtr = &infoPtr->segments[i];
+
+        // A segment this long would fill the message with its text before reaching its
+        // conversion, so that's as far as the message goes.
+        if (segPtr->len >= sizeof(segFormat))
+        {
+            break;
+        }
+        memcpy(segFormat, infoPtr->formatPtr + segPtr->start, segPtr->len);
+        segFormat[segPtr->len] = '\0';
+
+        char* bufPtr = msgPtr + used;
+        size_t bufSize = LOG_MAX_MSG_SIZE - used;
+        int n = 0;
+
+        // Formatting a %m conversion uses the errno.
+        errno = hdrPtr->savedErrno;
+
+        switch (segPtr->argType)
+        {
+            case ARG_NONE:
+                n = FormatSegment(bufPtr, bufSize, segFormat);
+                break;
+            case ARG_INT:
+            {
+                int value;
+                memcpy(&value, argPtr, sizeof(value));
+                argPtr += sizeof(value);
+                n = FormatSegment(bufPtr, bufSize, segFormat, value);
+                break;
+            }
+            case ARG_LONG:
+            {
+                long value;
+                memcpy(&value, argPtr, sizeof(value));
+                argPtr += sizeof(value);
+                n = FormatSegment(bufPtr, bufSize, segFormat, value);
+                break;
+            }
+            case ARG_LONG_LONG:
+            {
+                long long value;
+                memcpy(&value, argPtr, sizeof(value));
+                argPtr += sizeof(value);
+                n = FormatSegment(bufPtr, bufSize, segFormat, value);
+                break;
+            }
+            case ARG_DOUBLE:
+            {
+                double value;
+                memcpy(&value, argPtr, sizeof(value));
+                argPtr += sizeof(value);
+                n = FormatSegment(bufPtr, bufSize, segFormat, value);
+                break;
+            }
+            case ARG_LONG_DOUBLE:
+            {
+                long double value;
+                memcpy(&value, argPtr, sizeof(value));
+                argPtr += sizeof(value);
+                n = FormatSegment(bufPtr, bufSize, segFormat, value);
+                break;
+            }
+            case ARG_PTR:
+            {
+                void* value;
+                memcpy(&value, argPtr, sizeof(value));
+                argPtr += sizeof(value);
+                n = FormatSegment(bufPtr, bufSize, segFormat, value);
+                break;
+            }
+            case ARG_STR:
+            {
+                uint16_t len;
+                memcpy(&len, argPtr, sizeof(len));
+                argPtr += sizeof(len);
+                const char* strPtr = NULL;
+                if (len != NULL_STR_LEN)
+                {
+                    strPtr = (const char*)argPtr;
+                    argPtr += len + 1;
+                }
+                n = FormatSegment(bufPtr, bufSize, segFormat, strPtr);
+                break;
+            }
+        }
+
+        if (n < 0)
+        {
+            break;
+        }
+        used += ((size_t)n < bufSize) ? (size_t)n : bufSize - 1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats and logs all the messages in a ring, then reports any messages that were dropped.
+ *
+ * @warning Assumes that the mutex is locked.
+ *
+ * @return The number of records consumed.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t DrainRing
+(
+    Ring_t* ringPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char msg[LOG_MAX_MSG_SIZE];
+    uint32_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = ringPtr->tail;
+    size_t count = 0;
+
+    while (tail != head)
+    {
+        const RecordHeader_t* hdrPtr =
+            (const RecordHeader_t*)(ringPtr->data + (tail & (RingBytes - 1)));
+
+        if (hdrPtr->level != PADDING_LEVEL)
+        {
+            FormatRecord(hdrPtr, msg);
+
+            // Drop the message if its call site just logged the same thing.
+            if (!logLimit_IsRepeat(hdrPtr->sitePtr, ringPtr->threadName, msg))
+            {
+                log_EmitMsg(hdrPtr->level,
+                            hdrPtr->levelStrPtr,
+                            hdrPtr->compNamePtr,
+                            ringPtr->threadName,
+                            le_path_GetBasenamePtr(hdrPtr->sitePtr->filenamePtr, "/"),
+                            hdrPtr->functionNamePtr,
+                            hdrPtr->sitePtr->lineNumber,
+                            hdrPtr->timestamp,
+                            msg);
+            }
+            count++;
+        }
+
+        tail += hdrPtr->size;
+
+        // Give the space back to the producer right away.
+        __atomic_store_n(&ringPtr->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    uint32_t droppedCount = __atomic_load_n(&ringPtr->droppedCount, __ATOMIC_RELAXED);
+    if (droppedCount != ringPtr->reportedCount)
+    {
+        snprintf(msg,
+                 sizeof(msg),
+                 "%" PRIu32 " log messages dropped (log ring full).",
+                 droppedCount - ringPtr->reportedCount);
+        log_EmitMsg(LE_LOG_WARN, log_GetSeverityStr(LE_LOG_WARN), STRINGIZE(LE_COMPONENT_NAME),
+                    ringPtr->threadName, STRINGIZE(LE_FILENAME), __func__, __LINE__, time(NULL),
+                    msg);
+
+        ringPtr->reportedCount = droppedCount;
+    }
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats and logs the messages in all the rings, and deletes the rings of threads that have
+ * exited once they're empty.
+ *
+ * @return The number of records consumed.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t DrainAll
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count = 0;
+
+    Lock();
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&RingList);
+    while (linkPtr != NULL)
+    {
+        Ring_t* ringPtr = CONTAINER_OF(linkPtr, Ring_t, link);
+        linkPtr = le_dls_PeekNext(&RingList, linkPtr);
+
+        // Check for orphaning first, so the final records are drained before the ring goes.
+        bool isOrphaned = __atomic_load_n(&ringPtr->isOrphaned, __ATOMIC_ACQUIRE);
+
+        count += DrainRing(ringPtr);
+
+        if (isOrphaned)
+        {
+            le_dls_Remove(&RingList, &ringPtr->link);
+            free(ringPtr);
+        }
+    }
+
+    Unlock();
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether any ring has records in it.
+ *
+ * @return true if there is something to drain.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsAnythingPending
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isPending = false;
+
+    Lock();
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&RingList);
+    while ((linkPtr != NULL) && !isPending)
+    {
+        Ring_t* ringPtr = CONTAINER_OF(linkPtr, Ring_t, link);
+
+        isPending = (__atomic_load_n(&ringPtr->head, __ATOMIC_SEQ_CST) != ringPtr->tail);
+
+        linkPtr = le_dls_PeekNext(&RingList, linkPtr);
+    }
+
+    Unlock();
+
+    return isPending;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the drainer thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* DrainerMain
+(
+    void* unused
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (;;)
+    {
+        if (DrainAll() != 0)
+        {
+            continue;
+        }
+
+        // Tell the producers to wake us up, then check once more for anything that was recorded
+        // before they could see that.
+        __atomic_store_n(&IsDrainerIdle, true, __ATOMIC_SEQ_CST);
+
+        if (IsAnythingPending())
+        {
+            __atomic_store_n(&IsDrainerIdle, false, __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        while ((sem_wait(&WakeUpSem) == -1) && (errno == EINTR))
+        {
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flushes the rings when the process exits.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushAtExit
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    logRing_Flush();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Turns deferred formatting off in a child process created by fork().  The drainer thread isn't
+ * copied into the child, and whatever is waiting in the rings will be logged by the parent.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DisableInChild
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    IsEnabled = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module, turning deferred formatting on if the LE_LOG_DEFERRED environment
+ * variable asks for it.  Must be called only once, by log_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* envStrPtr = getenv("LE_LOG_DEFERRED");
+
+    if ((envStrPtr == NULL) || (envStrPtr[0] == '\0') || (strcmp(envStrPtr, "0") == 0))
+    {
+        return;
+    }
+
+    // The variable can give the ring size in kilobytes.
+    char* endPtr;
+    unsigned long kBytes = strtoul(envStrPtr, &endPtr, 10);
+    if ((*endPtr == '\0') && (kBytes > 0) && (kBytes <= (1024 * 1024)))
+    {
+        RingBytes = MIN_RING_BYTES;
+        while (RingBytes < kBytes * 1024)
+        {
+            RingBytes *= 2;
+        }
+    }
+
+    LE_ASSERT(pthread_key_create(&RingKey, OrphanRing) == 0);
+    LE_ASSERT(sem_init(&WakeUpSem, 0, 0) == 0);
+
+    pthread_t drainer;
+    pthread_attr_t attr;
+    LE_ASSERT(pthread_attr_init(&attr) == 0);
+    LE_ASSERT(pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) == 0);
+    if (pthread_create(&drainer, &attr, DrainerMain, NULL) != 0)
+    {
+        LE_ERROR("Failed to start log drainer thread (%m). Deferred formatting is off.");
+        pthread_attr_destroy(&attr);
+        return;
+    }
+    pthread_attr_destroy(&attr);
+    pthread_setname_np(drainer, "logDrainer");
+
+    LE_ASSERT(atexit(FlushAtExit) == 0);
+    LE_ASSERT(pthread_atfork(NULL, NULL, DisableInChild) == 0);
+
+    IsEnabled = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records a log message in the calling thread's log ring, to be formatted and written to the log
+ * later by the drainer thread.
+ *
+ * @return
+ *  - true if the message was taken care of (recorded, or dropped because the ring was full).
+ *  - false if the message must be formatted and logged right away by the caller, because
+ *    deferred formatting is off or the message can't be deferred.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logRing_Record
+(
+    le_log_CallSite_t* sitePtr,     ///< [IN] Call site that logged the message.
+    le_log_Level_t level,           ///< [IN] Severity level (-1 if this is a trace).
+    const char* levelStrPtr,        ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,        ///< [IN] Name of the component that logged the message.
+    const char* functionNamePtr,    ///< [IN] Name of the function that logged the message.
+    const char* formatPtr,          ///< [IN] Message format.
+    int savedErrno,                 ///< [IN] errno value to report for %m.
+    va_list args                    ///< [IN] Message format arguments.  Only used up if
+                                    ///       true is returned.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsEnabled)
+    {
+        return false;
+    }
+
+    const FormatInfo_t* infoPtr = GetFormatInfo(sitePtr, formatPtr);
+    if (infoPtr == NULL)
+    {
+        return false;
+    }
+
+    Ring_t* ringPtr = GetRing();
+    if (ringPtr == NULL)
+    {
+        return false;
+    }
+
+    va_list sizeArgs;
+    va_copy(sizeArgs, args);
+    size_t size = GetRecordSize(infoPtr, sizeArgs);
+    va_end(sizeArgs);
+
+    // Messages that would hog the ring are logged right away.
+    if (size > RingBytes / 4)
+    {
+        return false;
+    }
+
+    uint32_t head = ringPtr->head;
+    uint32_t tail = __atomic_load_n(&ringPtr->tail, __ATOMIC_ACQUIRE);
+    uint32_t offset = head & (RingBytes - 1);
+    uint32_t spaceToEnd = RingBytes - offset;
+    uint32_t needed = (size > spaceToEnd) ? (spaceToEnd + size) : size;
+
+    if (RingBytes - (head - tail) < needed)
+    {
+        __atomic_fetch_add(&ringPtr->droppedCount, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    // Skip the space left at the end of the buffer if the record doesn't fit in it.
+    if (size > spaceToEnd)
+    {
+        RecordHeader_t* padPtr = (RecordHeader_t*)(ringPtr->data + offset);
+        padPtr->size = spaceToEnd;
+        padPtr->level = PADDING_LEVEL;
+        head += spaceToEnd;
+        offset = 0;
+    }
+
+    RecordHeader_t* hdrPtr = (RecordHeader_t*)(ringPtr->data + offset);
+    hdrPtr->size = size;
+    hdrPtr->level = level;
+    hdrPtr->savedErrno = savedErrno;
+    hdrPtr->formatInfoPtr = infoPtr;
+    hdrPtr->sitePtr = sitePtr;
+    hdrPtr->levelStrPtr = levelStrPtr;
+    hdrPtr->compNamePtr = compNamePtr;
+    hdrPtr->functionNamePtr = functionNamePtr;
+    hdrPtr->timestamp = time(NULL);
+
+    WriteArgs(infoPtr, (uint8_t*)(hdrPtr + 1), args);
+
+    __atomic_store_n(&ringPtr->head, head + size, __ATOMIC_RELEASE);
+
+    // Wake up the drainer if it has gone to sleep.  The fence pairs with the drainer's check
+    // for pending records after it sets IsDrainerIdle.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (   __atomic_load_n(&IsDrainerIdle, __ATOMIC_RELAXED)
+        && __atomic_exchange_n(&IsDrainerIdle, false, __ATOMIC_SEQ_CST))
+    {
+        sem_post(&WakeUpSem);
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats and writes to the log all the messages that are waiting in log rings, blocking until
+ * that is done.  Used to get them out before a message that is logged right away (e.g., just
+ * before the process dies).
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Flush
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (IsEnabled)
+    {
+        DrainAll();
+    }
+}
@@ -0,0 +1,77 @@
+/** @file logRing.h
+ *
+ * Log module's "Deferred Formatting" (log ring) inter-module interface definitions.
+ *
+ * When deferred formatting is turned on (see @ref c_log_control_env_deferred), a log message
+ * from one of the LE_DEBUG(), LE_INFO(), etc. macros isn't formatted by the thread that logs it.
+ * Instead, that thread copies a reference to the call site's parsed format string and the raw
+ * values of the format arguments into its own single-producer, single-consumer ring buffer.
+ * A background "drainer" thread empties the rings of all the threads in the process, formats the
+ * messages and writes them to the log.
+ *
+ * Each call site's format string is parsed the first time it logs, and the result is cached in
+ * the call site's static le_log_CallSite_t object.  Format strings that aren't string literals,
+ * and ones that can't be deferred (e.g., ones using '*' field widths or positional arguments),
+ * are logged the usual way.
+ *
+ * If a thread's ring is full, its message is dropped and counted; the drainer reports how many
+ * messages were dropped the next time it empties that ring.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_LOG_RING_H_INCLUDE_GUARD
+#define LEGATO_LOG_RING_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module, turning deferred formatting on if the LE_LOG_DEFERRED environment
+ * variable asks for it.  Must be called only once, by log_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records a log message in the calling thread's log ring, to be formatted and written to the log
+ * later by the drainer thread.
+ *
+ * @return
+ *  - true if the message was taken care of (recorded, or dropped because the ring was full).
+ *  - false if the message must be formatted and logged right away by the caller, because
+ *    deferred formatting is off or the message can't be deferred.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logRing_Record
+(
+    le_log_CallSite_t* sitePtr,     ///< [IN] Call site that logged the message.
+    le_log_Level_t level,           ///< [IN] Severity level (-1 if this is a trace).
+    const char* levelStrPtr,        ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,        ///< [IN] Name of the component that logged the message.
+    const char* functionNamePtr,    ///< [IN] Name of the function that logged the message.
+    const char* formatPtr,          ///< [IN] Message format.
+    int savedErrno,                 ///< [IN] errno value to report for %m.
+    va_list args                    ///< [IN] Message format arguments.  Only used up if
+                                    ///       true is returned.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats and writes to the log all the messages that are waiting in log rings, blocking until
+ * that is done.  Used to get them out before a message that is logged right away (e.g., just
+ * before the process dies).
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Flush
+(
+    void
+);
+
+
+#endif // LEGATO_LOG_RING_H_INCLUDE_GUARD
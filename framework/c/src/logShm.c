@@ -0,0 +1,316 @@
+/** @file logShm.c
+ *
+ * Implementation of the log module's "Shared Memory Transport".  See logShm.h for an overview
+ * and logDaemon.h for the layout of the Log Ring.
+ *
+ * All threads in the process write into the same ring, so writers are serialized by a mutex.
+ * The Log Control Daemon is the only reader.  Nothing here may log, because it is called from
+ * inside the logging code.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "log.h"
+#include "logShm.h"
+#include "logDaemon/logDaemon.h"
+#include "limit.h"
+#include "fileDescriptor.h"
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Longest source file name or function name copied into a record, including the terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_SOURCE_NAME_BYTES   128
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The process's Log Ring, or NULL if there isn't one.  Set once by logShm_Open() and cleared in
+ * a forked child (which must not write into its parent's ring).
+ */
+//--------------------------------------------------------------------------------------------------
+static logShm_RingHeader_t* RingPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start of the Log Ring's data area.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t* RingDataPtr;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * eventfd used to wake up the Log Control Daemon.
+ */
+//--------------------------------------------------------------------------------------------------
+static int WakeFd = -1;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Serializes the threads writing into the Log Ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops a child process created by fork() from writing into its parent's Log Ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DisableInChild
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RingPtr = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies a string into a record, truncating it if necessary.
+ *
+ * @return Pointer to the byte following the copied string's terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint8_t* CopyString
+(
+    uint8_t* destPtr,           ///< [OUT] Where to copy the string to.
+    const char* strPtr,         ///< [IN] The string.
+    size_t len                  ///< [IN] Number of bytes to copy (not including the terminator).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    memcpy(destPtr, strPtr, len);
+    destPtr[len] = '\0';
+
+    return destPtr + len + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asks the Log Control Daemon for a Log Ring over the log client IPC session, and starts writing
+ * log messages into it if the daemon provides one.  Must be called only once, by
+ * log_ConnectToControlDaemon(), after the process's log sessions have been registered.
+ */
+//--------------------------------------------------------------------------------------------------
+void logShm_Open
+(
+    le_msg_SessionRef_t sessionRef      ///< [IN] Session with the Log Control Daemon.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd < 0)
+    {
+        LE_ERROR("Failed to create eventfd (%m).");
+        return;
+    }
+
+    // The message takes ownership of the fd it carries, so send a duplicate.
+    int sendFd = fcntl(wakeFd, F_DUPFD_CLOEXEC, 0);
+    if (sendFd < 0)
+    {
+        LE_ERROR("Failed to duplicate eventfd (%m).");
+        fd_Close(wakeFd);
+        return;
+    }
+
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+    char* packetPtr = le_msg_GetPayloadPtr(msgRef);
+    packetPtr[0] = LOG_CMD_OPEN_RING;
+    packetPtr[1] = '\0';
+    le_msg_SetFd(msgRef, sendFd);
+
+    msgRef = le_msg_RequestSyncResponse(msgRef);
+    if (msgRef == NULL)
+    {
+        LE_ERROR("Log Ring request failed!");
+        fd_Close(wakeFd);
+        return;
+    }
+
+    // If the daemon doesn't store logs, there's no memfd in the response.
+    int memFd = le_msg_GetFd(msgRef);
+    le_msg_ReleaseMsg(msgRef);
+    if (memFd < 0)
+    {
+        fd_Close(wakeFd);
+        return;
+    }
+
+    struct stat st;
+    void* addr = MAP_FAILED;
+    if (fstat(memFd, &st) != 0)
+    {
+        LE_ERROR("Failed to stat Log Ring memfd (%m).");
+    }
+    else if (st.st_size <= (off_t)sizeof(logShm_RingHeader_t))
+    {
+        LE_ERROR("Log Ring memfd is too small (%lld bytes).", (long long)st.st_size);
+    }
+    else
+    {
+        addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+        if (addr == MAP_FAILED)
+        {
+            LE_ERROR("Failed to map Log Ring (%m).");
+        }
+    }
+    fd_Close(memFd);
+
+    if (addr == MAP_FAILED)
+    {
+        fd_Close(wakeFd);
+        return;
+    }
+
+    logShm_RingHeader_t* ringPtr = addr;
+    if (   (ringPtr->magic != LOG_SHM_RING_MAGIC)
+        || (ringPtr->dataSize + sizeof(logShm_RingHeader_t) > (size_t)st.st_size)
+        || ((ringPtr->dataSize & (ringPtr->dataSize - 1)) != 0)
+        || (ringPtr->dataSize < LOG_SHM_MAX_RECORD_BYTES) )
+    {
+        LE_ERROR("Log Ring has a bad header.");
+        munmap(addr, st.st_size);
+        fd_Close(wakeFd);
+        return;
+    }
+
+    LE_ASSERT(pthread_atfork(NULL, NULL, DisableInChild) == 0);
+
+    WakeFd = wakeFd;
+    RingDataPtr = (uint8_t*)(ringPtr + 1);
+    __atomic_store_n(&RingPtr, ringPtr, __ATOMIC_RELEASE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a formatted log message into the process's Log Ring.
+ *
+ * @return
+ *  - true if the message was taken care of (written, or dropped because the ring was full).
+ *  - false if there is no Log Ring, so the caller must write the message to the log itself.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logShm_Write
+(
+    le_log_Level_t level,           ///< [IN] Severity level (-1 if this is a trace).
+    const char* levelStrPtr,        ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,        ///< [IN] Name of the component that logged the message.
+    const char* threadNamePtr,      ///< [IN] Name of the thread that logged the message.
+    const char* baseFileNamePtr,    ///< [IN] Name of the source file (without its directory).
+    const char* functionNamePtr,    ///< [IN] Name of the function that logged the message.
+    unsigned int lineNumber,        ///< [IN] Line number in the source file.
+    time_t timestamp,               ///< [IN] Time the message was logged.
+    const char* msgPtr              ///< [IN] The formatted user message.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    logShm_RingHeader_t* ringPtr = __atomic_load_n(&RingPtr, __ATOMIC_ACQUIRE);
+
+    if (ringPtr == NULL)
+    {
+        return false;
+    }
+
+    // Work out how big the record is, truncating the strings to their limits.
+    size_t levelLen = strnlen(levelStrPtr, LIMIT_MAX_LOG_KEYWORD_LEN);
+    size_t compLen = strnlen(compNamePtr, LIMIT_MAX_COMPONENT_NAME_LEN);
+    size_t threadLen = strnlen(threadNamePtr, LIMIT_MAX_THREAD_NAME_LEN);
+    size_t fileLen = strnlen(baseFileNamePtr, MAX_SOURCE_NAME_BYTES - 1);
+    size_t funcLen = strnlen(functionNamePtr, MAX_SOURCE_NAME_BYTES - 1);
+    size_t msgLen = strnlen(msgPtr, LOG_MAX_MSG_SIZE - 1);
+
+    uint32_t recordSize = sizeof(logShm_RecordHeader_t)
+                        + levelLen + compLen + threadLen + fileLen + funcLen + msgLen + 6;
+    recordSize = (recordSize + 7) & ~7;
+
+    LE_ASSERT(recordSize <= LOG_SHM_MAX_RECORD_BYTES);
+
+    uint32_t dataSize = ringPtr->dataSize;
+
+    LE_ASSERT(pthread_mutex_lock(&Mutex) == 0);
+
+    uint32_t head = ringPtr->head;
+    uint32_t tail = __atomic_load_n(&ringPtr->tail, __ATOMIC_ACQUIRE);
+    uint32_t offset = head & (dataSize - 1);
+    uint32_t padSize = 0;
+
+    // A record never wraps around the end of the data area.
+    if (offset + recordSize > dataSize)
+    {
+        padSize = dataSize - offset;
+    }
+
+    if ((head - tail) + padSize + recordSize > dataSize)
+    {
+        __atomic_store_n(&ringPtr->droppedCount,
+                         ringPtr->droppedCount + 1,
+                         __ATOMIC_RELAXED);
+
+        LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
+
+        return true;
+    }
+
+    if (padSize != 0)
+    {
+        logShm_RecordHeader_t* padPtr = (logShm_RecordHeader_t*)(RingDataPtr + offset);
+        padPtr->size = padSize;
+        padPtr->type = LOG_SHM_RECORD_PAD;
+
+        head += padSize;
+        offset = 0;
+    }
+
+    logShm_RecordHeader_t* hdrPtr = (logShm_RecordHeader_t*)(RingDataPtr + offset);
+    hdrPtr->size = recordSize;
+    hdrPtr->type = LOG_SHM_RECORD_MSG;
+    hdrPtr->level = (int8_t)level;
+    hdrPtr->reserved = 0;
+    hdrPtr->lineNumber = lineNumber;
+    hdrPtr->reserved2 = 0;
+    hdrPtr->timestamp = timestamp;
+
+    uint8_t* strPtr = (uint8_t*)(hdrPtr + 1);
+    strPtr = CopyString(strPtr, levelStrPtr, levelLen);
+    strPtr = CopyString(strPtr, compNamePtr, compLen);
+    strPtr = CopyString(strPtr, threadNamePtr, threadLen);
+    strPtr = CopyString(strPtr, baseFileNamePtr, fileLen);
+    strPtr = CopyString(strPtr, functionNamePtr, funcLen);
+    CopyString(strPtr, msgPtr, msgLen);
+
+    __atomic_store_n(&ringPtr->head, head + recordSize, __ATOMIC_RELEASE);
+
+    LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
+
+    // The daemon sets consumerWaiting before it checks the head one last time, so either it sees
+    // the new record or this sees the flag.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (   __atomic_load_n(&ringPtr->consumerWaiting, __ATOMIC_RELAXED)
+        && __atomic_exchange_n(&ringPtr->consumerWaiting, 0, __ATOMIC_ACQ_REL) )
+    {
+        uint64_t count = 1;
+        ssize_t result;
+        do
+        {
+            result = write(WakeFd, &count, sizeof(count));
+        }
+        while ((result == -1) && (errno == EINTR));
+    }
+
+    return true;
+}
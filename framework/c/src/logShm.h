@@ -0,0 +1,54 @@
+/** @file logShm.h
+ *
+ * Log module's "Shared Memory Transport" inter-module interface definitions.
+ *
+ * When the Log Control Daemon has persistent log storage turned on, each process that connects
+ * to it gets a shared memory Log Ring (see logShm_RingHeader_t in logDaemon.h).  The process's
+ * log messages are then written into that ring rather than sent to syslog, and the Log Control
+ * Daemon stores them in its compressed log files.  Messages logged before the ring is set up
+ * (or when log storage is off) go to syslog as before.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_LOG_SHM_H_INCLUDE_GUARD
+#define LEGATO_LOG_SHM_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asks the Log Control Daemon for a Log Ring over the log client IPC session, and starts writing
+ * log messages into it if the daemon provides one.  Must be called only once, by
+ * log_ConnectToControlDaemon(), after the process's log sessions have been registered.
+ */
+//--------------------------------------------------------------------------------------------------
+void logShm_Open
+(
+    le_msg_SessionRef_t sessionRef      ///< [IN] Session with the Log Control Daemon.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a formatted log message into the process's Log Ring.
+ *
+ * @return
+ *  - true if the message was taken care of (written, or dropped because the ring was full).
+ *  - false if there is no Log Ring, so the caller must write the message to the log itself.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logShm_Write
+(
+    le_log_Level_t level,           ///< [IN] Severity level (-1 if this is a trace).
+    const char* levelStrPtr,        ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,        ///< [IN] Name of the component that logged the message.
+    const char* threadNamePtr,      ///< [IN] Name of the thread that logged the message.
+    const char* baseFileNamePtr,    ///< [IN] Name of the source file (without its directory).
+    const char* functionNamePtr,    ///< [IN] Name of the function that logged the message.
+    unsigned int lineNumber,        ///< [IN] Line number in the source file.
+    time_t timestamp,               ///< [IN] Time the message was logged.
+    const char* msgPtr              ///< [IN] The formatted user message.
+);
+
+
+#endif // LEGATO_LOG_SHM_H_INCLUDE_GUARD
@@ -30,6 +30,72 @@
  * delete a sub-pool while there are still blocks allocated from it.  The sub-pool itself is then
  * removed from the list of pools and released back into the pool of sub-pools.
  *
+ * THREAD CACHES
+ * =============
+ *
+ * Pools are normally protected by a single process-wide mutex.  A pool can optionally be given a
+ * per-thread cache (a "magazine") using le_mem_EnableThreadCache().  Each thread then keeps a
+ * small private stack of free blocks for that pool, so that allocating and releasing blocks
+ * doesn't need the mutex at all in the common case.  When a thread's cache runs empty, it is
+ * refilled with a batch of blocks taken from the pool's shared free list; when it grows beyond
+ * the configured size, a batch of blocks is flushed back to the shared free list.  Both of these
+ * are done with the mutex held.  When a thread dies, everything in its caches is flushed back to
+ * the shared free lists.
+ *
+ * Blocks sitting in a thread's cache are counted as free blocks, and the pool's statistics
+ * counters (and block reference counts) are updated using atomic operations, so the statistics
+ * remain accurate regardless of which path a block takes.
+ *
+ * Sub-pools can't have thread caches, because deleting a sub-pool requires all of its free
+ * blocks to be on its free list.
+ *
+ * SLAB POOLS
+ * ==========
+ *
+ * Pools created with le_mem_CreateSlabPool() don't get their blocks from malloc().  Instead, each
+ * expansion maps one large, contiguous "slab" of memory directly from the kernel and carves it up
+ * into blocks.  Slabs are made up of fixed-size "chunks" (SLAB_CHUNK_SIZE bytes) that are aligned
+ * on chunk-sized boundaries in memory, and each chunk starts with a small header that points to
+ * the pool.  This means the blocks in a slab don't need to carry a pool pointer; the pool is found
+ * by rounding the block's address down to the start of its chunk.  Free slab blocks also keep
+ * their free list link inside the (unused) user object area, so the only per-block overhead left
+ * is the reference count (plus the guard bands, if enabled).
+ *
+ * To tell the two kinds of blocks apart, the reference count is always placed immediately before
+ * the user object's data section, and slab blocks have the top bit of their reference count
+ * field set (SLAB_BLOCK_FLAG).
+ *
+ * Objects in a slab pool can optionally be aligned on CPU cache line boundaries, and the slabs can
+ * optionally be backed by (transparent) huge pages.  Slab pools can't have sub-pools.
+ *
+ * TRIMMING
+ * ========
+ *
+ * Because each slab is a separate memory mapping, a slab whose blocks are all free can be unmapped
+ * again.  le_mem_Trim() does this by counting the free blocks of each slab (by walking the pool's
+ * free list), removing the blocks of completely free slabs from the free list, and unmapping those
+ * slabs.  A pool is never trimmed below the number of blocks that were explicitly requested using
+ * le_mem_ExpandPool() (minBlocks), so only the growth caused by le_mem_ForceAlloc() is given back.
+ * Blocks held in thread caches are not on the free list, so their slabs are left alone.
+ *
+ * Blocks of normal pools are allocated from the heap in groups that can't be given back
+ * individually, so trimming has no effect on them.
+ *
+ * Pools can also be trimmed automatically: when a pool that has idle trimming enabled is expanded
+ * by le_mem_ForceAlloc(), a flag is set.  Event Loops check this flag before going to sleep and,
+ * if it is set, wait with a timeout instead of forever.  If the timeout expires without anything
+ * happening, the Event Loop calls mem_TrimIdlePools().
+ *
+ * VARIABLE-SIZE POOLS
+ * ===================
+ *
+ * A variable-size pool (le_mem_CreateVarPool()) is just an array of ordinary pools, one for each
+ * "size class".  Size classes start at VAR_POOL_MIN_CLASS_SIZE bytes and double in size up to the
+ * variable-size pool's maximum object size, which is always the size of the last class.
+ * Allocations are forwarded to the pool of the smallest class that fits.  Since the objects
+ * allocated are ordinary pool objects, they are released (and reference counted) the normal way,
+ * and each size class appears in the list of pools with its own statistics.
+ *
  * GUARD BANDS
  * ===========
  *
@@ -46,6 +112,8 @@
 #include "mem.h"
 #include "limit.h"
 
+#include <sys/mman.h>
+
 #define USE_GUARD_BAND
 #define FILL_DELETED_AND_CHECK_ALLOCATED
 
@@ -53,6 +121,13 @@
 #define GUARD_WORD ((uint32_t)0xDEADBEEF)
 #define GUARD_BAND_SIZE (sizeof(GUARD_WORD) * NUM_GUARD_BAND_WORDS)
 
+/// Offset of the user object from the start of a block's data section.
+#ifdef USE_GUARD_BAND
+    #define USER_DATA_OFFSET GUARD_BAND_SIZE
+#else
+    #define USER_DATA_OFFSET 0
+#endif
+
 
 /// The maximum total pool name size, including the component prefix, which is a component
 /// name plus a '.' separator ("myComp.myPool") and the null terminator.
@@ -62,6 +137,13 @@
 /// @todo Make this configurable.
 #define DEFAULT_SUB_POOLS_POOL_SIZE     8
 
+/// The object size of the smallest size class in a variable-size pool.
+#define VAR_POOL_MIN_CLASS_SIZE         16
+
+/// The maximum number of size classes in a variable-size pool (enough to double the class size
+/// until it reaches the largest possible object size).
+#define VAR_POOL_MAX_CLASSES            (sizeof(size_t) * 8)
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -71,6 +153,52 @@
 #define DEFAULT_NUM_BLOCKS_TO_FORCE     1
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The number of pools that a single thread can be caching blocks for at the same time.
+ *
+ * Cache slots are selected by hashing the pool's address.  If two cached pools used by the same
+ * thread hash to the same slot, the slot's blocks are flushed back to the old pool before the slot
+ * is handed over to the new pool.
+ */
+//--------------------------------------------------------------------------------------------------
+#define THREAD_CACHE_NUM_SLOTS          16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the chunks that slabs are made of.  Chunks are always aligned on a multiple of their
+ * size, so this must be a power of two (and a multiple of the page size).
+ */
+//--------------------------------------------------------------------------------------------------
+#define SLAB_CHUNK_SIZE                 (64 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * CPU cache line size that objects are aligned on in slab pools created with
+ * LE_MEM_SLAB_CACHE_ALIGNED.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CACHE_LINE_SIZE                 64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flag that is set in the reference count field of blocks that live in slabs.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SLAB_BLOCK_FLAG                 (((size_t)1) << ((sizeof(size_t) * 8) - 1))
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mask used to extract the reference count from a block's reference count field.
+ */
+//--------------------------------------------------------------------------------------------------
+#define REF_COUNT_MASK                  (~SLAB_BLOCK_FLAG)
+
+
 #ifdef LE_MEM_TRACE
     #undef le_mem_TryAlloc
     #undef le_mem_AssertAlloc
@@ -102,6 +230,7 @@ typedef struct
 
     size_t refCount;            ///< The number of external references to this memory block's
                                 ///     user object. (0 = free)
+                                ///  NOTE: Must immediately precede the data (see SLAB POOLS).
 
     uint8_t  data[];            ///< This block's data content (Has a guard band at the
                                 ///     start and end if USE_GUARD_BAND is defined).
@@ -109,6 +238,83 @@ typedef struct
 MemBlock_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header found at the start of every chunk of a slab.
+ *
+ * Slab blocks themselves consist of just a reference count (size_t), followed by the data section.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    MemPool_t*      poolPtr;        ///< The pool that the blocks in this chunk belong to.
+    struct Slab*    slabPtr;        ///< The slab that this chunk is part of.
+}
+SlabChunk_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header found at the start of every slab (in its first chunk).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct Slab
+{
+    SlabChunk_t     firstChunk;     ///< The first chunk's header.  NOTE: Must be first.
+    le_dls_Link_t   link;           ///< This slab's link in its pool's list of slabs.
+    size_t          numChunks;      ///< Number of chunks in the slab.
+    size_t          numBlocks;      ///< Number of blocks in the slab.
+    size_t          numFree;        ///< Number of free blocks in the slab (only valid while
+                                    ///  trimming).
+    bool            isReleasing;    ///< true if the slab is being unmapped (only valid while
+                                    ///  trimming).
+}
+Slab_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A slot in a thread's cache of free blocks.  Holds free blocks belonging to a single pool.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    MemPool_t*      poolPtr;        ///< The pool the cached blocks belong to (NULL = slot unused).
+    #ifndef LE_MEM_VALGRIND
+        le_sls_List_t freeList;     ///< List of free blocks held privately by the thread.
+    #endif
+    size_t          numBlocks;      ///< Number of blocks on the free list.
+}
+ThreadCacheSlot_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A thread's cache of free blocks.  One of these is allocated for each thread that allocates or
+ * releases blocks from a pool that has thread caching enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    ThreadCacheSlot_t slot[THREAD_CACHE_NUM_SLOTS];
+}
+ThreadCache_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Variable-size pool.  See the VARIABLE-SIZE POOLS section at the top of this file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_mem_VarPool
+{
+    size_t              numClasses;                         ///< Number of size classes.
+    le_mem_PoolRef_t    classPools[VAR_POOL_MAX_CLASSES];   ///< Pools for each size class, from
+                                                            ///  smallest to largest.
+}
+VarPool_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Local list of all memory pools created with le_mem_CreatePool and le_mem_CreateSubPool
@@ -135,6 +341,41 @@ static size_t* PoolListChangeCountRef = &PoolListChangeCount;
 static le_mem_PoolRef_t SubPoolsPool;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if a pool with idle trimming enabled has been expanded by le_mem_ForceAlloc() since the
+ * last time mem_TrimIdlePools() was called.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IdleTrimPending = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Local memory pool that is used for allocating variable-size pools.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t VarPoolsPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Local memory pool that is used for allocating thread caches.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t ThreadCachePool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key used to find the calling thread's cache of free blocks (ThreadCache_t).
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef LE_MEM_VALGRIND
+static pthread_key_t ThreadCacheKey;
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Pthreads fast mutex used to protect data structures in this module from multithreading races.
@@ -199,30 +440,181 @@ static inline void Unlock
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds to a pool's count of blocks in use, updating its high-water mark too.
+ *
+ * @note Safe to call with or without the mutex locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void AddBlocksInUse
+(
+    MemPool_t*  poolPtr,    ///< [IN] The pool.
+    size_t      numBlocks   ///< [IN] The number of blocks that went into use.
+)
+{
+    size_t numInUse = __atomic_add_fetch(&(poolPtr->numBlocksInUse), numBlocks, __ATOMIC_RELAXED);
+    size_t maxUsed = __atomic_load_n(&(poolPtr->maxNumBlocksUsed), __ATOMIC_RELAXED);
+
+    while (   (numInUse > maxUsed)
+           && !__atomic_compare_exchange_n(&(poolPtr->maxNumBlocksUsed),
+                                           &maxUsed,
+                                           numInUse,
+                                           true,
+                                           __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED) )
+    {
+        // maxUsed was refreshed by the failed compare-exchange.  Try again.
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Subtracts from a pool's count of blocks in use.
+ *
+ * @note Safe to call with or without the mutex locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void RemoveBlocksInUse
+(
+    MemPool_t*  poolPtr,    ///< [IN] The pool.
+    size_t      numBlocks   ///< [IN] The number of blocks that are no longer in use.
+)
+{
+    __atomic_sub_fetch(&(poolPtr->numBlocksInUse), numBlocks, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a pointer to the reference count field of the block that holds a given user object.
+ * This works for both normal blocks and slab blocks.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t* GetRefCountPtr
+(
+    void* objPtr    ///< [IN] Pointer to the user object.
+)
+{
+    return ((size_t*)(((uint8_t*)objPtr) - USER_DATA_OFFSET)) - 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the pool that a given user object belongs to.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline MemPool_t* GetObjectPool
+(
+    void* objPtr    ///< [IN] Pointer to the user object.
+)
+{
+    size_t* refCountPtr = GetRefCountPtr(objPtr);
+
+    if (__atomic_load_n(refCountPtr, __ATOMIC_RELAXED) & SLAB_BLOCK_FLAG)
+    {
+        SlabChunk_t* chunkPtr =
+                    (SlabChunk_t*)(((uintptr_t)refCountPtr) & ~((uintptr_t)SLAB_CHUNK_SIZE - 1));
+
+        return chunkPtr->poolPtr;
+    }
+
+    return CONTAINER_OF(refCountPtr, MemBlock_t, refCount)->poolPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a pointer to the start of the block that holds a given user object.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint8_t* GetBlockPtr
+(
+    MemPool_t*  poolPtr,    ///< [IN] The pool that the object belongs to.
+    void*       objPtr      ///< [IN] Pointer to the user object.
+)
+{
+    size_t* refCountPtr = GetRefCountPtr(objPtr);
+
+    if (poolPtr->isSlabPool)
+    {
+        return (uint8_t*)refCountPtr;
+    }
+
+    return (uint8_t*)CONTAINER_OF(refCountPtr, MemBlock_t, refCount);
+}
+
+
+#ifndef LE_MEM_VALGRIND
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Gets a pointer to the free list link of a free block, given a pointer to its user object.
+     * Slab blocks keep their link in the user object itself.
+     */
+    //----------------------------------------------------------------------------------------------
+    static inline le_sls_Link_t* GetFreeLinkPtr
+    (
+        MemPool_t*  poolPtr,    ///< [IN] The pool that the object belongs to.
+        void*       objPtr      ///< [IN] Pointer to the user object.
+    )
+    {
+        if (poolPtr->isSlabPool)
+        {
+            return objPtr;
+        }
+
+        return &(CONTAINER_OF(GetRefCountPtr(objPtr), MemBlock_t, refCount)->link);
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Gets a pointer to the user object of a free block, given a pointer to its free list link.
+     */
+    //----------------------------------------------------------------------------------------------
+    static inline void* GetFreeLinkObject
+    (
+        MemPool_t*      poolPtr,    ///< [IN] The pool that the block belongs to.
+        le_sls_Link_t*  linkPtr     ///< [IN] Pointer to the block's free list link.
+    )
+    {
+        if (poolPtr->isSlabPool)
+        {
+            return linkPtr;
+        }
+
+        return CONTAINER_OF(linkPtr, MemBlock_t, link)->data + USER_DATA_OFFSET;
+    }
+#endif
+
+
 #ifdef USE_GUARD_BAND
 
     //----------------------------------------------------------------------------------------------
     /**
-     * Initializes the guard bands in a memory block's data payload section.
+     * Initializes the guard bands around a user object.
      */
     //----------------------------------------------------------------------------------------------
     static void InitGuardBands
     (
-        MemBlock_t* blockHeaderPtr  // Pointer to the per-block overhead area of the memory block.
+        MemPool_t*  poolPtr,    // The pool the object belongs to.
+        void*       objPtr      // Pointer to the user object.
     )
     {
         int i;
 
-        // There's a guard band at the start of the data section.
-        uint32_t* guardBandWordPtr = (uint32_t*)(blockHeaderPtr->data);
+        // There's a guard band at the start of the data section, just before the user object.
+        uint32_t* guardBandWordPtr = (uint32_t*)(((uint8_t*)objPtr) - GUARD_BAND_SIZE);
         for (i = 0; i < NUM_GUARD_BAND_WORDS; i++, guardBandWordPtr++)
         {
             *guardBandWordPtr = GUARD_WORD;
         }
 
         // There's another guard band at the end of the data section.
-        guardBandWordPtr = (uint32_t*)(   ((uint8_t*)blockHeaderPtr)
-                                        + blockHeaderPtr->poolPtr->blockSize
+        guardBandWordPtr = (uint32_t*)(   GetBlockPtr(poolPtr, objPtr)
+                                        + poolPtr->blockSize
                                         - GUARD_BAND_SIZE );
         for (i = 0; i < NUM_GUARD_BAND_WORDS; i++, guardBandWordPtr++)
         {
@@ -232,18 +624,19 @@ static inline void Unlock
 
     //----------------------------------------------------------------------------------------------
     /**
-     * Checks the integrity of the guard bands in a memory block's data payload section.
+     * Checks the integrity of the guard bands around a user object.
      */
     //----------------------------------------------------------------------------------------------
     static void CheckGuardBands
     (
-        MemBlock_t* blockHeaderPtr  // Pointer to the per-block overhead area of the memory block.
+        MemPool_t*  poolPtr,    // The pool the object belongs to.
+        void*       objPtr      // Pointer to the user object.
     )
     {
         int i;
 
-        // There's a guard band at the start of the data section.
-        uint32_t* guardBandWordPtr = (uint32_t*)(blockHeaderPtr->data);
+        // There's a guard band at the start of the data section, just before the user object.
+        uint32_t* guardBandWordPtr = (uint32_t*)(((uint8_t*)objPtr) - GUARD_BAND_SIZE);
         for (i = 0; i < NUM_GUARD_BAND_WORDS; i++, guardBandWordPtr++)
         {
             if (*guardBandWordPtr != GUARD_WORD)
@@ -251,7 +644,7 @@ static inline void Unlock
                 LE_EMERG("Memory corruption detected at address %p before object allocated"
                                                                                 " from pool '%s'.",
                          guardBandWordPtr,
-                         blockHeaderPtr->poolPtr->name);
+                         poolPtr->name);
                 LE_FATAL("Guard band value should have been %d, but was found to be %d.",
                          GUARD_WORD,
                          *guardBandWordPtr);
@@ -259,8 +652,8 @@ static inline void Unlock
         }
 
         // There's another guard band at the end of the data section.
-        guardBandWordPtr = (uint32_t*)(   ((uint8_t*)blockHeaderPtr)
-                                        + blockHeaderPtr->poolPtr->blockSize
+        guardBandWordPtr = (uint32_t*)(   GetBlockPtr(poolPtr, objPtr)
+                                        + poolPtr->blockSize
                                         - GUARD_BAND_SIZE);
         for (i = 0; i < NUM_GUARD_BAND_WORDS; i++, guardBandWordPtr++)
         {
@@ -269,7 +662,7 @@ static inline void Unlock
                 LE_EMERG("Memory corruption detected at address %p at end of object allocated"
                                                                                 " from pool '%s'.",
                          guardBandWordPtr,
-                         blockHeaderPtr->poolPtr->name);
+                         poolPtr->name);
                 LE_FATAL("Guard band value should have been %d, but was found to be %d.",
                          GUARD_WORD,
                          *guardBandWordPtr);
@@ -336,6 +729,16 @@ static void InitPool
     pool->numBlocksInUse = 0;
     pool->maxNumBlocksUsed = 0;
     pool->numBlocksToForce = DEFAULT_NUM_BLOCKS_TO_FORCE;
+    pool->threadCacheSize = 0;
+    pool->isSlabPool = false;
+    pool->slabOptions = 0;
+    pool->slabBlockOffset = 0;
+    pool->blocksPerChunk = 0;
+    pool->slabList = LE_DLS_LIST_INIT;
+    pool->minBlocks = 0;
+    pool->idleTrim = false;
+    pool->isIdleTrimPending = false;
+    pool->numBytesReclaimed = 0;
 
     #ifdef LE_MEM_TRACE
         pool->memTrace = NULL;
@@ -408,26 +811,134 @@ static void MoveBlocks
 static void InitBlock
 (
     le_mem_PoolRef_t pool,       ///< [IN] The pool the new block belongs to.
-    MemBlock_t* newBlockPtr      ///< [IN] The block being initialized.
+    void* newBlockPtr            ///< [IN] The block being initialized.
 )
 {
+    void* objPtr;
+
     // Initialize the block.
-    #ifndef LE_MEM_VALGRIND
-        // Add the block to the pool's free list.
-        newBlockPtr->link = LE_SLS_LINK_INIT;
-        le_sls_Stack(&(pool->freeList), &(newBlockPtr->link));
-    #endif
+    if (pool->isSlabPool)
+    {
+        // Slab blocks only have a reference count, flagged to say that they live in a slab.
+        size_t* refCountPtr = newBlockPtr;
 
-    newBlockPtr->refCount = 0;
-    newBlockPtr->poolPtr = pool;
+        *refCountPtr = SLAB_BLOCK_FLAG;
+        objPtr = ((uint8_t*)(refCountPtr + 1)) + USER_DATA_OFFSET;
+    }
+    else
+    {
+        MemBlock_t* blockPtr = newBlockPtr;
+
+        blockPtr->refCount = 0;
+        blockPtr->poolPtr = pool;
+        objPtr = blockPtr->data + USER_DATA_OFFSET;
+    }
 
     #ifdef USE_GUARD_BAND
-        InitGuardBands(newBlockPtr);
+        InitGuardBands(pool, objPtr);
+    #endif
+
+    #ifndef LE_MEM_VALGRIND
+        // Add the block to the pool's free list.
+        le_sls_Link_t* linkPtr = GetFreeLinkPtr(pool, objPtr);
+        *linkPtr = LE_SLS_LINK_INIT;
+        le_sls_Stack(&(pool->freeList), linkPtr);
+    #else
+        (void)objPtr;
     #endif
 }
 
 
 #ifndef LE_MEM_VALGRIND
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Maps a new slab and adds its blocks to a slab pool.
+     *
+     * @note
+     *      Updates the pools total number of blocks.
+     *
+     * @note
+     *      Assumes that the mutex is locked.
+     */
+    //----------------------------------------------------------------------------------------------
+    static void AddSlab
+    (
+        le_mem_PoolRef_t    pool,       ///< [IN] The slab pool to be expanded.
+        size_t              numBlocks   ///< [IN] The minimum number of blocks to add to the pool.
+    )
+    {
+        size_t numChunks = (numBlocks + pool->blocksPerChunk - 1) / pool->blocksPerChunk;
+        size_t slabSize = numChunks * SLAB_CHUNK_SIZE;
+        size_t i;
+        size_t j;
+
+        // Map an extra chunk's worth of memory so that the slab can be aligned on a chunk boundary,
+        // then give back the unused memory before and after the slab.
+        size_t mapSize = slabSize + SLAB_CHUNK_SIZE;
+        uint8_t* mapPtr = mmap(NULL,
+                               mapSize,
+                               PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS,
+                               -1,
+                               0);
+
+        LE_FATAL_IF(mapPtr == MAP_FAILED,
+                    "Failed to map %zu bytes for memory pool '%s' (%m).",
+                    mapSize,
+                    pool->name);
+
+        uint8_t* slabPtr = (uint8_t*)(   (((uintptr_t)mapPtr) + SLAB_CHUNK_SIZE - 1)
+                                       & ~((uintptr_t)SLAB_CHUNK_SIZE - 1) );
+
+        if (slabPtr > mapPtr)
+        {
+            LE_ASSERT(munmap(mapPtr, slabPtr - mapPtr) == 0);
+        }
+        if ((mapPtr + mapSize) > (slabPtr + slabSize))
+        {
+            LE_ASSERT(munmap(slabPtr + slabSize, (mapPtr + mapSize) - (slabPtr + slabSize)) == 0);
+        }
+
+        #ifdef MADV_HUGEPAGE
+            if (pool->slabOptions & LE_MEM_SLAB_HUGE_PAGES)
+            {
+                // This is only a hint, so it doesn't matter if the kernel can't do it.
+                if (madvise(slabPtr, slabSize, MADV_HUGEPAGE) != 0)
+                {
+                    LE_DEBUG("Huge pages not available for memory pool '%s' (%m).", pool->name);
+                }
+            }
+        #endif
+
+        // Fill in the slab header (mmap() gives us zeroed memory).
+        Slab_t* newSlabPtr = (Slab_t*)slabPtr;
+        newSlabPtr->link = LE_DLS_LINK_INIT;
+        newSlabPtr->numChunks = numChunks;
+        newSlabPtr->numBlocks = numChunks * pool->blocksPerChunk;
+        le_dls_Queue(&(pool->slabList), &(newSlabPtr->link));
+
+        // Set up each chunk's header and carve the chunk up into blocks.
+        for (i = 0; i < numChunks; i++)
+        {
+            uint8_t* chunkPtr = slabPtr + (i * SLAB_CHUNK_SIZE);
+
+            ((SlabChunk_t*)chunkPtr)->poolPtr = pool;
+            ((SlabChunk_t*)chunkPtr)->slabPtr = newSlabPtr;
+
+            uint8_t* blockPtr = chunkPtr + pool->slabBlockOffset;
+
+            for (j = 0; j < pool->blocksPerChunk; j++)
+            {
+                InitBlock(pool, blockPtr);
+                blockPtr += pool->blockSize;
+            }
+        }
+
+        // Update the pool.
+        pool->totalBlocks += newSlabPtr->numBlocks;
+    }
+
+
     //----------------------------------------------------------------------------------------------
     /**
      * Creates blocks and adds them to the pool.
@@ -436,6 +947,10 @@ static void InitBlock
      *      Updates the pools total number of blocks.
      *
      * @note
+     *      Slab pools are expanded by a whole number of slab chunks, so they may get more blocks
+     *      than were asked for.
+     *
+     * @note
      *      Assumes that the mutex is locked.
      */
     //----------------------------------------------------------------------------------------------
@@ -445,24 +960,295 @@ static void InitBlock
         size_t              numBlocks   ///< [IN] The number of blocks to add to the pool.
     )
     {
+        if (pool->isSlabPool)
+        {
+            AddSlab(pool, numBlocks);
+            return;
+        }
+
         size_t i;
         size_t blockSize = pool->blockSize;
         size_t mallocSize = numBlocks * blockSize;
 
         // Allocate the chunk.
-        MemBlock_t* newBlockPtr = malloc(mallocSize);
+        uint8_t* newBlockPtr = malloc(mallocSize);
 
         LE_ASSERT(newBlockPtr);
 
         for (i = 0; i < numBlocks; i++)
         {
             InitBlock(pool, newBlockPtr);
-            newBlockPtr = (MemBlock_t*)(((uint8_t*)newBlockPtr) + blockSize);
+            newBlockPtr += blockSize;
         }
 
         // Update the pool.
         pool->totalBlocks += numBlocks;
     }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Gets the slab that a slab block belongs to, given a pointer to its user object.
+     */
+    //----------------------------------------------------------------------------------------------
+    static inline Slab_t* GetObjectSlab
+    (
+        void*   objPtr  ///< [IN] Pointer to the user object.
+    )
+    {
+        SlabChunk_t* chunkPtr = (SlabChunk_t*)(   ((uintptr_t)objPtr)
+                                                & ~((uintptr_t)SLAB_CHUNK_SIZE - 1) );
+
+        return chunkPtr->slabPtr;
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Unmaps the slabs of a slab pool whose blocks are all free, without shrinking the pool below
+     * its minimum number of blocks.
+     *
+     * @return
+     *      The number of bytes given back to the OS.
+     *
+     * @note
+     *      Assumes that the mutex is locked.
+     */
+    //----------------------------------------------------------------------------------------------
+    static size_t TrimSlabs
+    (
+        le_mem_PoolRef_t    pool    ///< [IN] The slab pool to be trimmed.
+    )
+    {
+        le_dls_Link_t* slabLinkPtr;
+        le_sls_Link_t* freeLinkPtr;
+        size_t numSlabsToRelease = 0;
+        bool isSlabInUse = false;
+
+        // Count the free blocks in each slab.
+        slabLinkPtr = le_dls_Peek(&(pool->slabList));
+        while (slabLinkPtr != NULL)
+        {
+            Slab_t* slabPtr = CONTAINER_OF(slabLinkPtr, Slab_t, link);
+            slabPtr->numFree = 0;
+            slabPtr->isReleasing = false;
+
+            slabLinkPtr = le_dls_PeekNext(&(pool->slabList), slabLinkPtr);
+        }
+
+        freeLinkPtr = le_sls_Peek(&(pool->freeList));
+        while (freeLinkPtr != NULL)
+        {
+            GetObjectSlab(GetFreeLinkObject(pool, freeLinkPtr))->numFree++;
+
+            freeLinkPtr = le_sls_PeekNext(&(pool->freeList), freeLinkPtr);
+        }
+
+        // Pick the completely free slabs to release, starting with the newest ones, as long as
+        // that leaves the pool with at least its minimum number of blocks.
+        slabLinkPtr = le_dls_PeekTail(&(pool->slabList));
+        while (slabLinkPtr != NULL)
+        {
+            Slab_t* slabPtr = CONTAINER_OF(slabLinkPtr, Slab_t, link);
+
+            if (   (slabPtr->numFree == slabPtr->numBlocks)
+                && ((pool->totalBlocks - slabPtr->numBlocks) >= pool->minBlocks) )
+            {
+                slabPtr->isReleasing = true;
+                pool->totalBlocks -= slabPtr->numBlocks;
+                numSlabsToRelease++;
+            }
+            else if ((pool->totalBlocks - slabPtr->numBlocks) >= pool->minBlocks)
+            {
+                isSlabInUse = true;
+            }
+
+            slabLinkPtr = le_dls_PeekPrev(&(pool->slabList), slabLinkPtr);
+        }
+
+        // The pool still needs trimming at idle time if slabs that could otherwise be released
+        // have blocks in use.
+        pool->isIdleTrimPending = pool->isIdleTrimPending && isSlabInUse;
+
+        if (numSlabsToRelease == 0)
+        {
+            return 0;
+        }
+
+        // Take the blocks of the released slabs off the free list, keeping the others in order.
+        le_sls_List_t keptList = LE_SLS_LIST_INIT;
+
+        while ((freeLinkPtr = le_sls_Pop(&(pool->freeList))) != NULL)
+        {
+            if (!GetObjectSlab(GetFreeLinkObject(pool, freeLinkPtr))->isReleasing)
+            {
+                le_sls_Queue(&keptList, freeLinkPtr);
+            }
+        }
+
+        pool->freeList = keptList;
+
+        // Give the released slabs back to the OS.
+        size_t numBytes = 0;
+
+        slabLinkPtr = le_dls_Peek(&(pool->slabList));
+        while (slabLinkPtr != NULL)
+        {
+            Slab_t* slabPtr = CONTAINER_OF(slabLinkPtr, Slab_t, link);
+
+            slabLinkPtr = le_dls_PeekNext(&(pool->slabList), slabLinkPtr);
+
+            if (slabPtr->isReleasing)
+            {
+                size_t slabSize = slabPtr->numChunks * SLAB_CHUNK_SIZE;
+
+                le_dls_Remove(&(pool->slabList), &(slabPtr->link));
+
+                LE_ASSERT(munmap(slabPtr, slabSize) == 0);
+
+                numBytes += slabSize;
+            }
+        }
+
+        pool->numBytesReclaimed += numBytes;
+
+        return numBytes;
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Moves blocks from a thread cache slot back onto its pool's shared free list.
+     *
+     * @note
+     *      Locks the mutex.
+     */
+    //----------------------------------------------------------------------------------------------
+    static void FlushCacheSlot
+    (
+        ThreadCacheSlot_t*  slotPtr,    ///< [IN] The cache slot to flush.
+        size_t              numToKeep   ///< [IN] Number of blocks to leave in the cache slot.
+    )
+    {
+        MemPool_t* poolPtr = slotPtr->poolPtr;
+
+        Lock();
+
+        while (slotPtr->numBlocks > numToKeep)
+        {
+            le_sls_Stack(&(poolPtr->freeList), le_sls_Pop(&(slotPtr->freeList)));
+            slotPtr->numBlocks--;
+        }
+
+        Unlock();
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Refills an empty thread cache slot with a batch of blocks from its pool's shared free list.
+     * Half of the pool's thread cache size is moved, or fewer if the shared free list doesn't
+     * have that many.
+     *
+     * @note
+     *      Locks the mutex.
+     */
+    //----------------------------------------------------------------------------------------------
+    static void RefillCacheSlot
+    (
+        ThreadCacheSlot_t*  slotPtr     ///< [IN] The cache slot to refill.
+    )
+    {
+        MemPool_t* poolPtr = slotPtr->poolPtr;
+
+        Lock();
+
+        size_t numToMove = (poolPtr->threadCacheSize + 1) / 2;
+
+        while (slotPtr->numBlocks < numToMove)
+        {
+            le_sls_Link_t* blockLinkPtr = le_sls_Pop(&(poolPtr->freeList));
+
+            if (blockLinkPtr == NULL)
+            {
+                break;
+            }
+
+            le_sls_Stack(&(slotPtr->freeList), blockLinkPtr);
+            slotPtr->numBlocks++;
+        }
+
+        Unlock();
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Destructor for thread caches.  Called automatically when a thread that has a thread cache
+     * dies.  Flushes all the cached blocks back to their pools and releases the cache.
+     */
+    //----------------------------------------------------------------------------------------------
+    static void DeleteThreadCache
+    (
+        void* cachePtr  ///< [IN] Pointer to the thread's cache (ThreadCache_t).
+    )
+    {
+        ThreadCache_t* threadCachePtr = cachePtr;
+        size_t i;
+
+        for (i = 0; i < THREAD_CACHE_NUM_SLOTS; i++)
+        {
+            if (threadCachePtr->slot[i].poolPtr != NULL)
+            {
+                FlushCacheSlot(&(threadCachePtr->slot[i]), 0);
+            }
+        }
+
+        le_mem_Release(threadCachePtr);
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Gets the calling thread's cache slot for a given pool, creating the thread's cache if
+     * the thread doesn't have one yet.  If the slot is being used for a different pool, that
+     * pool's blocks are flushed out of it first.
+     *
+     * @return Pointer to the cache slot.
+     */
+    //----------------------------------------------------------------------------------------------
+    static ThreadCacheSlot_t* GetThreadCacheSlot
+    (
+        MemPool_t*  poolPtr     ///< [IN] The pool.
+    )
+    {
+        ThreadCache_t* threadCachePtr = pthread_getspecific(ThreadCacheKey);
+
+        if (threadCachePtr == NULL)
+        {
+            threadCachePtr = le_mem_ForceAlloc(ThreadCachePool);
+            memset(threadCachePtr, 0, sizeof(*threadCachePtr));
+
+            LE_ASSERT(pthread_setspecific(ThreadCacheKey, threadCachePtr) == 0);
+        }
+
+        // Pools are allocated on at least 8 byte boundaries, so drop the low bits of the address.
+        ThreadCacheSlot_t* slotPtr =
+                        &(threadCachePtr->slot[((uintptr_t)poolPtr >> 3) % THREAD_CACHE_NUM_SLOTS]);
+
+        if (slotPtr->poolPtr != poolPtr)
+        {
+            if (slotPtr->poolPtr != NULL)
+            {
+                FlushCacheSlot(slotPtr, 0);
+            }
+
+            slotPtr->poolPtr = poolPtr;
+            slotPtr->freeList = LE_SLS_LIST_INIT;
+        }
+
+        return slotPtr;
+    }
 #endif
 
 
@@ -516,6 +1302,16 @@ void mem_Init
     // Create a memory for all sub-pools.
     SubPoolsPool = le_mem_CreatePool("SubPools", sizeof(MemPool_t));
     le_mem_ExpandPool(SubPoolsPool, DEFAULT_SUB_POOLS_POOL_SIZE);
+
+    // Create a memory pool for all variable-size pools.
+    VarPoolsPool = le_mem_CreatePool("VarPools", sizeof(VarPool_t));
+
+    // Create the pool of per-thread block caches and the thread-local data key used to find them.
+    ThreadCachePool = le_mem_CreatePool("ThreadCaches", sizeof(ThreadCache_t));
+
+    #ifndef LE_MEM_VALGRIND
+        LE_ASSERT(pthread_key_create(&ThreadCacheKey, DeleteThreadCache) == 0);
+    #endif
 }
 
 
@@ -530,22 +1326,13 @@ void mem_Init
         void*   objPtr  ///< [IN] Pointer to the object we're finding a pool for.
     )
     {
-        MemBlock_t* blockPtr;
-
-        // Get the block from the object pointer.
-        #ifdef USE_GUARD_BAND
-            uint8_t* dataPtr = objPtr;
-            dataPtr -= GUARD_BAND_SIZE;
-            blockPtr = CONTAINER_OF(dataPtr, MemBlock_t, data);
-        #else
-            blockPtr = CONTAINER_OF(objPtr, MemBlock_t, data);
-        #endif
+        MemPool_t* poolPtr = GetObjectPool(objPtr);
 
         #ifdef USE_GUARD_BAND
-            CheckGuardBands(blockPtr);
+            CheckGuardBands(poolPtr, objPtr);
         #endif
 
-        return blockPtr->poolPtr;
+        return poolPtr;
     }
 
 
@@ -655,25 +1442,111 @@ le_mem_PoolRef_t _le_mem_CreatePool
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Expands the size of a memory pool.
+ * Creates an empty slab pool.  See @ref mem_slab_pools for more information.
  *
- * @return  A reference to the memory pool object (the same value passed into it).
+ * @return
+ *      A reference to the memory pool object.
  *
- * @note    On failure, the process exits, so you don't have to worry about checking the returned
- *          reference for validity.
+ * @note
+ *      On failure, the process exits, so you don't have to worry about checking the returned
+ *      reference for validity.
  */
 //--------------------------------------------------------------------------------------------------
-le_mem_PoolRef_t le_mem_ExpandPool
+le_mem_PoolRef_t _le_mem_CreateSlabPool
 (
-    le_mem_PoolRef_t    pool,       ///< [IN] The pool to be expanded.
-    size_t              numObjects  ///< [IN] The number of objects to add to the pool.
+    const char*     componentName,  ///< [IN] Name of the component.
+    const char*     name,           ///< [IN] Name of the pool inside the component.
+    size_t          objSize,        ///< [IN] The size of the individual objects to be allocated
+                                    ///       from this pool (in bytes).
+    uint32_t        options         ///< [IN] Bit mask of LE_MEM_SLAB_xxx options.
 )
 {
+    le_mem_PoolRef_t newPool = malloc(sizeof(MemPool_t));
+
+    // Crash if we can't create the memory pool.
+    LE_ASSERT(newPool);
+
+    // Initialize the memory pool.
+    InitPool(newPool, componentName, name, objSize);
+
     #ifndef LE_MEM_VALGRIND
-        LE_ASSERT(pool);
+    {
+        // Free slab blocks keep their free list link in the user object part of the block,
+        // so the user object part must be big enough to hold one.
+        size_t dataSize = objSize;
+        if (dataSize < sizeof(le_sls_Link_t))
+        {
+            dataSize = sizeof(le_sls_Link_t);
+        }
+
+        // The block holds only a reference count, the guard bands, and the user object.
+        size_t headerSize = sizeof(size_t) + USER_DATA_OFFSET;
+        size_t blockSize = headerSize + dataSize + USER_DATA_OFFSET;
+
+        // Objects are aligned on cache line boundaries, if requested, otherwise on the processor
+        // word size.  Either way, all the blocks are the same size, so every object in a chunk is
+        // aligned if the first one is.
+        size_t alignment = (options & LE_MEM_SLAB_CACHE_ALIGNED) ? CACHE_LINE_SIZE : sizeof(void*);
+        blockSize = ((blockSize + alignment - 1) / alignment) * alignment;
+
+        // Leave room for the slab header at the start of each chunk.
+        size_t firstObjOffset = ((sizeof(Slab_t) + headerSize + alignment - 1) / alignment)
+                                                                                        * alignment;
+
+        newPool->isSlabPool = true;
+        newPool->slabOptions = options;
+        newPool->blockSize = blockSize;
+        newPool->slabBlockOffset = firstObjOffset - headerSize;
+        newPool->blocksPerChunk = (SLAB_CHUNK_SIZE - newPool->slabBlockOffset) / blockSize;
+
+        LE_FATAL_IF(newPool->blocksPerChunk == 0,
+                    "Objects of %zu bytes are too big for slab pool '%s'.",
+                    objSize,
+                    newPool->name);
+    }
+    #else
+        // Slab pools are just normal pools when pools are disabled.
+        (void)options;
+    #endif
+
+    Lock();
 
+    // Generate an error if there are multiple pools with the same name.
+    VerifyUniquenessOfName(newPool);
+
+    // Add the new pool to the list of pools.
+    PoolListChangeCount++;
+    le_dls_Queue(&PoolList, &(newPool->poolLink));
+
+    Unlock();
+
+    return newPool;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expands the size of a memory pool.
+ *
+ * @note    Locks the mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExpandPool
+(
+    le_mem_PoolRef_t    pool,       ///< [IN] The pool to be expanded.
+    size_t              numObjects, ///< [IN] The number of objects to add to the pool.
+    bool                isForced    ///< [IN] true if le_mem_ForceAlloc() is expanding the pool,
+                                    ///       false if the pool's owner asked for the objects.
+)
+{
+    #ifndef LE_MEM_VALGRIND
         Lock();
 
+        if (!isForced)
+        {
+            pool->minBlocks += numObjects;
+        }
+
         if (pool->superPoolPtr)
         {
             // This is a sub-pool so the memory blocks to create must come from the super-pool.
@@ -693,12 +1566,7 @@ le_mem_PoolRef_t le_mem_ExpandPool
             pool->totalBlocks = pool->totalBlocks + numObjects;
 
             // Update the super-pool's block use counts.
-            pool->superPoolPtr->numBlocksInUse += numObjects;
-
-            if (pool->superPoolPtr->numBlocksInUse > pool->superPoolPtr->maxNumBlocksUsed)
-            {
-                pool->superPoolPtr->maxNumBlocksUsed = pool->superPoolPtr->numBlocksInUse;
-            }
+            AddBlocksInUse(pool->superPoolPtr, numObjects);
         }
         else
         {
@@ -706,8 +1574,34 @@ le_mem_PoolRef_t le_mem_ExpandPool
             AddBlocks(pool, numObjects);
         }
 
-        Unlock();
-    #endif
+        Unlock();
+    #else
+        (void)pool;
+        (void)numObjects;
+        (void)isForced;
+    #endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expands the size of a memory pool.
+ *
+ * @return  A reference to the memory pool object (the same value passed into it).
+ *
+ * @note    On failure, the process exits, so you don't have to worry about checking the returned
+ *          reference for validity.
+ */
+//--------------------------------------------------------------------------------------------------
+le_mem_PoolRef_t le_mem_ExpandPool
+(
+    le_mem_PoolRef_t    pool,       ///< [IN] The pool to be expanded.
+    size_t              numObjects  ///< [IN] The number of objects to add to the pool.
+)
+{
+    LE_ASSERT(pool);
+
+    ExpandPool(pool, numObjects, false);
 
     return pool;
 }
@@ -729,53 +1623,65 @@ void* le_mem_TryAlloc
 {
     LE_ASSERT(pool != NULL);
 
-    MemBlock_t* blockPtr = NULL;
     void* userPtr = NULL;
 
-    Lock();
-
     #ifndef LE_MEM_VALGRIND
-        // Pop a link off the pool.
-        le_sls_Link_t* blockLinkPtr = le_sls_Pop(&(pool->freeList));
+        le_sls_Link_t* blockLinkPtr;
+
+        if (pool->threadCacheSize != 0)
+        {
+            // Pop a link off the calling thread's cache, refilling the cache if it is empty.
+            ThreadCacheSlot_t* slotPtr = GetThreadCacheSlot(pool);
+
+            if (slotPtr->numBlocks == 0)
+            {
+                RefillCacheSlot(slotPtr);
+            }
+
+            blockLinkPtr = le_sls_Pop(&(slotPtr->freeList));
+
+            if (blockLinkPtr != NULL)
+            {
+                slotPtr->numBlocks--;
+            }
+        }
+        else
+        {
+            // Pop a link off the pool.
+            Lock();
+            blockLinkPtr = le_sls_Pop(&(pool->freeList));
+            Unlock();
+        }
 
         if (blockLinkPtr != NULL)
         {
-            // Get the block from the block link.
-            blockPtr = CONTAINER_OF(blockLinkPtr, MemBlock_t, link);
+            // Get the user object from the block link.
+            userPtr = GetFreeLinkObject(pool, blockLinkPtr);
         }
     #else
-        blockPtr = malloc(pool->blockSize);
+        MemBlock_t* blockPtr = malloc(pool->blockSize);
 
         if (blockPtr != NULL)
         {
             InitBlock(pool, blockPtr);
+            userPtr = blockPtr->data + USER_DATA_OFFSET;
         }
     #endif
 
-    if (blockPtr != NULL)
+    if (userPtr != NULL)
     {
-        // Update the pool and the block.
-        pool->numAllocations++;
-        pool->numBlocksInUse++;
-
-        if (pool->numBlocksInUse > pool->maxNumBlocksUsed)
-        {
-            pool->maxNumBlocksUsed = pool->numBlocksInUse;
-        }
+        // Update the pool and the block (keeping the block's slab flag).
+        __atomic_add_fetch(&(pool->numAllocations), 1, __ATOMIC_RELAXED);
+        AddBlocksInUse(pool, 1);
 
-        blockPtr->refCount = 1;
+        size_t* refCountPtr = GetRefCountPtr(userPtr);
+        *refCountPtr = (*refCountPtr & SLAB_BLOCK_FLAG) | 1;
 
-        // Return the user object in the block.
         #ifdef USE_GUARD_BAND
-            CheckGuardBands(blockPtr);
-            userPtr = blockPtr->data + GUARD_BAND_SIZE;
-        #else
-            userPtr = blockPtr->data;
+            CheckGuardBands(pool, userPtr);
         #endif
     }
 
-    Unlock();
-
     return userPtr;
 }
 
@@ -830,11 +1736,18 @@ void* le_mem_ForceAlloc
         while ((objPtr = le_mem_TryAlloc(pool)) == NULL)
         {
             // Expand the pool.
-            le_mem_ExpandPool(pool, pool->numBlocksToForce);
+            ExpandPool(pool, pool->numBlocksToForce, true);
 
             Lock();
             pool->numOverflows++;
 
+            // Let the Event Loop know it should trim this pool once things settle down.
+            if (pool->idleTrim)
+            {
+                pool->isIdleTrimPending = true;
+                IdleTrimPending = true;
+            }
+
             // log a warning.
             LE_DEBUG("Memory pool '%s' overflowed. Expanded to %zu blocks.",
                     pool->name,
@@ -876,6 +1789,44 @@ void le_mem_SetNumObjsToForce
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enables per-thread caching of free objects for a given pool.
+ *
+ * See @ref mem_thread_caches for more information.
+ *
+ * @return
+ *      Nothing.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_mem_EnableThreadCache
+(
+    le_mem_PoolRef_t    pool,       ///< [IN] The pool.
+    size_t              numObjects  ///< [IN] The maximum number of free objects that each thread
+                                    ///       may keep in its cache for this pool.
+)
+{
+    LE_ASSERT(pool != NULL);
+    LE_ASSERT(numObjects != 0);
+
+    LE_FATAL_IF(pool->superPoolPtr != NULL,
+                "Sub-pool '%s' can't have a thread cache.",
+                pool->name);
+
+    #ifndef LE_MEM_VALGRIND
+        Lock();
+
+        LE_FATAL_IF(pool->threadCacheSize != 0,
+                    "Thread cache already enabled for pool '%s'.",
+                    pool->name);
+
+        pool->threadCacheSize = numObjects;
+
+        Unlock();
+    #endif
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Releases an object.  If the object's reference count has reached zero, it will be destructed
@@ -896,59 +1847,69 @@ void le_mem_Release
     void*   objPtr  ///< [IN] Pointer to the object to be released.
 )
 {
-    MemBlock_t* blockPtr;
-
-    // Get the block from the object pointer.
-    #ifdef USE_GUARD_BAND
-        uint8_t* dataPtr = objPtr;
-        dataPtr -= GUARD_BAND_SIZE;
-        blockPtr = CONTAINER_OF(dataPtr, MemBlock_t, data);
-    #else
-        blockPtr = CONTAINER_OF(objPtr, MemBlock_t, data);
-    #endif
+    // Get the block's reference count and pool from the object pointer.
+    size_t* refCountPtr = GetRefCountPtr(objPtr);
+    MemPool_t* poolPtr = GetObjectPool(objPtr);
 
     #ifdef USE_GUARD_BAND
-        CheckGuardBands(blockPtr);
+        CheckGuardBands(poolPtr, objPtr);
     #endif
 
-    Lock();
-
-    switch (blockPtr->refCount)
+    // Atomically drop the reference count, checking what it was before.
+    switch (__atomic_fetch_sub(refCountPtr, 1, __ATOMIC_ACQ_REL) & REF_COUNT_MASK)
     {
         case 1:
         {
-            MemPool_t* poolPtr = blockPtr->poolPtr;
-
             // The reference count has reached zero.
-            blockPtr->refCount = 0;
-
             // Call the destructor, if there is one.
-            if (poolPtr->destructor)
+            // Note that the mutex is not held, so the destructor is free to use the memory pools.
+            le_mem_Destructor_t destructor = poolPtr->destructor;
+            if (destructor)
             {
-                // Make sure that the destructor is not called with the mutex locked, because
-                // it is not a recursive mutex and therefore will deadlock if locked again by
-                // the same thread.  Also, fetch the destructor function address before unlocking
-                // the mutex so that we don't touch the pool object while the mutex is unlocked.
-                le_mem_Destructor_t destructor = poolPtr->destructor;
-                Unlock();
                 destructor(objPtr);
-
-                // Re-lock the mutex now so that it is safe to access the pool object again.
-                Lock();
             }
 
+            // Take the block out of the in-use count before it goes back on a free list.  Once
+            // it's there, another thread can allocate it and count it again, which would push the
+            // count (and its high-water mark) over the real number of blocks in use.
+            RemoveBlocksInUse(poolPtr, 1);
+
             #ifndef LE_MEM_VALGRIND
                 // Release the memory back into the pool.
                 // Note that we don't do this before calling the destructor because the destructor
                 // still needs to access it, but after it goes back on the free list, it could get
                 // reallocated by another thread (or even the destructor itself) and have its
                 // contents clobbered.
-                le_sls_Stack(&(poolPtr->freeList), &(blockPtr->link));
+                if (poolPtr->threadCacheSize != 0)
+                {
+                    // Put it in the calling thread's cache, flushing half the cache back to the
+                    // pool if the cache is now over-full.
+                    ThreadCacheSlot_t* slotPtr = GetThreadCacheSlot(poolPtr);
+
+                    le_sls_Stack(&(slotPtr->freeList), GetFreeLinkPtr(poolPtr, objPtr));
+                    slotPtr->numBlocks++;
+
+                    if (slotPtr->numBlocks > poolPtr->threadCacheSize)
+                    {
+                        FlushCacheSlot(slotPtr, poolPtr->threadCacheSize / 2);
+                    }
+                }
+                else
+                {
+                    Lock();
+                    le_sls_Stack(&(poolPtr->freeList), GetFreeLinkPtr(poolPtr, objPtr));
+                    Unlock();
+                }
             #else
-                free(blockPtr);
+                free(GetBlockPtr(poolPtr, objPtr));
             #endif
 
-            poolPtr->numBlocksInUse--;
+            // If the last idle-time trim couldn't shrink this pool back down because some of its
+            // blocks were in use, try again the next time the thread goes idle.
+            if (__atomic_load_n(&poolPtr->isIdleTrimPending, __ATOMIC_RELAXED))
+            {
+                __atomic_store_n(&IdleTrimPending, true, __ATOMIC_RELAXED);
+            }
 
             break;
         }
@@ -956,14 +1917,13 @@ void le_mem_Release
         case 0:
             LE_EMERG("Releasing free block.");
             LE_FATAL("Free block released from pool %p (%s).",
-                     blockPtr->poolPtr,
-                     blockPtr->poolPtr->name);
+                     poolPtr,
+                     poolPtr->name);
 
         default:
-            blockPtr->refCount--;
+            // Other references remain.
+            break;
     }
-
-    Unlock();
 }
 
 
@@ -982,22 +1942,13 @@ void le_mem_AddRef
     void*   objPtr  ///< [IN] Pointer to the object.
 )
 {
-    #ifdef USE_GUARD_BAND
-        objPtr = (((uint8_t*)objPtr) - GUARD_BAND_SIZE);
-    #endif
-    MemBlock_t* memBlockPtr = CONTAINER_OF(objPtr, MemBlock_t, data);
+    size_t* refCountPtr = GetRefCountPtr(objPtr);
 
     #ifdef USE_GUARD_BAND
-        CheckGuardBands(memBlockPtr);
+        CheckGuardBands(GetObjectPool(objPtr), objPtr);
     #endif
 
-    Lock();
-
-    LE_ASSERT(memBlockPtr->refCount != 0);
-
-    memBlockPtr->refCount++;
-
-    Unlock();
+    LE_ASSERT((__atomic_fetch_add(refCountPtr, 1, __ATOMIC_RELAXED) & REF_COUNT_MASK) != 0);
 }
 
 
@@ -1048,6 +1999,7 @@ void le_mem_GetStats
     statsPtr->numFree = pool->totalBlocks - pool->numBlocksInUse;
     statsPtr->numBlocksInUse = pool->numBlocksInUse;
     statsPtr->maxNumBlocksUsed = pool->maxNumBlocksUsed;
+    statsPtr->numBytesReclaimed = pool->numBytesReclaimed;
 
     Unlock();
 }
@@ -1069,7 +2021,7 @@ void le_mem_ResetStats
     LE_ASSERT(pool != NULL);
 
     Lock();
-    pool->numAllocations = 0;
+    __atomic_store_n(&(pool->numAllocations), 0, __ATOMIC_RELAXED);
     pool->numOverflows = 0;
     Unlock();
 }
@@ -1281,6 +2233,12 @@ le_mem_PoolRef_t _le_mem_CreateSubPool
     // Make sure the parent pool is not itself a sub-pool.
     LE_ASSERT(superPool->superPoolPtr == NULL);
 
+    // Sub-pools take over blocks by changing the blocks' pool pointers, which slab blocks don't have.
+    LE_FATAL_IF(superPool->isSlabPool,
+                "Can't create sub-pool '%s' of slab pool '%s'.",
+                name,
+                superPool->name);
+
     // Get a sub-pool from the pool of sub-pools.
     le_mem_PoolRef_t subPool = le_mem_ForceAlloc(SubPoolsPool);
 
@@ -1344,7 +2302,7 @@ void le_mem_DeleteSubPool
     MoveBlocks(superPool, subPool, numBlocks);
 
     // Update the superPool's block use count.
-    superPool->numBlocksInUse -= numBlocks;
+    RemoveBlocksInUse(superPool, numBlocks);
 
     // Remove the sub-pool from the list of sub-pools.
     PoolListChangeCount++;
@@ -1357,3 +2315,274 @@ void le_mem_DeleteSubPool
 }
 
 
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an empty variable-size pool.
+ *
+ * @return
+ *      A reference to the variable-size pool.
+ *
+ * @note
+ *      On failure, the process exits, so you don't have to worry about checking the returned
+ *      reference for validity.
+ */
+//--------------------------------------------------------------------------------------------------
+le_mem_VarPoolRef_t _le_mem_CreateVarPool
+(
+    const char*     componentName,  ///< [IN] Name of the component.
+    const char*     name,           ///< [IN] Name of the pool inside the component.
+    size_t          maxSize         ///< [IN] Size of the largest object that can be allocated
+                                    ///       from this pool (in bytes).
+)
+{
+    LE_FATAL_IF(maxSize == 0, "Variable-size pool '%s' has a maximum object size of zero.", name);
+
+    VarPool_t* varPoolPtr = le_mem_ForceAlloc(VarPoolsPool);
+
+    varPoolPtr->numClasses = 0;
+
+    size_t classSize = VAR_POOL_MIN_CLASS_SIZE;
+
+    for (;;)
+    {
+        // The last size class is always exactly the maximum size.
+        if (classSize > maxSize)
+        {
+            classSize = maxSize;
+        }
+
+        // Name each size class after the variable-size pool and its object size.
+        char className[LIMIT_MAX_MEM_POOL_NAME_BYTES];
+        if (snprintf(className, sizeof(className), "%s-%zu", name, classSize) >= sizeof(className))
+        {
+            LE_DEBUG("Memory pool name '%s-%zu' is truncated to '%s'", name, classSize, className);
+        }
+
+        varPoolPtr->classPools[varPoolPtr->numClasses] = _le_mem_CreatePool(componentName,
+                                                                            className,
+                                                                            classSize);
+        varPoolPtr->numClasses++;
+
+        if (classSize == maxSize)
+        {
+            break;
+        }
+
+        classSize *= 2;
+    }
+
+    return varPoolPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocates an object of a given size from a variable-size pool.
+ *
+ * @return  Pointer to the allocated object.
+ *
+ * @note    On failure, the process exits, so you don't have to worry about checking the returned
+ *          pointer for validity.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_mem_VarAlloc
+(
+    le_mem_VarPoolRef_t pool,   ///< [IN] Variable-size pool to allocate from.
+    size_t              size    ///< [IN] Number of bytes needed.
+)
+{
+    LE_ASSERT(pool);
+
+    // There are only a handful of size classes, so a linear search is as quick as anything.
+    size_t i;
+    for (i = 0; i < pool->numClasses; i++)
+    {
+        if (pool->classPools[i]->userDataSize >= size)
+        {
+            return le_mem_ForceAlloc(pool->classPools[i]);
+        }
+    }
+
+    LE_FATAL("Object of %zu bytes is too big for variable-size pool '%s' (max %zu bytes).",
+             size,
+             pool->classPools[pool->numClasses - 1]->name,
+             pool->classPools[pool->numClasses - 1]->userDataSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocates a copy of a null-terminated string from a variable-size pool.
+ *
+ * @return  Pointer to the copy of the string.
+ *
+ * @note    On failure, the process exits, so you don't have to worry about checking the returned
+ *          pointer for validity.
+ */
+//--------------------------------------------------------------------------------------------------
+char* le_mem_StrDup
+(
+    le_mem_VarPoolRef_t pool,   ///< [IN] Variable-size pool to allocate from.
+    const char*         str     ///< [IN] String to copy.
+)
+{
+    LE_ASSERT(str);
+
+    size_t numBytes = strlen(str) + 1;
+
+    char* copyPtr = le_mem_VarAlloc(pool, numBytes);
+    memcpy(copyPtr, str, numBytes);
+
+    return copyPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expands every size class of a variable-size pool.
+ *
+ * @return  A reference to the variable-size pool (the same value passed into it).
+ */
+//--------------------------------------------------------------------------------------------------
+le_mem_VarPoolRef_t le_mem_ExpandVarPool
+(
+    le_mem_VarPoolRef_t pool,       ///< [IN] Variable-size pool to be expanded.
+    size_t              numObjects  ///< [IN] Number of objects to add to each size class.
+)
+{
+    LE_ASSERT(pool);
+
+    size_t i;
+    for (i = 0; i < pool->numClasses; i++)
+    {
+        le_mem_ExpandPool(pool->classPools[i], numObjects);
+    }
+
+    return pool;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gives the memory of a pool's unused objects back to the OS.
+ *
+ * @return
+ *      The number of bytes given back to the OS.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t le_mem_Trim
+(
+    le_mem_PoolRef_t    pool        ///< [IN] The pool to be trimmed.
+)
+{
+    LE_ASSERT(pool != NULL);
+
+    size_t numBytes = 0;
+
+    #ifndef LE_MEM_VALGRIND
+        Lock();
+
+        if (pool->isSlabPool)
+        {
+            numBytes = TrimSlabs(pool);
+        }
+
+        Unlock();
+
+        if (numBytes > 0)
+        {
+            LE_DEBUG("Memory pool '%s' trimmed by %zu bytes.", pool->name, numBytes);
+        }
+    #endif
+
+    return numBytes;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enables automatic trimming of a pool when the process goes idle after the pool has been
+ * expanded by le_mem_ForceAlloc().
+ *
+ * @return
+ *      Nothing.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_mem_EnableIdleTrim
+(
+    le_mem_PoolRef_t    pool        ///< [IN] The pool.
+)
+{
+    LE_ASSERT(pool != NULL);
+
+    Lock();
+    pool->idleTrim = true;
+    Unlock();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a pool that is trimmed at idle time has been expanded by le_mem_ForceAlloc()
+ * since the last time the idle pools were trimmed.
+ *
+ * @return
+ *      true if mem_TrimIdlePools() should be called the next time the thread goes idle.
+ */
+//--------------------------------------------------------------------------------------------------
+bool mem_IsIdleTrimPending
+(
+    void
+)
+{
+    return __atomic_load_n(&IdleTrimPending, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trims all pools that have idle-time trimming enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+void mem_TrimIdlePools
+(
+    void
+)
+{
+    size_t numBytes = 0;
+
+    Lock();
+
+    // Another thread may have beaten us to it.
+    if (IdleTrimPending)
+    {
+        IdleTrimPending = false;
+
+        #ifndef LE_MEM_VALGRIND
+            le_dls_Link_t* poolLinkPtr = le_dls_Peek(&PoolList);
+
+            while (poolLinkPtr != NULL)
+            {
+                MemPool_t* poolPtr = CONTAINER_OF(poolLinkPtr, MemPool_t, poolLink);
+
+                if (poolPtr->isIdleTrimPending && poolPtr->isSlabPool)
+                {
+                    // This leaves the pool pending if slabs that still have blocks in use kept it
+                    // from being trimmed down, so it is trimmed again once blocks are released.
+                    numBytes += TrimSlabs(poolPtr);
+                }
+
+                poolLinkPtr = le_dls_PeekNext(&PoolList, poolLinkPtr);
+            }
+        #endif
+    }
+
+    Unlock();
+
+    if (numBytes > 0)
+    {
+        LE_DEBUG("Idle memory pools trimmed by %zu bytes.", numBytes);
+    }
+}
@@ -40,6 +40,22 @@ typedef struct le_mem_Pool
     size_t maxNumBlocksUsed;            ///< Maximum number of allocated blocks at any one time.
     size_t numBlocksToForce;            ///< Number of blocks that is added when Force Alloc
                                         ///  expands the pool.
+    size_t threadCacheSize;             ///< Maximum number of free blocks that each thread may
+                                        ///  hold in its private cache for this pool.
+                                        ///  0 = per-thread caching is disabled.
+    bool isSlabPool;                    ///< true if the blocks are carved out of slabs
+                                        ///  (see le_mem_CreateSlabPool()).
+    uint32_t slabOptions;               ///< LE_MEM_SLAB_xxx options the slab pool was created with.
+    size_t slabBlockOffset;             ///< Offset of the first block from the start of each
+                                        ///  slab chunk.
+    size_t blocksPerChunk;              ///< Number of blocks that fit in one slab chunk.
+    le_dls_List_t slabList;             ///< List of slabs allocated for a slab pool.
+    size_t minBlocks;                   ///< Number of blocks added using le_mem_ExpandPool().
+                                        ///  le_mem_Trim() won't shrink the pool below this.
+    bool idleTrim;                      ///< true if the pool is trimmed when the process is idle.
+    bool isIdleTrimPending;             ///< true if the pool has been expanded by Force Alloc
+                                        ///  and not yet trimmed back down to its minimum size.
+    size_t numBytesReclaimed;           ///< Total bytes given back to the OS by le_mem_Trim().
     #ifdef LE_MEM_TRACE
         le_log_TraceRef_t memTrace;     ///< If tracing is enabled, keeps track of a trace object
                                         ///  for this pool.
@@ -66,6 +82,33 @@ void mem_Init
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a pool that is trimmed at idle time has been expanded by le_mem_ForceAlloc()
+ * since the last time the idle pools were trimmed.
+ *
+ * @return
+ *      true if mem_TrimIdlePools() should be called the next time the thread goes idle.
+ */
+//--------------------------------------------------------------------------------------------------
+bool mem_IsIdleTrimPending
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trims all pools that have idle-time trimming enabled.  Called by the Event Loop when a thread
+ * has been idle for a while after a burst of pool expansion.
+ */
+//--------------------------------------------------------------------------------------------------
+void mem_TrimIdlePools
+(
+    void
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Exposing the memory pool list; mainly for the Inspect tool.
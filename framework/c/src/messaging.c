@@ -85,6 +85,12 @@
  * side.  For all other types of messages, this is set to 0 (NULL) to indicate that it does
  * not belong to a request-response transaction.
  *
+ * A client can ask for a session to use a shared memory transport (see messagingShm.h).  The
+ * session then exchanges messages through a pair of rings in shared memory, and the socket
+ * only carries the transport set-up, messages that carry file descriptors, and the hang-up.
+ * Transaction IDs 2 to 10 (which are never safe references, because those are odd) are
+ * reserved for the set-up messages.
+ *
  * See also @ref serviceDirectoryProtocol.
  *
  * @warning The code in this subsystem @b must be thread safe and re-entrant.
@@ -95,6 +101,7 @@
 #include "legato.h"
 #include "serviceDirectory/serviceDirectoryProtocol.h"
 #include "messagingMessage.h"
+#include "messagingShm.h"
 #include "messagingProtocol.h"
 #include "messagingSession.h"
 #include "messagingInterface.h"
@@ -117,6 +124,7 @@ void msg_Init
 {
     msgProto_Init();
     msgMessage_Init();
+    msgShm_Init();
     msgInterface_Init();
     msgSession_Init();
 }
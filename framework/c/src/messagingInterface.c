@@ -200,6 +200,7 @@ static void InitInterface
                 sizeof(interfacePtr->id.name));
 
     interfacePtr->sessionList = LE_DLS_LIST_INIT;
+    memset(&interfacePtr->stats, 0, sizeof(interfacePtr->stats));
 }
 
 
@@ -239,6 +240,9 @@ static msgInterface_Service_t* CreateService
     // Initialize the open handlers dls
     servicePtr->openListPtr = LE_DLS_LIST_INIT;
 
+    servicePtr->workerCount = 0;
+    servicePtr->nextWorker = 0;
+
     ServiceObjMapChangeCount++;
     le_hashmap_Put(ServiceMapRef, &servicePtr->interface.id, servicePtr);
 
@@ -989,9 +993,73 @@ void msgInterface_CallCloseHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of a service worker thread.  Just runs the event loop, which calls the
+ * functions queued to it by the server thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* WorkerThreadMain
+(
+    void* contextPtr    ///< [IN] Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_event_RunLoop();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes a service worker thread exit.  Queued to the worker behind any messages that it still
+ * has to process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopWorker
+(
+    void* param1Ptr,    ///< [IN] Not used.
+    void* param2Ptr     ///< [IN] Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_thread_Exit(NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Calls a service's receive handler for a message.  Runs in a worker thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleMessageInWorker
+(
+    void* servicePtr,   ///< [IN] Pointer to the Service object.  The caller holds a reference to it.
+    void* msgRef        ///< [IN] Message reference for the received message.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgInterface_Service_t* serviceRef = servicePtr;
+
+    pthread_setspecific(ThreadLocalRxMsgKey, msgRef);
+
+    serviceRef->recvHandler(msgRef, serviceRef->recvContextPtr);
+
+    pthread_setspecific(ThreadLocalRxMsgKey, NULL);
+
+    // The Mutex must be held when releasing Service objects (see ServiceDestructor()).
+    LOCK
+    le_mem_Release(serviceRef);
+    UNLOCK
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Dispatches a message received from a client to a service's server.
+ *
+ * If the service has a worker pool, the message is handed to the worker thread that handles the
+ * session the message was received through.  Each session sticks to one worker, so messages
+ * from the same session are still handled in order.
  */
 //--------------------------------------------------------------------------------------------------
 void msgInterface_ProcessMessageFromClient
@@ -1001,8 +1069,24 @@ void msgInterface_ProcessMessageFromClient
 )
 //--------------------------------------------------------------------------------------------------
 {
+    if ((serviceRef->workerCount > 0) && (serviceRef->recvHandler != NULL))
+    {
+        le_msg_SessionRef_t sessionRef = le_msg_GetSession(msgRef);
+
+        if (sessionRef->workerThread == NULL)
+        {
+            sessionRef->workerThread = serviceRef->workerThreads[serviceRef->nextWorker];
+            serviceRef->nextWorker = (serviceRef->nextWorker + 1) % serviceRef->workerCount;
+        }
+
+        le_mem_AddRef(serviceRef);
+        le_event_QueueFunctionToThread(sessionRef->workerThread,
+                                       HandleMessageInWorker,
+                                       serviceRef,
+                                       msgRef);
+    }
     // Pass the message to the server's registered receive handler, if there is one.
-    if (serviceRef->recvHandler != NULL)
+    else if (serviceRef->recvHandler != NULL)
     {
         // Set the thread-local received message reference so it can be retrieved by the handler.
         pthread_setspecific(ThreadLocalRxMsgKey, msgRef);
@@ -1093,6 +1177,14 @@ void le_msg_DeleteService
     // Close any remaining open sessions.
     CloseAllSessions(serviceRef);
 
+    // Stop the worker threads once they have finished with the messages already handed to them.
+    size_t i;
+    for (i = 0; i < serviceRef->workerCount; i++)
+    {
+        le_event_QueueFunctionToThread(serviceRef->workerThreads[i], StopWorker, NULL, NULL);
+    }
+    serviceRef->workerCount = 0;
+
     // NOTE: Lock the mutex here to prevent a race between this thread dropping ownership
     // of the service and another thread trying to offer the same service.  This is very
     // unlikely to ever happen, but just in case, make sure it fails with a sensible
@@ -1253,6 +1345,51 @@ void le_msg_SetServiceRecvHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes a service hand the messages that it receives to a pool of worker threads, instead of
+ * handling them all in the server thread.
+ *
+ * @note    This is a server-only function that can only be called once for a given service.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_SetServiceWorkerPool
+(
+    le_msg_ServiceRef_t serviceRef, ///< [in] Reference to the service.
+    size_t              threadCount ///< [in] Number of worker threads.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_FATAL_IF(serviceRef->serverThread != le_thread_GetCurrent(),
+                "Service (%s:%s) not owned by calling thread.",
+                serviceRef->interface.id.name,
+                le_msg_GetProtocolIdStr(serviceRef->interface.id.protocolRef));
+    LE_FATAL_IF(serviceRef->workerCount != 0,
+                "Service (%s:%s) already has a worker pool.",
+                serviceRef->interface.id.name,
+                le_msg_GetProtocolIdStr(serviceRef->interface.id.protocolRef));
+    LE_FATAL_IF((threadCount == 0) || (threadCount > LIMIT_MAX_IPC_SERVICE_WORKERS),
+                "Invalid worker thread count %zu for service (%s:%s).",
+                threadCount,
+                serviceRef->interface.id.name,
+                le_msg_GetProtocolIdStr(serviceRef->interface.id.protocolRef));
+
+    size_t i;
+    for (i = 0; i < threadCount; i++)
+    {
+        char name[LIMIT_MAX_THREAD_NAME_BYTES];
+
+        snprintf(name, sizeof(name), "%.32s-%zu", serviceRef->interface.id.name, i);
+
+        serviceRef->workerThreads[i] = le_thread_Create(name, WorkerThreadMain, NULL);
+        le_thread_Start(serviceRef->workerThreads[i]);
+    }
+
+    serviceRef->nextWorker = 0;
+    serviceRef->workerCount = threadCount;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Associates an opaque context value (void pointer) with a given service that can be retrieved
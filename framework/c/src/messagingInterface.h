@@ -41,6 +41,85 @@ typedef struct
 msgInterface_Id_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of buckets in a round-trip time histogram.
+ *
+ * Bucket 0 counts round trips shorter than 1 microsecond, and bucket n (n > 0) counts round trips
+ * of at least 2^(n-1) and less than 2^n microseconds.  The last bucket also counts anything
+ * longer than that.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_STATS_RTT_BUCKET_COUNT 24
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Traffic statistics, kept for each session and totalled for each interface.
+ *
+ * The counters are only ever incremented, and are read without locking (e.g., by the Inspect
+ * tool, straight out of the process's memory), so a reader may see a set of counters that is a
+ * few messages out of step, but never a wrong count.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t txMsgCount;        ///< Number of messages sent.
+    uint64_t txByteCount;       ///< Number of bytes sent (including transaction IDs).
+    uint64_t rxMsgCount;        ///< Number of messages received.
+    uint64_t rxByteCount;       ///< Number of bytes received (including transaction IDs).
+    uint32_t txQueueMaxDepth;   ///< Most messages ever waiting on a Transmit Queue at once.
+    uint32_t backPressureCount; ///< Number of times sending stalled because the socket or
+                                ///  shared memory ring was full.
+    uint32_t rttHistogram[MSG_STATS_RTT_BUCKET_COUNT]; ///< Request-response round-trip times
+                                ///  (see MSG_STATS_RTT_BUCKET_COUNT).  Client-side only.
+}
+msgInterface_Stats_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Works out the round-trip time that a given percentage of the transactions in a histogram
+ * completed within.
+ *
+ * @return The upper bound of the histogram bucket that the percentile falls in, in microseconds,
+ *         or 0 if the histogram is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint32_t msgInterface_GetRttPercentile
+(
+    const msgInterface_Stats_t* statsPtr,   ///< [IN] Statistics holding the histogram.
+    uint32_t percent                        ///< [IN] Percentile wanted (1 to 100).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t total = 0;
+    uint64_t count = 0;
+    size_t i;
+
+    for (i = 0; i < MSG_STATS_RTT_BUCKET_COUNT; i++)
+    {
+        total += statsPtr->rttHistogram[i];
+    }
+
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < MSG_STATS_RTT_BUCKET_COUNT - 1; i++)
+    {
+        count += statsPtr->rttHistogram[i];
+        if ((count * 100) >= (total * percent))
+        {
+            break;
+        }
+    }
+
+    return ((uint32_t)1) << i;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Generic Interface object. This is the abstraction of interface objects such as client and server.
@@ -53,6 +132,8 @@ typedef struct le_msg_Interface
     le_dls_List_t sessionList;         ///< List of Session objects for open sessions with other
                                        ///  interfaces.
     msgInterface_Type_t interfaceType; ///< The type of the more specific interface object.
+    msgInterface_Stats_t stats;        ///< Traffic totals for all sessions on this interface,
+                                       ///  past and present.  Updated atomically.
 }
 msgInterface_Interface_t;
 
@@ -94,6 +175,11 @@ typedef struct le_msg_Service
 
     le_dls_List_t                   closeListPtr; ///< open List: list of close session handlers
                                                   ///  called when a session is opened
+
+    le_thread_Ref_t workerThreads[LIMIT_MAX_IPC_SERVICE_WORKERS]; ///< Worker thread pool that
+                                        ///  received messages are handed to.
+    size_t          workerCount;        ///< Number of threads in the worker pool (0 = no pool).
+    size_t          nextWorker;         ///< Index of the worker to give the next session to.
 }
 msgInterface_Service_t;
 
@@ -12,6 +12,7 @@
 #include "messagingProtocol.h"
 #include "messagingSession.h"
 #include "messagingInterface.h"
+#include "messagingShm.h"
 #include "fileDescriptor.h"
 #include "unixSocket.h"
 
@@ -39,16 +40,13 @@ static void MessageDestructor
     {
         LE_ERROR("Released a message without sending response expected by client.");
 
-        le_msg_CloseSession(msgPtr->sessionRef);
-        // NOTE: Because the message object holds a reference to the session object, even though
-        // we have closed the session and it has been "deleted", it actually still exists until
-        // we release it (later in this function).
-
         // Because the session is closing without the server asking for it to be closed,
-        // notify the server of the closure (if the server has a close handler registered).
-        msgInterface_CallCloseHandler(
-            (le_msg_ServiceRef_t)msgSession_GetInterfaceRef(msgPtr->sessionRef),
-            msgPtr->sessionRef);
+        // notify the server of the closure too (if the server has a close handler registered).
+        // NOTE: Because the message object holds a reference to the session object, even though
+        // the session is closed and "deleted", it actually still exists until we release it
+        // (later in this function).  If this is a worker thread, the close is done later by the
+        // thread that owns the session, which takes its own reference.
+        msgSession_CloseServerSession(msgPtr->sessionRef, true);
     }
 
     // Release any open fds in the message.
@@ -122,6 +120,69 @@ le_mem_PoolRef_t msgMessage_CreatePool
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of bytes to send for a message, including its transaction ID.
+ *
+ * @return The byte count.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t msgMessage_GetSendSize
+(
+    Message_t*  msgPtr      ///< [IN] The Message to be sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Unless the payload length has been set for this protocol, the whole payload buffer is sent.
+    size_t payloadLen = le_msg_GetMaxPayloadSize(msgPtr);
+    if (le_msg_GetSessionProtocol(msgPtr->sessionRef)->isVarLength)
+    {
+        payloadLen = msgPtr->payloadLen;
+    }
+
+    return sizeof(msgPtr->txnId) + payloadLen;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check and tidy up the payload of a message that has just been received.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_COMM_ERROR if the message is too short to be valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FinishReceive
+(
+    le_msg_MessageRef_t msgRef,     ///< [IN] Message object holding the received message.
+    size_t              byteCount   ///< [IN] Number of bytes received, including the txn ID.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (byteCount < sizeof(msgRef->txnId))
+    {
+        LE_ERROR("Received message too short (%zu bytes).", byteCount);
+        return LE_COMM_ERROR;
+    }
+
+    // The sender may have sent less than the whole payload buffer.  Code that doesn't use
+    // le_msg_SetPayloadLength() doesn't know that, so clear the rest for it, the same as if
+    // the whole buffer had been sent.
+    size_t maxPayloadSize = le_msg_GetMaxPayloadSize(msgRef);
+    msgRef->payloadLen = byteCount - sizeof(msgRef->txnId);
+    if (   (msgRef->payloadLen < maxPayloadSize)
+        && !le_msg_GetSessionProtocol(msgRef->sessionRef)->isVarLength)
+    {
+        memset((uint8_t*)msgRef->payload + msgRef->payloadLen,
+               0,
+               maxPayloadSize - msgRef->payloadLen);
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Send a single message over a connected socket.
@@ -142,8 +203,10 @@ le_result_t msgMessage_Send
 )
 //--------------------------------------------------------------------------------------------------
 {
+    bool isResponse = le_msg_NeedsResponse(msgPtr);
+
     // If this is a response message,
-    if (le_msg_NeedsResponse(msgPtr))
+    if (isResponse)
     {
         // If there was an fd that was received from the client but not fetched from the message
         // generate a warning and close that fd.
@@ -160,11 +223,83 @@ le_result_t msgMessage_Send
 
     // The first bytes come from our transaction ID and the rest (if any)
     // from our Message object's payload section, which comes right after the transaction ID.
-    return unixSocket_SendMsg(  socketFd,
-                                &msgPtr->txnId,
-                                sizeof(msgPtr->txnId) + le_msg_GetMaxPayloadSize(msgPtr),
-                                msgPtr->fd,
-                                false   ); // Don't send process credentials.
+    le_result_t result = unixSocket_SendMsg(socketFd,
+                                            &msgPtr->txnId,
+                                            msgMessage_GetSendSize(msgPtr),
+                                            msgPtr->fd,
+                                            false   ); // Don't send process credentials.
+
+    // If a response couldn't be sent, put its fd back in the responseFd position, so that it
+    // gets sent when the message is sent again later (or closed if the message is released).
+    if (isResponse && (result != LE_OK))
+    {
+        msgPtr->clientServer.server.responseFd = msgPtr->fd;
+        msgPtr->fd = -1;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a message will carry a file descriptor when it is sent.
+ *
+ * @return true if msgMessage_Send() will send an fd with the message.
+ */
+//--------------------------------------------------------------------------------------------------
+bool msgMessage_HasFd
+(
+    Message_t*  msgPtr      ///< [IN] The Message to be sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (msgPtr->fd >= 0)
+    {
+        return true;
+    }
+
+    return (   (msgSession_GetInterfaceType(msgPtr->sessionRef) == LE_MSG_INTERFACE_SERVER)
+            && (msgPtr->clientServer.server.responseFd >= 0));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a batch of messages over a connected socket.  None of the messages may carry a file
+ * descriptor (see msgMessage_HasFd()).
+ *
+ * If the socket fills up part-way through the batch, the number of messages that were sent is
+ * reported through sentCountPtr, and the rest must be sent later.
+ *
+ * @return
+ * - LE_OK if all the messages were sent.
+ * - LE_NO_MEMORY if the socket doesn't have enough send buffer space available right now.
+ * - LE_COMM_ERROR if the localSocketFd is not connected.
+ * - LE_FAULT if failed for some other reason (check your logs).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_SendBatch
+(
+    int         socketFd,       ///< [IN] Connected socket's file descriptor.
+    Message_t*  msgPtrs[],      ///< [IN] The Messages to be sent.
+    size_t      count,          ///< [IN] Number of messages in the batch.
+    size_t*     sentCountPtr    ///< [OUT] Number of messages that were sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct iovec ioVectors[count];
+
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        LE_ASSERT(!msgMessage_HasFd(msgPtrs[i]));
+
+        ioVectors[i].iov_base = &msgPtrs[i]->txnId;
+        ioVectors[i].iov_len = msgMessage_GetSendSize(msgPtrs[i]);
+    }
+
+    return unixSocket_SendDataMsgBatch(socketFd, ioVectors, count, sentCountPtr);
 }
 
 
@@ -199,10 +334,158 @@ le_result_t msgMessage_Receive
         msgRef->clientServer.server.responseFd = -1;
     }
 
+    if (result == LE_OK)
+    {
+        result = FinishReceive(msgRef, byteCount);
+    }
+
     return result;
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive as many messages as are waiting on a connected socket, up to the number of Message
+ * objects provided.  Never blocks.
+ *
+ * On return, the first *receivedCountPtr Message objects hold received messages.  The others
+ * are untouched and can be used for a later receive.
+ *
+ * @return
+ * - LE_OK if at least one message was received.
+ * - LE_WOULD_BLOCK if there's nothing there to receive.
+ * - LE_CLOSED if the connection has closed.
+ * - LE_COMM_ERROR if an error was encountered.
+ *
+ * @note    A message that is too short to be valid is dropped with an error log, and is not
+ *          counted in *receivedCountPtr, but it is counted in *socketCountPtr.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_ReceiveBatch
+(
+    int                 socketFd,           ///< [IN] The socket's file descriptor.
+    le_msg_MessageRef_t msgRefs[],          ///< [IN] Message objects to store the messages in.
+    size_t              count,              ///< [IN] Number of Message objects provided.
+    size_t*             receivedCountPtr,   ///< [OUT] Number of messages received.
+    size_t*             socketCountPtr      ///< [OUT] Number of messages taken from the socket,
+                                            ///        including any that were dropped.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct iovec ioVectors[count];
+    size_t byteCounts[count];
+    int fds[count];
+
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        ioVectors[i].iov_base = &msgRefs[i]->txnId;
+        ioVectors[i].iov_len = sizeof(msgRefs[i]->txnId) + le_msg_GetMaxPayloadSize(msgRefs[i]);
+    }
+
+    size_t receivedCount;
+    le_result_t result = unixSocket_ReceiveMsgBatch(socketFd,
+                                                    ioVectors,
+                                                    byteCounts,
+                                                    fds,
+                                                    count,
+                                                    &receivedCount);
+
+    *receivedCountPtr = 0;
+    *socketCountPtr = 0;
+
+    if (result != LE_OK)
+    {
+        return ((result == LE_FAULT) ? LE_COMM_ERROR : result);
+    }
+
+    *socketCountPtr = receivedCount;
+
+    for (i = 0; i < receivedCount; i++)
+    {
+        le_msg_MessageRef_t msgRef = msgRefs[i];
+
+        msgRef->fd = fds[i];
+        if (msgSession_GetInterfaceType(msgRef->sessionRef) == LE_MSG_INTERFACE_SERVER)
+        {
+            msgRef->clientServer.server.responseFd = -1;
+        }
+
+        if (FinishReceive(msgRef, byteCounts[i]) != LE_OK)
+        {
+            if (msgRef->fd >= 0)
+            {
+                fd_Close(msgRef->fd);
+                msgRef->fd = -1;
+            }
+            continue;
+        }
+
+        // Keep the received messages together at the front of the array.
+        msgRefs[i] = msgRefs[*receivedCountPtr];
+        msgRefs[*receivedCountPtr] = msgRef;
+        (*receivedCountPtr)++;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a single message through a session's shared memory transport.  The message must not
+ * carry a file descriptor (see msgMessage_HasFd()).
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_NO_MEMORY if the outgoing ring is full right now.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_SendShm
+(
+    msgShm_TransportRef_t   transportRef,   ///< [IN] The session's shared memory transport.
+    Message_t*              msgPtr,         ///< [IN] The Message to be sent.
+    uint32_t                socketSeq       ///< [IN] Number of messages sent through the socket.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(!msgMessage_HasFd(msgPtr));
+
+    return msgShm_Push(transportRef, &msgPtr->txnId, msgMessage_GetSendSize(msgPtr), socketSeq);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive the next message waiting in a session's shared memory transport.  There must be one
+ * (see msgShm_Peek()).
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_COMM_ERROR if the message was not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_ReceiveShm
+(
+    msgShm_TransportRef_t   transportRef,   ///< [IN] The session's shared memory transport.
+    le_msg_MessageRef_t     msgRef          ///< [IN] Message object to store the message in.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t byteCount = msgShm_Pop(transportRef,
+                                  &msgRef->txnId,
+                                  sizeof(msgRef->txnId) + le_msg_GetMaxPayloadSize(msgRef));
+
+    msgRef->fd = -1;
+    if (msgSession_GetInterfaceType(msgRef->sessionRef) == LE_MSG_INTERFACE_SERVER)
+    {
+        msgRef->clientServer.server.responseFd = -1;
+    }
+
+    return FinishReceive(msgRef, byteCount);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Call the completion callback function for a given message, if it has one.
@@ -273,7 +556,14 @@ le_msg_MessageRef_t le_msg_CreateMsg
 
     msgPtr->fd = -1;
     msgPtr->txnId = 0;
-    memset(msgPtr->payload, 0, le_msg_GetProtocolMaxMsgSize(protocolRef));
+    msgPtr->payloadLen = le_msg_GetProtocolMaxMsgSize(protocolRef);
+
+    // Only the packed part of the payload is sent if the protocol sets payload lengths, so there's
+    // no need to clear the whole buffer.
+    if (!protocolRef->isVarLength)
+    {
+        memset(msgPtr->payload, 0, msgPtr->payloadLen);
+    }
 
     return msgPtr;
 }
@@ -372,6 +662,52 @@ size_t le_msg_GetMaxPayloadSize
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the number of bytes at the start of the payload buffer that are to be sent.
+ *
+ * Once this has been called on a message, messages in the same protocol are no longer cleared
+ * when they are created, and only the payload length is sent, so it must be set on every message
+ * sent in that protocol from then on.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_SetPayloadLength
+(
+    le_msg_MessageRef_t msgRef,     ///< [in] Reference to the message.
+    size_t              length      ///< [in] Number of payload bytes to send.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(length <= le_msg_GetMaxPayloadSize(msgRef));
+
+    msgRef->payloadLen = length;
+
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetSessionProtocol(msgRef->sessionRef);
+    if (!protocolRef->isVarLength)
+    {
+        __atomic_store_n(&protocolRef->isVarLength, true, __ATOMIC_RELAXED);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the number of payload bytes in a message.  For a received message, this is the number of
+ * payload bytes that were received.
+ *
+ * @return The length, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t le_msg_GetPayloadLength
+(
+    le_msg_MessageRef_t msgRef      ///< [in] Reference to the message.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return msgRef->payloadLen;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets the file descriptor to be sent with this message.
@@ -8,6 +8,16 @@
 #ifndef LEGATO_MESSAGING_MESSAGE_H_INCLUDE_GUARD
 #define LEGATO_MESSAGING_MESSAGE_H_INCLUDE_GUARD
 
+#include "messagingShm.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of messages sent or received in one system call by the session layer.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_MESSAGE_BATCH_SIZE 16
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Represents a message.
@@ -28,6 +38,8 @@ typedef struct le_msg_Message
             le_msg_ResponseCallback_t   completionCallback; ///< Function to call when txn finishes.
                                                             ///  NULL if no response expected.
             void*                       contextPtr; ///< Opaque ptr to pass to completion callback.
+            uint64_t                    startTimeUs;///< When the transaction started (relative
+                                                    ///  time in microseconds).
         }
         client;
 
@@ -41,7 +53,8 @@ typedef struct le_msg_Message
     clientServer;
 
     int                         fd;         ///< File descriptor to send or received (-1 = no fd)
-    void*                       txnId;      ///< Safe reference value used as a transaction ID.
+    size_t                      payloadLen; ///< Number of payload bytes to send or received.
+    void*                       txnId;      ///< Transaction ID (0 = not part of a transaction).
     void*                       payload[0]; ///< Variable-length payload buffer appears at the end.
 }
 Message_t;
@@ -90,6 +103,72 @@ le_result_t msgMessage_Send
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of bytes that will be sent for a message, including its transaction ID.
+ *
+ * @return The byte count.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t msgMessage_GetSendSize
+(
+    Message_t*  msgPtr      ///< [IN] The Message to be sent.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of bytes that were received for a message, including its transaction ID.
+ *
+ * @return The byte count.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t msgMessage_GetReceivedSize
+(
+    Message_t*  msgPtr      ///< [IN] The Message that was received.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return sizeof(msgPtr->txnId) + msgPtr->payloadLen;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a message will carry a file descriptor when it is sent.
+ *
+ * @return true if msgMessage_Send() will send an fd with the message.
+ */
+//--------------------------------------------------------------------------------------------------
+bool msgMessage_HasFd
+(
+    Message_t*  msgPtr      ///< [IN] The Message to be sent.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a batch of messages over a connected socket.  None of the messages may carry a file
+ * descriptor (see msgMessage_HasFd()).
+ *
+ * If the socket fills up part-way through the batch, the number of messages that were sent is
+ * reported through sentCountPtr, and the rest must be sent later.
+ *
+ * @return
+ * - LE_OK if all the messages were sent.
+ * - LE_NO_MEMORY if the socket doesn't have enough send buffer space available right now.
+ * - LE_COMM_ERROR if the socket reported an error on the send operation.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_SendBatch
+(
+    int         socketFd,       ///< [IN] Connected socket's file descriptor.
+    Message_t*  msgPtrs[],      ///< [IN] The Messages to be sent.
+    size_t      count,          ///< [IN] Number of messages in the batch.
+    size_t*     sentCountPtr    ///< [OUT] Number of messages that were sent.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Receive a single message from a connected socket.
@@ -108,6 +187,70 @@ le_result_t msgMessage_Receive
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive as many messages as are waiting on a connected socket, up to the number of Message
+ * objects provided.  Never blocks.
+ *
+ * On return, the first *receivedCountPtr Message objects hold received messages.  The others
+ * are untouched and can be used for a later receive.
+ *
+ * @return
+ * - LE_OK if at least one message was received.
+ * - LE_WOULD_BLOCK if there's nothing there to receive.
+ * - LE_CLOSED if the connection has closed.
+ * - LE_COMM_ERROR if an error was encountered.
+ *
+ * @note    A message that is too short to be valid is dropped with an error log, and is not
+ *          counted in *receivedCountPtr, but it is counted in *socketCountPtr.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_ReceiveBatch
+(
+    int                 socketFd,           ///< [IN] The socket's file descriptor.
+    le_msg_MessageRef_t msgRefs[],          ///< [IN] Message objects to store the messages in.
+    size_t              count,              ///< [IN] Number of Message objects provided.
+    size_t*             receivedCountPtr,   ///< [OUT] Number of messages received.
+    size_t*             socketCountPtr      ///< [OUT] Number of messages taken from the socket,
+                                            ///        including any that were dropped.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a single message through a session's shared memory transport.  The message must not
+ * carry a file descriptor (see msgMessage_HasFd()).
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_NO_MEMORY if the outgoing ring is full right now.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_SendShm
+(
+    msgShm_TransportRef_t   transportRef,   ///< [IN] The session's shared memory transport.
+    Message_t*              msgPtr,         ///< [IN] The Message to be sent.
+    uint32_t                socketSeq       ///< [IN] Number of messages sent through the socket.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive the next message waiting in a session's shared memory transport.  There must be one
+ * (see msgShm_Peek()).
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_COMM_ERROR if the message was not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_ReceiveShm
+(
+    msgShm_TransportRef_t   transportRef,   ///< [IN] The session's shared memory transport.
+    le_msg_MessageRef_t     msgRef          ///< [IN] Message object to store the message in.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets a pointer to the queue link inside a Message object.
@@ -175,6 +318,39 @@ static inline void* msgMessage_GetTxnId
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records when a client-side request message's transaction started.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void msgMessage_SetStartTime
+(
+    le_msg_MessageRef_t msgRef,
+    uint64_t            startTimeUs ///< [IN] Relative time, in microseconds.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgRef->clientServer.client.startTimeUs = startTimeUs;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets when a client-side request message's transaction started.
+ *
+ * @return The relative time, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t msgMessage_GetStartTime
+(
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return msgRef->clientServer.client.startTimeUs;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Call the completion callback function for a given message.
@@ -110,6 +110,7 @@ static msgProtocol_Protocol_t* CreateProtocol
 
     protocolPtr->link = LE_SLS_LINK_INIT;
     protocolPtr->maxPayloadSize = largestMsgSize;
+    protocolPtr->isVarLength = false;
     if (le_utf8_Copy(protocolPtr->id, protocolId, sizeof(protocolPtr->id), NULL) == LE_OVERFLOW)
     {
         LE_CRIT("Protocol identifier truncated from '%s' to '%s'.", protocolId, protocolPtr->id);
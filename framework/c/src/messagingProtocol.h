@@ -21,6 +21,8 @@ typedef struct le_msg_Protocol
     char id[LIMIT_MAX_PROTOCOL_ID_BYTES];   ///< Unique identifier for the protocol.
     size_t maxPayloadSize;                  ///< Max payload size (in bytes) in this protocol.
     le_mem_PoolRef_t messagePoolRef;        ///< Pool of Message objects.
+    bool isVarLength;                       ///< true once le_msg_SetPayloadLength() has been used
+                                            ///  on a message in this protocol.
 }
 msgProtocol_Protocol_t;
 
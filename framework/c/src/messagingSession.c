@@ -16,6 +16,7 @@
 #include "messagingSession.h"
 #include "messagingProtocol.h"
 #include "messagingMessage.h"
+#include "messagingShm.h"
 #include "fileDescriptor.h"
 
 
@@ -24,10 +25,9 @@
 // =======================================
 
 //--------------------------------------------------------------------------------------------------
-/// The peak number of outstanding request-response transactions that we expect to have
-/// ongoing at the same time in the same process.
+/// Mask that turns a transaction sequence number into an index in a session's Transaction Table.
 //--------------------------------------------------------------------------------------------------
-#define MAX_EXPECTED_TXNS 32
+#define TXN_TABLE_MASK (MSG_SESSION_TXN_TABLE_SIZE - 1)
 
 
 //--------------------------------------------------------------------------------------------------
@@ -64,22 +64,42 @@ static le_mem_PoolRef_t SessionPoolRef;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Transaction Map.  This is a Safe Reference Map used to generate and match up
- * transaction IDs for request-response transactions.
- *
- * @note    Because this is shared by multiple threads, it must be protected using the Mutex.
+ * A counter that increments every time a change is made to a session list in ANY interface obj.
  */
 //--------------------------------------------------------------------------------------------------
-static le_ref_MapRef_t TxnMapRef;
+static size_t SessionObjListChangeCount = 0;
+static size_t* SessionObjListChangeCountRef = &SessionObjListChangeCount;
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * A counter that increments every time a change is made to a session list in ANY interface obj.
+ * A batch of client sessions whose open requests have been sent to the Service Directory, but
+ * whose responses haven't been received yet.  See le_msg_StartOpenBatch().
  */
 //--------------------------------------------------------------------------------------------------
-static size_t SessionObjListChangeCount = 0;
-static size_t* SessionObjListChangeCountRef = &SessionObjListChangeCount;
+typedef struct msgSession_OpenBatch
+{
+    le_dls_List_t   pendingList;    ///< Sessions waiting for their open response, in the order
+                                    ///  their open requests were sent.
+}
+OpenBatch_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which Open Batch objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t OpenBatchPoolRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key used to find the current thread's Open Batch object, if the thread has started an open
+ * batch (NULL if it hasn't).
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_key_t OpenBatchKey;
 
 
 // =======================================
@@ -87,6 +107,148 @@ static size_t* SessionObjListChangeCountRef = &SessionObjListChangeCount;
 // =======================================
 
 static void AttemptOpen(msgSession_Session_t* sessionPtr);
+static void CompletePendingOpen(msgSession_Session_t* sessionPtr);
+static bool SendSharedMemSetup(msgSession_Session_t* sessionPtr);
+static le_result_t ReceiveSharedMemAck(msgSession_Session_t* sessionPtr);
+static void TriggerDeferredProcessing(msgSession_Session_t* sessionPtr);
+static void ActivateSharedMem(msgSession_Session_t* sessionPtr, msgShm_TransportRef_t shmRef);
+static void HandleSharedMemSetup(msgSession_Session_t* sessionPtr, le_msg_MessageRef_t msgRef);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the current relative (monotonic) time in microseconds, for timing transactions.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t GetRelativeTimeUs
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000000) + (uint64_t)now.usec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Raises a statistics maximum to a given value, if it is lower.
+ *
+ * This is used on an interface's statistics, which may be updated by several threads at once.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void RaiseMax
+(
+    uint32_t* maxPtr,
+    uint32_t value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t max = __atomic_load_n(maxPtr, __ATOMIC_RELAXED);
+
+    while (   (value > max)
+           && !__atomic_compare_exchange_n(maxPtr, &max, value, true,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts a message that has been sent, in both the session's and the interface's statistics.
+ *
+ * @note    The session's statistics are only updated by the thread that owns the session, but
+ *          other threads may be using other sessions on the same interface at the same time.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountSent
+(
+    msgSession_Session_t* sessionPtr,
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgInterface_Stats_t* ifStatsPtr = &sessionPtr->interfaceRef->stats;
+    size_t byteCount = msgMessage_GetSendSize(msgRef);
+
+    sessionPtr->stats.txMsgCount++;
+    sessionPtr->stats.txByteCount += byteCount;
+
+    __atomic_fetch_add(&ifStatsPtr->txMsgCount, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ifStatsPtr->txByteCount, byteCount, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts a message that has been received, in both the session's and the interface's statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountReceived
+(
+    msgSession_Session_t* sessionPtr,
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgInterface_Stats_t* ifStatsPtr = &sessionPtr->interfaceRef->stats;
+    size_t byteCount = msgMessage_GetReceivedSize(msgRef);
+
+    sessionPtr->stats.rxMsgCount++;
+    sessionPtr->stats.rxByteCount += byteCount;
+
+    __atomic_fetch_add(&ifStatsPtr->rxMsgCount, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ifStatsPtr->rxByteCount, byteCount, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts a time that sending had to stop because the socket or shared memory ring was full.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountBackPressure
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    sessionPtr->stats.backPressureCount++;
+
+    __atomic_fetch_add(&sessionPtr->interfaceRef->stats.backPressureCount, 1, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds the round-trip time of a request-response transaction that has just completed to the
+ * session's and the interface's histograms.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RecordRoundTripTime
+(
+    msgSession_Session_t* sessionPtr,
+    le_msg_MessageRef_t requestMsgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t rttUs = GetRelativeTimeUs() - msgMessage_GetStartTime(requestMsgRef);
+
+    // Bucket n holds times from 2^(n-1) up to 2^n microseconds, i.e., n is the bit length.
+    size_t bucket = (rttUs == 0) ? 0 : (size_t)(64 - __builtin_clzll(rttUs));
+    if (bucket >= MSG_STATS_RTT_BUCKET_COUNT)
+    {
+        bucket = MSG_STATS_RTT_BUCKET_COUNT - 1;
+    }
+
+    sessionPtr->stats.rttHistogram[bucket]++;
+
+    __atomic_fetch_add(&sessionPtr->interfaceRef->stats.rttHistogram[bucket], 1,
+                       __ATOMIC_RELAXED);
+}
 
 
 //--------------------------------------------------------------------------------------------------
@@ -107,6 +269,12 @@ static void PushTransmitQueue
 
     LOCK
     le_dls_Queue(&sessionPtr->transmitQueue, linkPtr);
+    uint32_t depth = ++(sessionPtr->txQueueDepth);
+    if (depth > sessionPtr->stats.txQueueMaxDepth)
+    {
+        sessionPtr->stats.txQueueMaxDepth = depth;
+        RaiseMax(&sessionPtr->interfaceRef->stats.txQueueMaxDepth, depth);
+    }
     UNLOCK
 }
 
@@ -131,6 +299,10 @@ static le_msg_MessageRef_t PopTransmitQueue
 
     LOCK
     linkPtr = le_dls_Pop(&sessionPtr->transmitQueue);
+    if (linkPtr != NULL)
+    {
+        sessionPtr->txQueueDepth--;
+    }
     UNLOCK
 
     if (linkPtr != NULL)
@@ -160,13 +332,14 @@ static void UnPopTransmitQueue
 
     LOCK
     le_dls_Stack(&sessionPtr->transmitQueue, linkPtr);
+    sessionPtr->txQueueDepth++;
     UNLOCK
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Pushes a message onto the tail of the Receive Queue.
+ * Pushes a message that has just been received onto the tail of the Receive Queue.
  */
 //--------------------------------------------------------------------------------------------------
 static inline void PushReceiveQueue
@@ -176,6 +349,8 @@ static inline void PushReceiveQueue
 )
 //--------------------------------------------------------------------------------------------------
 {
+    CountReceived(sessionPtr, msgRef);
+
     le_dls_Queue(&sessionPtr->receiveQueue, msgMessage_GetQueueLinkPtr(msgRef));
 }
 
@@ -207,22 +382,75 @@ static le_msg_MessageRef_t PopReceiveQueue
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts a transaction sequence number into a transaction ID.
+ *
+ * Transaction IDs are always odd, so they are never 0 (no transaction) and never clash with the
+ * reserved shared memory set-up IDs (see messagingShm.h).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void* TxnIdFromSeq
+(
+    uint32_t seq
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (void*)((((uintptr_t)seq) << 1) | 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts a transaction ID into the transaction sequence number that it was made from.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint32_t SeqFromTxnId
+(
+    void* txnId
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (uint32_t)(((uintptr_t)txnId) >> 1);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a transaction ID for a given message and stores it inside the Message object.
+ *
+ * The sequence number is chosen so that the message gets a free slot in the session's
+ * Transaction Table, if there is one.
+ *
+ * @note    Transaction IDs are only ever created, looked up and deleted by the thread that owns the
+ *          session, so no locking is needed.
  */
 //--------------------------------------------------------------------------------------------------
 static void CreateTxnId
 (
+    msgSession_Session_t* sessionPtr,
     le_msg_MessageRef_t msgRef
 )
 //--------------------------------------------------------------------------------------------------
 {
-    LOCK
+    uint32_t seq = sessionPtr->nextTxnSeq;
+    size_t i;
+
+    for (i = 0; i < MSG_SESSION_TXN_TABLE_SIZE; i++, seq++)
+    {
+        if (sessionPtr->txnTable[seq & TXN_TABLE_MASK] == NULL)
+        {
+            sessionPtr->txnTable[seq & TXN_TABLE_MASK] = msgRef;
+            break;
+        }
+    }
 
-    msgMessage_SetTxnId(msgRef, le_ref_CreateRef(TxnMapRef, msgRef));
+    // If the table is full, the ID is still unique; the message will just have to be found
+    // on the Transaction List when the response arrives.
+    sessionPtr->nextTxnSeq = seq + 1;
 
-    UNLOCK
+    msgMessage_SetTxnId(msgRef, TxnIdFromSeq(seq));
+    msgMessage_SetStartTime(msgRef, GetRelativeTimeUs());
 }
 
 
@@ -235,17 +463,41 @@ static void CreateTxnId
 //--------------------------------------------------------------------------------------------------
 static le_msg_MessageRef_t LookupTxnId
 (
+    msgSession_Session_t* sessionPtr,
     le_msg_MessageRef_t msgRef
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_msg_MessageRef_t requestMsgRef;
+    void* txnId = msgMessage_GetTxnId(msgRef);
 
-    LOCK
-    requestMsgRef = le_ref_Lookup(TxnMapRef, msgMessage_GetTxnId(msgRef));
-    UNLOCK
+    if ((((uintptr_t)txnId) & 1) == 0)
+    {
+        return NULL;
+    }
+
+    le_msg_MessageRef_t requestMsgRef = sessionPtr->txnTable[SeqFromTxnId(txnId) & TXN_TABLE_MASK];
+
+    if ((requestMsgRef != NULL) && (msgMessage_GetTxnId(requestMsgRef) == txnId))
+    {
+        return requestMsgRef;
+    }
 
-    return requestMsgRef;
+    // The request didn't fit in the table, so search the Transaction List for it.
+    le_dls_Link_t* linkPtr = le_dls_Peek(&sessionPtr->txnList);
+
+    while (linkPtr != NULL)
+    {
+        requestMsgRef = msgMessage_GetMessageContainingLink(linkPtr);
+
+        if (msgMessage_GetTxnId(requestMsgRef) == txnId)
+        {
+            return requestMsgRef;
+        }
+
+        linkPtr = le_dls_PeekNext(&sessionPtr->txnList, linkPtr);
+    }
+
+    return NULL;
 }
 
 
@@ -256,15 +508,17 @@ static le_msg_MessageRef_t LookupTxnId
 //--------------------------------------------------------------------------------------------------
 static void DeleteTxnId
 (
+    msgSession_Session_t* sessionPtr,
     le_msg_MessageRef_t msgRef
 )
 //--------------------------------------------------------------------------------------------------
 {
-    LOCK
-
-    le_ref_DeleteRef(TxnMapRef, msgMessage_GetTxnId(msgRef));
+    uint32_t index = SeqFromTxnId(msgMessage_GetTxnId(msgRef)) & TXN_TABLE_MASK;
 
-    UNLOCK
+    if (sessionPtr->txnTable[index] == msgRef)
+    {
+        sessionPtr->txnTable[index] = NULL;
+    }
 }
 
 
@@ -286,17 +540,13 @@ static void AddToTxnList
 )
 //--------------------------------------------------------------------------------------------------
 {
-    LOCK
-
     le_dls_Queue(&sessionPtr->txnList, msgMessage_GetQueueLinkPtr(msgRef));
-
-    UNLOCK
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Removes a given message from a given session's transaction list and from the Transaction Map.
+ * Removes a given message from a given session's transaction list.
  */
 //--------------------------------------------------------------------------------------------------
 static void RemoveFromTxnList
@@ -306,11 +556,7 @@ static void RemoveFromTxnList
 )
 //--------------------------------------------------------------------------------------------------
 {
-    LOCK
-
     le_dls_Remove(&sessionPtr->txnList, msgMessage_GetQueueLinkPtr(msgRef));
-
-    UNLOCK
 }
 
 
@@ -328,22 +574,13 @@ static void PurgeTxnList
 )
 //--------------------------------------------------------------------------------------------------
 {
-    for (;;)
-    {
-        le_dls_Link_t* linkPtr;
-
-        LOCK
-        linkPtr = le_dls_Pop(&sessionPtr->txnList);
-        UNLOCK
-
-        if (linkPtr == NULL)
-        {
-            break;
-        }
+    le_dls_Link_t* linkPtr;
 
+    while (NULL != (linkPtr = le_dls_Pop(&sessionPtr->txnList)))
+    {
         le_msg_MessageRef_t msgRef = msgMessage_GetMessageContainingLink(linkPtr);
 
-        DeleteTxnId(msgRef);
+        DeleteTxnId(sessionPtr, msgRef);
 
         msgMessage_CallCompletionCallback(msgRef, NULL /* no response */);
 
@@ -378,7 +615,7 @@ static void PurgeTransmitQueue
             // and its transaction ID needs to be deleted.
             if ( (msgMessage_GetTxnId(msgRef) != NULL) )
             {
-                DeleteTxnId(msgRef);
+                DeleteTxnId(sessionPtr, msgRef);
             }
 
             // Call the message's completion callback function, if it has one.
@@ -413,6 +650,33 @@ static void PurgeReceiveQueue
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Releases the spare Message objects kept for receiving into.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PurgeRxSpareList
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr;
+
+    while (NULL != (linkPtr = le_dls_Pop(&sessionPtr->rxSpareList)))
+    {
+        le_msg_MessageRef_t msgRef = msgMessage_GetMessageContainingLink(linkPtr);
+
+        // Whatever was last received into a spare wasn't a valid request, so don't let the
+        // release complain about it not being responded to.
+        msgMessage_SetTxnId(msgRef, 0);
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    sessionPtr->rxBatchSize = 1;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a Session object.
@@ -437,7 +701,10 @@ static msgSession_Session_t* CreateSession
     sessionPtr->fdMonitorRef = NULL;
 
     sessionPtr->txnList = LE_DLS_LIST_INIT;
+    memset(sessionPtr->txnTable, 0, sizeof(sessionPtr->txnTable));
+    sessionPtr->nextTxnSeq = 0;
     sessionPtr->transmitQueue = LE_DLS_LIST_INIT;
+    sessionPtr->txQueueDepth = 0;
     sessionPtr->receiveQueue = LE_DLS_LIST_INIT;
 
     sessionPtr->contextPtr = NULL;
@@ -448,6 +715,25 @@ static msgSession_Session_t* CreateSession
     sessionPtr->closeHandler = NULL;
     sessionPtr->closeContextPtr = NULL;
 
+    sessionPtr->rxSpareList = LE_DLS_LIST_INIT;
+    sessionPtr->rxBatchSize = 1;
+
+    sessionPtr->shmSlotCount = 0;
+    sessionPtr->shmRef = NULL;
+    sessionPtr->shmPendingRef = NULL;
+    sessionPtr->shmMonitorRef = NULL;
+    sessionPtr->shmSetupFds[0] = -1;
+    sessionPtr->shmSetupFds[1] = -1;
+    sessionPtr->shmSetupFds[2] = -1;
+    sessionPtr->shmHeldMsgRef = NULL;
+    sessionPtr->txSocketCount = 0;
+    sessionPtr->rxSocketCount = 0;
+    sessionPtr->workerThread = NULL;
+    sessionPtr->isClosePending = false;
+    sessionPtr->openBatchPtr = NULL;
+    sessionPtr->openBatchLink = LE_DLS_LINK_INIT;
+    memset(&sessionPtr->stats, 0, sizeof(sessionPtr->stats));
+
     sessionPtr->interfaceRef = interfaceRef;
 
     SessionObjListChangeCount++;
@@ -457,6 +743,59 @@ static msgSession_Session_t* CreateSession
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops using a session's shared memory transport (if it has one) and releases everything
+ * associated with it.
+ *
+ * @note    This is used on both the client side and the server side.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopSharedMem
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (sessionPtr->shmMonitorRef != NULL)
+    {
+        le_fdMonitor_Delete(sessionPtr->shmMonitorRef);
+        sessionPtr->shmMonitorRef = NULL;
+    }
+
+    if (sessionPtr->shmRef != NULL)
+    {
+        msgShm_Delete(sessionPtr->shmRef);
+        sessionPtr->shmRef = NULL;
+    }
+
+    if (sessionPtr->shmPendingRef != NULL)
+    {
+        msgShm_Delete(sessionPtr->shmPendingRef);
+        sessionPtr->shmPendingRef = NULL;
+    }
+
+    size_t i;
+    for (i = 0; i < NUM_ARRAY_MEMBERS(sessionPtr->shmSetupFds); i++)
+    {
+        if (sessionPtr->shmSetupFds[i] >= 0)
+        {
+            fd_Close(sessionPtr->shmSetupFds[i]);
+            sessionPtr->shmSetupFds[i] = -1;
+        }
+    }
+
+    if (sessionPtr->shmHeldMsgRef != NULL)
+    {
+        le_msg_ReleaseMsg(sessionPtr->shmHeldMsgRef);
+        sessionPtr->shmHeldMsgRef = NULL;
+    }
+
+    sessionPtr->txSocketCount = 0;
+    sessionPtr->rxSocketCount = 0;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Closes a session.
@@ -472,6 +811,14 @@ static void CloseSession
 {
     sessionPtr->state = LE_MSG_SESSION_STATE_CLOSED;
 
+    // If the session's open request is still pending in an open batch, the response will never
+    // be needed now.
+    if (sessionPtr->openBatchPtr != NULL)
+    {
+        le_dls_Remove(&sessionPtr->openBatchPtr->pendingList, &sessionPtr->openBatchLink);
+        sessionPtr->openBatchPtr = NULL;
+    }
+
     // Always notify the server on close.
     if (sessionPtr->interfaceRef->interfaceType == LE_MSG_INTERFACE_SERVER)
     {
@@ -480,6 +827,9 @@ static void CloseSession
         msgInterface_CallCloseHandler((le_msg_ServiceRef_t)sessionPtr->interfaceRef, sessionPtr);
     }
 
+    // Stop using shared memory.
+    StopSharedMem(sessionPtr);
+
     // Delete the socket and the FD Monitor.
     if (sessionPtr->fdMonitorRef != NULL)
     {
@@ -497,6 +847,7 @@ static void CloseSession
     }
     PurgeTransmitQueue(sessionPtr);
     PurgeReceiveQueue(sessionPtr);
+    PurgeRxSpareList(sessionPtr);
 }
 
 
@@ -747,14 +1098,15 @@ static void ProcessMessageFromServer
 {
     // This is either an asynchronous response message or an indication message from the server.
     // If it is an asynchronous response, this newly received message will have a matching
-    // request message on the Transaction List and in the Transaction Map.
+    // request message on the Transaction List (and usually in the Transaction Table).
 
-    // Use the Transaction Map to look for the request message.
-    le_msg_MessageRef_t requestMsgRef = LookupTxnId(msgRef);
+    // Look for the request message.
+    le_msg_MessageRef_t requestMsgRef = LookupTxnId(sessionPtr, msgRef);
     if (requestMsgRef != NULL)
     {
-        // The transaction is complete!  Remove it from the Transaction Map.
-        DeleteTxnId(requestMsgRef);
+        // The transaction is complete!  Remove it from the Transaction Table.
+        RecordRoundTripTime(sessionPtr, requestMsgRef);
+        DeleteTxnId(sessionPtr, requestMsgRef);
 
         // Remove the request message from the session's Transaction List.
         RemoveFromTxnList(sessionPtr, requestMsgRef);
@@ -805,8 +1157,15 @@ static void ProcessReceivedMessages
         }
         else if (sessionPtr->interfaceRef->interfaceType == LE_MSG_INTERFACE_SERVER)
         {
-            msgInterface_ProcessMessageFromClient((le_msg_ServiceRef_t)sessionPtr->interfaceRef,
-                                                  msgRef);
+            if (msgShm_IsSetupTxnId(msgMessage_GetTxnId(msgRef)))
+            {
+                HandleSharedMemSetup(sessionPtr, msgRef);
+            }
+            else
+            {
+                msgInterface_ProcessMessageFromClient((le_msg_ServiceRef_t)sessionPtr->interfaceRef,
+                                                      msgRef);
+            }
         }
     }
 }
@@ -902,32 +1261,226 @@ static void ClientSocketError
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Receive messages from the socket and put them on the Receive Queue.
+ * Checks whether the next message in a session's shared memory ring is due for delivery, i.e.,
+ * whether all the socket messages that were sent before it have been delivered.
+ *
+ * @return true if there is a message in the ring and it's due.
  */
 //--------------------------------------------------------------------------------------------------
-static void ReceiveMessages
+static bool IsSharedMemMessageDue
 (
     msgSession_Session_t* sessionPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
+    uint32_t socketSeq;
+
+    return (   msgShm_Peek(sessionPtr->shmRef, &socketSeq)
+            && ((int32_t)(socketSeq - sessionPtr->rxSocketCount) <= 0));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive the next message, in order, on a session that uses a shared memory transport.
+ *
+ * Messages come through the shared memory ring, except for those carrying file descriptors,
+ * which come through the socket.  Each message in the ring records how many socket messages were
+ * sent before it, so those are always delivered first.
+ *
+ * @return
+ * - LE_OK if a message was received.
+ * - LE_WOULD_BLOCK if there's nothing to receive right now.
+ * - LE_CLOSED if the connection has closed.
+ * - LE_COMM_ERROR if an error was encountered.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReceiveSharedMemMessage
+(
+    msgSession_Session_t* sessionPtr,
+    le_msg_MessageRef_t* msgRefPtr      ///< [OUT] The message received.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_MessageRef_t msgRef;
+    le_result_t result;
+
     for (;;)
     {
-        // Create a Message object.
-        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionPtr);
+        if (IsSharedMemMessageDue(sessionPtr))
+        {
+            msgRef = le_msg_CreateMsg(sessionPtr);
 
-        // Receive from the socket into the Message object.
-        le_result_t result = msgMessage_Receive(sessionPtr->socketFd, msgRef);
+            if (msgMessage_ReceiveShm(sessionPtr->shmRef, msgRef) == LE_OK)
+            {
+                *msgRefPtr = msgRef;
+                return LE_OK;
+            }
 
-        if (result == LE_OK)
+            // Drop the bad message and move on to the next one.
+            msgMessage_SetTxnId(msgRef, 0);
+            le_msg_ReleaseMsg(msgRef);
+            continue;
+        }
+
+        // The next message is in the socket, if anywhere.  It may have been received already
+        // and held back while earlier messages were delivered from the ring.
+        msgRef = sessionPtr->shmHeldMsgRef;
+        if (msgRef == NULL)
+        {
+            msgRef = le_msg_CreateMsg(sessionPtr);
+
+            result = msgMessage_Receive(sessionPtr->socketFd, msgRef);
+            if (result != LE_OK)
+            {
+                msgMessage_SetTxnId(msgRef, 0);
+                le_msg_ReleaseMsg(msgRef);
+                return result;
+            }
+
+            // A message may have been put in the ring after we looked, but before this one was
+            // sent.  If so, it has to go first.
+            if (IsSharedMemMessageDue(sessionPtr))
+            {
+                sessionPtr->shmHeldMsgRef = msgRef;
+                continue;
+            }
+        }
+
+        sessionPtr->shmHeldMsgRef = NULL;
+        sessionPtr->rxSocketCount++;
+
+        *msgRefPtr = msgRef;
+        return LE_OK;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive messages from a session's shared memory transport (and socket) and put them on the
+ * Receive Queue, then tell the other side that we're going to sleep.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReceiveSharedMemMessages
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (;;)
+    {
+        le_msg_MessageRef_t msgRef;
+        le_result_t result;
+
+        while (LE_OK == (result = ReceiveSharedMemMessage(sessionPtr, &msgRef)))
         {
-            // Received something.  Push it onto the Receive Queue for later processing.
             PushReceiveQueue(sessionPtr, msgRef);
         }
-        else
+
+        // If the socket closed or failed, the FD Monitor will tell us about it.
+        if (result != LE_WOULD_BLOCK)
+        {
+            break;
+        }
+
+        // If something arrived in the ring just as we were about to sleep, go around again.
+        // But if the ring's next message is still waiting for a socket message, the socket
+        // will wake us up when it arrives.
+        if (msgShm_PrepareToSleep(sessionPtr->shmRef) || !IsSharedMemMessageDue(sessionPtr))
+        {
+            break;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive messages from the socket and put them on the Receive Queue.
+ *
+ * Messages are received in batches.  The batch size grows while batches come back full and
+ * shrinks when they don't, and Message objects that weren't needed are kept on the session's
+ * spare list for next time, so a quiet session doesn't tie up more than one Message object.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReceiveMessages
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_MessageRef_t batch[MSG_MESSAGE_BATCH_SIZE];
+
+    if (sessionPtr->shmRef != NULL)
+    {
+        ReceiveSharedMemMessages(sessionPtr);
+        return;
+    }
+
+    for (;;)
+    {
+        // Get Message objects to receive into, reusing spares where possible.
+        size_t count;
+        for (count = 0; count < sessionPtr->rxBatchSize; count++)
+        {
+            le_dls_Link_t* linkPtr = le_dls_Pop(&sessionPtr->rxSpareList);
+
+            if (linkPtr != NULL)
+            {
+                batch[count] = msgMessage_GetMessageContainingLink(linkPtr);
+            }
+            else
+            {
+                batch[count] = le_msg_CreateMsg(sessionPtr);
+            }
+        }
+
+        // Receive from the socket into the Message objects.
+        size_t receivedCount;
+        size_t socketCount;
+        le_result_t result = msgMessage_ReceiveBatch(sessionPtr->socketFd,
+                                                     batch,
+                                                     count,
+                                                     &receivedCount,
+                                                     &socketCount);
+
+        // Push whatever was received onto the Receive Queue for later processing, and keep the
+        // rest of the Message objects for next time.
+        size_t i;
+        for (i = 0; i < receivedCount; i++)
+        {
+            PushReceiveQueue(sessionPtr, batch[i]);
+        }
+        sessionPtr->rxSocketCount += socketCount;
+        for (; i < count; i++)
+        {
+            le_dls_Stack(&sessionPtr->rxSpareList, msgMessage_GetQueueLinkPtr(batch[i]));
+        }
+
+        if (result != LE_OK)
         {
             // Nothing left to receive from the socket.  We are done.
-            le_msg_ReleaseMsg(msgRef);
+            break;
+        }
+
+        // Messages that were dropped as invalid still count, so a batch that had some dropped
+        // doesn't look like the socket was drained.
+        if (socketCount == count)
+        {
+            // The batch was full, so there may be more waiting.  Try a bigger batch.
+            if (sessionPtr->rxBatchSize < MSG_MESSAGE_BATCH_SIZE)
+            {
+                sessionPtr->rxBatchSize *= 2;
+            }
+        }
+        else
+        {
+            // The socket has been drained.  If most of the batch went unused, shrink it.
+            if ((socketCount < (count / 2)) && (sessionPtr->rxBatchSize > 1))
+            {
+                sessionPtr->rxBatchSize /= 2;
+            }
             break;
         }
     }
@@ -980,10 +1533,140 @@ static void ServerSocketError
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finish with a message that has been sent from a session's Transmit Queue.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FinishSentMessage
+(
+    msgSession_Session_t* sessionPtr,
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    CountSent(sessionPtr, msgRef);
+
+    switch (sessionPtr->interfaceRef->interfaceType)
+    {
+        // If this is the client side of the session,
+        case LE_MSG_INTERFACE_CLIENT:
+            // If a response is expected from the other side later, then put this
+            // message on the Transaction List.
+            if (msgMessage_GetTxnId(msgRef) != 0)
+            {
+                AddToTxnList(sessionPtr, msgRef);
+            }
+            // Otherwise, release it.
+            else
+            {
+                le_msg_ReleaseMsg(msgRef);
+            }
+
+            break;
+
+        // If this is the server side of the session,
+        case LE_MSG_INTERFACE_SERVER:
+            // If this was the acknowledgement of a shared memory transport, start using it.
+            if (msgMessage_GetTxnId(msgRef) == MSG_SHM_TXN_ID_ACK_OK)
+            {
+                ActivateSharedMem(sessionPtr, sessionPtr->shmPendingRef);
+                sessionPtr->shmPendingRef = NULL;
+            }
+
+            // Release the message, but first clear out the transaction ID so that
+            // the message knows that it is not being deleted without a reponse message
+            // being sent if one was expected.
+            msgMessage_SetTxnId(msgRef, 0);
+            le_msg_ReleaseMsg(msgRef);
+
+            break;
+
+        default:
+            LE_FATAL("Unhandled interface type (%d)",
+                     sessionPtr->interfaceRef->interfaceType);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send messages from the Transmit Queue of a session that uses a shared memory transport, until
+ * either the ring (or the socket) becomes full or there are no more messages waiting.
+ *
+ * Messages carrying file descriptors go through the socket.  The rest go through the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendToSharedMem
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_MessageRef_t msgRef;
+    bool socketFull = false;
+
+    while (NULL != (msgRef = PopTransmitQueue(sessionPtr)))
+    {
+        le_result_t result;
+        bool hasFd = msgMessage_HasFd(msgRef);
+
+        if (hasFd)
+        {
+            result = msgMessage_Send(sessionPtr->socketFd, msgRef);
+            if (result == LE_OK)
+            {
+                sessionPtr->txSocketCount++;
+            }
+        }
+        else
+        {
+            result = msgMessage_SendShm(sessionPtr->shmRef, msgRef, sessionPtr->txSocketCount);
+        }
+
+        if (result == LE_OK)
+        {
+            FinishSentMessage(sessionPtr, msgRef);
+            continue;
+        }
+
+        UnPopTransmitQueue(sessionPtr, msgRef);
+
+        if (result == LE_NO_MEMORY)
+        {
+            // If the socket is full, the FD Monitor will tell us when it's writeable again.
+            // If the ring is full, the other side will wake us up when it frees a slot.
+            CountBackPressure(sessionPtr);
+            socketFull = hasFd;
+        }
+        else if (result != LE_COMM_ERROR)
+        {
+            LE_FATAL("Unexpected return code %d.", result);
+        }
+
+        break;
+    }
+
+    if (socketFull)
+    {
+        EnableWriteabilityNotification(sessionPtr);
+    }
+    else
+    {
+        DisableWriteabilityNotification(sessionPtr);
+    }
+
+    msgShm_WakePeer(sessionPtr->shmRef);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Send messages from a session's Transmit Queue until either the socket becomes full or there
  * are no more messages waiting on the queue.
+ *
+ * Consecutive messages that don't carry file descriptors are sent in batches with a single
+ * system call.  A message carrying a file descriptor is sent on its own.
  */
 //--------------------------------------------------------------------------------------------------
 static void SendFromTransmitQueue
@@ -992,11 +1675,41 @@ static void SendFromTransmitQueue
 )
 //--------------------------------------------------------------------------------------------------
 {
+    le_msg_MessageRef_t batch[MSG_MESSAGE_BATCH_SIZE];
+
     for (;;)
     {
-        le_msg_MessageRef_t msgRef = PopTransmitQueue(sessionPtr);
+        if (sessionPtr->shmRef != NULL)
+        {
+            SendToSharedMem(sessionPtr);
+            return;
+        }
 
-        if (msgRef == NULL)
+        // Pop the next batch of messages off the queue.
+        size_t count = 0;
+        le_msg_MessageRef_t msgRef;
+        while (   (count < MSG_MESSAGE_BATCH_SIZE)
+               && ((msgRef = PopTransmitQueue(sessionPtr)) != NULL))
+        {
+            if (msgMessage_HasFd(msgRef))
+            {
+                // A message with an fd goes on its own, so if it can't start a batch, leave it
+                // for the next one.
+                if (count > 0)
+                {
+                    UnPopTransmitQueue(sessionPtr, msgRef);
+                }
+                else
+                {
+                    batch[count++] = msgRef;
+                }
+                break;
+            }
+
+            batch[count++] = msgRef;
+        }
+
+        if (count == 0)
         {
             // Since the Transmit Queue is empty, tell the FD Monitor that we don't need to be
             // notified about writeability anymore.
@@ -1004,51 +1717,43 @@ static void SendFromTransmitQueue
             break;
         }
 
-        le_result_t result = msgMessage_Send(sessionPtr->socketFd, msgRef);
+        le_result_t result;
+        size_t sentCount;
+
+        if (count == 1)
+        {
+            result = msgMessage_Send(sessionPtr->socketFd, batch[0]);
+            sentCount = (result == LE_OK) ? 1 : 0;
+        }
+        else
+        {
+            result = msgMessage_SendBatch(sessionPtr->socketFd, batch, count, &sentCount);
+        }
+
+        sessionPtr->txSocketCount += sentCount;
+
+        size_t i;
+        for (i = 0; i < sentCount; i++)
+        {
+            FinishSentMessage(sessionPtr, batch[i]);
+        }
+
+        // Put any messages that weren't sent back on the head of the queue, in their original
+        // order.
+        for (i = count; i > sentCount; i--)
+        {
+            UnPopTransmitQueue(sessionPtr, batch[i - 1]);
+        }
 
         switch (result)
         {
             case LE_OK:
-                switch (sessionPtr->interfaceRef->interfaceType)
-                {
-                    // If this is the client side of the session,
-                    case LE_MSG_INTERFACE_CLIENT:
-                        // If a response is expected from the other side later, then put this
-                        // message on the Transaction List.
-                        if (msgMessage_GetTxnId(msgRef) != 0)
-                        {
-                            AddToTxnList(sessionPtr, msgRef);
-                        }
-                        // Otherwise, release it.
-                        else
-                        {
-                            le_msg_ReleaseMsg(msgRef);
-                        }
-
-                        break;
-
-                    // If this is the server side of the session,
-                    case LE_MSG_INTERFACE_SERVER:
-                        // Release the message, but first clear out the transaction ID so that
-                        // the message knows that it is not being deleted without a reponse message
-                        // being sent if one was expected.
-                        msgMessage_SetTxnId(msgRef, 0);
-                        le_msg_ReleaseMsg(msgRef);
-
-                        break;
-
-                    default:
-                        LE_FATAL("Unhandled interface type (%d)",
-                                 sessionPtr->interfaceRef->interfaceType);
-                }
-
-                break;  // Continue to loop around and send another.
+                break;  // Continue to loop around and send more.
 
             case LE_NO_MEMORY:
-                // Have to wait for the socket to become writeable.  Put the message back on
-                // the head of the queue and ask the FD Monitor to tell us when the socket becomes
-                // writeable again.
-                UnPopTransmitQueue(sessionPtr, msgRef);
+                // Have to wait for the socket to become writeable.  Ask the FD Monitor to tell
+                // us when the socket becomes writeable again.
+                CountBackPressure(sessionPtr);
                 EnableWriteabilityNotification(sessionPtr);
 
                 return;
@@ -1056,10 +1761,8 @@ static void SendFromTransmitQueue
             case LE_COMM_ERROR:
                 // In this case, we expect a handler function to be called by the FD Monitor,
                 // so we don't need to handle this case here.  However, we must stop
-                // trying to transmit now.  Stick the current message back on the Transmit Queue
-                // so it gets cleaned up with the others when the session closes.
-                UnPopTransmitQueue(sessionPtr, msgRef);
-
+                // trying to transmit now.  The unsent messages are back on the Transmit Queue
+                // so they get cleaned up with the others when the session closes.
                 return;
 
             default:
@@ -1089,19 +1792,46 @@ static void ClientSocketReadable
             break;
 
         case LE_MSG_SESSION_STATE_OPENING:
+            if (sessionPtr->shmPendingRef != NULL)
+            {
+                // The Session is waiting for the server's answer to our shared memory offer.
+                le_result_t result = ReceiveSharedMemAck(sessionPtr);
+
+                if (result == LE_WOULD_BLOCK)
+                {
+                    break;
+                }
+                else if (result != LE_OK)
+                {
+                    RetryOpen(sessionPtr);
+                    break;
+                }
+            }
             // The Session is waiting for notification from the server that the session
             // has been opened.
-            if (ReceiveSessionOpenResponse(sessionPtr) != LE_OK)
+            else if (ReceiveSessionOpenResponse(sessionPtr) != LE_OK)
             {
                 RetryOpen(sessionPtr);
+                break;
             }
-            else
+            // If the client asked for shared memory, offer it to the server and wait for its
+            // answer before telling the client the session is open.
+            else if (SendSharedMemSetup(sessionPtr))
             {
-                sessionPtr->state = LE_MSG_SESSION_STATE_OPEN;
+                break;
+            }
 
-                // Call the client's completion callback.
-                sessionPtr->openHandler(sessionPtr, sessionPtr->openContextPtr);
+            sessionPtr->state = LE_MSG_SESSION_STATE_OPEN;
+
+            // Anything the server sent before answering our shared memory offer is processed
+            // after the client has been told the session is open.
+            if (!le_dls_IsEmpty(&sessionPtr->receiveQueue))
+            {
+                TriggerDeferredProcessing(sessionPtr);
             }
+
+            // Call the client's completion callback.
+            sessionPtr->openHandler(sessionPtr, sessionPtr->openContextPtr);
             break;
 
         case LE_MSG_SESSION_STATE_OPEN:
@@ -1391,113 +2121,645 @@ static void AttemptOpen
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Attempts to open a session, blocking (not returning) until the attempt is complete.
+ * Finishes an attempt to open a session that was started by StartSessionOpenAttempt(), blocking
+ * (not returning) until the Service Directory or the server responds.
  *
  * Updates the session state to either OPEN or CLOSED, depending on the result.
  *
  * @return
  * - LE_OK if the session was successfully opened.
- * - LE_UNAVAILABLE if shouldWait and server not currently offering service client i/f bound to.
- * - LE_NOT_PERMITTED if shouldWait and the client interface is not bound to any service.
- * - LE_COMM_ERROR if the Service Directory cannot be reached.
+ * - LE_UNAVAILABLE if server not currently offering service client i/f bound to.
+ * - LE_NOT_PERMITTED if the client interface is not bound to any service.
+ * - LE_CLOSED if the server closed the connection before accepting it.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AttemptOpenSync
+static le_result_t FinishOpenSync
 (
-    msgSession_Session_t* sessionPtr,
-    bool shouldWait         ///< true = if the client interface is not bound or the server is
-                            ///         not advertising the service at this time, then wait
-                            ///         until the binding or advertisement happens.
-                            ///  false = don't wait for a binding or advertisement if either is
-                            ///         missing at this time.
+    msgSession_Session_t* sessionPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_result_t result;
+    // Block until a response is received.
+    le_result_t result = ReceiveSessionOpenResponse(sessionPtr);
 
-    do
+    // If a server didn't accept us, give up on this attempt.
+    if (result != LE_OK)
     {
-        // Start the session "Open" attempt.
-        result = StartSessionOpenAttempt(sessionPtr, shouldWait);
+        CloseSession(sessionPtr);
+        return result;
+    }
 
-        if (result == LE_OK)
-        {
-            // Block until a response is received.
-            result = ReceiveSessionOpenResponse(sessionPtr);
+    // Set the socket non-blocking for future operation.
+    fd_SetNonBlocking(sessionPtr->socketFd);
 
-            // If a server accepted us,
-            if (result == LE_OK)
+    // Start monitoring for events on this socket.
+    StartSocketMonitoring(sessionPtr, ClientSocketEventHandler);
+
+    sessionPtr->state = LE_MSG_SESSION_STATE_OPEN;
+
+    // If the client asked for shared memory, offer it to the server and wait for
+    // its answer.  If the socket fails meanwhile, the socket monitor will report it.
+    if (SendSharedMemSetup(sessionPtr))
+    {
+        fd_SetBlocking(sessionPtr->socketFd);
+        if (ReceiveSharedMemAck(sessionPtr) != LE_OK)
+        {
+            msgShm_Delete(sessionPtr->shmPendingRef);
+            sessionPtr->shmPendingRef = NULL;
+        }
+        fd_SetNonBlocking(sessionPtr->socketFd);
+
+        if (!le_dls_IsEmpty(&sessionPtr->receiveQueue))
+        {
+            TriggerDeferredProcessing(sessionPtr);
+        }
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Attempts to open a session, blocking (not returning) until the attempt is complete.
+ *
+ * Updates the session state to either OPEN or CLOSED, depending on the result.
+ *
+ * @return
+ * - LE_OK if the session was successfully opened.
+ * - LE_UNAVAILABLE if shouldWait and server not currently offering service client i/f bound to.
+ * - LE_NOT_PERMITTED if shouldWait and the client interface is not bound to any service.
+ * - LE_COMM_ERROR if the Service Directory cannot be reached.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AttemptOpenSync
+(
+    msgSession_Session_t* sessionPtr,
+    bool shouldWait         ///< true = if the client interface is not bound or the server is
+                            ///         not advertising the service at this time, then wait
+                            ///         until the binding or advertisement happens.
+                            ///  false = don't wait for a binding or advertisement if either is
+                            ///         missing at this time.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result;
+
+    do
+    {
+        // Start the session "Open" attempt.
+        result = StartSessionOpenAttempt(sessionPtr, shouldWait);
+
+        if (result == LE_OK)
+        {
+            result = FinishOpenSync(sessionPtr);
+        }
+
+    } while (result == LE_CLOSED);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens a session, blocking (not returning) until it is open.  Retries for as long as the
+ * session fails to open.
+ *
+ * This function logs a fatal error and terminates the calling process if the Service Directory
+ * can't be reached.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OpenSessionSync
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result;
+
+    do
+    {
+        result = AttemptOpenSync(sessionPtr, true /* wait if necessary */ );
+
+        if (result != LE_OK)
+        {
+            // Failure to connect to the Service Directory is a fatal error.
+            if (result == LE_COMM_ERROR)
             {
-                // Set the socket non-blocking for future operation.
-                fd_SetNonBlocking(sessionPtr->socketFd);
+                LE_FATAL("Failed to connect to the Service Directory.");
+            }
+
+            // For any other error, report an error and retry.
+            le_msg_InterfaceRef_t interfaceRef = le_msg_GetSessionInterface(sessionPtr);
+            LE_ERROR("Session failed (%s). Retrying... (%s:%s)",
+                     LE_RESULT_TXT(result),
+                     le_msg_GetInterfaceName(interfaceRef),
+                     le_msg_GetProtocolIdStr(le_msg_GetInterfaceProtocol(interfaceRef)));
+        }
+
+    } while (result != LE_OK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finishes opening a session whose open request was sent as part of an open batch, blocking
+ * (not returning) until it is open.
+ *
+ * If the open request fails, the session is opened again the usual (unbatched) way.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CompletePendingOpen
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Remove(&sessionPtr->openBatchPtr->pendingList, &sessionPtr->openBatchLink);
+    sessionPtr->openBatchPtr = NULL;
+
+    if (FinishOpenSync(sessionPtr) != LE_OK)
+    {
+        OpenSessionSync(sessionPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Do deferred processing of the Receive Queue for a session.
+ *
+ * This is really just a way to kick start processing of messages on the session's
+ * Receive Queue later, when they couldn't be processed immediately because a synchronous
+ * transaction was underway at the time.
+ *
+ * The that Receive Queue could have already been drained before this
+ * function was run, so don't get upset if there aren't any messages left to process.
+ *
+ * @warning The Session may have already been closed, reopened, or even deleted since the function
+ *          call was queued to the Event Queue.
+ *
+ * @note    This function is called by the Event Loop as a "queued function".
+ *          That's why the parameter list looks unusual.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessDeferredMessages
+(
+    void* param1Ptr,    ///< [IN] Pointer to a Session object.
+    void* param2Ptr     ///< not used
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgSession_Session_t* sessionPtr = param1Ptr;
+
+    ProcessReceivedMessages(sessionPtr);
+
+    // NOTE: Each of these queued functions holds a reference to the session object so that
+    //       the session object doesn't go away.  But it could go away as soon as we release it.
+    le_mem_Release(sessionPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trigger deferred message queue processing.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TriggerDeferredProcessing
+(
+    msgSession_Session_t*  sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // NOTE: Each of these queued functions holds a reference to the session object so that
+    //       the session object doesn't go away before the queued function is run.
+    le_mem_AddRef(sessionPtr);
+    le_event_QueueFunction(ProcessDeferredMessages, sessionPtr, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File descriptor monitoring event handler function for a shared memory transport's wake
+ * eventfd.  The other side writes to it when it has put messages in the ring while we were
+ * asleep, or when it has freed a slot in a ring that we found full.
+ *
+ * @note    This function is used for both clients and servers.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void SharedMemWakeHandler
+(
+    int fd,         ///< eventfd file descriptor.
+    short events    ///< Bit map of events that occurred (see 'man 2 poll')
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgSession_Session_t* sessionPtr = le_fdMonitor_GetContextPtr();
+
+    msgShm_ClearWake(sessionPtr->shmRef);
+
+    // Send first, because processing received messages could delete the session.
+    if (!le_dls_IsEmpty(&sessionPtr->transmitQueue))
+    {
+        SendFromTransmitQueue(sessionPtr);
+    }
+
+    ReceiveMessages(sessionPtr);
+    ProcessReceivedMessages(sessionPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts using a shared memory transport for a session.
+ *
+ * @note    This function is used for both clients and servers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ActivateSharedMem
+(
+    msgSession_Session_t* sessionPtr,
+    msgShm_TransportRef_t shmRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    sessionPtr->shmRef = shmRef;
+
+    sessionPtr->shmMonitorRef = le_fdMonitor_Create(le_msg_GetInterfaceName(
+                                                                    sessionPtr->interfaceRef),
+                                                    msgShm_GetWakeFd(shmRef),
+                                                    SharedMemWakeHandler,
+                                                    POLLIN);
+
+    le_fdMonitor_SetContextPtr(sessionPtr->shmMonitorRef, sessionPtr);
+
+    TRACE("Using shared memory on session with service (%s:%s).",
+          le_msg_GetInterfaceName(sessionPtr->interfaceRef),
+          le_msg_GetProtocolIdStr(le_msg_GetInterfaceProtocol(sessionPtr->interfaceRef)));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Offers the server a shared memory transport for a session that has just opened, if the client
+ * asked for one.  The server's answer must then be received using ReceiveSharedMemAck().
+ *
+ * @note    This is used only on the client side.
+ *
+ * @return true if the offer was sent, false if the session will just use its socket.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool SendSharedMemSetup
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static void* const setupTxnIds[] = { MSG_SHM_TXN_ID_SETUP_MEM,
+                                         MSG_SHM_TXN_ID_SETUP_SERVER_WAKE,
+                                         MSG_SHM_TXN_ID_SETUP_CLIENT_WAKE };
+
+    if (sessionPtr->shmSlotCount == 0)
+    {
+        return false;
+    }
+
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetSessionProtocol(sessionPtr);
+    msgShm_TransportRef_t shmRef = msgShm_Create(le_msg_GetProtocolMaxMsgSize(protocolRef),
+                                                 sessionPtr->shmSlotCount);
+    if (shmRef == NULL)
+    {
+        LE_WARN("Shared memory not available for session with service (%s:%s).",
+                le_msg_GetInterfaceName(sessionPtr->interfaceRef),
+                le_msg_GetProtocolIdStr(protocolRef));
+        return false;
+    }
+
+    // Send the server the memory and the eventfds, one per message.  These are tiny and the
+    // socket is new, so it's fine to block here.
+    fd_SetBlocking(sessionPtr->socketFd);
+
+    le_result_t result = LE_OK;
+    size_t i;
+    for (i = 0; (i < NUM_ARRAY_MEMBERS(setupTxnIds)) && (result == LE_OK); i++)
+    {
+        void* txnId = setupTxnIds[i];
+
+        result = unixSocket_SendMsg(sessionPtr->socketFd,
+                                    &txnId,
+                                    sizeof(txnId),
+                                    msgShm_GetSetupFd(shmRef, txnId),
+                                    false);
+        if (result == LE_OK)
+        {
+            sessionPtr->txSocketCount++;
+        }
+    }
+
+    fd_SetNonBlocking(sessionPtr->socketFd);
+
+    msgShm_CloseMemFd(shmRef);
+
+    // If that failed, the socket is broken and the socket monitor will report it.
+    if (result != LE_OK)
+    {
+        msgShm_Delete(shmRef);
+        return false;
+    }
+
+    sessionPtr->shmPendingRef = shmRef;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receives the server's answer to a shared memory transport offer sent by SendSharedMemSetup(),
+ * and starts using the transport if the server accepted it.
+ *
+ * Messages are received from the socket one at a time, so that nothing the server sent after its
+ * answer is received before the transport is active.  Anything the server sent before its answer
+ * is put on the session's Receive Queue.
+ *
+ * @note    This is used only on the client side.
+ *
+ * @return
+ * - LE_OK if the answer was received (whatever it was).
+ * - LE_WOULD_BLOCK if the socket is non-blocking and the answer hasn't arrived yet.
+ * - LE_CLOSED or LE_COMM_ERROR if the socket failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReceiveSharedMemAck
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (;;)
+    {
+        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionPtr);
+
+        le_result_t result = msgMessage_Receive(sessionPtr->socketFd, msgRef);
+        if (result != LE_OK)
+        {
+            le_msg_ReleaseMsg(msgRef);
+            return result;
+        }
+
+        sessionPtr->rxSocketCount++;
+
+        void* txnId = msgMessage_GetTxnId(msgRef);
+        if ((txnId != MSG_SHM_TXN_ID_ACK_OK) && (txnId != MSG_SHM_TXN_ID_ACK_FAIL))
+        {
+            PushReceiveQueue(sessionPtr, msgRef);
+            continue;
+        }
+
+        le_msg_ReleaseMsg(msgRef);
+
+        msgShm_TransportRef_t shmRef = sessionPtr->shmPendingRef;
+        sessionPtr->shmPendingRef = NULL;
+
+        if (txnId == MSG_SHM_TXN_ID_ACK_OK)
+        {
+            ActivateSharedMem(sessionPtr, shmRef);
+        }
+        else
+        {
+            LE_WARN("Server refused shared memory for session with service (%s:%s).",
+                    le_msg_GetInterfaceName(sessionPtr->interfaceRef),
+                    le_msg_GetProtocolIdStr(le_msg_GetSessionProtocol(sessionPtr)));
+            msgShm_Delete(shmRef);
+        }
+
+        return LE_OK;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handles one of the messages a client sends to set up a shared memory transport.  Once they
+ * have all arrived, the memory is mapped and the client is sent an acknowledgement.  The
+ * transport is used from when the acknowledgement has been sent.
+ *
+ * @note    This is used only on the server side.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleSharedMemSetup
+(
+    msgSession_Session_t* sessionPtr,
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    void* txnId = msgMessage_GetTxnId(msgRef);
+    int fd = le_msg_GetFd(msgRef);
+
+    // This isn't a request, so don't let the release complain about it not being responded to.
+    msgMessage_SetTxnId(msgRef, 0);
+    le_msg_ReleaseMsg(msgRef);
+
+    size_t index;
+    if (txnId == MSG_SHM_TXN_ID_SETUP_MEM)
+    {
+        index = 0;
+    }
+    else if (txnId == MSG_SHM_TXN_ID_SETUP_SERVER_WAKE)
+    {
+        index = 1;
+    }
+    else if (txnId == MSG_SHM_TXN_ID_SETUP_CLIENT_WAKE)
+    {
+        index = 2;
+    }
+    else
+    {
+        LE_ERROR("Unexpected shared memory set-up message (%p) from client.", txnId);
+        if (fd >= 0)
+        {
+            fd_Close(fd);
+        }
+        return;
+    }
+
+    if (sessionPtr->shmSetupFds[index] >= 0)
+    {
+        fd_Close(sessionPtr->shmSetupFds[index]);
+    }
+    sessionPtr->shmSetupFds[index] = fd;
+
+    if (   (sessionPtr->shmSetupFds[0] < 0)
+        || (sessionPtr->shmSetupFds[1] < 0)
+        || (sessionPtr->shmSetupFds[2] < 0))
+    {
+        // Wait for the rest.
+        return;
+    }
+
+    msgShm_TransportRef_t shmRef = NULL;
+    if ((sessionPtr->shmRef == NULL) && (sessionPtr->shmPendingRef == NULL))
+    {
+        shmRef = msgShm_Attach(le_msg_GetProtocolMaxMsgSize(le_msg_GetSessionProtocol(sessionPtr)),
+                               sessionPtr->shmSetupFds[0],
+                               sessionPtr->shmSetupFds[1],
+                               sessionPtr->shmSetupFds[2]);
+    }
+    else
+    {
+        LE_ERROR("Client asked for a second shared memory transport.");
+        fd_Close(sessionPtr->shmSetupFds[0]);
+        fd_Close(sessionPtr->shmSetupFds[1]);
+        fd_Close(sessionPtr->shmSetupFds[2]);
+    }
 
-                // Start monitoring for events on this socket.
-                StartSocketMonitoring(sessionPtr, ClientSocketEventHandler);
+    sessionPtr->shmSetupFds[0] = -1;
+    sessionPtr->shmSetupFds[1] = -1;
+    sessionPtr->shmSetupFds[2] = -1;
 
-                sessionPtr->state = LE_MSG_SESSION_STATE_OPEN;
-            }
-            else
-            {
-                CloseSession(sessionPtr);
-            }
-        }
+    // Answer through the socket, after anything already waiting to go.
+    sessionPtr->shmPendingRef = shmRef;
 
-    } while (result == LE_CLOSED);
+    le_msg_MessageRef_t ackRef = le_msg_CreateMsg(sessionPtr);
+    msgMessage_SetTxnId(ackRef, (shmRef != NULL) ? MSG_SHM_TXN_ID_ACK_OK : MSG_SHM_TXN_ID_ACK_FAIL);
 
-    return result;
+    PushTransmitQueue(sessionPtr, ackRef);
+    SendFromTransmitQueue(sessionPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Do deferred processing of the Receive Queue for a session.
- *
- * This is really just a way to kick start processing of messages on the session's
- * Receive Queue later, when they couldn't be processed immediately because a synchronous
- * transaction was underway at the time.
- *
- * The that Receive Queue could have already been drained before this
- * function was run, so don't get upset if there aren't any messages left to process.
- *
- * @warning The Session may have already been closed, reopened, or even deleted since the function
- *          call was queued to the Event Queue.
- *
- * @note    This function is called by the Event Loop as a "queued function".
- *          That's why the parameter list looks unusual.
+ * Waits until the other side of a session's shared memory transport wakes us up, or something
+ * arrives on the session's socket.
  */
 //--------------------------------------------------------------------------------------------------
-static void ProcessDeferredMessages
+static void WaitForSharedMem
 (
-    void* param1Ptr,    ///< [IN] Pointer to a Session object.
-    void* param2Ptr     ///< not used
+    msgSession_Session_t* sessionPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    msgSession_Session_t* sessionPtr = param1Ptr;
+    struct pollfd pollFds[2];
 
-    ProcessReceivedMessages(sessionPtr);
+    pollFds[0].fd = msgShm_GetWakeFd(sessionPtr->shmRef);
+    pollFds[0].events = POLLIN;
+    pollFds[1].fd = sessionPtr->socketFd;
+    pollFds[1].events = POLLIN;
 
-    // NOTE: Each of these queued functions holds a reference to the session object so that
-    //       the session object doesn't go away.  But it could go away as soon as we release it.
-    le_mem_Release(sessionPtr);
+    int result;
+    do
+    {
+        result = poll(pollFds, NUM_ARRAY_MEMBERS(pollFds), -1);
+    }
+    while ((result < 0) && (errno == EINTR));
+
+    LE_FATAL_IF(result < 0, "poll() failed (%m).");
+
+    msgShm_ClearWake(sessionPtr->shmRef);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Trigger deferred message queue processing.
+ * Do a synchronous request-response transaction on a session that uses a shared memory
+ * transport.
+ *
+ * @return The response message, or NULL if the session failed or closed.
  */
 //--------------------------------------------------------------------------------------------------
-static void TriggerDeferredProcessing
+static le_msg_MessageRef_t SharedMemSyncRequestResponse
 (
-    msgSession_Session_t*  sessionPtr
+    msgSession_Session_t* sessionPtr,
+    le_msg_MessageRef_t msgRef
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // NOTE: Each of these queued functions holds a reference to the session object so that
-    //       the session object doesn't go away before the queued function is run.
-    le_mem_AddRef(sessionPtr);
-    le_event_QueueFunction(ProcessDeferredMessages, sessionPtr, NULL);
+    le_msg_MessageRef_t rxMsgRef = NULL;
+    le_result_t result;
+
+    // Send the Request Message, waiting for space in the ring if necessary.
+    for (;;)
+    {
+        if (msgMessage_HasFd(msgRef))
+        {
+            fd_SetBlocking(sessionPtr->socketFd);
+            result = msgMessage_Send(sessionPtr->socketFd, msgRef);
+            fd_SetNonBlocking(sessionPtr->socketFd);
+
+            if (result == LE_OK)
+            {
+                sessionPtr->txSocketCount++;
+            }
+        }
+        else
+        {
+            result = msgMessage_SendShm(sessionPtr->shmRef, msgRef, sessionPtr->txSocketCount);
+        }
+
+        if (result != LE_NO_MEMORY)
+        {
+            break;
+        }
+
+        CountBackPressure(sessionPtr);
+        msgShm_WakePeer(sessionPtr->shmRef);
+        WaitForSharedMem(sessionPtr);
+    }
+
+    if (result == LE_OK)
+    {
+        CountSent(sessionPtr, msgRef);
+    }
+
+    msgShm_WakePeer(sessionPtr->shmRef);
+
+    // Receive until the response arrives.  Queue anything else for later processing.
+    while (result == LE_OK)
+    {
+        result = ReceiveSharedMemMessage(sessionPtr, &rxMsgRef);
+
+        if (result == LE_WOULD_BLOCK)
+        {
+            msgShm_PrepareToSleep(sessionPtr->shmRef);
+            if (!IsSharedMemMessageDue(sessionPtr))
+            {
+                WaitForSharedMem(sessionPtr);
+            }
+            result = LE_OK;
+            continue;
+        }
+
+        if (result != LE_OK)
+        {
+            rxMsgRef = NULL;
+            break;
+        }
+
+        if (msgMessage_GetTxnId(rxMsgRef) == msgMessage_GetTxnId(msgRef))
+        {
+            CountReceived(sessionPtr, rxMsgRef);
+            RecordRoundTripTime(sessionPtr, msgRef);
+            break;
+        }
+
+        if (le_dls_IsEmpty(&sessionPtr->receiveQueue))
+        {
+            TriggerDeferredProcessing(sessionPtr);
+        }
+        PushReceiveQueue(sessionPtr, rxMsgRef);
+        rxMsgRef = NULL;
+    }
+
+    // Invalidate the ID for this transaction.
+    DeleteTxnId(sessionPtr, msgRef);
+
+    // Don't need the request message anymore.
+    le_msg_ReleaseMsg(msgRef);
+
+    return rxMsgRef;
 }
 
 
@@ -1534,7 +2796,8 @@ void msgSession_Init
     SessionPoolRef = le_mem_CreatePool("Session", sizeof(msgSession_Session_t));
     le_mem_ExpandPool(SessionPoolRef, 10); /// @todo Make this configurable.
 
-    TxnMapRef = le_ref_CreateMap("MsgTxnIDs", MAX_EXPECTED_TXNS);
+    OpenBatchPoolRef = le_mem_CreatePool("OpenBatch", sizeof(OpenBatch_t));
+    LE_ASSERT(pthread_key_create(&OpenBatchKey, NULL) == 0);
 
     // Get a reference to the trace keyword that is used to control tracing in this module.
     TraceRef = le_log_GetTraceRef("messaging");
@@ -1571,13 +2834,108 @@ bool msgSession_IsOpen
 )
 //--------------------------------------------------------------------------------------------------
 {
-    return (sessionRef->state == LE_MSG_SESSION_STATE_OPEN);
+    return (   (sessionRef->state == LE_MSG_SESSION_STATE_OPEN)
+            && !__atomic_load_n(&sessionRef->isClosePending, __ATOMIC_ACQUIRE) );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Closes a server-side session whose close was handed over to the thread that owns it by another
+ * thread.
+ *
+ * @note    A reference to the session was taken when the close was handed over, so the session
+ *          still exists even if the client closed it in the meantime.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseQueuedSession
+(
+    void* sessionPtr,       ///< [in] Pointer to the Session object.
+    void* notifyServerPtr   ///< [in] Non-NULL to call the service's close handlers again.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgSession_Session_t* sessionRef = sessionPtr;
+
+    // Server-side sessions are deleted when they close, so if it's closed already, it's gone.
+    if (sessionRef->state != LE_MSG_SESSION_STATE_CLOSED)
+    {
+        msgSession_CloseServerSession(sessionRef, (notifyServerPtr != NULL));
+    }
+
+    le_mem_Release(sessionRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Closes and deletes a server-side session.  If called by a thread other than the one that owns
+ * the session (such as one of the service's worker threads), the close is handed over to the
+ * thread that owns the session.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgSession_CloseServerSession
+(
+    le_msg_SessionRef_t sessionRef,
+    bool notifyServer   ///< [in] true to call the service's close handlers again after closing
+                        ///       (for closes the server didn't ask for).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Only the thread that owns the session may delete its FD Monitor, change the session lists
+    // and call the close handlers.  Messages already handed over by the same thread are sent
+    // before the session is closed.
+    if (le_thread_GetCurrent() != sessionRef->threadRef)
+    {
+        if (!__atomic_exchange_n(&sessionRef->isClosePending, true, __ATOMIC_ACQ_REL))
+        {
+            le_mem_AddRef(sessionRef);
+
+            le_event_QueueFunctionToThread(sessionRef->threadRef,
+                                           CloseQueuedSession,
+                                           sessionRef,
+                                           notifyServer ? sessionRef : NULL);
+        }
+        return;
+    }
+
+    DeleteSession(sessionRef);
+
+    // NOTE: If the caller holds a reference to the session (e.g., through a message), the session
+    // still exists until that reference is released, even though it has been "deleted".
+    if (notifyServer)
+    {
+        msgInterface_CallCloseHandler((le_msg_ServiceRef_t)sessionRef->interfaceRef, sessionRef);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a message that was handed over to the thread that owns its session by another thread.
+ *
+ * @note    The message holds a reference to the session, so the session can't go away before
+ *          this runs.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendQueuedMessage
+(
+    void* sessionPtr,   ///< [in] Pointer to the Session object.
+    void* msgRef        ///< [in] Reference to the message.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgSession_SendMessage(sessionPtr, msgRef);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
  * Sends a given Message object through a given Session.
+ *
+ * On the server side, other threads (such as the service's worker threads) may also send, in
+ * which case the message is handed over to the thread that owns the session.  Messages sent by
+ * the same thread are still sent in order.
  */
 //--------------------------------------------------------------------------------------------------
 void msgSession_SendMessage
@@ -1589,10 +2947,24 @@ void msgSession_SendMessage
 {
     // Only the thread that is handling events on this socket is allowed to send messages through
     // this socket.  This prevents multi-threaded races.
-    /// @todo Allow other threads to send?
-    LE_FATAL_IF(le_thread_GetCurrent() != sessionRef->threadRef,
-                "Attempt to send by thread that doesn't own session '%s'.",
-                le_msg_GetInterfaceName(le_msg_GetSessionInterface(sessionRef)));
+    if (le_thread_GetCurrent() != sessionRef->threadRef)
+    {
+        LE_FATAL_IF(sessionRef->interfaceRef->interfaceType != LE_MSG_INTERFACE_SERVER,
+                    "Attempt to send by thread that doesn't own session '%s'.",
+                    le_msg_GetInterfaceName(le_msg_GetSessionInterface(sessionRef)));
+
+        le_event_QueueFunctionToThread(sessionRef->threadRef,
+                                       SendQueuedMessage,
+                                       sessionRef,
+                                       messageRef);
+        return;
+    }
+
+    // If the session's open request is still pending in an open batch, finish opening it first.
+    if (sessionRef->openBatchPtr != NULL)
+    {
+        CompletePendingOpen(sessionRef);
+    }
 
     if (sessionRef->state != LE_MSG_SESSION_STATE_OPEN)
     {
@@ -1630,11 +3002,16 @@ void msgSession_RequestResponse
                 le_msg_GetInterfaceName(le_msg_GetSessionInterface(sessionRef)));
     /// @todo Allow other threads to send?
 
+    if (sessionRef->openBatchPtr != NULL)
+    {
+        CompletePendingOpen(sessionRef);
+    }
+
     LE_FATAL_IF(sessionRef->state != LE_MSG_SESSION_STATE_OPEN,
                 "Attempt to send message on session that is not open.");
 
     // Create an ID for this transaction.
-    CreateTxnId(msgRef);
+    CreateTxnId(sessionRef, msgRef);
 
     // Put the message on the Transmit Queue.
     PushTransmitQueue(sessionRef, msgRef);
@@ -1664,14 +3041,28 @@ le_msg_MessageRef_t msgSession_DoSyncRequestResponse
                 "Attempted synchronous operation by thread that doesn't own session '%s'.",
                 le_msg_GetInterfaceName(le_msg_GetSessionInterface(sessionRef)));
 
+    if (sessionRef->openBatchPtr != NULL)
+    {
+        CompletePendingOpen(sessionRef);
+    }
+
     // Create an ID for this transaction.
-    CreateTxnId(msgRef);
+    CreateTxnId(sessionRef, msgRef);
+
+    if (sessionRef->shmRef != NULL)
+    {
+        return SharedMemSyncRequestResponse(sessionRef, msgRef);
+    }
 
     // Put the socket into blocking mode.
     fd_SetBlocking(sessionRef->socketFd);
 
     // Send the Request Message.
-    msgMessage_Send(sessionRef->socketFd, msgRef);
+    if (msgMessage_Send(sessionRef->socketFd, msgRef) == LE_OK)
+    {
+        sessionRef->txSocketCount++;
+        CountSent(sessionRef, msgRef);
+    }
 
     // While we have not yet received the response we are waiting for, keep
     // receiving messages.  Any that we receive that don't match the transaction ID
@@ -1692,9 +3083,13 @@ le_msg_MessageRef_t msgSession_DoSyncRequestResponse
             break;
         }
 
+        sessionRef->rxSocketCount++;
+
         if (msgMessage_GetTxnId(rxMsgRef) == msgMessage_GetTxnId(msgRef))
         {
             // Got the synchronous response we were waiting for.
+            CountReceived(sessionRef, rxMsgRef);
+            RecordRoundTripTime(sessionRef, msgRef);
             break;
         }
 
@@ -1713,7 +3108,7 @@ le_msg_MessageRef_t msgSession_DoSyncRequestResponse
     }
 
     // Invalidate the ID for this transaction.
-    DeleteTxnId(msgRef);
+    DeleteTxnId(sessionRef, msgRef);
 
     // Don't need the request message anymore.
     le_msg_ReleaseMsg(msgRef);
@@ -2015,29 +3410,23 @@ void le_msg_OpenSessionSync
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_result_t result;
+    OpenBatch_t* batchPtr = pthread_getspecific(OpenBatchKey);
 
-    do
+    // If this thread is batching session opens, just send the open request.  The response is
+    // received when the batch is finished, or when the session is first used.
+    if (batchPtr != NULL)
     {
-        result = AttemptOpenSync(sessionRef, true /* wait if necessary */ );
-
-        if (result != LE_OK)
+        if (StartSessionOpenAttempt(sessionRef, true /* wait if necessary */ ) != LE_OK)
         {
-            // Failure to connect to the Service Directory is a fatal error.
-            if (result == LE_COMM_ERROR)
-            {
-                LE_FATAL("Failed to connect to the Service Directory.");
-            }
-
-            // For any other error, report an error and retry.
-            le_msg_InterfaceRef_t interfaceRef = le_msg_GetSessionInterface(sessionRef);
-            LE_ERROR("Session failed (%s). Retrying... (%s:%s)",
-                     LE_RESULT_TXT(result),
-                     le_msg_GetInterfaceName(interfaceRef),
-                     le_msg_GetProtocolIdStr(le_msg_GetInterfaceProtocol(interfaceRef)));
+            LE_FATAL("Failed to connect to the Service Directory.");
         }
 
-    } while (result != LE_OK);
+        sessionRef->openBatchPtr = batchPtr;
+        le_dls_Queue(&batchPtr->pendingList, &sessionRef->openBatchLink);
+        return;
+    }
+
+    OpenSessionSync(sessionRef);
 }
 
 
@@ -2079,6 +3468,65 @@ le_result_t le_msg_TryOpenSessionSync
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a batch of session opens on the calling thread.  Until le_msg_FinishOpenBatch() is
+ * called, le_msg_OpenSessionSync() only sends the open request and returns without waiting for
+ * the session to open.
+ *
+ * @note    Batches can't be nested.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_StartOpenBatch
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_FATAL_IF(pthread_getspecific(OpenBatchKey) != NULL,
+                "Session open batch already started on this thread.");
+
+    OpenBatch_t* batchPtr = le_mem_ForceAlloc(OpenBatchPoolRef);
+    batchPtr->pendingList = LE_DLS_LIST_INIT;
+
+    LE_ASSERT(pthread_setspecific(OpenBatchKey, batchPtr) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finishes the calling thread's batch of session opens, blocking until every session opened
+ * in the batch is open.
+ *
+ * This function logs a fatal error and terminates the calling process if the thread hasn't
+ * started a batch.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_FinishOpenBatch
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    OpenBatch_t* batchPtr = pthread_getspecific(OpenBatchKey);
+
+    LE_FATAL_IF(batchPtr == NULL, "No session open batch started on this thread.");
+
+    // Stop batching first, so that any retries below are done the usual way.
+    LE_ASSERT(pthread_setspecific(OpenBatchKey, NULL) == 0);
+
+    // The responses are collected in the order the requests were sent, so the first wait
+    // covers most of the others' round trips too.
+    le_dls_Link_t* linkPtr;
+    while ((linkPtr = le_dls_Peek(&batchPtr->pendingList)) != NULL)
+    {
+        CompletePendingOpen(CONTAINER_OF(linkPtr, msgSession_Session_t, openBatchLink));
+    }
+
+    le_mem_Release(batchPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Terminates a session.
@@ -2093,7 +3541,7 @@ void le_msg_CloseSession
     // On the server side, sessions are automatically deleted when they close.
     if (sessionRef->interfaceRef->interfaceType == LE_MSG_INTERFACE_SERVER)
     {
-        DeleteSession(sessionRef);
+        msgSession_CloseServerSession(sessionRef, false);
     }
     else if (sessionRef->state != LE_MSG_SESSION_STATE_CLOSED)
     {
@@ -2102,6 +3550,49 @@ void le_msg_CloseSession
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asks for a session to exchange its messages through shared memory instead of its socket,
+ * once it is open.
+ *
+ * @note    This is a client-only function, and the session must not be open.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_EnableSharedMemTransport
+(
+    le_msg_SessionRef_t sessionRef, ///< [in] Reference to the session.
+    size_t              slotCount   ///< [in] Number of messages each side can have in flight
+                                    ///       (rounded up to a power of two).  0 = use the socket.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_FATAL_IF(sessionRef->interfaceRef->interfaceType != LE_MSG_INTERFACE_CLIENT,
+                "Shared memory can only be enabled by the client side of a session.");
+
+    LE_FATAL_IF(sessionRef->state != LE_MSG_SESSION_STATE_CLOSED,
+                "Shared memory can't be enabled on a session that is already open.");
+
+    sessionRef->shmSlotCount = slotCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a session is exchanging its messages through shared memory.
+ *
+ * @return true if it is, false if it is using its socket (or is not open).
+ */
+//--------------------------------------------------------------------------------------------------
+bool le_msg_IsSharedMemTransportActive
+(
+    le_msg_SessionRef_t sessionRef  ///< [in] Reference to the session.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (sessionRef->shmRef != NULL);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches a reference to the protocol that is being used for a given session.
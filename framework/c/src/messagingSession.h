@@ -11,6 +11,18 @@
 #define LE_MESSAGING_SESSION_H_INCLUDE_GUARD
 
 #include "messagingInterface.h"
+#include "messagingShm.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of slots in a session's Transaction Table.  Must be a power of two.
+ *
+ * This many request-response transactions can be matched up with their response with a single
+ * look-up.  Any more than that are still matched up, by searching the session's Transaction List.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_SESSION_TXN_TABLE_SIZE 32
 
 
 //--------------------------------------------------------------------------------------------------
@@ -48,8 +60,13 @@ typedef struct le_msg_Session
 
     le_dls_List_t                   txnList;        ///< List of request messages that have been
                                                     ///  sent and are waiting for their response.
+    le_msg_MessageRef_t txnTable[MSG_SESSION_TXN_TABLE_SIZE]; ///< Transaction Table: request
+                                                    ///  messages waiting for their response,
+                                                    ///  indexed by transaction sequence number.
+    uint32_t                        nextTxnSeq;     ///< Sequence number for the next transaction.
 
     le_dls_List_t                   transmitQueue;  ///< Queue of messages waiting to be sent.
+    uint32_t                        txQueueDepth;   ///< Number of messages on the Transmit Queue.
 
     le_dls_List_t                   receiveQueue;   ///< Queue of received messages waiting to be
                                                     /// processed.
@@ -61,6 +78,36 @@ typedef struct le_msg_Session
     void*                           openContextPtr; ///< Open handler's context pointer.
     le_msg_SessionEventHandler_t    closeHandler;   ///< Close handler function.
     void*                           closeContextPtr;///< Close handler's context pointer.
+
+    le_dls_List_t                   rxSpareList;    ///< Message objects kept for receiving into.
+    size_t                          rxBatchSize;    ///< Number of messages to try to receive at
+                                                    ///  once (adapts to the incoming traffic).
+
+    size_t                          shmSlotCount;   ///< Slots to ask for in a shared memory
+                                                    ///  transport (0 = socket only). Client-only.
+    msgShm_TransportRef_t           shmRef;         ///< Shared memory transport (NULL = none).
+    msgShm_TransportRef_t           shmPendingRef;  ///< Transport to start using once the server
+                                                    ///  has acknowledged it. Server-only.
+    le_fdMonitor_Ref_t              shmMonitorRef;  ///< Monitor for the transport's wake eventfd.
+    int                             shmSetupFds[3]; ///< Set-up fds received so far. Server-only.
+    le_msg_MessageRef_t             shmHeldMsgRef;  ///< Message received from the socket that
+                                                    ///  must wait for earlier ones in the ring.
+    uint32_t                        txSocketCount;  ///< Messages sent through the socket so far.
+    uint32_t                        rxSocketCount;  ///< Messages received through the socket and
+                                                    ///  delivered so far.
+    le_thread_Ref_t                 workerThread;   ///< Service worker thread that handles this
+                                                    ///  session's messages (NULL = none yet).
+                                                    ///  Server-only.
+    bool                            isClosePending; ///< true if another thread has handed the
+                                                    ///  session's close over to the thread that
+                                                    ///  owns it. Server-only.
+    struct msgSession_OpenBatch*    openBatchPtr;   ///< Open batch that this session's open
+                                                    ///  request is pending in (NULL = none).
+                                                    ///  Client-only.
+    le_dls_Link_t                   openBatchLink;  ///< Used to link into the open batch.
+    msgInterface_Stats_t            stats;          ///< Traffic statistics for this session.
+                                                    ///  Only updated by the thread that owns
+                                                    ///  the session.
 }
 msgSession_Session_t;
 
@@ -114,6 +161,21 @@ bool msgSession_IsOpen
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Closes and deletes a server-side session.  If called by a thread other than the one that owns
+ * the session (such as one of the service's worker threads), the close is handed over to the
+ * thread that owns the session.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgSession_CloseServerSession
+(
+    le_msg_SessionRef_t sessionRef,
+    bool notifyServer   ///< [in] true to call the service's close handlers again after closing
+                        ///       (for closes the server didn't ask for).
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sends a given Message object through a given Session.
@@ -0,0 +1,781 @@
+/** @file messagingShm.c
+ *
+ * @ref c_messaging implementation's "Shared Memory Transport" module implementation.
+ *
+ * See @ref messagingShm.h for an overview of the shared memory transport, and @ref messaging.c
+ * for an overview of the @ref c_messaging implementation.
+ *
+ * The shared memory region looks like this:
+ *
+ * @verbatim
+ *
+ *   +-----------------+-------------------------------------+-------------------------------------+
+ *   | Region header   | Client-to-server ring header, slots | Server-to-client ring header, slots |
+ *   +-----------------+-------------------------------------+-------------------------------------+
+ *
+ * @endverbatim
+ *
+ * Ring indices run freely and wrap at 2^32.  The slot count is a power of two, so an index is
+ * turned into a slot position by masking.  The consumer only writes the head index and its
+ * "waiting" flag, and the producer only writes the tail index, its "waiting" flag, and the slots
+ * between the tail and the head.  They are kept in separate cache lines.
+ *
+ * Everything read from the shared memory is treated as untrusted, because the other side is
+ * another process.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "messagingShm.h"
+#include "fileDescriptor.h"
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_GET_SEALS 1034
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Seals that the region's memfd must carry, so that neither side can change its size while the
+ * other has it mapped (which would make the other side fault on access).
+ */
+//--------------------------------------------------------------------------------------------------
+#define REGION_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of the magic number at the start of the region.
+ */
+//--------------------------------------------------------------------------------------------------
+#define REGION_MAGIC 0x6C654D53
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of a cache line, in bytes.  Used to keep the two sides' variables apart.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CACHE_LINE_BYTES 64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest number of slots allowed in each direction.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_SLOT_COUNT 4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of the shared memory region.  Written by the client before the memfd is
+ * sent to the server.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    magic;          ///< REGION_MAGIC.
+    uint32_t    slotCount;      ///< Number of slots in each ring.
+    uint32_t    slotSize;       ///< Size of each slot, in bytes.
+    uint8_t     reserved[CACHE_LINE_BYTES - (3 * sizeof(uint32_t))];
+}
+RegionHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of each ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    head;               ///< Index of the next slot to read.  Written by the consumer.
+    uint32_t    consumerWaiting;    ///< 1 = consumer is asleep waiting for a message.
+    uint8_t     reserved1[CACHE_LINE_BYTES - (2 * sizeof(uint32_t))];
+
+    uint32_t    tail;               ///< Index of the next slot to write.  Written by the producer.
+    uint32_t    producerWaiting;    ///< 1 = producer is waiting for a slot to be freed.
+    uint8_t     reserved2[CACHE_LINE_BYTES - (2 * sizeof(uint32_t))];
+}
+RingHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A message slot.  Holds the transaction ID followed by the payload.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    dataSize;       ///< Number of bytes in data.
+    uint32_t    socketSeq;      ///< Number of socket messages the producer had sent before this.
+    uint8_t     data[];         ///< Transaction ID followed by the payload.
+}
+Slot_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A shared memory transport, as seen by one side of the session.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct msgShm_Transport
+{
+    uint8_t*        basePtr;        ///< Start of the mapped region.
+    size_t          regionSize;     ///< Size of the mapped region, in bytes.
+    uint32_t        slotCount;      ///< Number of slots in each ring (a power of two).
+    size_t          slotSize;       ///< Size of each slot, in bytes.
+    RingHeader_t*   txRingPtr;      ///< Ring that this side produces into.
+    RingHeader_t*   rxRingPtr;      ///< Ring that this side consumes from.
+    int             memFd;          ///< The memfd (client side, until sent), or -1.
+    int             wakeFd;         ///< eventfd that the other side writes to wake this side.
+    int             peerWakeFd;     ///< eventfd that this side writes to wake the other side.
+}
+Transport_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which Transport objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t TransportPoolRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the size of each slot for a given protocol.
+ *
+ * @return The size, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t SlotSize
+(
+    size_t maxPayloadSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t size = sizeof(Slot_t) + sizeof(void*) + maxPayloadSize;
+
+    return (size + 7) & ~(size_t)7;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the size of each ring (header plus slots), rounded up to a whole cache line.
+ *
+ * @return The size, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t RingSize
+(
+    uint32_t slotCount,
+    size_t slotSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t size = sizeof(RingHeader_t) + (slotCount * slotSize);
+
+    return (size + CACHE_LINE_BYTES - 1) & ~(size_t)(CACHE_LINE_BYTES - 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a pointer to the slot for a given ring index.
+ *
+ * @return The pointer.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline Slot_t* GetSlot
+(
+    Transport_t*    transportPtr,
+    RingHeader_t*   ringPtr,
+    uint32_t        index
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (Slot_t*)((uint8_t*)(ringPtr + 1)
+                     + ((index & (transportPtr->slotCount - 1)) * transportPtr->slotSize));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Increments an eventfd to wake up whoever is waiting on it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteWake
+(
+    int fd
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const uint64_t one = 1;
+    ssize_t bytesWritten;
+
+    do
+    {
+        bytesWritten = write(fd, &one, sizeof(one));
+    }
+    while ((bytesWritten < 0) && (errno == EINTR));
+
+    if ((bytesWritten < 0) && (errno != EAGAIN))
+    {
+        LE_ERROR("Failed to write to eventfd %d (%m).", fd);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a Transport object around a mapped region.
+ *
+ * @return Pointer to the object.
+ */
+//--------------------------------------------------------------------------------------------------
+static Transport_t* CreateTransport
+(
+    void*       basePtr,
+    size_t      regionSize,
+    uint32_t    slotCount,
+    size_t      slotSize,
+    bool        isClient
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Transport_t* transportPtr = le_mem_ForceAlloc(TransportPoolRef);
+
+    transportPtr->basePtr = basePtr;
+    transportPtr->regionSize = regionSize;
+    transportPtr->slotCount = slotCount;
+    transportPtr->slotSize = slotSize;
+
+    RingHeader_t* clientToServerPtr = (RingHeader_t*)(transportPtr->basePtr
+                                                      + sizeof(RegionHeader_t));
+    RingHeader_t* serverToClientPtr = (RingHeader_t*)((uint8_t*)clientToServerPtr
+                                                      + RingSize(slotCount, slotSize));
+
+    transportPtr->txRingPtr = (isClient ? clientToServerPtr : serverToClientPtr);
+    transportPtr->rxRingPtr = (isClient ? serverToClientPtr : clientToServerPtr);
+
+    transportPtr->memFd = -1;
+    transportPtr->wakeFd = -1;
+    transportPtr->peerWakeFd = -1;
+
+    return transportPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes this module.  This must be called only once at start-up, before any other functions
+ * in this module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    TransportPoolRef = le_mem_CreatePool("MsgShmTransports", sizeof(Transport_t));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a shared memory transport on the client side of a session.
+ *
+ * The memfd and both eventfds are created.  They must then be passed to the server (see
+ * msgShm_GetSetupFd()).
+ *
+ * @return A reference to the transport, or NULL if it couldn't be created (check the logs).
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_TransportRef_t msgShm_Create
+(
+    size_t maxPayloadSize,  ///< [IN] Largest message payload of the session's protocol, in bytes.
+    size_t slotCount        ///< [IN] Number of message slots in each direction.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Round the slot count up to a power of two.
+    uint32_t count = 1;
+    while ((count < slotCount) && (count < MAX_SLOT_COUNT))
+    {
+        count *= 2;
+    }
+
+    size_t slotSize = SlotSize(maxPayloadSize);
+    size_t regionSize = sizeof(RegionHeader_t) + (2 * RingSize(count, slotSize));
+
+    int memFd = syscall(SYS_memfd_create, "le_msg", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memFd < 0)
+    {
+        LE_ERROR("Failed to create memfd (%m).");
+        return NULL;
+    }
+
+    if (   (ftruncate(memFd, regionSize) != 0)
+        || (fcntl(memFd, F_ADD_SEALS, REGION_SEALS) != 0) )
+    {
+        LE_ERROR("Failed to size and seal memfd of %zu bytes (%m).", regionSize);
+        fd_Close(memFd);
+        return NULL;
+    }
+
+    void* basePtr = mmap(NULL, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+    if (basePtr == MAP_FAILED)
+    {
+        LE_ERROR("Failed to map %zu bytes of shared memory (%m).", regionSize);
+        fd_Close(memFd);
+        return NULL;
+    }
+
+    int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int peerWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((wakeFd < 0) || (peerWakeFd < 0))
+    {
+        LE_ERROR("Failed to create eventfd (%m).");
+        if (wakeFd >= 0)
+        {
+            fd_Close(wakeFd);
+        }
+        if (peerWakeFd >= 0)
+        {
+            fd_Close(peerWakeFd);
+        }
+        munmap(basePtr, regionSize);
+        fd_Close(memFd);
+        return NULL;
+    }
+
+    // The memfd starts out zeroed, so only the region header and the "waiting" flags need to be
+    // set.  Both consumers start out idle.
+    RegionHeader_t* headerPtr = basePtr;
+    headerPtr->magic = REGION_MAGIC;
+    headerPtr->slotCount = count;
+    headerPtr->slotSize = slotSize;
+
+    Transport_t* transportPtr = CreateTransport(basePtr, regionSize, count, slotSize, true);
+    transportPtr->txRingPtr->consumerWaiting = 1;
+    transportPtr->rxRingPtr->consumerWaiting = 1;
+
+    transportPtr->memFd = memFd;
+    transportPtr->wakeFd = wakeFd;
+    transportPtr->peerWakeFd = peerWakeFd;
+
+    return transportPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a shared memory transport on the server side of a session from the file descriptors
+ * the client sent.  Takes ownership of the file descriptors, even on failure.
+ *
+ * @return A reference to the transport, or NULL if the memory is not usable (check the logs).
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_TransportRef_t msgShm_Attach
+(
+    size_t maxPayloadSize,  ///< [IN] Largest message payload of the session's protocol, in bytes.
+    int memFd,              ///< [IN] The memfd holding the rings.
+    int wakeFd,             ///< [IN] eventfd that the client writes to wake the server.
+    int peerWakeFd          ///< [IN] eventfd that the server writes to wake the client.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    void* basePtr = MAP_FAILED;
+    size_t regionSize = 0;
+    uint32_t slotCount = 0;
+    size_t slotSize = SlotSize(maxPayloadSize);
+    struct stat st;
+    int seals = fcntl(memFd, F_GET_SEALS);
+
+    // Without the seals, the client could shrink the memory while we have it mapped.
+    if (seals < 0)
+    {
+        LE_ERROR("Failed to get shared memory fd seals (%m).");
+    }
+    else if ((seals & REGION_SEALS) != REGION_SEALS)
+    {
+        LE_ERROR("Shared memory fd is not sealed (seals %x).", seals);
+    }
+    else if (fstat(memFd, &st) != 0)
+    {
+        LE_ERROR("Failed to stat shared memory fd (%m).");
+    }
+    else if ((size_t)st.st_size < sizeof(RegionHeader_t))
+    {
+        LE_ERROR("Shared memory too small (%zu bytes).", (size_t)st.st_size);
+    }
+    else
+    {
+        regionSize = st.st_size;
+        basePtr = mmap(NULL, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+        if (basePtr == MAP_FAILED)
+        {
+            LE_ERROR("Failed to map %zu bytes of shared memory (%m).", regionSize);
+        }
+    }
+
+    fd_Close(memFd);
+
+    if (basePtr != MAP_FAILED)
+    {
+        // Check that the client laid the region out the way we would have.
+        RegionHeader_t header = *(RegionHeader_t*)basePtr;
+        slotCount = header.slotCount;
+
+        if (   (header.magic != REGION_MAGIC)
+            || (header.slotSize != slotSize)
+            || (slotCount == 0)
+            || (slotCount > MAX_SLOT_COUNT)
+            || ((slotCount & (slotCount - 1)) != 0)
+            || (regionSize != sizeof(RegionHeader_t) + (2 * RingSize(slotCount, slotSize))))
+        {
+            LE_ERROR("Shared memory layout not recognized (magic %x, %u slots of %u bytes).",
+                     header.magic,
+                     header.slotCount,
+                     header.slotSize);
+            munmap(basePtr, regionSize);
+            basePtr = MAP_FAILED;
+        }
+    }
+
+    if ((basePtr == MAP_FAILED) || (wakeFd < 0) || (peerWakeFd < 0))
+    {
+        if (basePtr != MAP_FAILED)
+        {
+            munmap(basePtr, regionSize);
+        }
+        if (wakeFd >= 0)
+        {
+            fd_Close(wakeFd);
+        }
+        if (peerWakeFd >= 0)
+        {
+            fd_Close(peerWakeFd);
+        }
+        return NULL;
+    }
+
+    fd_SetNonBlocking(wakeFd);
+    fd_SetNonBlocking(peerWakeFd);
+
+    Transport_t* transportPtr = CreateTransport(basePtr, regionSize, slotCount, slotSize, false);
+    transportPtr->wakeFd = wakeFd;
+    transportPtr->peerWakeFd = peerWakeFd;
+
+    return transportPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets one of the file descriptors that a client must send to the server to set up a transport.
+ *
+ * @return The file descriptor (still owned by the transport).
+ */
+//--------------------------------------------------------------------------------------------------
+int msgShm_GetSetupFd
+(
+    msgShm_TransportRef_t transportRef,
+    void* setupTxnId        ///< [IN] Which one (one of the MSG_SHM_TXN_ID_SETUP_xxx values).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (setupTxnId == MSG_SHM_TXN_ID_SETUP_MEM)
+    {
+        return transportRef->memFd;
+    }
+    else if (setupTxnId == MSG_SHM_TXN_ID_SETUP_SERVER_WAKE)
+    {
+        return transportRef->peerWakeFd;
+    }
+    else if (setupTxnId == MSG_SHM_TXN_ID_SETUP_CLIENT_WAKE)
+    {
+        return transportRef->wakeFd;
+    }
+
+    LE_FATAL("Not a set-up transaction ID (%p).", setupTxnId);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Closes the client's copy of the memfd once it has been sent to the server.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_CloseMemFd
+(
+    msgShm_TransportRef_t transportRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (transportRef->memFd >= 0)
+    {
+        fd_Close(transportRef->memFd);
+        transportRef->memFd = -1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a transport, unmapping the shared memory and closing its file descriptors.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_Delete
+(
+    msgShm_TransportRef_t transportRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgShm_CloseMemFd(transportRef);
+    fd_Close(transportRef->wakeFd);
+    fd_Close(transportRef->peerWakeFd);
+
+    munmap(transportRef->basePtr, transportRef->regionSize);
+
+    le_mem_Release(transportRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the eventfd that becomes readable when the other side wants this side to wake up.
+ *
+ * @return The file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+int msgShm_GetWakeFd
+(
+    msgShm_TransportRef_t transportRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return transportRef->wakeFd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resets the wake eventfd after it became readable.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_ClearWake
+(
+    msgShm_TransportRef_t transportRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t count;
+    ssize_t bytesRead;
+
+    do
+    {
+        bytesRead = read(transportRef->wakeFd, &count, sizeof(count));
+    }
+    while ((bytesRead < 0) && (errno == EINTR));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies a message into the next free slot of the outgoing ring and publishes it.
+ *
+ * The other side is not woken up.  Call msgShm_WakePeer() after a batch of messages.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_NO_MEMORY if the ring is full.  The other side will write to our wake eventfd when it
+ *   frees a slot.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgShm_Push
+(
+    msgShm_TransportRef_t transportRef,
+    const void* dataPtr,    ///< [IN] Transaction ID followed by the payload.
+    size_t dataSize,        ///< [IN] Number of bytes at dataPtr.
+    uint32_t socketSeq      ///< [IN] Number of messages sent through the socket so far.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RingHeader_t* ringPtr = transportRef->txRingPtr;
+
+    LE_ASSERT(dataSize <= transportRef->slotSize - sizeof(Slot_t));
+
+    uint32_t tail = __atomic_load_n(&ringPtr->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE);
+
+    if ((uint32_t)(tail - head) >= transportRef->slotCount)
+    {
+        // Full.  Ask the consumer to wake us when it frees a slot, then check again in case it
+        // did so before it could see the request.
+        __atomic_store_n(&ringPtr->producerWaiting, 1, __ATOMIC_SEQ_CST);
+        head = __atomic_load_n(&ringPtr->head, __ATOMIC_SEQ_CST);
+
+        if ((uint32_t)(tail - head) >= transportRef->slotCount)
+        {
+            return LE_NO_MEMORY;
+        }
+
+        __atomic_store_n(&ringPtr->producerWaiting, 0, __ATOMIC_RELAXED);
+    }
+
+    Slot_t* slotPtr = GetSlot(transportRef, ringPtr, tail);
+    slotPtr->dataSize = dataSize;
+    slotPtr->socketSeq = socketSeq;
+    memcpy(slotPtr->data, dataPtr, dataSize);
+
+    __atomic_store_n(&ringPtr->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wakes up the other side if it has gone to sleep waiting for messages.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_WakePeer
+(
+    msgShm_TransportRef_t transportRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RingHeader_t* ringPtr = transportRef->txRingPtr;
+
+    // Pairs with the consumer setting its flag and then checking the tail in
+    // msgShm_PrepareToSleep().
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (   __atomic_load_n(&ringPtr->consumerWaiting, __ATOMIC_RELAXED)
+        && __atomic_exchange_n(&ringPtr->consumerWaiting, 0, __ATOMIC_SEQ_CST))
+    {
+        WriteWake(transportRef->peerWakeFd);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Looks at the next slot in the incoming ring without consuming it.
+ *
+ * @return true if there is a message waiting, false if the ring is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+bool msgShm_Peek
+(
+    msgShm_TransportRef_t transportRef,
+    uint32_t* socketSeqPtr  ///< [OUT] Number of socket messages the sender had sent before it.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RingHeader_t* ringPtr = transportRef->rxRingPtr;
+
+    uint32_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&ringPtr->tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    *socketSeqPtr = __atomic_load_n(&GetSlot(transportRef, ringPtr, head)->socketSeq,
+                                    __ATOMIC_RELAXED);
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the next message out of the incoming ring and frees its slot.  There must be one
+ * (see msgShm_Peek()).
+ *
+ * @return The number of bytes copied (transaction ID plus payload).
+ */
+//--------------------------------------------------------------------------------------------------
+size_t msgShm_Pop
+(
+    msgShm_TransportRef_t transportRef,
+    void* buffPtr,          ///< [OUT] Where to put the transaction ID followed by the payload.
+    size_t buffSize         ///< [IN] Size of the buffer, in bytes.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RingHeader_t* ringPtr = transportRef->rxRingPtr;
+
+    uint32_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_RELAXED);
+    Slot_t* slotPtr = GetSlot(transportRef, ringPtr, head);
+
+    // Read the size only once, since the other side could change it under us.
+    size_t dataSize = __atomic_load_n(&slotPtr->dataSize, __ATOMIC_RELAXED);
+    if (dataSize > buffSize)
+    {
+        LE_ERROR("Message in shared memory too big (%zu bytes).  Truncated.", dataSize);
+        dataSize = buffSize;
+    }
+
+    memcpy(buffPtr, slotPtr->data, dataSize);
+
+    __atomic_store_n(&ringPtr->head, head + 1, __ATOMIC_RELEASE);
+
+    // If the producer is waiting for a free slot, wake it up.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (   __atomic_load_n(&ringPtr->producerWaiting, __ATOMIC_RELAXED)
+        && __atomic_exchange_n(&ringPtr->producerWaiting, 0, __ATOMIC_SEQ_CST))
+    {
+        WriteWake(transportRef->peerWakeFd);
+    }
+
+    return dataSize;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tells the other side that this side is going to sleep until its wake eventfd is written.
+ *
+ * @return true if it's safe to sleep, or false if a message arrived in the meantime (in which
+ *         case the other side has not been told anything).
+ */
+//--------------------------------------------------------------------------------------------------
+bool msgShm_PrepareToSleep
+(
+    msgShm_TransportRef_t transportRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RingHeader_t* ringPtr = transportRef->rxRingPtr;
+
+    __atomic_store_n(&ringPtr->consumerWaiting, 1, __ATOMIC_SEQ_CST);
+
+    if (   __atomic_load_n(&ringPtr->tail, __ATOMIC_SEQ_CST)
+        != __atomic_load_n(&ringPtr->head, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&ringPtr->consumerWaiting, 0, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,247 @@
+/** @file messagingShm.h
+ *
+ * @ref c_messaging implementation's "Shared Memory Transport" module's inter-module interface
+ * definitions.
+ *
+ * A shared memory transport is a pair of single-producer, single-consumer rings of message slots,
+ * one for each direction, in a memfd shared between the client and the server of a session.  Each
+ * side also has an eventfd that the other side writes to wake it up when it has gone to sleep
+ * waiting for messages (or for space in a full ring).
+ *
+ * The session's socket is kept as the control channel.  It carries the transport set-up, messages
+ * that carry file descriptors, and the hang-up.  To keep messages in order across the two paths,
+ * every slot records how many messages its sender had sent through the socket before it.
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_MESSAGING_SHM_H_INCLUDE_GUARD
+#define LEGATO_MESSAGING_SHM_H_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Transaction IDs used by the messages that set up a shared memory transport over a session's
+ * socket.  These are even, so they can never clash with a real transaction ID, which is always
+ * a safe reference (and safe references are always odd).
+ *
+ * The client sends the three SETUP messages (each carrying one file descriptor) right after the
+ * session opens, and the server answers with one of the ACK messages.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_SHM_TXN_ID_SETUP_MEM            ((void*)(uintptr_t)2)   ///< Carries the memfd.
+#define MSG_SHM_TXN_ID_SETUP_SERVER_WAKE    ((void*)(uintptr_t)4)   ///< Carries server's eventfd.
+#define MSG_SHM_TXN_ID_SETUP_CLIENT_WAKE    ((void*)(uintptr_t)6)   ///< Carries client's eventfd.
+#define MSG_SHM_TXN_ID_ACK_OK               ((void*)(uintptr_t)8)   ///< Server mapped the memory.
+#define MSG_SHM_TXN_ID_ACK_FAIL             ((void*)(uintptr_t)10)  ///< Server couldn't use it.
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a transaction ID belongs to a shared memory set-up message.
+ *
+ * @return true if it does.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool msgShm_IsSetupTxnId
+(
+    void* txnId
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (   (txnId != NULL)
+            && (((uintptr_t)txnId & 1) == 0)
+            && ((uintptr_t)txnId <= (uintptr_t)MSG_SHM_TXN_ID_ACK_FAIL));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a shared memory transport.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct msgShm_Transport* msgShm_TransportRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes this module.  This must be called only once at start-up, before any other functions
+ * in this module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a shared memory transport on the client side of a session.
+ *
+ * The memfd and both eventfds are created.  They must then be passed to the server (see
+ * msgShm_GetSetupFd()).
+ *
+ * @return A reference to the transport, or NULL if it couldn't be created (check the logs).
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_TransportRef_t msgShm_Create
+(
+    size_t maxPayloadSize,  ///< [IN] Largest message payload of the session's protocol, in bytes.
+    size_t slotCount        ///< [IN] Number of message slots in each direction.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a shared memory transport on the server side of a session from the file descriptors
+ * the client sent.  Takes ownership of the file descriptors, even on failure.
+ *
+ * @return A reference to the transport, or NULL if the memory is not usable (check the logs).
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_TransportRef_t msgShm_Attach
+(
+    size_t maxPayloadSize,  ///< [IN] Largest message payload of the session's protocol, in bytes.
+    int memFd,              ///< [IN] The memfd holding the rings.
+    int wakeFd,             ///< [IN] eventfd that the client writes to wake the server.
+    int peerWakeFd          ///< [IN] eventfd that the server writes to wake the client.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets one of the file descriptors that a client must send to the server to set up a transport.
+ *
+ * @return The file descriptor (still owned by the transport).
+ */
+//--------------------------------------------------------------------------------------------------
+int msgShm_GetSetupFd
+(
+    msgShm_TransportRef_t transportRef,
+    void* setupTxnId        ///< [IN] Which one (one of the MSG_SHM_TXN_ID_SETUP_xxx values).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Closes the client's copy of the memfd once it has been sent to the server.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_CloseMemFd
+(
+    msgShm_TransportRef_t transportRef
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a transport, unmapping the shared memory and closing its file descriptors.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_Delete
+(
+    msgShm_TransportRef_t transportRef
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the eventfd that becomes readable when the other side wants this side to wake up.
+ *
+ * @return The file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+int msgShm_GetWakeFd
+(
+    msgShm_TransportRef_t transportRef
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resets the wake eventfd after it became readable.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_ClearWake
+(
+    msgShm_TransportRef_t transportRef
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies a message into the next free slot of the outgoing ring and publishes it.
+ *
+ * The other side is not woken up.  Call msgShm_WakePeer() after a batch of messages.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_NO_MEMORY if the ring is full.  The other side will write to our wake eventfd when it
+ *   frees a slot.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgShm_Push
+(
+    msgShm_TransportRef_t transportRef,
+    const void* dataPtr,    ///< [IN] Transaction ID followed by the payload.
+    size_t dataSize,        ///< [IN] Number of bytes at dataPtr.
+    uint32_t socketSeq      ///< [IN] Number of messages sent through the socket so far.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wakes up the other side if it has gone to sleep waiting for messages.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_WakePeer
+(
+    msgShm_TransportRef_t transportRef
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Looks at the next slot in the incoming ring without consuming it.
+ *
+ * @return true if there is a message waiting, false if the ring is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+bool msgShm_Peek
+(
+    msgShm_TransportRef_t transportRef,
+    uint32_t* socketSeqPtr  ///< [OUT] Number of socket messages the sender had sent before it.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the next message out of the incoming ring and frees its slot.  There must be one
+ * (see msgShm_Peek()).
+ *
+ * @return The number of bytes copied (transaction ID plus payload).
+ */
+//--------------------------------------------------------------------------------------------------
+size_t msgShm_Pop
+(
+    msgShm_TransportRef_t transportRef,
+    void* buffPtr,          ///< [OUT] Where to put the transaction ID followed by the payload.
+    size_t buffSize         ///< [IN] Size of the buffer, in bytes.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tells the other side that this side is going to sleep until its wake eventfd is written.
+ *
+ * @return true if it's safe to sleep, or false if a message arrived in the meantime (in which
+ *         case the other side has not been told anything).
+ */
+//--------------------------------------------------------------------------------------------------
+bool msgShm_PrepareToSleep
+(
+    msgShm_TransportRef_t transportRef
+);
+
+
+#endif // LEGATO_MESSAGING_SHM_H_INCLUDE_GUARD
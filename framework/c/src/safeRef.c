@@ -9,6 +9,18 @@
  *       processor architectures.  Also, if they try to use a memory address as a Safe Ref,
  *       the memory address is guaranteed to be detected as an invalid Safe Reference.
  *
+ * Each Reference Map keeps its mappings in a table of slots.  A Safe Reference encodes the index
+ * of its slot together with the slot's generation count, which is incremented every time the slot
+ * is freed, so a lookup is just an array index and a compare, and a deleted Safe Reference stays
+ * invalid even after its slot has been reused.  Free slots are reused in the order they were
+ * freed, so that any particular slot goes through its generations as slowly as possible.  When
+ * all the slots are in use, the table is doubled in size.
+ *
+ * Safe Reference bit layout (from least significant bit):
+ *  - 1 bit that is always 1 (so the reference is odd),
+ *  - SLOT_INDEX_BITS bits of slot index,
+ *  - the rest are the low bits of the slot's generation count.
+ *
  * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
  */
 
@@ -26,20 +38,66 @@
 /// @todo Make this configurable.
 #define DEFAULT_MAP_POOL_SIZE 10
 
+/// Number of bits of a Safe Reference used for the slot index.  On 32-bit targets, this leaves
+/// 15 bits of generation count, so a deleted Safe Reference only becomes valid again after its
+/// slot has been reused 32768 times.
+#define SLOT_INDEX_BITS ((sizeof(void*) > 4) ? 24 : 16)
+
+/// Maximum number of slots in a Reference Map.
+#define MAX_SLOTS ((size_t)1 << SLOT_INDEX_BITS)
+
+/// Smallest number of slots in a Reference Map.
+#define MIN_SLOTS 4
+
+/// Free list link value for "no slot".
+#define NO_SLOT UINT32_MAX
+
 /// Name used for diagnostics.
 static const char ModuleName[] = "ref";
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * A slot in a Reference Map's table.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    void*       ptr;            ///< The pointer the slot's Safe Reference maps to.
+    uintptr_t   generation;     ///< Incremented every time the slot is freed.
+    uint32_t    nextFree;       ///< Next slot in the free list, or NO_SLOT.
+    bool        isUsed;         ///< true if the slot holds a mapping.
+}
+Slot_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference Map iterator.  There is one per map.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_ref_Iter
+{
+    struct le_ref_Map*  mapPtr;     ///< The map being iterated over.
+    ssize_t             index;      ///< Current slot index (-1 = before the first slot).
+    bool                isValid;    ///< false if not positioned on a mapping.
+}
+Iter_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Reference Map object, which stores mappings from Safe References to pointers.
- * The actual mapping is held in a hashmap.
+ * The actual mappings are held in a table of slots, indexed by the Safe References.
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct le_ref_Map
 {
-    ssize_t             nextRefNum;     ///< The next Safe Reference value to be assigned.
+    Slot_t*     slotsPtr;           ///< Table of slots (malloc'd).
+    size_t      slotCount;          ///< Number of slots allocated.
+    size_t      usedSlotCount;      ///< Number of slots that have ever been used (high water mark).
+    uint32_t    freeHead;           ///< Oldest free slot, or NO_SLOT.
+    uint32_t    freeTail;           ///< Most recently freed slot, or NO_SLOT.
+    uintptr_t   baseGeneration;     ///< Generation count of slots that have never been used.
 
-    le_hashmap_Ref_t    referenceMap;    ///< HashMap of Mapping objects.
+    Iter_t      iterator;           ///< The map's iterator.
 
     char          name[MAX_NAME_BYTES]; ///< The name of the map (for diagnostics).
 }
@@ -53,44 +111,145 @@ Map_t;
 //--------------------------------------------------------------------------------------------------
 static le_mem_PoolRef_t MapPool;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generation count given to the slots of the next Map created.  Different Maps start at
+ * different generations so that a Safe Reference from one Map is unlikely to be valid in another.
+ */
+//--------------------------------------------------------------------------------------------------
+static uintptr_t NextMapGeneration = 0;
+
 // =============================================
 //  PRIVATE FUNCTIONS
 // =============================================
 
 //--------------------------------------------------------------------------------------------------
 /**
- * SafeRef hashing function.
- *
- * @return  Returns the SafeRef itself as it can used as a hash
+ * Build the Safe Reference for a slot.
  *
+ * @return  The Safe Reference.
  */
 //--------------------------------------------------------------------------------------------------
-
-size_t hashSafeRef
+static inline void* MakeSafeRef
 (
-    const void* safeRefPtr    ///< [in] Safe Ref to be hashed
+    Map_t*      mapPtr,
+    size_t      index
 )
 {
-    // Return the key value itself.
-    return (size_t) safeRefPtr;
+    uintptr_t generation = mapPtr->slotsPtr[index].generation;
+
+    return (void*)((generation << (SLOT_INDEX_BITS + 1)) | ((uintptr_t)index << 1) | 1);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * SafeRef equality function.
+ * Find the slot that a Safe Reference refers to.
  *
- * @return  Returns true if the integers are equal, false otherwise
+ * @return  Pointer to the slot, or NULL if the Safe Reference is not valid in this map.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline Slot_t* FindSlot
+(
+    Map_t*      mapPtr,
+    void*       safeRef
+)
+{
+    uintptr_t refValue = (uintptr_t)safeRef;
+    size_t index = (refValue >> 1) & (MAX_SLOTS - 1);
+
+    if (((refValue & 1) == 0) || (index >= mapPtr->usedSlotCount))
+    {
+        return NULL;
+    }
+
+    Slot_t* slotPtr = &mapPtr->slotsPtr[index];
+
+    if (   (!slotPtr->isUsed)
+        || ((refValue >> (SLOT_INDEX_BITS + 1))
+            != (slotPtr->generation & (UINTPTR_MAX >> (SLOT_INDEX_BITS + 1)))) )
+    {
+        return NULL;
+    }
+
+    return slotPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a free slot from a map, growing the map if necessary.
  *
+ * @return  The slot index.
  */
 //--------------------------------------------------------------------------------------------------
+static size_t AllocSlot
+(
+    Map_t*      mapPtr
+)
+{
+    size_t index;
+
+    if (mapPtr->freeHead != NO_SLOT)
+    {
+        index = mapPtr->freeHead;
+        mapPtr->freeHead = mapPtr->slotsPtr[index].nextFree;
+        if (mapPtr->freeHead == NO_SLOT)
+        {
+            mapPtr->freeTail = NO_SLOT;
+        }
+
+        return index;
+    }
+
+    if (mapPtr->usedSlotCount == mapPtr->slotCount)
+    {
+        LE_FATAL_IF(mapPtr->slotCount >= MAX_SLOTS,
+                    "Too many Safe References in Map '%s'.",
+                    mapPtr->name);
+
+        mapPtr->slotCount *= 2;
+        if (mapPtr->slotCount > MAX_SLOTS)
+        {
+            mapPtr->slotCount = MAX_SLOTS;
+        }
+
+        mapPtr->slotsPtr = realloc(mapPtr->slotsPtr, mapPtr->slotCount * sizeof(Slot_t));
+        LE_ASSERT(mapPtr->slotsPtr);
+    }
+
+    index = mapPtr->usedSlotCount;
+    mapPtr->usedSlotCount++;
+    mapPtr->slotsPtr[index].generation = mapPtr->baseGeneration;
 
-bool equalsSafeRef
+    return index;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Return a slot to its map's free list.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FreeSlot
 (
-    const void* firstSafeRef,    ///< [in] First SafeRef for comparing.
-    const void* secondSafeRef    ///< [in] Second SafeRef for comparing.
+    Map_t*      mapPtr,
+    size_t      index
 )
 {
-    return firstSafeRef == secondSafeRef;
+    Slot_t* slotPtr = &mapPtr->slotsPtr[index];
+
+    slotPtr->isUsed = false;
+    slotPtr->ptr = NULL;
+    slotPtr->generation++;
+    slotPtr->nextFree = NO_SLOT;
+
+    if (mapPtr->freeTail == NO_SLOT)
+    {
+        mapPtr->freeHead = index;
+    }
+    else
+    {
+        mapPtr->slotsPtr[mapPtr->freeTail].nextFree = index;
+    }
+    mapPtr->freeTail = index;
 }
 
 // =============================================
@@ -149,15 +308,27 @@ le_ref_MapRef_t le_ref_CreateMap
         LE_WARN("Map name '%s%s' truncated to '%s'.", ModuleName, name, mapPtr->name);
     }
 
-    /// @todo Make this a random number so that using a reference from another Map is unlikely to
-    ///       get by undetected.
-    mapPtr->nextRefNum = 0x10000001; // Use only odd numbers.
+    mapPtr->slotCount = (maxRefs < MIN_SLOTS) ? MIN_SLOTS : maxRefs;
+    if (mapPtr->slotCount > MAX_SLOTS)
+    {
+        mapPtr->slotCount = MAX_SLOTS;
+    }
+
+    // It is ok to use malloc here as we will not be destroying the map
+    mapPtr->slotsPtr = malloc(mapPtr->slotCount * sizeof(Slot_t));
+    LE_ASSERT(mapPtr->slotsPtr);
+
+    mapPtr->usedSlotCount = 0;
+    mapPtr->freeHead = NO_SLOT;
+    mapPtr->freeTail = NO_SLOT;
+
+    /// @todo Make this a random number so that using a reference from another Map is even less
+    ///       likely to get by undetected.
+    mapPtr->baseGeneration = __atomic_fetch_add(&NextMapGeneration, 0x101, __ATOMIC_RELAXED);
 
-    mapPtr->referenceMap = le_hashmap_Create(mapPtr->name,
-                                             maxRefs,
-                                             hashSafeRef,
-                                             equalsSafeRef
-                                            );
+    mapPtr->iterator.mapPtr = mapPtr;
+    mapPtr->iterator.index = -1;
+    mapPtr->iterator.isValid = false;
 
     return mapPtr;
 }
@@ -178,13 +349,13 @@ void* le_ref_CreateRef
 )
 //--------------------------------------------------------------------------------------------------
 {
-    ssize_t thisRef = mapRef->nextRefNum;
+    size_t index = AllocSlot(mapRef);
+    Slot_t* slotPtr = &mapRef->slotsPtr[index];
 
-    le_hashmap_Put(mapRef->referenceMap, (const void*)(thisRef), ptr);
+    slotPtr->ptr = ptr;
+    slotPtr->isUsed = true;
 
-    mapRef->nextRefNum += 2; // Increment the reference number for next time, keeping it odd.
-
-    return (void *)thisRef;
+    return MakeSafeRef(mapRef, index);
 }
 
 
@@ -204,7 +375,9 @@ void* le_ref_Lookup
 )
 //--------------------------------------------------------------------------------------------------
 {
-    return le_hashmap_Get(mapRef->referenceMap, safeRef);
+    Slot_t* slotPtr = FindSlot(mapRef, safeRef);
+
+    return (slotPtr == NULL) ? NULL : slotPtr->ptr;
 }
 
 
@@ -220,10 +393,15 @@ void le_ref_DeleteRef
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (le_hashmap_Remove(mapRef->referenceMap, safeRef) == NULL)
+    Slot_t* slotPtr = FindSlot(mapRef, safeRef);
+
+    if (slotPtr == NULL)
     {
         LE_ERROR("Deleting non-existent Safe Reference %p from Map '%s'.", safeRef, mapRef->name);
+        return;
     }
+
+    FreeSlot(mapRef, slotPtr - mapRef->slotsPtr);
 }
 
 
@@ -234,8 +412,8 @@ void le_ref_DeleteRef
  * per map, and calling this function resets the iterator position to the start of the map.  The
  * iterator is not ready for data access until le_ref_NextNode() has been called at least once.
  *
- * @return  Returns A reference to a hashmap iterator which is ready for le_hashmap_NextNode() to be
- *          called on it.
+ * @return  Returns A reference to an iterator which is ready for le_ref_NextNode() to be called
+ *          on it.
  */
 //--------------------------------------------------------------------------------------------------
 le_ref_IterRef_t le_ref_GetIterator
@@ -243,7 +421,10 @@ le_ref_IterRef_t le_ref_GetIterator
     le_ref_MapRef_t mapRef ///< [in] Reference to the map.
 )
 {
-    return (le_ref_IterRef_t)le_hashmap_GetIterator(mapRef->referenceMap);
+    mapRef->iterator.index = -1;
+    mapRef->iterator.isValid = false;
+
+    return &mapRef->iterator;
 }
 
 
@@ -261,14 +442,28 @@ le_result_t le_ref_NextNode
     le_ref_IterRef_t iteratorRef ///< [IN] Reference to the iterator.
 )
 {
-    return le_hashmap_NextNode((le_hashmap_It_Ref_t)iteratorRef);
+    Map_t* mapPtr = iteratorRef->mapPtr;
+
+    for (iteratorRef->index++;
+         iteratorRef->index < (ssize_t)mapPtr->usedSlotCount;
+         iteratorRef->index++)
+    {
+        if (mapPtr->slotsPtr[iteratorRef->index].isUsed)
+        {
+            iteratorRef->isValid = true;
+            return LE_OK;
+        }
+    }
+
+    iteratorRef->isValid = false;
+    return LE_NOT_FOUND;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
  * Retrieves a pointer to the safe ref iterator is currently pointing at.  If the iterator has just
- * been initialized and le_hashmap_NextNode() has not been called, or if the iterator has been
+ * been initialized and le_ref_NextNode() has not been called, or if the iterator has been
  * invalidated then this will return NULL.
  *
  * @return  A pointer to the current key, or NULL if the iterator has been invalidated or is not ready.
@@ -280,7 +475,13 @@ const void* le_ref_GetSafeRef
     le_ref_IterRef_t iteratorRef ///< [IN] Reference to the iterator.
 )
 {
-    return le_hashmap_GetKey((le_hashmap_It_Ref_t)iteratorRef);
+    if (   (!iteratorRef->isValid)
+        || (!iteratorRef->mapPtr->slotsPtr[iteratorRef->index].isUsed) )
+    {
+        return NULL;
+    }
+
+    return MakeSafeRef(iteratorRef->mapPtr, iteratorRef->index);
 }
 
 
@@ -299,5 +500,11 @@ void* le_ref_GetValue
     le_ref_IterRef_t iteratorRef ///< [IN] Reference to the iterator.
 )
 {
-    return le_hashmap_GetValue((le_hashmap_It_Ref_t)iteratorRef);
+    if (   (!iteratorRef->isValid)
+        || (!iteratorRef->mapPtr->slotsPtr[iteratorRef->index].isUsed) )
+    {
+        return NULL;
+    }
+
+    return iteratorRef->mapPtr->slotsPtr[iteratorRef->index].ptr;
 }
@@ -98,21 +98,27 @@ User List ------> User --+---> Name               |        |        |
  * Each Binding object and Connection object holds a reference count on a User object.  A User
  * object will be deleted when all associated Binding objects and Connection objects are deleted.
  *
+ * The lists are kept so that the 'sdir' tool can list everything in a stable order, but nothing
+ * is looked up by searching them.  Instead, three hash maps index the same objects:
+ *  - the User Map finds User objects by Unix user ID,
+ *  - the Service Map finds advertised Server Connections by server user ID and service name, and
+ *  - the Binding Map finds Binding objects by client user ID and client interface name.
+ *
  *
  * @section sd_theoryOfOperation Theory of Operation
  *
  * When a client connects and makes a request to open a service, the client's UID is looked up in
- * the User List.  The client User's Binding List is searched for the interface name provided by
- * the client.  If a matching Binding object is not found, the Client Connection object is added
- * to the User object's Unbound Clients List.  If a matching Binding object is found, it will
- * specify the server User object and service name.  The server's User's Service List will be
- * searched for a matching Server Connection object.  If no matching Server Connection can be
+ * the User Map.  The client's UID and the interface name provided by the client are looked up in
+ * the Binding Map.  If a matching Binding object is not found, the Client Connection object is
+ * added to the User object's Unbound Clients List.  If a matching Binding object is found, it will
+ * specify the server User object and service name, which are looked up in the Service Map to find
+ * a matching Server Connection object.  If no matching Server Connection can be
  * found, the Client Connection is added to the Binding object's Waiting Clients List.
  *
- * When a server connects and advertises a service, the server UID is looked-up in the User List.
- * The service name is then searched for in the Service List for that User.  If a Server Connection
- * object is not found for that service name on that User, the new one is is added to the list.
- * Otherwise, the new server connection is dropped.
+ * When a server connects and advertises a service, the server UID is looked-up in the User Map.
+ * The server UID and service name are then looked up in the Service Map.  If a Server Connection
+ * object is not found for that service name on that User, the new one is is added to the Service
+ * Map and the User's Service List.  Otherwise, the new server connection is dropped.
  *
  * When a new Server Connection is added to a Service List, all users' Binding Lists are
  * searched for matching bindings, and if any that match have non-empty Waiting Clients Lists,
@@ -220,6 +226,29 @@ User List ------> User --+---> Name               |        |        |
 #define MAX_CONNECT_REQUEST_BACKLOG 100
 
 
+//--------------------------------------------------------------------------------------------------
+/// Number of users, services and bindings that the hash maps are initially sized for.
+/// The maps grow if there are more.
+//--------------------------------------------------------------------------------------------------
+#define MAX_EXPECTED_USERS      30
+#define MAX_EXPECTED_SERVICES   30
+#define MAX_EXPECTED_BINDINGS   30
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key used to look up services and bindings in the Service Map and the Binding Map: a user ID and
+ * an interface name.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uid_t       uid;    ///< Server's user ID (services) or client's user ID (bindings).
+    const char* name;   ///< Service name (services) or client interface name (bindings).
+}
+InterfaceKey_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Represents a user.  Objects of this type are allocated from the User Pool and are kept on the
@@ -250,6 +279,17 @@ static le_mem_PoolRef_t UserPoolRef;
 static le_dls_List_t UserList = LE_DLS_LIST_INIT;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The User Map, in which all User objects are indexed by user ID.
+ *
+ * Key is a pointer to the User object's uid (uid_t is 32 bits, so the uint32 hash functions are
+ * used).  Value is a pointer to the User object.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t UserMapRef;
+
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -265,6 +305,7 @@ typedef struct
     User_t*                     userPtr;        ///< Pointer to the User object for the client uid.
     pid_t                       pid;            ///< Process ID of client process.
     svcdir_InterfaceDetails_t   interface;      ///< IPC interface details.
+    InterfaceKey_t              key;            ///< Key in the Service Map (once advertised).
 }
 ServerConnection_t;
 
@@ -275,6 +316,18 @@ ServerConnection_t;
 static le_mem_PoolRef_t ServerConnectionPoolRef;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The Service Map, in which Server Connections that have advertised a service are indexed by
+ * server user ID and service name.
+ *
+ * Key is a pointer to the Server Connection's InterfaceKey_t.  Value is a pointer to the Server
+ * Connection object.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t ServiceMapRef;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Represents a binding from a user's client interface to a service.  Objects of this type are
@@ -290,6 +343,7 @@ typedef struct
     char                serverInterfaceName[LIMIT_MAX_IPC_INTERFACE_NAME_BYTES];///< Service name
     ServerConnection_t* serverConnectionPtr;///< Ptr to Server Connection (NULL if service unavail.)
     le_dls_List_t       waitingClientsList; ///< List of Client Connections waiting for the service.
+    InterfaceKey_t      key;                ///< Key in the Binding Map.
 }
 Binding_t;
 
@@ -300,6 +354,18 @@ Binding_t;
 static le_mem_PoolRef_t BindingPoolRef;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The Binding Map, in which all Binding objects are indexed by client user ID and client
+ * interface name.
+ *
+ * Key is a pointer to the Binding object's InterfaceKey_t.  Value is a pointer to the Binding
+ * object.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t BindingMapRef;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Enumeration of the different states that a client connection can be in.
@@ -369,6 +435,44 @@ static le_fdMonitor_Ref_t ServerSocketMonitorRef;
 //  FUNCTIONS
 // =======================================
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key hash function for the Service Map and the Binding Map.
+ *
+ * @return  The hash value for a user ID and interface name pair (the key).
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t HashInterfaceKey
+(
+    const void* keyPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const InterfaceKey_t* interfaceKeyPtr = keyPtr;
+
+    return (le_hashmap_HashString(interfaceKeyPtr->name) * 31) + interfaceKeyPtr->uid;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key equality comparison function for the Service Map and the Binding Map.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool AreInterfaceKeysEqual
+(
+    const void* firstKeyPtr,
+    const void* secondKeyPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const InterfaceKey_t* firstInterfaceKeyPtr = firstKeyPtr;
+    const InterfaceKey_t* secondInterfaceKeyPtr = secondKeyPtr;
+
+    return (   (firstInterfaceKeyPtr->uid == secondInterfaceKeyPtr->uid)
+            && le_hashmap_EqualsString(firstInterfaceKeyPtr->name, secondInterfaceKeyPtr->name));
+}
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -399,8 +503,9 @@ static User_t* CreateUser
     userPtr->serviceList = LE_DLS_LIST_INIT;
     userPtr->unboundClientsList = LE_DLS_LIST_INIT;
 
-    // Add it to the User List.
+    // Add it to the User List and the User Map.
     le_dls_Queue(&UserList, &userPtr->link);
+    le_hashmap_Put(UserMapRef, &userPtr->uid, userPtr);
 
     return userPtr;
 }
@@ -408,7 +513,7 @@ static User_t* CreateUser
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Searches the User List for a particular Unix user ID.  If found, increments the reference count
+ * Looks up a particular Unix user ID in the User Map.  If found, increments the reference count
  * on that object.  If not found, creates a new User object.
  *
  * @return Pointer to the User object.
@@ -420,19 +525,12 @@ static User_t* GetUser
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_dls_Link_t* linkPtr = le_dls_Peek(&UserList);
+    User_t* userPtr = le_hashmap_Get(UserMapRef, &uid);
 
-    while (linkPtr != NULL)
+    if (userPtr != NULL)
     {
-        User_t* userPtr = CONTAINER_OF(linkPtr, User_t, link);
-
-        if (userPtr->uid == uid)
-        {
-            le_mem_AddRef(userPtr);
-            return userPtr;
-        }
-
-        linkPtr = le_dls_PeekNext(&UserList, linkPtr);
+        le_mem_AddRef(userPtr);
+        return userPtr;
     }
 
     return CreateUser(uid);
@@ -453,14 +551,15 @@ static void UserDestructor
 {
     User_t* userPtr = objPtr;
 
-    // Remove the User object from the User List.
+    // Remove the User object from the User List and the User Map.
     le_dls_Remove(&UserList, &userPtr->link);
+    le_hashmap_Remove(UserMapRef, &userPtr->uid);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Searches a (client) User's Binding List for a particular client-side interface name.
+ * Looks up a (client) User's binding for a particular client-side interface name.
  *
  * @return Pointer to the Binding object or NULL if not found.
  **/
@@ -472,21 +571,9 @@ static Binding_t* FindBinding
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_dls_Link_t* linkPtr = le_dls_Peek(&userPtr->bindingList);
-
-    while (linkPtr != NULL)
-    {
-        Binding_t* bindingPtr = CONTAINER_OF(linkPtr, Binding_t, link);
-
-        if (strcmp(bindingPtr->clientInterfaceName, interfaceName) == 0)
-        {
-            return bindingPtr;
-        }
-
-        linkPtr = le_dls_PeekNext(&userPtr->bindingList, linkPtr);
-    }
+    InterfaceKey_t key = { .uid = userPtr->uid, .name = interfaceName };
 
-    return NULL;
+    return le_hashmap_Get(BindingMapRef, &key);
 }
 
 
@@ -597,9 +684,9 @@ static le_result_t ReceiveMessage
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Searches a User's Service List for a particular service name.
+ * Looks up a particular service name offered by a given User.
  *
- * @return Pointer to the Server Connection object for the matching service.
+ * @return Pointer to the Server Connection object for the matching service, or NULL if not found.
  **/
 //--------------------------------------------------------------------------------------------------
 static ServerConnection_t* FindService
@@ -609,21 +696,9 @@ static ServerConnection_t* FindService
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_dls_Link_t* linkPtr = le_dls_Peek(&userPtr->serviceList);
-
-    while (linkPtr != NULL)
-    {
-        ServerConnection_t* serverConnectionPtr = CONTAINER_OF(linkPtr, ServerConnection_t, link);
-
-        if (strcmp(serverConnectionPtr->interface.interfaceName, serviceName) == 0)
-        {
-            return serverConnectionPtr;
-        }
+    InterfaceKey_t key = { .uid = userPtr->uid, .name = serviceName };
 
-        linkPtr = le_dls_PeekNext(&userPtr->serviceList, linkPtr);
-    }
-
-    return NULL;
+    return le_hashmap_Get(ServiceMapRef, &key);
 }
 
 
@@ -917,8 +992,11 @@ static void CreateBinding
     bindingPtr->serverConnectionPtr = NULL;
     bindingPtr->waitingClientsList = LE_DLS_LIST_INIT;
 
-    // Add the Binding to the client User's Binding List.
+    // Add the Binding to the client User's Binding List and the Binding Map.
     le_dls_Queue(&bindingPtr->clientUserPtr->bindingList, &bindingPtr->link);
+    bindingPtr->key.uid = clientUserPtr->uid;
+    bindingPtr->key.name = bindingPtr->clientInterfaceName;
+    le_hashmap_Put(BindingMapRef, &bindingPtr->key, bindingPtr);
 
     // Look for a server serving the binding's destination service.
     bindingPtr->serverConnectionPtr = FindService(bindingPtr->serverUserPtr, serverInterfaceName);
@@ -1072,8 +1150,11 @@ static void ProcessAdvertisementFromServer
     // connection to the service list.
     else
     {
-        // Add the object to the User's Service List.
+        // Add the object to the User's Service List and the Service Map.
         le_dls_Queue(&connectionPtr->userPtr->serviceList, &connectionPtr->link);
+        connectionPtr->key.uid = connectionPtr->userPtr->uid;
+        connectionPtr->key.name = connectionPtr->interface.interfaceName;
+        le_hashmap_Put(ServiceMapRef, &connectionPtr->key, connectionPtr);
 
         LE_DEBUG("Server (uid %u '%s', pid %d) now serving service '%s' (%s).",
                  connectionPtr->userPtr->uid,
@@ -1324,6 +1405,7 @@ static void CreateClientConnection
 
     snprintf(fdMonName, sizeof(fdMonName), "Client:fd%duid%upid%d", fd, uid, pid);
     connectionPtr->fdMonitorRef = le_fdMonitor_Create(fdMonName, fd, ClientSocketHandler, POLLIN);
+    le_fdMonitor_SetDirectDispatch(connectionPtr->fdMonitorRef, true);
 
     // Set a pointer to the Connection object as the handler context.
     le_fdMonitor_SetContextPtr(connectionPtr->fdMonitorRef, connectionPtr);
@@ -1614,6 +1696,7 @@ static void CreateServerConnection
 
     snprintf(fdMonName, sizeof(fdMonName), "Server:fd%duid%upid%d", fd, uid, pid);
     connectionPtr->fdMonitorRef = le_fdMonitor_Create(fdMonName, fd, ServerSocketHandler, POLLIN);
+    le_fdMonitor_SetDirectDispatch(connectionPtr->fdMonitorRef, true);
 
     // Set a pointer to the Connection object as the handler context.
     le_fdMonitor_SetContextPtr(connectionPtr->fdMonitorRef, connectionPtr);
@@ -1683,6 +1766,7 @@ static void ServerConnectionDestructor
         if (le_dls_IsInList(&connectionPtr->userPtr->serviceList, &connectionPtr->link))
         {
             le_dls_Remove(&connectionPtr->userPtr->serviceList, &connectionPtr->link);
+            le_hashmap_Remove(ServiceMapRef, &connectionPtr->key);
         }
     }
 
@@ -1773,8 +1857,9 @@ static void BindingDestructor
 {
     Binding_t* bindingPtr = objPtr;
 
-    // Remove the Binding object from the User's Binding List.
+    // Remove the Binding object from the User's Binding List and the Binding Map.
     le_dls_Remove(&bindingPtr->clientUserPtr->bindingList, &bindingPtr->link);
+    le_hashmap_Remove(BindingMapRef, &bindingPtr->key);
 
     // While the list of waiting clients is not empty, pop one off and process it.
     le_dls_Link_t* linkPtr;
@@ -2573,6 +2658,20 @@ COMPONENT_INIT
     le_mem_SetDestructor(UserPoolRef, UserDestructor);
     le_mem_SetDestructor(BindingPoolRef, BindingDestructor);
 
+    // Create the hash maps.
+    UserMapRef = le_hashmap_CreateResizable("Users",
+                                            MAX_EXPECTED_USERS,
+                                            le_hashmap_HashUInt32,
+                                            le_hashmap_EqualsUInt32);
+    ServiceMapRef = le_hashmap_CreateResizable("Services",
+                                               MAX_EXPECTED_SERVICES,
+                                               HashInterfaceKey,
+                                               AreInterfaceKeysEqual);
+    BindingMapRef = le_hashmap_CreateResizable("Bindings",
+                                               MAX_EXPECTED_BINDINGS,
+                                               HashInterfaceKey,
+                                               AreInterfaceKeysEqual);
+
     // Create built-in, hard-coded bindings.
     CreateHardCodedBindings();
 
@@ -2596,6 +2695,8 @@ COMPONENT_INIT
                                                  ServerSocketFd,
                                                  ServerConnectHandler,
                                                  POLLIN);
+    le_fdMonitor_SetDirectDispatch(ClientSocketMonitorRef, true);
+    le_fdMonitor_SetDirectDispatch(ServerSocketMonitorRef, true);
     if (listen(ClientSocketFd, MAX_CONNECT_REQUEST_BACKLOG) != 0)
     {
         LE_FATAL("Client socket listen() call failed with errno %d (%m).", errno);
@@ -22,6 +22,13 @@
 #define DEFAULT_REFMAP_NAME "Default Timer SafeRefs"
 #define DEFAULT_REFMAP_MAXSIZE 23
 
+/// Number of children of each node of a thread's timer heap.  A 4-ary heap is shallower than a
+/// binary one, and the four children of a node usually share a cache line.
+#define TIMER_HEAP_ARITY 4
+
+/// Number of slots allocated for a thread's timer heap when its first timer is started.
+#define TIMER_HEAP_INITIAL_CAPACITY 16
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -110,9 +117,13 @@ static Timer_t* CreateTimer
     timerPtr->interval = (le_clk_Time_t){0, 0};
     timerPtr->repeatCount = 1;
     timerPtr->contextPtr = NULL;
+    timerPtr->slack = (le_clk_Time_t){0, 0};
     timerPtr->link = LE_DLS_LINK_INIT;
+    timerPtr->heapIndex = 0;
+    timerPtr->startSeq = 0;
     timerPtr->isActive = false;
     timerPtr->expiryTime = (le_clk_Time_t){0, 0};
+    timerPtr->deadlineTime = (le_clk_Time_t){0, 0};
     timerPtr->expiryCount = 0;
     timerPtr->safeRef = NULL;
     timerPtr->safeRef = le_ref_CreateRef(SafeRefMap, timerPtr);
@@ -123,125 +134,211 @@ static Timer_t* CreateTimer
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add the timer record to the given list, sorted according to the timer value
+ * Check whether a timer's deadline comes before another one's.  Timers with equal deadlines expire
+ * in the order they were started.
+ *
+ * Timers without slack have their deadline at their expiry time, so among them this is expiry order.
+ *
+ * @return true if timer A's deadline comes first.
  */
 //--------------------------------------------------------------------------------------------------
-static void AddToTimerList
+static bool IsEarlier
 (
-    le_dls_List_t* listPtr,               ///< [IN] The list to add to.
-    Timer_t* newTimerPtr                  ///< [IN] The timer to add
+    const Timer_t* aPtr,                ///< [IN] Timer A.
+    const Timer_t* bPtr                 ///< [IN] Timer B.
 )
 {
-    Timer_t* timerPtr;
-    le_dls_Link_t* linkPtr;
+    if (le_clk_GreaterThan(bPtr->deadlineTime, aPtr->deadlineTime))
+    {
+        return true;
+    }
 
-    if ( newTimerPtr->isActive )
+    if (le_clk_GreaterThan(aPtr->deadlineTime, bPtr->deadlineTime))
     {
-        LE_ERROR("Timer '%s' is already active", newTimerPtr->name);
-        return;
+        return false;
     }
 
-    // Get the start of the list
-    linkPtr = le_dls_Peek(listPtr);
+    return (aPtr->startSeq < bPtr->startSeq);
+}
 
-    // Find the timer whose expiry time is greater than the new timer.
-    while ( linkPtr != NULL )
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Put a timer into a given slot of the heap.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void SetHeapSlot
+(
+    timer_ThreadRec_t* threadRecPtr,    ///< [IN] The thread's timer record.
+    size_t index,                       ///< [IN] The slot.
+    Timer_t* timerPtr                   ///< [IN] The timer.
+)
+{
+    threadRecPtr->heapPtr[index] = timerPtr;
+    timerPtr->heapIndex = index;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move a timer towards the top of the heap until its parent expires before it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SiftUp
+(
+    timer_ThreadRec_t* threadRecPtr,    ///< [IN] The thread's timer record.
+    size_t index                        ///< [IN] The slot holding the timer to move.
+)
+{
+    Timer_t* timerPtr = threadRecPtr->heapPtr[index];
+
+    while (index > 0)
     {
-        timerPtr = CONTAINER_OF(linkPtr, Timer_t, link);
+        size_t parent = (index - 1) / TIMER_HEAP_ARITY;
+        Timer_t* parentPtr = threadRecPtr->heapPtr[parent];
 
-        if ( le_clk_GreaterThan(timerPtr->expiryTime, newTimerPtr->expiryTime) )
+        if (!IsEarlier(timerPtr, parentPtr))
+        {
             break;
+        }
 
-        linkPtr = le_dls_PeekNext(listPtr, linkPtr);
+        SetHeapSlot(threadRecPtr, index, parentPtr);
+        index = parent;
     }
 
-    TimerListChangeCount++;
-    if (linkPtr == NULL)
-    {
-        // The list is either empty, or the new timer has the largest expiry time.
-        // In either case, add the new timer to the end of the list.
-        le_dls_Queue(listPtr, &newTimerPtr->link);
-    }
-    else
+    SetHeapSlot(threadRecPtr, index, timerPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move a timer towards the bottom of the heap until it expires before all its children.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SiftDown
+(
+    timer_ThreadRec_t* threadRecPtr,    ///< [IN] The thread's timer record.
+    size_t index                        ///< [IN] The slot holding the timer to move.
+)
+{
+    Timer_t* timerPtr = threadRecPtr->heapPtr[index];
+
+    for (;;)
     {
-        // Found a timer with larger expiry time; insert the new timer before it.
-        le_dls_AddBefore(listPtr, linkPtr, &newTimerPtr->link);
+        size_t firstChild = (index * TIMER_HEAP_ARITY) + 1;
+        size_t endChild = firstChild + TIMER_HEAP_ARITY;
+        size_t child;
+        size_t earliest = index;
+        Timer_t* earliestPtr = timerPtr;
+
+        if (endChild > threadRecPtr->heapCount)
+        {
+            endChild = threadRecPtr->heapCount;
+        }
+
+        for (child = firstChild; child < endChild; child++)
+        {
+            if (IsEarlier(threadRecPtr->heapPtr[child], earliestPtr))
+            {
+                earliest = child;
+                earliestPtr = threadRecPtr->heapPtr[child];
+            }
+        }
+
+        if (earliest == index)
+        {
+            break;
+        }
+
+        SetHeapSlot(threadRecPtr, index, earliestPtr);
+        index = earliest;
     }
 
-    // The new timer is now on the active list
-    newTimerPtr->isActive = true;
+    SetHeapSlot(threadRecPtr, index, timerPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Peek at the first timer from the given timer list
- *
- * @return:
- *      - pointer to the first timer on the list
- *      - NULL if the list is empty
+ * Add the timer record to the thread's active timers, ordered according to the timer's deadline
+ * (its expiry time plus its slack).
  */
 //--------------------------------------------------------------------------------------------------
-static Timer_t* PeekFromTimerList
+static void AddToTimerList
 (
-    le_dls_List_t* listPtr              ///< [IN] The list to look at.
+    timer_ThreadRec_t* threadRecPtr,      ///< [IN] The thread's timer record.
+    Timer_t* newTimerPtr                  ///< [IN] The timer to add
 )
 {
-    le_dls_Link_t* linkPtr;
+    if ( newTimerPtr->isActive )
+    {
+        LE_ERROR("Timer '%s' is already active", newTimerPtr->name);
+        return;
+    }
 
-    linkPtr = le_dls_Peek(listPtr);
-    if (linkPtr != NULL)
+    // Make room in the heap, if necessary.  The heap never shrinks.
+    if (threadRecPtr->heapCount == threadRecPtr->heapCapacity)
     {
-        return ( CONTAINER_OF(linkPtr, Timer_t, link) );
+        size_t newCapacity = (threadRecPtr->heapCapacity == 0 ?
+                              TIMER_HEAP_INITIAL_CAPACITY : threadRecPtr->heapCapacity * 2);
+
+        Timer_t** newHeapPtr = realloc(threadRecPtr->heapPtr, newCapacity * sizeof(Timer_t*));
+        LE_ASSERT(newHeapPtr != NULL);
+
+        threadRecPtr->heapPtr = newHeapPtr;
+        threadRecPtr->heapCapacity = newCapacity;
     }
-    return NULL;
+
+    TimerListChangeCount++;
+    newTimerPtr->startSeq = threadRecPtr->nextStartSeq++;
+    newTimerPtr->deadlineTime = le_clk_Add(newTimerPtr->expiryTime, newTimerPtr->slack);
+
+    threadRecPtr->heapPtr[threadRecPtr->heapCount] = newTimerPtr;
+    threadRecPtr->heapCount++;
+    SiftUp(threadRecPtr, threadRecPtr->heapCount - 1);
+
+    le_dls_Queue(&threadRecPtr->activeTimerList, &newTimerPtr->link);
+
+    // The new timer is now on the active list
+    newTimerPtr->isActive = true;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Pop the first timer from the given timer list
+ * Peek at the active timer with the earliest deadline
  *
  * @return:
- *      - pointer to the first timer on the list
- *      - NULL if the list is empty
+ *      - pointer to the timer with the earliest deadline
+ *      - NULL if there are no active timers
  */
 //--------------------------------------------------------------------------------------------------
-static Timer_t* PopFromTimerList
+static Timer_t* PeekFromTimerList
 (
-    le_dls_List_t* listPtr              ///< [IN] The list to look at.
+    timer_ThreadRec_t* threadRecPtr     ///< [IN] The thread's timer record.
 )
 {
-    le_dls_Link_t* linkPtr;
-    Timer_t* timerPtr;
-
-    linkPtr = le_dls_Pop(listPtr);
-    if (linkPtr != NULL)
+    if (threadRecPtr->heapCount == 0)
     {
-        TimerListChangeCount++;
-        timerPtr = CONTAINER_OF(linkPtr, Timer_t, link);
-
-        // The timer is no longer on the active list
-        timerPtr->isActive = false;
-
-        return timerPtr;
+        return NULL;
     }
-    return NULL;
+
+    return threadRecPtr->heapPtr[0];
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove the timer from the given timer list
+ * Remove the timer from the thread's active timers
  *
  * @return
  *      - LE_OK on success
- *      - LE_FAULT if the timer was not in the list
+ *      - LE_FAULT if the timer was not active
  */
 //--------------------------------------------------------------------------------------------------
 static le_result_t RemoveFromTimerList
 (
-    le_dls_List_t* listPtr,             ///< [IN] The list to look at.
+    timer_ThreadRec_t* threadRecPtr,    ///< [IN] The thread's timer record.
     Timer_t* timerPtr                   ///< [IN] The timer to remove
 )
 {
@@ -253,12 +350,58 @@ static le_result_t RemoveFromTimerList
     // Remove the timer from the active list
     timerPtr->isActive = false;
     TimerListChangeCount++;
-    le_dls_Remove(listPtr, &timerPtr->link);
+    le_dls_Remove(&threadRecPtr->activeTimerList, &timerPtr->link);
+
+    // Fill the hole in the heap with the last timer in the heap, then move that one up or down
+    // to where it belongs.
+    size_t index = timerPtr->heapIndex;
+
+    threadRecPtr->heapCount--;
+    if (index < threadRecPtr->heapCount)
+    {
+        SetHeapSlot(threadRecPtr, index, threadRecPtr->heapPtr[threadRecPtr->heapCount]);
+
+        if ((index > 0)
+            && IsEarlier(threadRecPtr->heapPtr[index],
+                         threadRecPtr->heapPtr[(index - 1) / TIMER_HEAP_ARITY]))
+        {
+            SiftUp(threadRecPtr, index);
+        }
+        else
+        {
+            SiftDown(threadRecPtr, index);
+        }
+    }
 
     return LE_OK;
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pop the active timer with the earliest deadline
+ *
+ * @return:
+ *      - pointer to the timer with the earliest deadline
+ *      - NULL if there are no active timers
+ */
+//--------------------------------------------------------------------------------------------------
+static Timer_t* PopFromTimerList
+(
+    timer_ThreadRec_t* threadRecPtr     ///< [IN] The thread's timer record.
+)
+{
+    Timer_t* timerPtr = PeekFromTimerList(threadRecPtr);
+
+    if (timerPtr != NULL)
+    {
+        (void)RemoveFromTimerList(threadRecPtr, timerPtr);
+    }
+
+    return timerPtr;
+}
+
+
 #if 0
 //--------------------------------------------------------------------------------------------------
 /**
@@ -304,6 +447,10 @@ static void PrintTimerList
 //--------------------------------------------------------------------------------------------------
 /**
  * Arm and (re)start the timerFD
+ *
+ * The timerFD is set to go off at the given timer's deadline rather than its expiry time, so that
+ * when timers have slack, the one wake-up can expire every timer whose expiry time has been reached
+ * by then.  This is safe because the given timer has the earliest deadline of all active timers.
  */
 //--------------------------------------------------------------------------------------------------
 static void RestartTimerFD
@@ -314,11 +461,11 @@ static void RestartTimerFD
     timer_ThreadRec_t* threadRecPtr = thread_GetTimerRecPtr();
     struct itimerspec timerInterval;
 
-    // Set the timer to expire at the expiry time of the given timer
+    // Set the timer to expire at the deadline of the given timer
     // There is a small possibility that the time set now will be slightly in the past
     // at this point but it will just cause the timerfd to expire immediately.
-    timerInterval.it_value.tv_sec = timerPtr->expiryTime.sec;
-    timerInterval.it_value.tv_nsec = timerPtr->expiryTime.usec * 1000;
+    timerInterval.it_value.tv_sec = timerPtr->deadlineTime.sec;
+    timerInterval.it_value.tv_nsec = timerPtr->deadlineTime.usec * 1000;
 
     // The timerFD does not repeat
     timerInterval.it_interval.tv_sec = 0;
@@ -404,8 +551,7 @@ static void ProcessExpiredTimer
         expiredTimer->expiryTime = le_clk_Add(expiredTimer->expiryTime, expiredTimer->interval);
 
         // Add the timer back to the timer list
-        AddToTimerList(&threadRecPtr->activeTimerList, expiredTimer);
-        //PrintTimerList(&threadRecPtr->activeTimerList);
+        AddToTimerList(threadRecPtr, expiredTimer);
     }
 
     // call the optional expiry handler function
@@ -457,7 +603,7 @@ static void TimerFdHandler
     LE_ERROR_IF(expiry != 1,  "On TimerFD read, unexpected expiry=%u", (unsigned int)expiry);
 
     // Pop off the first timer from the active list, and make sure it is the expected timer.
-    firstTimerPtr = PopFromTimerList(&threadRecPtr->activeTimerList);
+    firstTimerPtr = PopFromTimerList(threadRecPtr);
     LE_ASSERT( threadRecPtr->firstTimerPtr == firstTimerPtr );
 
     // Need to reset the expected timer, in case processing the current timer will cause the same
@@ -469,17 +615,19 @@ static void TimerFdHandler
     ProcessExpiredTimer(firstTimerPtr);
 
     // Check if there are any other timers that have since expired, pop them off the
-    // list and process them.
-    firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+    // list and process them.  Timers with slack whose expiry time has passed are expired now too,
+    // as long as they come up in deadline order, so that they share this wake-up.  Any that don't
+    // will still expire before their deadline.
+    firstTimerPtr = PeekFromTimerList(threadRecPtr);
     while ( firstTimerPtr != NULL &&
             le_clk_GreaterThan(le_clk_GetRelativeTime(), firstTimerPtr->expiryTime) )
     {
         // Pop off the timer and process it
-        firstTimerPtr = PopFromTimerList(&threadRecPtr->activeTimerList);
+        firstTimerPtr = PopFromTimerList(threadRecPtr);
         ProcessExpiredTimer(firstTimerPtr);
 
         // Try the next timer on the list
-        firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+        firstTimerPtr = PeekFromTimerList(threadRecPtr);
     }
 
     // While processing expired timers in the above loop, it is possible that a timer was started,
@@ -595,6 +743,10 @@ void timer_InitThread
 
     recPtr->timerFD = -1;
     recPtr->activeTimerList = LE_DLS_LIST_INIT;
+    recPtr->heapPtr = NULL;
+    recPtr->heapCount = 0;
+    recPtr->heapCapacity = 0;
+    recPtr->nextStartSeq = 0;
     recPtr->firstTimerPtr = NULL;
 }
 
@@ -648,6 +800,12 @@ void timer_DestructThread
 
         le_mem_Release(timerPtr);
     }
+
+    // Release the timer heap
+    free(threadRecPtr->heapPtr);
+    threadRecPtr->heapPtr = NULL;
+    threadRecPtr->heapCount = 0;
+    threadRecPtr->heapCapacity = 0;
 }
 
 // =============================================
@@ -840,6 +998,43 @@ le_result_t le_timer_SetRepeat
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the timer slack using milliseconds.
+ *
+ * The timer may expire up to this long after its interval has elapsed, so that its expiry can be
+ * handled in the same wake-up as other timers of the same thread.  The default is 0.
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_BUSY if the timer is currently running
+ *
+ * @note
+ *      If an invalid timer object is given, the process exits.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_timer_SetSlack
+(
+    le_timer_Ref_t timerRef,     ///< [IN] Set slack for this timer object.
+    uint32_t slack               ///< [IN] Timer slack in milliseconds.
+)
+{
+    Timer_t* timerPtr = le_ref_Lookup(SafeRefMap, timerRef);
+    LE_FATAL_IF(timerPtr == NULL, "Invalid timer reference %p.", timerRef);
+
+    if ( timerPtr->isActive )
+    {
+        return LE_BUSY;
+    }
+
+    time_t seconds = slack / 1000;
+    timerPtr->slack.sec = seconds;
+    timerPtr->slack.usec = (slack - (seconds * 1000)) * 1000;
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set context pointer for the timer
@@ -990,12 +1185,11 @@ le_result_t le_timer_Start
     // Add the timer to the timer list. This is the only place we reset the expiry count.
     timerPtr->expiryCount = 0;
     timerPtr->expiryTime = le_clk_Add(le_clk_GetRelativeTime(), timerPtr->interval);
-    AddToTimerList(&threadRecPtr->activeTimerList, timerPtr);
-    //PrintTimerList(&threadRecPtr->activeTimerList);
+    AddToTimerList(threadRecPtr, timerPtr);
 
     // Get the first timer from the active list. This is needed to determine whether the timerFD
     // needs to be restarted, in case the new timer was put at the beginning of the list.
-    firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+    firstTimerPtr = PeekFromTimerList(threadRecPtr);
 
     // If the timerFD is not running, or it is running a timer that is no longer at the beginning
     // of the active list, then (re)start the timerFD.
@@ -1041,7 +1235,7 @@ le_result_t le_timer_Stop
 
     timer_ThreadRec_t* threadRecPtr = thread_GetTimerRecPtr();
 
-    result = RemoveFromTimerList(&threadRecPtr->activeTimerList, timerPtr);
+    result = RemoveFromTimerList(threadRecPtr, timerPtr);
     if (result == LE_OK)
     {
         // If the timer was at the start of the active list, then restart the timerFD using the next
@@ -1051,7 +1245,7 @@ le_result_t le_timer_Stop
             TRACE("Stopping the first active timer");
             threadRecPtr->firstTimerPtr = NULL;
 
-            firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+            firstTimerPtr = PeekFromTimerList(threadRecPtr);
             if (firstTimerPtr != NULL)
             {
                 RestartTimerFD(firstTimerPtr);
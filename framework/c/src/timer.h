@@ -25,11 +25,15 @@ typedef struct
     le_clk_Time_t interval;                  ///< Interval
     uint32_t repeatCount;                    ///< Number of times the timer will repeat
     void* contextPtr;                        ///< Context for timer expiry
+    le_clk_Time_t slack;                     ///< How late the timer may expire
 
     // Internal State
     le_dls_Link_t link;                      ///< For adding to the timer list
+    size_t heapIndex;                        ///< Position in the thread's timer heap, if active
+    uint64_t startSeq;                       ///< Orders timers with equal expiry times
     bool isActive;                           ///< Is the timer active/running?
     le_clk_Time_t expiryTime;                ///< Time at which the timer should expire
+    le_clk_Time_t deadlineTime;              ///< Latest time the timer may expire (expiry + slack)
     uint32_t expiryCount;                    ///< Number of times the counter has expired
     le_timer_Ref_t safeRef;                  ///< For the API user to refer to this timer by
 }
@@ -50,11 +54,17 @@ Timer_t;
 typedef struct
 {
     int timerFD;                        ///< System timer used by the thread.
-    le_dls_List_t activeTimerList;      ///< Linked list of running legato timers for this thread
-    Timer_t* firstTimerPtr;             ///< Pointer to the timer on the active list that is
-                                        ///  associated with the currently running timerFD,
-                                        ///  or NULL if there are no timers on the active list.
-                                        ///  This is normally the first timer on the list.
+    le_dls_List_t activeTimerList;      ///< Unordered list of running legato timers for this
+                                        ///  thread (for inspection and clean-up).
+    Timer_t** heapPtr;                  ///< 4-ary min-heap of the running timers, ordered by
+                                        ///  deadline time.  The earliest is at index 0.
+    size_t heapCount;                   ///< Number of timers in the heap.
+    size_t heapCapacity;                ///< Number of slots allocated for the heap.
+    uint64_t nextStartSeq;              ///< Sequence number for the next timer to be started.
+    Timer_t* firstTimerPtr;             ///< Pointer to the running timer that is associated
+                                        ///  with the currently running timerFD, or NULL if
+                                        ///  there are no running timers.  This is normally
+                                        ///  the timer at the top of the heap.
 
 }
 timer_ThreadRec_t;
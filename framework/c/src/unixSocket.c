@@ -528,6 +528,97 @@ le_result_t unixSocket_SendDataMsg
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a batch of messages containing only data through a connected Unix domain datagram or
+ * sequenced-packet socket, using as few system calls as possible.  Each I/O vector becomes one
+ * message.
+ *
+ * If the socket runs out of buffer space part-way through the batch, the messages that were
+ * already sent are counted in *sentCountPtr and the rest must be sent later.
+ *
+ * @return
+ * - LE_OK if all the messages were sent.
+ * - LE_COMM_ERROR if the localSocketFd is not connected.
+ * - LE_FAULT if failed for some other reason (check your logs).
+ * - LE_NO_MEMORY if the send socket is set to non-blocking and it doesn't have enough buffer
+ *                  space to send the rest of the batch right now. Wait for the "writeable" event
+ *                  on the file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_SendDataMsgBatch
+(
+    int localSocketFd,          ///< [IN] fd of the local socket that will be used to send.
+    struct iovec* ioVectors,    ///< [IN] Array of I/O vectors, one per message to be sent.
+    size_t count,               ///< [IN] Number of messages to be sent.
+    size_t* sentCountPtr        ///< [OUT] Number of messages that were sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct mmsghdr msgHeaders[count];
+
+    memset(msgHeaders, 0, sizeof(msgHeaders));
+
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        msgHeaders[i].msg_hdr.msg_iov = &ioVectors[i];
+        msgHeaders[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    *sentCountPtr = 0;
+
+    while (*sentCountPtr < count)
+    {
+        // Send as many as the socket will take (retry if interrupted by a signal).
+        int sentCount;
+        do
+        {
+            sentCount = sendmmsg(localSocketFd,
+                                 msgHeaders + *sentCountPtr,
+                                 count - *sentCountPtr,
+                                 0);
+        }
+        while ((sentCount < 0) && (errno == EINTR));
+
+        if (sentCount < 0)
+        {
+            switch (errno)
+            {
+                case EAGAIN:  // Same as EWOULDBLOCK
+                    return LE_NO_MEMORY;
+
+                case ENOTCONN:
+                case ECONNRESET:
+                case EPIPE:
+                    LE_WARN("sendmmsg() failed with errno %d (%m).", errno);
+                    return LE_COMM_ERROR;
+
+                default:
+                    LE_ERROR("sendmmsg() failed with errno %d (%m).", errno);
+                    return LE_FAULT;
+            }
+        }
+
+        for (i = *sentCountPtr; i < *sentCountPtr + sentCount; i++)
+        {
+            if (msgHeaders[i].msg_len < ioVectors[i].iov_len)
+            {
+                LE_ERROR("The last %zu data bytes (of %zu total) were discarded by sendmmsg()!",
+                         ioVectors[i].iov_len - msgHeaders[i].msg_len,
+                         ioVectors[i].iov_len);
+                *sentCountPtr = i + 1;
+                return LE_FAULT;
+            }
+        }
+
+        *sentCountPtr += sentCount;
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Receives through a connected Unix domain socket a message containing any combination of
@@ -715,6 +806,133 @@ le_result_t unixSocket_ReceiveDataMsg
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receives through a connected Unix domain datagram or sequenced-packet socket as many messages
+ * as are waiting to be received, up to a given maximum, using as few system calls as possible.
+ * Each message can carry a data payload and a file descriptor.  Credentials are not received.
+ *
+ * This never blocks.  Entries beyond *receivedCountPtr in the output arrays are left untouched.
+ *
+ * @return
+ * - LE_OK if at least one message was received.
+ * - LE_WOULD_BLOCK if there is nothing to be received.
+ * - LE_CLOSED if the connection closed (and nothing was received before the close).
+ * - LE_FAULT if failed for some other reason (check your logs).
+ *
+ * @warning Any part of a message that couldn't fit into its receive buffer will have been lost.
+ *          That message's received data size will be the size of its buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_ReceiveMsgBatch
+(
+    int localSocketFd,      ///< [IN] fd of local socket that will be used to receive the messages.
+    struct iovec* ioVectors,///< [IN] Array of I/O vectors, one per message buffer.
+    size_t* dataSizes,      ///< [OUT] Array of received data sizes, one per message buffer.
+    int* fds,               ///< [OUT] Array of received file descriptors, one per message buffer.
+                            ///        (-1 will be stored for messages that had no fd.)
+    size_t count,           ///< [IN] Maximum number of messages to receive.
+    size_t* receivedCountPtr///< [OUT] Number of messages that were received.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char cmsgBuffers[count][CMSG_BUFF_SIZE];    // Ancillary data buffer for each message.
+    struct mmsghdr msgHeaders[count];
+
+    memset(msgHeaders, 0, sizeof(msgHeaders));
+
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        msgHeaders[i].msg_hdr.msg_iov = &ioVectors[i];
+        msgHeaders[i].msg_hdr.msg_iovlen = 1;
+        msgHeaders[i].msg_hdr.msg_control = cmsgBuffers[i];
+        msgHeaders[i].msg_hdr.msg_controllen = sizeof(cmsgBuffers[i]);
+    }
+
+    *receivedCountPtr = 0;
+
+    // Keep trying to receive until we don't get interrupted by a signal.
+    int receivedCount;
+    do
+    {
+        receivedCount = recvmmsg(localSocketFd, msgHeaders, count, MSG_DONTWAIT, NULL);
+    }
+    while ((receivedCount < 0) && (errno == EINTR));
+
+    // If we failed, process the error and return.
+    if (receivedCount < 0)
+    {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            return LE_WOULD_BLOCK;
+        }
+        else if (errno == ECONNRESET)
+        {
+            return LE_CLOSED;
+        }
+        else
+        {
+            LE_ERROR("recvmmsg() failed with errno %d (%m).", errno);
+            return LE_FAULT;
+        }
+    }
+
+    for (i = 0; i < (size_t)receivedCount; i++)
+    {
+        struct msghdr* msgHeaderPtr = &msgHeaders[i].msg_hdr;
+
+        fds[i] = -1;
+
+        // Extract any file descriptor from the ancillary data messages.
+        if (msgHeaderPtr->msg_controllen > 0)
+        {
+            ExtractAncillaryData(msgHeaderPtr, &fds[i], NULL);
+        }
+        // An empty message with no ancillary data marks the end of the connection, and every
+        // receive after the end comes back empty too.  Whatever was received before it is still
+        // returned; the close will be seen again on the next call.  An empty message followed by
+        // real ones is just an empty datagram, which is returned like any other.
+        else if (msgHeaders[i].msg_len == 0)
+        {
+            size_t j;
+            for (j = i + 1; j < (size_t)receivedCount; j++)
+            {
+                if ((msgHeaders[j].msg_len != 0) || (msgHeaders[j].msg_hdr.msg_controllen != 0))
+                {
+                    break;
+                }
+            }
+            if (j == (size_t)receivedCount)
+            {
+                break;
+            }
+        }
+
+        if ((msgHeaderPtr->msg_flags & MSG_CTRUNC) != 0)
+        {
+            LE_WARN("Ancillary data was discarded because it couldn't fit in our buffer.");
+        }
+
+        if ((msgHeaderPtr->msg_flags & MSG_TRUNC) != 0)
+        {
+            LE_ERROR("Received message truncated to %zu bytes.", ioVectors[i].iov_len);
+        }
+
+        dataSizes[i] = msgHeaders[i].msg_len;
+    }
+
+    *receivedCountPtr = i;
+
+    if (i == 0)
+    {
+        return LE_CLOSED;
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches the socket error state code (SO_ERROR).
@@ -447,6 +447,33 @@ le_result_t unixSocket_SendDataMsg
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a batch of messages containing only data through a connected Unix domain datagram or
+ * sequenced-packet socket, using as few system calls as possible.  Each I/O vector becomes one
+ * message.
+ *
+ * If the socket runs out of buffer space part-way through the batch, the messages that were
+ * already sent are counted in *sentCountPtr and the rest must be sent later.
+ *
+ * @return
+ * - LE_OK if all the messages were sent.
+ * - LE_COMM_ERROR if the localSocketFd is not connected.
+ * - LE_FAULT if failed for some other reason (check your logs).
+ * - LE_NO_MEMORY if the send socket is set to non-blocking and it doesn't have enough buffer
+ *                  space to send the rest of the batch right now. Wait for the "writeable" event
+ *                  on the file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_SendDataMsgBatch
+(
+    int localSocketFd,          ///< [IN] fd of the local socket that will be used to send.
+    struct iovec* ioVectors,    ///< [IN] Array of I/O vectors, one per message to be sent.
+    size_t count,               ///< [IN] Number of messages to be sent.
+    size_t* sentCountPtr        ///< [OUT] Number of messages that were sent.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Receives through a connected Unix domain socket a message containing any combination of
@@ -518,6 +545,36 @@ le_result_t unixSocket_ReceiveDataMsg
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receives through a connected Unix domain datagram or sequenced-packet socket as many messages
+ * as are waiting to be received, up to a given maximum, using as few system calls as possible.
+ * Each message can carry a data payload and a file descriptor.  Credentials are not received.
+ *
+ * This never blocks.  Entries beyond *receivedCountPtr in the output arrays are left untouched.
+ *
+ * @return
+ * - LE_OK if at least one message was received.
+ * - LE_WOULD_BLOCK if there is nothing to be received.
+ * - LE_CLOSED if the connection closed (and nothing was received before the close).
+ * - LE_FAULT if failed for some other reason (check your logs).
+ *
+ * @warning Any part of a message that couldn't fit into its receive buffer will have been lost.
+ *          That message's received data size will be the size of its buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_ReceiveMsgBatch
+(
+    int localSocketFd,      ///< [IN] fd of local socket that will be used to receive the messages.
+    struct iovec* ioVectors,///< [IN] Array of I/O vectors, one per message buffer.
+    size_t* dataSizes,      ///< [OUT] Array of received data sizes, one per message buffer.
+    int* fds,               ///< [OUT] Array of received file descriptors, one per message buffer.
+                            ///        (-1 will be stored for messages that had no fd.)
+    size_t count,           ///< [IN] Maximum number of messages to receive.
+    size_t* receivedCountPtr///< [OUT] Number of messages that were received.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches the socket error state code (SO_ERROR).
@@ -0,0 +1,457 @@
+ /**
+  * This is the unit test for the rate limiting of logging call sites, and the suppression of
+  * repeated messages.
+  *
+  * The log module reads its settings from the environment when the process starts, so the test
+  * runs itself again with them set.  Its log messages go to stderr, which is redirected to a
+  * file so they can be checked.
+  *
+  * The following is a list of the test cases:
+  *
+  *  - A call site can log a burst of messages, after which the rest are suppressed until its
+  *    token bucket refills.
+  *  - Identical messages from a call site are counted, and the count is logged before the next
+  *    different message.
+  *  - The suppressed messages and repeats not reported yet are reported periodically.
+  *  - A child process doesn't take its first message as a repeat of its parent's, and reports
+  *    what it suppressed when it exits.
+  *
+  * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+  */
+
+#include "legato.h"
+#include <sys/wait.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rate limit the test runs with: messages per second, and messages in a burst.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RATE_LIMIT          10
+#define BURST_LIMIT         5
+#define RATE_LIMIT_STR      "10,5"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of messages logged in each burst.  Must be more than the burst limit.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BURST_COUNT         20
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Longest time to wait for the periodic report, in milliseconds (twice the report interval).
+ */
+//--------------------------------------------------------------------------------------------------
+#define REPORT_WAIT_MS      10000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffers that messages are read into.  Messages are never longer than this.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_MSG_BYTES       256
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path of the file that stderr is redirected to.
+ */
+//--------------------------------------------------------------------------------------------------
+static char LogFilePath[] = "/tmp/testFwLogLimit.XXXXXX";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The file that stderr is redirected to, opened for reading.
+ */
+//--------------------------------------------------------------------------------------------------
+static FILE* LogFile;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of messages that the burst call site got to log.
+ */
+//--------------------------------------------------------------------------------------------------
+static int BurstLoggedCount = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Redirects stderr to a new file, and opens the file for reading.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RedirectStdErr(void)
+{
+    int fd = mkstemp(LogFilePath);
+    LE_ASSERT(fd >= 0);
+
+    LogFile = fopen(LogFilePath, "r");
+    LE_ASSERT(LogFile != NULL);
+
+    LE_ASSERT(dup2(fd, STDERR_FILENO) == STDERR_FILENO);
+    close(fd);
+
+    printf("Log messages are in '%s'.\n", LogFilePath);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the next message from the log file, if there is one.
+ *
+ * @return true if a message was read, false if there is nothing more in the file yet.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadMsg
+(
+    pid_t* pidPtr,      ///< [OUT] Process that logged the message.
+    char* msgPtr,       ///< [OUT] The user message.
+    size_t msgSize      ///< [IN] Size of the buffer msgPtr points to.
+)
+{
+    char line[MAX_MSG_BYTES + 200];
+
+    if (fgets(line, sizeof(line), LogFile) == NULL)
+    {
+        clearerr(LogFile);
+        return false;
+    }
+
+    line[strcspn(line, "\n")] = '\0';
+
+    // The process ID is in the process name's brackets, and the message is after the last '|'.
+    const char* pidStrPtr = strchr(line, '[');
+    const char* textPtr = strrchr(line, '|');
+    LE_ASSERT((pidStrPtr != NULL) && (textPtr != NULL));
+
+    *pidPtr = atoi(pidStrPtr + 1);
+    LE_ASSERT(le_utf8_Copy(msgPtr, textPtr + 2, msgSize, NULL) == LE_OK);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the next message from the log file, and checks that it is a given message from this
+ * process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExpectMsg
+(
+    const char* expectedPtr
+)
+{
+    pid_t pid;
+    char msg[MAX_MSG_BYTES];
+
+    LE_ASSERT(ReadMsg(&pid, msg, sizeof(msg)));
+    LE_ASSERT(pid == getpid());
+    LE_ASSERT(strcmp(msg, expectedPtr) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts the messages in the rest of the log file that start with a given prefix.
+ *
+ * @return The number of messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CountMsgs
+(
+    const char* prefixPtr
+)
+{
+    pid_t pid;
+    char msg[MAX_MSG_BYTES];
+    int count = 0;
+
+    while (ReadMsg(&pid, msg, sizeof(msg)))
+    {
+        if (strncmp(msg, prefixPtr, strlen(prefixPtr)) == 0)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a burst of numbered messages from a single call site.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogBurst
+(
+    int count
+)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        LE_INFO("burst %d", i);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a message from the call site used for the repeat tests.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogText
+(
+    const char* textPtr
+)
+{
+    LE_INFO("%s", textPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a message from the call site used for the periodic report test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogOtherText
+(
+    const char* textPtr
+)
+{
+    LE_INFO("%s", textPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a message from the call site used for the fork test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogForkText
+(
+    const char* textPtr
+)
+{
+    LE_INFO("%s", textPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a burst of messages from the call site used by the child in the fork test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogChildBurst
+(
+    int count
+)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        LE_INFO("child burst %d", i);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that a call site gets to log its burst, and then only what its bucket refills with.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestTokenBucket(void)
+{
+    LogBurst(BURST_COUNT);
+
+    int count = CountMsgs("burst ");
+    LE_ASSERT(count == BURST_LIMIT);
+    BurstLoggedCount = count;
+
+    // Wait long enough for two tokens.
+    usleep((2 * 1000000) / RATE_LIMIT);
+
+    LogBurst(BURST_COUNT);
+
+    // The wait may have taken a bit longer, but nowhere near enough for a whole burst.
+    count = CountMsgs("burst ");
+    LE_ASSERT((count >= 1) && (count < BURST_LIMIT));
+    BurstLoggedCount += count;
+
+    printf("Token bucket test passed.\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that identical messages are counted, and that the count is logged before the next
+ * different message.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestRepeats(void)
+{
+    // Stay within the burst limit, so that only repeats are suppressed.
+    LogText("same");
+    LogText("same");
+    LogText("same");
+    LogText("same");
+    LogText("different");
+
+    ExpectMsg("same");
+    ExpectMsg("Last message repeated 3 times.");
+    ExpectMsg("different");
+
+    printf("Repeat test passed.\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that a child process doesn't take its first message as a repeat of its parent's, and
+ * reports the messages it suppressed when it exits.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestFork(void)
+{
+    LogForkText("fork");
+    ExpectMsg("fork");
+
+    fflush(stdout);
+    pid_t childPid = fork();
+    LE_ASSERT(childPid >= 0);
+
+    if (childPid == 0)
+    {
+        LogForkText("fork");
+        LogChildBurst(BURST_LIMIT + 3);
+        exit(EXIT_SUCCESS);
+    }
+
+    int status;
+    LE_ASSERT(waitpid(childPid, &status, 0) == childPid);
+    LE_ASSERT(WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS));
+
+    pid_t pid;
+    char msg[MAX_MSG_BYTES];
+    bool isForkMsgFound = false;
+    bool isReportFound = false;
+    int childBurstCount = 0;
+
+    while (ReadMsg(&pid, msg, sizeof(msg)))
+    {
+        LE_ASSERT(pid == childPid);
+
+        if (strcmp(msg, "fork") == 0)
+        {
+            isForkMsgFound = true;
+        }
+        else if (strncmp(msg, "child burst ", 12) == 0)
+        {
+            childBurstCount++;
+        }
+        else if (strcmp(msg, "3 messages suppressed by rate limit.") == 0)
+        {
+            isReportFound = true;
+        }
+    }
+
+    LE_ASSERT(isForkMsgFound);
+    LE_ASSERT(childBurstCount == BURST_LIMIT);
+    LE_ASSERT(isReportFound);
+
+    printf("Fork test passed.\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that the suppressed messages and repeats that haven't been reported are reported
+ * periodically.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestPeriodicReport(void)
+{
+    LogOtherText("again");
+    LogOtherText("again");
+    LogOtherText("again");
+    ExpectMsg("again");
+
+    char burstReport[MAX_MSG_BYTES];
+    snprintf(burstReport,
+             sizeof(burstReport),
+             "%d messages suppressed by rate limit.",
+             (2 * BURST_COUNT) - BurstLoggedCount);
+
+    bool isBurstReportFound = false;
+    bool isRepeatReportFound = false;
+    int waitedMs = 0;
+
+    while ((!isBurstReportFound || !isRepeatReportFound) && (waitedMs < REPORT_WAIT_MS))
+    {
+        pid_t pid;
+        char msg[MAX_MSG_BYTES];
+
+        if (!ReadMsg(&pid, msg, sizeof(msg)))
+        {
+            usleep(100000);
+            waitedMs += 100;
+        }
+        else if (strcmp(msg, burstReport) == 0)
+        {
+            isBurstReportFound = true;
+        }
+        else if (strcmp(msg, "Last message repeated 2 times.") == 0)
+        {
+            isRepeatReportFound = true;
+        }
+        else
+        {
+            LE_FATAL("Unexpected message '%s'.", msg);
+        }
+    }
+
+    LE_ASSERT(isBurstReportFound);
+    LE_ASSERT(isRepeatReportFound);
+
+    printf("Periodic report test passed.\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+    // Run again with the log settings in the environment.
+    if (getenv("LE_LOG_SUPPRESS_REPEATS") == NULL)
+    {
+        LE_ASSERT(setenv("LE_LOG_LEVEL", "INFO", 1) == 0);
+        LE_ASSERT(setenv("LE_LOG_RATE_LIMIT", RATE_LIMIT_STR, 1) == 0);
+        LE_ASSERT(setenv("LE_LOG_SUPPRESS_REPEATS", "1", 1) == 0);
+        execv("/proc/self/exe", argv);
+        LE_FATAL("Failed to run the test again (%m).");
+    }
+
+    printf("\n");
+    printf("*** Unit Test for log rate limiting. ***\n");
+
+    RedirectStdErr();
+
+    TestTokenBucket();
+    TestRepeats();
+    TestFork();
+    TestPeriodicReport();
+
+    unlink(LogFilePath);
+
+    printf("*** Log rate limiting tests passed. ***\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,527 @@
+ /**
+  * This is the unit test for deferred formatting of log messages (log rings).
+  *
+  * The log module reads its settings from the environment when the process starts, so the test
+  * runs itself again with deferred formatting turned on.  Its log messages go to stderr, which is
+  * redirected to a file so they can be checked.
+  *
+  * The following is a list of the test cases:
+  *
+  *  - Deferred messages with arguments of every type come out the same as printf() would format
+  *    them, including %s with NULL, %s with a precision and an unterminated string, %m and
+  *    long double.
+  *  - A CRITICAL message writes out all the waiting messages before it.
+  *  - A format string in a buffer that is changed after each message is logged as it was.
+  *  - The ring of a thread that has exited is still drained.
+  *  - Messages dropped because a thread's ring is full are counted, and the count is reported.
+  *  - Waiting messages are written out when the process exits.
+  *
+  * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+  */
+
+#include "legato.h"
+#include <sys/wait.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of each thread's log ring the test runs with, in kilobytes (the smallest allowed).
+ */
+//--------------------------------------------------------------------------------------------------
+#define RING_KBYTES_STR     "4"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffers that messages are read into.  Messages are never longer than this.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_MSG_BYTES       256
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of messages logged by LogAllTypes().
+ */
+//--------------------------------------------------------------------------------------------------
+#define CASE_COUNT          9
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of times the flooding thread calls LogAllTypes().  Far more than its ring can hold.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FLOOD_COUNT         500
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of messages logged by the process run for the exit test.
+ */
+//--------------------------------------------------------------------------------------------------
+#define EXIT_MSG_COUNT      20
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Longest time to wait for the drainer thread to write something out, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DRAIN_WAIT_MS       5000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path of the file that stderr is redirected to.
+ */
+//--------------------------------------------------------------------------------------------------
+static char LogFilePath[] = "/tmp/testFwLogRing.XXXXXX";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The file that stderr is redirected to, opened for reading.
+ */
+//--------------------------------------------------------------------------------------------------
+static FILE* LogFile;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The messages that LogAllTypes() logs, as printf() formats them.
+ */
+//--------------------------------------------------------------------------------------------------
+static char ExpectedMsgs[CASE_COUNT][MAX_MSG_BYTES];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A NULL string, kept where the compiler can't see that it's NULL (so it doesn't warn).
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* volatile NullStr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A string that isn't NUL-terminated, only to be printed with a precision.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char Unterminated[3] = { 'a', 'b', 'c' };
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a message, and stores what printf() makes of it in the next of the expected messages (if
+ * expectedIndexPtr isn't NULL).  errno is set to ENOENT first, for %m.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_CASE(expectedIndexPtr, ...) \
+    do { \
+        if ((expectedIndexPtr) != NULL) \
+        { \
+            errno = ENOENT; \
+            snprintf(ExpectedMsgs[(*(expectedIndexPtr))++], MAX_MSG_BYTES, __VA_ARGS__); \
+        } \
+        errno = ENOENT; \
+        LE_INFO(__VA_ARGS__); \
+    } while (0)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Redirects stderr to a new file, and opens the file for reading.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RedirectStdErr(void)
+{
+    int fd = mkstemp(LogFilePath);
+    LE_ASSERT(fd >= 0);
+
+    LogFile = fopen(LogFilePath, "r");
+    LE_ASSERT(LogFile != NULL);
+
+    LE_ASSERT(dup2(fd, STDERR_FILENO) == STDERR_FILENO);
+    close(fd);
+
+    printf("Log messages are in '%s'.\n", LogFilePath);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the next message from the log file, if there is one.
+ *
+ * @return true if a message was read, false if there is nothing more in the file yet.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadMsg
+(
+    pid_t* pidPtr,      ///< [OUT] Process that logged the message.
+    char* threadPtr,    ///< [OUT] Name of the thread that logged the message.
+    size_t threadSize,  ///< [IN] Size of the buffer threadPtr points to.
+    char* msgPtr,       ///< [OUT] The user message.
+    size_t msgSize      ///< [IN] Size of the buffer msgPtr points to.
+)
+{
+    char line[MAX_MSG_BYTES + 200];
+
+    if (fgets(line, sizeof(line), LogFile) == NULL)
+    {
+        clearerr(LogFile);
+        return false;
+    }
+
+    line[strcspn(line, "\n")] = '\0';
+
+    // The process ID is in the process name's brackets, the thread name follows "T=", and the
+    // message follows the third '|'.
+    const char* pidStrPtr = strchr(line, '[');
+    const char* threadStrPtr = strstr(line, " T=");
+    const char* textPtr = strchr(line, '|');
+    if (textPtr != NULL)
+    {
+        textPtr = strchr(textPtr + 1, '|');
+    }
+    if (textPtr != NULL)
+    {
+        textPtr = strchr(textPtr + 1, '|');
+    }
+    LE_ASSERT((pidStrPtr != NULL) && (threadStrPtr != NULL) && (textPtr != NULL));
+
+    *pidPtr = atoi(pidStrPtr + 1);
+    threadStrPtr += 3;
+    LE_ASSERT(strcspn(threadStrPtr, " ") < threadSize);
+    le_utf8_Copy(threadPtr, threadStrPtr, strcspn(threadStrPtr, " ") + 1, NULL);
+    LE_ASSERT(le_utf8_Copy(msgPtr, textPtr + 2, msgSize, NULL) == LE_OK);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the next message from the log file, waiting for it if necessary, and checks that it is a
+ * given message from this process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExpectMsg
+(
+    const char* expectedPtr,
+    bool mustWait               ///< [IN] true to wait for the drainer thread to write it out.
+)
+{
+    pid_t pid;
+    char thread[MAX_MSG_BYTES];
+    char msg[MAX_MSG_BYTES];
+    int waitedMs = 0;
+
+    while (!ReadMsg(&pid, thread, sizeof(thread), msg, sizeof(msg)))
+    {
+        LE_ASSERT(mustWait && (waitedMs < DRAIN_WAIT_MS));
+        usleep(10000);
+        waitedMs += 10;
+    }
+
+    LE_ASSERT(pid == getpid());
+    LE_ASSERT(strcmp(msg, expectedPtr) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a message with arguments of every type from each of several call sites.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogAllTypes
+(
+    int* expectedIndexPtr   ///< [IN/OUT] Index of the next expected message, or NULL if the
+                            ///           expected messages don't need to be stored.
+)
+{
+    LOG_CASE(expectedIndexPtr, "int %d %i %u %x %X %o %c %hd %hhu %+05d", -5, 7, 3000000000u,
+             0xbeef, 0xf00d, 8, 'z', (short)-2, (unsigned char)200, 42);
+    LOG_CASE(expectedIndexPtr, "long %ld %lu %lld %llx %zu %zd %jd %td", -123456789L,
+             4000000000UL, -9000000000LL, 0x123456789abcULL, (size_t)77, (ssize_t)-77,
+             (intmax_t)-1, (ptrdiff_t)12);
+    LOG_CASE(expectedIndexPtr, "double %f %.2e %g %8.3f %a", 3.25, 12345.678, 0.1, -1.5f, 1.0);
+    LOG_CASE(expectedIndexPtr, "long double %Lf %.3Le %Lg", 2.5L, 1234.5678L, 1e-3L);
+    LOG_CASE(expectedIndexPtr, "pointer %p %p", (void*)0x1234, NULL);
+    LOG_CASE(expectedIndexPtr, "string '%s' '%.3s' '%-6s' '%5.2s' '%.3s'", "hello",
+             "truncated", "ab", "xyz", Unterminated);
+    LOG_CASE(expectedIndexPtr, "null string '%s' '%.3s' '%10s'", NullStr, NullStr, NullStr);
+    LOG_CASE(expectedIndexPtr, "errno %m, %d%% done", 50);
+    LOG_CASE(expectedIndexPtr, "no arguments");
+
+    LE_ASSERT((expectedIndexPtr == NULL) || (*expectedIndexPtr == CASE_COUNT));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that every type of argument is formatted the way printf() would, and that a CRITICAL
+ * message writes out all the waiting messages before it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestArgTypesAndCritFlush(void)
+{
+    int expectedIndex = 0;
+    int i;
+
+    LogAllTypes(&expectedIndex);
+
+    LE_CRIT("flush");
+
+    // Everything must be in the file already, without waiting for the drainer thread.
+    for (i = 0; i < CASE_COUNT; i++)
+    {
+        ExpectMsg(ExpectedMsgs[i], false);
+    }
+    ExpectMsg("flush", false);
+
+    printf("Argument type and CRITICAL flush test passed.\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs messages with format strings built in a buffer, and then overwrites the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogFromBuffer(void)
+{
+    char format[MAX_MSG_BYTES];
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        snprintf(format, sizeof(format), "dyn %d", i);
+        LE_INFO(format);
+    }
+    memset(format, 'x', sizeof(format) - 1);
+    format[sizeof(format) - 1] = '\0';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that a format string that isn't a literal is used as it was when the message was logged,
+ * even though the buffer it's in is changed (and then gone) before the messages are written out.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestNonLiteralFormat(void)
+{
+    LogFromBuffer();
+
+    LE_CRIT("flush");
+
+    ExpectMsg("dyn 0", false);
+    ExpectMsg("dyn 1", false);
+    ExpectMsg("dyn 2", false);
+    ExpectMsg("flush", false);
+
+    printf("Non-literal format test passed.\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of a thread that logs a few messages and exits.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* OrphanThreadMain
+(
+    void* contextPtr
+)
+{
+    LE_INFO("orphan %d", 1);
+    LE_INFO("orphan %d", 2);
+    LE_INFO("orphan %d", 3);
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that the messages in the ring of a thread that has exited are still written out, by the
+ * drainer thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestOrphanedRing(void)
+{
+    le_thread_Ref_t threadRef = le_thread_Create("orphan", OrphanThreadMain, NULL);
+    le_thread_SetJoinable(threadRef);
+    le_thread_Start(threadRef);
+    LE_ASSERT(le_thread_Join(threadRef, NULL) == LE_OK);
+
+    ExpectMsg("orphan 1", true);
+    ExpectMsg("orphan 2", true);
+    ExpectMsg("orphan 3", true);
+
+    printf("Orphaned ring test passed.\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of a thread that logs much faster than its messages can be written out.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* FloodThreadMain
+(
+    void* contextPtr
+)
+{
+    int i;
+
+    for (i = 0; i < FLOOD_COUNT; i++)
+    {
+        LogAllTypes(NULL);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that messages dropped because a ring is full are counted, and that every message is either
+ * written out (correctly) or counted.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestDrops(void)
+{
+    le_thread_Ref_t threadRef = le_thread_Create("flood", FloodThreadMain, NULL);
+    le_thread_SetJoinable(threadRef);
+    le_thread_Start(threadRef);
+    LE_ASSERT(le_thread_Join(threadRef, NULL) == LE_OK);
+
+    LE_CRIT("flood done");
+
+    pid_t pid;
+    char thread[MAX_MSG_BYTES];
+    char msg[MAX_MSG_BYTES];
+    int writtenCount = 0;
+    int droppedCount = 0;
+
+    while (ReadMsg(&pid, thread, sizeof(thread), msg, sizeof(msg)))
+    {
+        LE_ASSERT(pid == getpid());
+
+        if (strcmp(thread, "flood") != 0)
+        {
+            LE_ASSERT(strcmp(msg, "flood done") == 0);
+            break;
+        }
+
+        unsigned int count;
+        char end;
+        if (sscanf(msg, "%u log messages dropped (log ring full%c", &count, &end) == 2)
+        {
+            droppedCount += count;
+            continue;
+        }
+
+        int i;
+        for (i = 0; (i < CASE_COUNT) && (strcmp(msg, ExpectedMsgs[i]) != 0); i++)
+        {
+        }
+        LE_FATAL_IF(i == CASE_COUNT, "Unexpected message '%s'.", msg);
+
+        writtenCount++;
+    }
+
+    printf("%d messages written, %d dropped.\n", writtenCount, droppedCount);
+
+    LE_ASSERT(droppedCount > 0);
+    LE_ASSERT(writtenCount + droppedCount == FLOOD_COUNT * CASE_COUNT);
+
+    printf("Drop test passed.\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that the messages waiting when a process exits are written out.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestExit
+(
+    char* programPtr
+)
+{
+    fflush(stdout);
+    pid_t childPid = fork();
+    LE_ASSERT(childPid >= 0);
+
+    if (childPid == 0)
+    {
+        execl("/proc/self/exe", programPtr, "exit", (char*)NULL);
+        LE_FATAL("Failed to run the exit test (%m).");
+    }
+
+    int status;
+    LE_ASSERT(waitpid(childPid, &status, 0) == childPid);
+    LE_ASSERT(WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS));
+
+    pid_t pid;
+    char thread[MAX_MSG_BYTES];
+    char msg[MAX_MSG_BYTES];
+    int i;
+
+    for (i = 0; i < EXIT_MSG_COUNT; i++)
+    {
+        char expected[MAX_MSG_BYTES];
+        snprintf(expected, sizeof(expected), "exit %d", i);
+
+        LE_ASSERT(ReadMsg(&pid, thread, sizeof(thread), msg, sizeof(msg)));
+        LE_ASSERT(pid == childPid);
+        LE_ASSERT(strcmp(msg, expected) == 0);
+    }
+
+    printf("Exit test passed.\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+    // Run again with the log settings in the environment.
+    if (getenv("LE_LOG_DEFERRED") == NULL)
+    {
+        LE_ASSERT(setenv("LE_LOG_LEVEL", "INFO", 1) == 0);
+        LE_ASSERT(setenv("LE_LOG_RATE_LIMIT", "off", 1) == 0);
+        LE_ASSERT(setenv("LE_LOG_DEFERRED", RING_KBYTES_STR, 1) == 0);
+        execv("/proc/self/exe", argv);
+        LE_FATAL("Failed to run the test again (%m).");
+    }
+
+    // When run for the exit test, just log and leave the messages waiting.
+    if ((argc > 1) && (strcmp(argv[1], "exit") == 0))
+    {
+        int i;
+        for (i = 0; i < EXIT_MSG_COUNT; i++)
+        {
+            LE_INFO("exit %d", i);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    printf("\n");
+    printf("*** Unit Test for deferred log formatting. ***\n");
+
+    RedirectStdErr();
+
+    TestArgTypesAndCritFlush();
+    TestNonLiteralFormat();
+    TestOrphanedRing();
+    TestDrops();
+    TestExit(argv[0]);
+
+    unlink(LogFilePath);
+
+    printf("*** Deferred log formatting tests passed. ***\n");
+
+    return EXIT_SUCCESS;
+}
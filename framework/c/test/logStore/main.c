@@ -0,0 +1,947 @@
+ /**
+  * This is the unit test for persistent log storage (logStore), which the Log Control Daemon
+  * writes and "log read" reads.
+  *
+  * Log storage can only be opened once per process, so each batch of log messages is written by
+  * a child process, and the parent reads them back.
+  *
+  * The following is a list of the test cases:
+  *
+  *  - Messages written in blocks are all read back as they were, in order, and take up less
+  *    space than they would uncompressed (whether they compress well or not at all).
+  *  - Reading selects messages by severity level (with traces and their keywords counted as
+  *    debug messages), process name, component name and time.
+  *  - A block whose compressed data is corrupted (with its checksum fixed up, so the data has to
+  *    be decompressed) or whose checksum is wrong is skipped, and the blocks around it are read.
+  *  - When log storage is opened again, a damaged block at the end of the current log file (cut
+  *    short, or garbage) is cut off, and the new blocks follow the good ones.
+  *
+  * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+  */
+
+#include "legato.h"
+#include "logStore.h"
+#include "limit.h"
+#include <sys/wait.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of log messages written for the round trip and filter tests.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RECORD_COUNT            1500
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of log messages written in each block for the corruption tests.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BLOCK_RECORD_COUNT      100
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of different ways a block is corrupted.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CORRUPT_COUNT           300
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timestamp of the first log message.  Every ten messages are a second apart.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BASE_TIME               1500000000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffers that a log message's strings are made in.  Short enough that none of them
+ * are truncated when stored.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_STRING_BYTES        32
+#define MAX_MSG_BYTES           400
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A log message made up by the test, and the strings it points to.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    logStore_Record_t   record;
+    char                levelStr[MAX_STRING_BYTES];
+    char                procName[MAX_STRING_BYTES];
+    char                compName[MAX_STRING_BYTES];
+    char                threadName[MAX_STRING_BYTES];
+    char                fileName[MAX_STRING_BYTES];
+    char                funcName[MAX_STRING_BYTES];
+    char                msg[MAX_MSG_BYTES];
+}
+TestRecord_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * What is checked while reading log messages back.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const logStore_Filter_t* filterPtr; ///< Filter the messages are read with.
+    unsigned int    nextIndex;          ///< Index of the next message that may be read.
+    unsigned int    skipStart;          ///< Index of the first message that may be damaged.
+    unsigned int    skipEnd;            ///< Index following the last message that may be damaged.
+    unsigned int    count;              ///< Number of good messages read.
+    unsigned int    traceCount;         ///< Number of good traces read.
+}
+ReadContext_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory that the test keeps its log files in.
+ */
+//--------------------------------------------------------------------------------------------------
+static char TestDirPath[] = "/tmp/testFwLogStore.XXXXXX";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes up the log message with a given index.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeRecord
+(
+    unsigned int index,
+    TestRecord_t* testRecordPtr     ///< [OUT] The log message.
+)
+{
+    static const char* levelStrs[] = { "DBUG", "INFO", "-WRN-", "=ERR=", "*CRT*", "*EMR*" };
+    logStore_Record_t* recordPtr = &testRecordPtr->record;
+
+    recordPtr->timestamp = BASE_TIME + (index / 10);
+    recordPtr->pid = 100 + (index % 3);
+    recordPtr->lineNumber = index;
+
+    // Mostly traces and debug to error messages, with a few critical and emergency messages (each
+    // of which ends its block).
+    if ((index % 401) == 400)
+    {
+        recordPtr->level = LE_LOG_EMERG;
+    }
+    else if ((index % 211) == 210)
+    {
+        recordPtr->level = LE_LOG_CRIT;
+    }
+    else if ((index % 5) == 0)
+    {
+        recordPtr->level = (le_log_Level_t)-1;
+    }
+    else
+    {
+        recordPtr->level = LE_LOG_DEBUG + (index % 5) - 1;
+    }
+
+    if (recordPtr->level == (le_log_Level_t)-1)
+    {
+        snprintf(testRecordPtr->levelStr, MAX_STRING_BYTES, "keyword%u", index % 3);
+    }
+    else
+    {
+        snprintf(testRecordPtr->levelStr, MAX_STRING_BYTES, "%s", levelStrs[recordPtr->level]);
+    }
+
+    snprintf(testRecordPtr->procName, MAX_STRING_BYTES, "proc%u", index % 3);
+    snprintf(testRecordPtr->compName, MAX_STRING_BYTES, "comp%u", (index / 3) % 2);
+    snprintf(testRecordPtr->threadName, MAX_STRING_BYTES, "thread%u", index % 4);
+    snprintf(testRecordPtr->fileName, MAX_STRING_BYTES, "file%u.c", index % 5);
+    snprintf(testRecordPtr->funcName, MAX_STRING_BYTES, "Function%u", index % 6);
+
+    // Some messages are random bytes, which don't compress.
+    if ((index % 10) == 3)
+    {
+        unsigned int seed = index;
+        size_t len = 1 + (rand_r(&seed) % (MAX_MSG_BYTES - 1));
+        size_t i;
+
+        for (i = 0; i < len; i++)
+        {
+            testRecordPtr->msg[i] = 1 + (rand_r(&seed) % 255);
+        }
+        testRecordPtr->msg[len] = '\0';
+    }
+    else
+    {
+        snprintf(testRecordPtr->msg,
+                 MAX_MSG_BYTES,
+                 "Message %u from the log storage test, saying the same thing as the others.",
+                 index);
+    }
+
+    recordPtr->levelStrPtr = testRecordPtr->levelStr;
+    recordPtr->procNamePtr = testRecordPtr->procName;
+    recordPtr->compNamePtr = testRecordPtr->compName;
+    recordPtr->threadNamePtr = testRecordPtr->threadName;
+    recordPtr->fileNamePtr = testRecordPtr->fileName;
+    recordPtr->funcNamePtr = testRecordPtr->funcName;
+    recordPtr->msgPtr = testRecordPtr->msg;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the number of bytes the log message with a given index takes up uncompressed.
+ *
+ * @return The number of bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetRecordSize
+(
+    unsigned int index
+)
+{
+    TestRecord_t testRecord;
+    MakeRecord(index, &testRecord);
+
+    return   sizeof(logStore_RecordHeader_t)
+           + strlen(testRecord.levelStr) + 1
+           + strlen(testRecord.procName) + 1
+           + strlen(testRecord.compName) + 1
+           + strlen(testRecord.threadName) + 1
+           + strlen(testRecord.fileName) + 1
+           + strlen(testRecord.funcName) + 1
+           + strlen(testRecord.msg) + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a log message read back is the message made up with its index (which is its
+ * line number).
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsRecordGood
+(
+    const logStore_Record_t* recordPtr
+)
+{
+    TestRecord_t expected;
+    MakeRecord(recordPtr->lineNumber, &expected);
+
+    return (   (recordPtr->timestamp == expected.record.timestamp)
+            && (recordPtr->pid == expected.record.pid)
+            && (recordPtr->level == expected.record.level)
+            && (strcmp(recordPtr->levelStrPtr, expected.levelStr) == 0)
+            && (strcmp(recordPtr->procNamePtr, expected.procName) == 0)
+            && (strcmp(recordPtr->compNamePtr, expected.compName) == 0)
+            && (strcmp(recordPtr->threadNamePtr, expected.threadName) == 0)
+            && (strcmp(recordPtr->fileNamePtr, expected.fileName) == 0)
+            && (strcmp(recordPtr->funcNamePtr, expected.funcName) == 0)
+            && (strcmp(recordPtr->msgPtr, expected.msg) == 0) );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a filter selects a log message.
+ *
+ * @return true if it does.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsSelected
+(
+    const logStore_Record_t* recordPtr,
+    const logStore_Filter_t* filterPtr
+)
+{
+    le_log_Level_t level = recordPtr->level;
+    if (level == (le_log_Level_t)-1)
+    {
+        level = LE_LOG_DEBUG;
+    }
+
+    return (   (recordPtr->timestamp >= filterPtr->startTime)
+            && (recordPtr->timestamp <= filterPtr->endTime)
+            && (level >= filterPtr->minLevel)
+            && (   (filterPtr->procNamePtr == NULL)
+                || (strcmp(recordPtr->procNamePtr, filterPtr->procNamePtr) == 0) )
+            && (   (filterPtr->compNamePtr == NULL)
+                || (strcmp(recordPtr->compNamePtr, filterPtr->compNamePtr) == 0) ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks a log message read back.  Messages must be good, selected by the filter, and in order,
+ * except those in the range that may be damaged.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckRecord
+(
+    const logStore_Record_t* recordPtr,
+    void* contextPtr
+)
+{
+    ReadContext_t* readPtr = contextPtr;
+    unsigned int index = recordPtr->lineNumber;
+
+    // A damaged message may have any index, as that may be what was damaged.
+    if (!IsRecordGood(recordPtr))
+    {
+        LE_FATAL_IF(readPtr->skipStart == readPtr->skipEnd, "Message %u is damaged.", index);
+        return;
+    }
+
+    if ((index >= readPtr->skipStart) && (index < readPtr->skipEnd))
+    {
+        return;
+    }
+
+    LE_FATAL_IF(index < readPtr->nextIndex, "Message %u read out of order.", index);
+    LE_FATAL_IF(!IsSelected(recordPtr, readPtr->filterPtr), "Message %u not selected.", index);
+
+    // Every message skipped must be one that isn't selected, or may be damaged.
+    while (readPtr->nextIndex < index)
+    {
+        TestRecord_t skipped;
+        MakeRecord(readPtr->nextIndex, &skipped);
+
+        LE_FATAL_IF(   !((readPtr->nextIndex >= readPtr->skipStart)
+                         && (readPtr->nextIndex < readPtr->skipEnd))
+                    && IsSelected(&skipped.record, readPtr->filterPtr),
+                    "Message %u is missing.",
+                    readPtr->nextIndex);
+
+        readPtr->nextIndex++;
+    }
+
+    readPtr->nextIndex++;
+    readPtr->count++;
+
+    if (recordPtr->level == (le_log_Level_t)-1)
+    {
+        readPtr->traceCount++;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the log messages in a directory, and checks them.
+ *
+ * @return The number of good messages read outside the range that may be damaged.
+ */
+//--------------------------------------------------------------------------------------------------
+static unsigned int ReadRecords
+(
+    const char* dirPathPtr,
+    const logStore_Filter_t* filterPtr,
+    unsigned int endIndex,          ///< [IN] Index following the last message written.
+    unsigned int skipStart,         ///< [IN] Index of the first message that may be damaged.
+    unsigned int skipEnd,           ///< [IN] Index following the last message that may be damaged.
+    unsigned int* traceCountPtr     ///< [OUT] Number of traces read (NULL if not wanted).
+)
+{
+    ReadContext_t context = { .filterPtr = filterPtr,
+                              .skipStart = skipStart,
+                              .skipEnd = skipEnd };
+
+    LE_ASSERT(logStore_Read(dirPathPtr, filterPtr, CheckRecord, &context) == LE_OK);
+
+    // Nothing selected may be missing at the end either.
+    while (context.nextIndex < endIndex)
+    {
+        TestRecord_t skipped;
+        MakeRecord(context.nextIndex, &skipped);
+
+        LE_FATAL_IF(   !((context.nextIndex >= skipStart) && (context.nextIndex < skipEnd))
+                    && IsSelected(&skipped.record, filterPtr),
+                    "Message %u is missing.",
+                    context.nextIndex);
+
+        context.nextIndex++;
+    }
+
+    if (traceCountPtr != NULL)
+    {
+        *traceCountPtr = context.traceCount;
+    }
+
+    return context.count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes log messages to a directory from a child process, which opens log storage, appends the
+ * messages and writes out what's left of the last block.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteRecords
+(
+    const char* dirPathPtr,
+    unsigned int firstIndex,
+    unsigned int count,
+    unsigned int step,          ///< [IN] Difference between the indexes of the messages.
+    unsigned int flushCount     ///< [IN] Number of messages per block (0 to let blocks fill up).
+)
+{
+    fflush(stdout);
+    pid_t childPid = fork();
+    LE_ASSERT(childPid >= 0);
+
+    if (childPid == 0)
+    {
+        unsigned int i;
+
+        LE_ASSERT(logStore_Open(dirPathPtr) == LE_OK);
+
+        for (i = 0; i < count; i++)
+        {
+            TestRecord_t testRecord;
+            MakeRecord(firstIndex + (i * step), &testRecord);
+            logStore_Append(&testRecord.record);
+
+            if ((flushCount != 0) && (((i + 1) % flushCount) == 0))
+            {
+                logStore_Flush();
+            }
+        }
+
+        logStore_Flush();
+        exit(EXIT_SUCCESS);
+    }
+
+    int status;
+    LE_ASSERT(waitpid(childPid, &status, 0) == childPid);
+    LE_ASSERT(WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the path of a test directory, creating the directory.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeDir
+(
+    const char* namePtr,
+    char* pathPtr,
+    size_t pathSize
+)
+{
+    LE_ASSERT(snprintf(pathPtr, pathSize, "%s/%s", TestDirPath, namePtr) < (int)pathSize);
+    LE_ASSERT(le_dir_Make(pathPtr, S_IRWXU) == LE_OK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the path of one of the log files in a directory.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetLogFilePath
+(
+    const char* dirPathPtr,
+    unsigned int index,         ///< [IN] 0 for the current file, 1 for the one before it, etc.
+    char* pathPtr               ///< [OUT] Buffer of LIMIT_MAX_PATH_BYTES bytes for the path.
+)
+{
+    LE_ASSERT(snprintf(pathPtr, LIMIT_MAX_PATH_BYTES, "%s/log.%u", dirPathPtr, index)
+              < LIMIT_MAX_PATH_BYTES);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a whole file into a buffer.
+ *
+ * @return Number of bytes read.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t ReadWholeFile
+(
+    const char* pathPtr,
+    uint8_t* buffPtr,
+    size_t buffSize
+)
+{
+    int fd = open(pathPtr, O_RDONLY);
+    LE_ASSERT(fd >= 0);
+
+    ssize_t len = read(fd, buffPtr, buffSize);
+    LE_ASSERT((len >= 0) && ((size_t)len < buffSize));
+
+    close(fd);
+
+    return len;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replaces a file's contents, or adds to them.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteWholeFile
+(
+    const char* pathPtr,
+    const void* dataPtr,
+    size_t len,
+    bool append                 ///< [IN] true to add to the file, false to replace its contents.
+)
+{
+    int fd = open(pathPtr, O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), S_IRUSR | S_IWUSR);
+    LE_ASSERT(fd >= 0);
+    LE_ASSERT(write(fd, dataPtr, len) == (ssize_t)len);
+    close(fd);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the size of a file.
+ *
+ * @return The size, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static off_t GetFileSize
+(
+    const char* pathPtr
+)
+{
+    struct stat st;
+    LE_ASSERT(stat(pathPtr, &st) == 0);
+
+    return st.st_size;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the blocks in a log file's contents.
+ *
+ * @return Number of good blocks found.  The offset following the last good block is stored after
+ *         the block offsets.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t FindBlocks
+(
+    const uint8_t* dataPtr,
+    size_t len,
+    size_t* offsetsPtr,         ///< [OUT] Offsets of the blocks.
+    size_t maxBlocks
+)
+{
+    size_t offset = sizeof(logStore_FileHeader_t);
+    size_t count = 0;
+
+    while ((count < maxBlocks) && (offset + sizeof(logStore_BlockHeader_t) <= len))
+    {
+        logStore_BlockHeader_t header;
+        memcpy(&header, dataPtr + offset, sizeof(header));
+
+        if (   (header.magic != LOG_STORE_BLOCK_MAGIC)
+            || (offset + sizeof(header) + header.compressedSize > len))
+        {
+            break;
+        }
+
+        offsetsPtr[count++] = offset;
+        offset += sizeof(header) + header.compressedSize;
+    }
+
+    offsetsPtr[count] = offset;
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the CRC-32 (IEEE 802.3) of some data, continuing from a previous CRC, the same way
+ * log storage does.
+ *
+ * @return The new CRC.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t Crc32
+(
+    uint32_t crc,
+    const void* dataPtr,
+    size_t len
+)
+{
+    const uint8_t* bytePtr = dataPtr;
+
+    crc = ~crc;
+    while (len-- > 0)
+    {
+        int bit;
+
+        crc ^= *bytePtr++;
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (0xEDB88320 ^ (crc >> 1)) : (crc >> 1);
+        }
+    }
+
+    return ~crc;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Recomputes a block's CRC, so that the block passes its checksum.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FixCrc
+(
+    uint8_t* blockPtr
+)
+{
+    logStore_BlockHeader_t header;
+    memcpy(&header, blockPtr, sizeof(header));
+
+    header.crc = 0;
+    uint32_t crc = Crc32(0, &header, sizeof(header));
+    header.crc = Crc32(crc, blockPtr + sizeof(header), header.compressedSize);
+
+    memcpy(blockPtr, &header, sizeof(header));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that messages are read back as they were written, in order, and that they're stored
+ * compressed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestRoundTrip
+(
+    const char* dirPathPtr
+)
+{
+    logStore_Filter_t filter = { .startTime = INT64_MIN,
+                                 .endTime = INT64_MAX,
+                                 .minLevel = LE_LOG_DEBUG };
+
+    LE_ASSERT(logStore_Read(dirPathPtr, &filter, CheckRecord, NULL) == LE_NOT_FOUND);
+
+    WriteRecords(dirPathPtr, 0, RECORD_COUNT, 1, 0);
+
+    LE_ASSERT(ReadRecords(dirPathPtr, &filter, RECORD_COUNT, 0, 0, NULL) == RECORD_COUNT);
+
+    size_t rawSize = 0;
+    off_t storedSize = 0;
+    char path[LIMIT_MAX_PATH_BYTES];
+    unsigned int i;
+
+    for (i = 0; i < RECORD_COUNT; i++)
+    {
+        rawSize += GetRecordSize(i);
+    }
+
+    for (i = 0; ; i++)
+    {
+        struct stat st;
+
+        GetLogFilePath(dirPathPtr, i, path);
+        if (stat(path, &st) != 0)
+        {
+            break;
+        }
+        storedSize += st.st_size;
+    }
+
+    printf("%zu bytes of messages stored in %lld bytes.\n", rawSize, (long long)storedSize);
+    LE_ASSERT(storedSize < (off_t)rawSize / 2);
+
+    // Messages that don't compress at all take up little more than they would uncompressed.
+    char randomDirPath[LIMIT_MAX_PATH_BYTES];
+    MakeDir("random", randomDirPath, sizeof(randomDirPath));
+
+    WriteRecords(randomDirPath, 3, RECORD_COUNT / 10, 10, 0);
+
+    rawSize = 0;
+    for (i = 3; i < RECORD_COUNT; i += 10)
+    {
+        rawSize += GetRecordSize(i);
+    }
+
+    GetLogFilePath(randomDirPath, 0, path);
+    storedSize = GetFileSize(path);
+    printf("%zu bytes of random messages stored in %lld bytes.\n", rawSize, (long long)storedSize);
+    LE_ASSERT(storedSize < (off_t)(rawSize + (rawSize / 50)));
+
+    printf("Round trip test passed.\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that reading selects messages by severity level, process name, component name and time.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestFilters
+(
+    const char* dirPathPtr          ///< [IN] Directory the round trip test wrote to.
+)
+{
+    static const logStore_Filter_t filters[] =
+    {
+        { INT64_MIN, INT64_MAX, LE_LOG_DEBUG, NULL, NULL },
+        { INT64_MIN, INT64_MAX, LE_LOG_INFO, NULL, NULL },
+        { INT64_MIN, INT64_MAX, LE_LOG_WARN, NULL, NULL },
+        { INT64_MIN, INT64_MAX, LE_LOG_ERR, NULL, NULL },
+        { INT64_MIN, INT64_MAX, LE_LOG_CRIT, NULL, NULL },
+        { INT64_MIN, INT64_MAX, LE_LOG_EMERG, NULL, NULL },
+        { INT64_MIN, INT64_MAX, LE_LOG_DEBUG, "proc1", NULL },
+        { INT64_MIN, INT64_MAX, LE_LOG_DEBUG, NULL, "comp0" },
+        { INT64_MIN, INT64_MAX, LE_LOG_WARN, "proc2", "comp1" },
+        { INT64_MIN, INT64_MAX, LE_LOG_DEBUG, "comp1", NULL },
+        { INT64_MIN, INT64_MAX, LE_LOG_DEBUG, "nosuch", NULL },
+        { BASE_TIME + 20, BASE_TIME + 30, LE_LOG_DEBUG, NULL, NULL },
+        { BASE_TIME + 50, BASE_TIME + 60, LE_LOG_ERR, "proc0", NULL },
+        { BASE_TIME + RECORD_COUNT, INT64_MAX, LE_LOG_DEBUG, NULL, NULL },
+    };
+    unsigned int i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(filters); i++)
+    {
+        unsigned int expectedCount = 0;
+        unsigned int expectedTraceCount = 0;
+        unsigned int traceCount;
+        unsigned int index;
+
+        for (index = 0; index < RECORD_COUNT; index++)
+        {
+            TestRecord_t testRecord;
+            MakeRecord(index, &testRecord);
+
+            if (IsSelected(&testRecord.record, &filters[i]))
+            {
+                expectedCount++;
+                if (testRecord.record.level == (le_log_Level_t)-1)
+                {
+                    expectedTraceCount++;
+                }
+            }
+        }
+
+        LE_ASSERT(ReadRecords(dirPathPtr, &filters[i], RECORD_COUNT, 0, 0, &traceCount)
+                  == expectedCount);
+        LE_ASSERT(traceCount == expectedTraceCount);
+    }
+
+    // Make sure the filters were worth testing.
+    LE_ASSERT(ReadRecords(dirPathPtr, &filters[0], RECORD_COUNT, 0, 0, NULL) == RECORD_COUNT);
+    LE_ASSERT(ReadRecords(dirPathPtr, &filters[1], RECORD_COUNT, 0, 0, NULL) < RECORD_COUNT);
+    LE_ASSERT(ReadRecords(dirPathPtr, &filters[5], RECORD_COUNT, 0, 0, NULL) > 0);
+    LE_ASSERT(ReadRecords(dirPathPtr, &filters[8], RECORD_COUNT, 0, 0, NULL) > 0);
+    LE_ASSERT(ReadRecords(dirPathPtr, &filters[9], RECORD_COUNT, 0, 0, NULL) == 0);
+
+    printf("Filter test passed.\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that a corrupted block is skipped, and the blocks around it are still read.  Blocks with
+ * their checksums fixed up get as far as being decompressed, so this also tests that damaged
+ * compressed data is rejected (or at least decompressed safely).
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestCorruptBlocks(void)
+{
+    static uint8_t original[4 * LOG_STORE_BLOCK_BYTES];
+    static uint8_t damaged[sizeof(original)];
+    char dirPath[LIMIT_MAX_PATH_BYTES];
+    char path[LIMIT_MAX_PATH_BYTES];
+    size_t offsets[8];
+    logStore_Filter_t filter = { .startTime = INT64_MIN,
+                                 .endTime = INT64_MAX,
+                                 .minLevel = LE_LOG_DEBUG };
+    unsigned int i;
+
+    MakeDir("corrupt", dirPath, sizeof(dirPath));
+    GetLogFilePath(dirPath, 0, path);
+
+    WriteRecords(dirPath, 0, 3 * BLOCK_RECORD_COUNT, 1, BLOCK_RECORD_COUNT);
+
+    // The second block holds the second BLOCK_RECORD_COUNT messages.  There may be more blocks
+    // after it, as a critical message ends its block early.
+    size_t len = ReadWholeFile(path, original, sizeof(original));
+    size_t blockCount = FindBlocks(original, len, offsets, NUM_ARRAY_MEMBERS(offsets) - 1);
+    LE_ASSERT(blockCount >= 3);
+    LE_ASSERT(offsets[blockCount] == len);
+
+    size_t blockOffset = offsets[1];
+    logStore_BlockHeader_t header;
+    memcpy(&header, original + blockOffset, sizeof(header));
+    size_t dataOffset = blockOffset + sizeof(header);
+
+    // Without its checksum fixed, the block is skipped without being decompressed.
+    memcpy(damaged, original, len);
+    damaged[dataOffset + (header.compressedSize / 2)] ^= 0x01;
+    WriteWholeFile(path, damaged, len, false);
+
+    LE_ASSERT(ReadRecords(dirPath, &filter, 3 * BLOCK_RECORD_COUNT,
+                          BLOCK_RECORD_COUNT, 2 * BLOCK_RECORD_COUNT, NULL)
+              == 2 * BLOCK_RECORD_COUNT);
+
+    // With its checksum fixed, the damaged data has to be decompressed.
+    for (i = 0; i < CORRUPT_COUNT; i++)
+    {
+        unsigned int seed = i;
+        int changes = 1 + (rand_r(&seed) % 4);
+
+        memcpy(damaged, original, len);
+
+        while (changes-- > 0)
+        {
+            damaged[dataOffset + (rand_r(&seed) % header.compressedSize)] ^=
+                1 + (rand_r(&seed) % 255);
+        }
+
+        // Sometimes claim the wrong uncompressed size too.
+        if ((i % 4) == 0)
+        {
+            logStore_BlockHeader_t badHeader = header;
+            badHeader.rawSize = rand_r(&seed) % (LOG_STORE_BLOCK_BYTES + 1);
+            memcpy(damaged + blockOffset, &badHeader, sizeof(badHeader));
+        }
+
+        FixCrc(damaged + blockOffset);
+        WriteWholeFile(path, damaged, len, false);
+
+        LE_ASSERT(ReadRecords(dirPath, &filter, 3 * BLOCK_RECORD_COUNT,
+                              BLOCK_RECORD_COUNT, 2 * BLOCK_RECORD_COUNT, NULL)
+                  == 2 * BLOCK_RECORD_COUNT);
+    }
+
+    // Compressed data cut short.
+    memcpy(damaged, original, len);
+    header.compressedSize /= 2;
+    memcpy(damaged + blockOffset, &header, sizeof(header));
+    FixCrc(damaged + blockOffset);
+    memmove(damaged + dataOffset + header.compressedSize, original + offsets[2], len - offsets[2]);
+    WriteWholeFile(path, damaged, len - header.compressedSize, false);
+
+    LE_ASSERT(ReadRecords(dirPath, &filter, 3 * BLOCK_RECORD_COUNT,
+                          BLOCK_RECORD_COUNT, 2 * BLOCK_RECORD_COUNT, NULL)
+              == 2 * BLOCK_RECORD_COUNT);
+
+    printf("Corrupt block test passed.\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that opening log storage cuts a damaged block off the end of the current log file, and
+ * that new blocks follow the good ones.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestDamagedTail(void)
+{
+    static uint8_t contents[4 * LOG_STORE_BLOCK_BYTES];
+    char dirPath[LIMIT_MAX_PATH_BYTES];
+    char path[LIMIT_MAX_PATH_BYTES];
+    size_t offsets[8];
+    logStore_Filter_t filter = { .startTime = INT64_MIN,
+                                 .endTime = INT64_MAX,
+                                 .minLevel = LE_LOG_DEBUG };
+    unsigned int endIndex = 0;
+    int damage;
+
+    MakeDir("tail", dirPath, sizeof(dirPath));
+    GetLogFilePath(dirPath, 0, path);
+
+    WriteRecords(dirPath, endIndex, BLOCK_RECORD_COUNT, 1, 0);
+    endIndex += BLOCK_RECORD_COUNT;
+
+    for (damage = 0; damage < 3; damage++)
+    {
+        size_t len = ReadWholeFile(path, contents, sizeof(contents));
+        size_t blockCount = FindBlocks(contents, len, offsets, NUM_ARRAY_MEMBERS(offsets) - 1);
+        LE_ASSERT(offsets[blockCount] == len);
+
+        size_t lastBlockOffset = offsets[blockCount - 1];
+        size_t lastBlockLen = len - lastBlockOffset;
+
+        switch (damage)
+        {
+            case 0:
+                // The last block written again, but cut short.
+                WriteWholeFile(path, contents + lastBlockOffset, lastBlockLen / 2, true);
+                break;
+
+            case 1:
+                // Only part of a block header.
+                WriteWholeFile(path, contents + lastBlockOffset, 10, true);
+                break;
+
+            default:
+            {
+                // A whole block, with a bad checksum.
+                uint8_t* blockPtr = contents + lastBlockOffset;
+                blockPtr[lastBlockLen - 1] ^= 0xFF;
+                WriteWholeFile(path, blockPtr, lastBlockLen, true);
+                break;
+            }
+        }
+        LE_ASSERT(GetFileSize(path) > (off_t)len);
+
+        // Just opening log storage cuts the damaged bytes off.
+        WriteRecords(dirPath, endIndex, 0, 1, 0);
+        LE_ASSERT(GetFileSize(path) == (off_t)len);
+
+        WriteRecords(dirPath, endIndex, BLOCK_RECORD_COUNT, 1, 0);
+        endIndex += BLOCK_RECORD_COUNT;
+
+        // The new blocks follow the old ones.
+        size_t newLen = ReadWholeFile(path, contents, sizeof(contents));
+        size_t newBlockCount = FindBlocks(contents,
+                                          newLen,
+                                          offsets,
+                                          NUM_ARRAY_MEMBERS(offsets) - 1);
+        LE_ASSERT(newBlockCount > blockCount);
+        LE_ASSERT(offsets[blockCount] == len);
+        LE_ASSERT(offsets[newBlockCount] == newLen);
+
+        LE_ASSERT(ReadRecords(dirPath, &filter, endIndex, 0, 0, NULL) == endIndex);
+    }
+
+    printf("Damaged tail test passed.\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+    printf("\n");
+    printf("*** Unit Test for persistent log storage. ***\n");
+
+    LE_ASSERT(mkdtemp(TestDirPath) != NULL);
+
+    char dirPath[LIMIT_MAX_PATH_BYTES];
+    MakeDir("roundTrip", dirPath, sizeof(dirPath));
+
+    TestRoundTrip(dirPath);
+    TestFilters(dirPath);
+    TestCorruptBlocks();
+    TestDamagedTail();
+
+    LE_ASSERT(le_dir_RemoveRecursive(TestDirPath) == LE_OK);
+
+    printf("*** Persistent log storage tests passed. ***\n");
+
+    return EXIT_SUCCESS;
+}
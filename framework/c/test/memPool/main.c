@@ -31,9 +31,18 @@ colourObj_t;
 #define FORCE_SIZE          3
 #define NUM_EXPAND_SUB_POOL 2
 #define NUM_ALLOC_SUPER_POOL    1
+#define CACHED_POOL_SIZE    16
+#define THREAD_CACHE_SIZE   4
+#define NUM_CACHE_THREADS   4
+#define NUM_CACHE_LOOPS     1000
+#define SLAB_POOL_SIZE      1000
+#define CACHE_LINE_SIZE     64
+#define TRIM_OBJ_SIZE       1000
+#define TRIM_NUM_OBJS       300
 
 static unsigned int NumRelease = 0;
 static unsigned int ReleaseId;
+static le_mem_PoolRef_t CachedPool;
 
 static void IdDestructor(void* objPtr)
 {
@@ -46,6 +55,23 @@ static void IdDestructor(void* objPtr)
 }
 
 
+static void* CachedPoolThreadMain(void* contextPtr)
+{
+    unsigned int i;
+
+    // Allocate and release over and over again, leaving some free blocks in this thread's cache
+    // when the thread dies.
+    for (i = 0; i < NUM_CACHE_LOOPS; i++)
+    {
+        idObj_t* objPtr = le_mem_ForceAlloc(CachedPool);
+        objPtr->id = i;
+        le_mem_Release(objPtr);
+    }
+
+    return NULL;
+}
+
+
 int main(int argc, char *argv[])
 {
     le_mem_PoolRef_t idPool, colourPool;
@@ -519,6 +545,232 @@ int main(int argc, char *argv[])
     printf("Successfully recreated sub-pool.\n");
 
 
+    //
+    // Allocate and release from a pool with a thread cache.
+    //
+    idObj_t* cachedPtr[CACHED_POOL_SIZE];
+    pthread_t cacheThreads[NUM_CACHE_THREADS];
+
+    CachedPool = le_mem_CreatePool("Cached Pool", sizeof(idObj_t));
+    le_mem_EnableThreadCache(CachedPool, THREAD_CACHE_SIZE);
+    le_mem_ExpandPool(CachedPool, CACHED_POOL_SIZE);
+
+    for (i = 0; i < CACHED_POOL_SIZE; i++)
+    {
+        cachedPtr[i] = le_mem_TryAlloc(CachedPool);
+
+        if (cachedPtr[i] == NULL)
+        {
+            printf("Error allocating from cached pool: %d", __LINE__);
+            return LE_FAULT;
+        }
+    }
+
+    le_mem_GetStats(CachedPool, &stats);
+    if ( (le_mem_TryAlloc(CachedPool) != NULL) || (stats.numFree != 0) ||
+         (stats.numBlocksInUse != CACHED_POOL_SIZE) )
+    {
+        printf("Error in cached pool: %d", __LINE__);
+        return LE_FAULT;
+    }
+
+    for (i = 0; i < CACHED_POOL_SIZE; i++)
+    {
+        le_mem_Release(cachedPtr[i]);
+    }
+
+    le_mem_GetStats(CachedPool, &stats);
+    if ( (stats.numFree != CACHED_POOL_SIZE) || (stats.numBlocksInUse != 0) )
+    {
+        printf("Error in cached pool: %d", __LINE__);
+        return LE_FAULT;
+    }
+
+    // Hammer the pool from several threads at once.
+    for (i = 0; i < NUM_CACHE_THREADS; i++)
+    {
+        LE_ASSERT(pthread_create(&cacheThreads[i], NULL, CachedPoolThreadMain, NULL) == 0);
+    }
+    for (i = 0; i < NUM_CACHE_THREADS; i++)
+    {
+        LE_ASSERT(pthread_join(cacheThreads[i], NULL) == 0);
+    }
+
+    le_mem_GetStats(CachedPool, &stats);
+    if ( (stats.numBlocksInUse != 0) ||
+         (stats.numAllocs != CACHED_POOL_SIZE + (NUM_CACHE_THREADS * NUM_CACHE_LOOPS)) ||
+         (stats.numFree != le_mem_GetObjectCount(CachedPool)) ||
+         (stats.maxNumBlocksUsed > le_mem_GetObjectCount(CachedPool)) )
+    {
+        printf("Error in cached pool: %d", __LINE__);
+        return LE_FAULT;
+    }
+
+    // The dead threads' caches must have been given back to the pool, so every block in the pool
+    // must be available to this thread.
+    size_t numCachedObjs = le_mem_GetObjectCount(CachedPool);
+    for (i = 0; i < numCachedObjs; i++)
+    {
+        if (le_mem_TryAlloc(CachedPool) == NULL)
+        {
+            printf("Error allocating from cached pool: %d", __LINE__);
+            return LE_FAULT;
+        }
+    }
+    printf("Thread cache works correctly.\n");
+
+
+    //
+    // Allocate and release from a cache aligned slab pool.
+    //
+    idObj_t* slabPtr[SLAB_POOL_SIZE];
+
+    le_mem_PoolRef_t slabPool = le_mem_CreateSlabPool("Slab Pool",
+                                                      sizeof(idObj_t),
+                                                      LE_MEM_SLAB_CACHE_ALIGNED);
+    le_mem_SetDestructor(slabPool, IdDestructor);
+    le_mem_ExpandPool(slabPool, SLAB_POOL_SIZE);
+
+    size_t numSlabObjs = le_mem_GetObjectCount(slabPool);
+    if ( (numSlabObjs < SLAB_POOL_SIZE) ||
+         ((le_mem_GetObjectFullSize(slabPool) % CACHE_LINE_SIZE) != 0) )
+    {
+        printf("Error in slab pool: %d", __LINE__);
+        return LE_FAULT;
+    }
+
+    for (i = 0; i < SLAB_POOL_SIZE; i++)
+    {
+        slabPtr[i] = le_mem_TryAlloc(slabPool);
+
+        if ( (slabPtr[i] == NULL) || (((uintptr_t)slabPtr[i] % CACHE_LINE_SIZE) != 0) )
+        {
+            printf("Error allocating from slab pool: %d", __LINE__);
+            return LE_FAULT;
+        }
+
+        slabPtr[i]->id = i;
+    }
+
+    // Objects must still find their way back to the right pool and destructor.
+    le_mem_AddRef(slabPtr[0]);
+    le_mem_Release(slabPtr[0]);
+
+    NumRelease = 0;
+    for (i = 0; i < SLAB_POOL_SIZE; i++)
+    {
+        le_mem_Release(slabPtr[i]);
+    }
+
+    le_mem_GetStats(slabPool, &stats);
+    if ( (NumRelease != SLAB_POOL_SIZE) || (stats.numBlocksInUse != 0) ||
+         (stats.numFree != numSlabObjs) || (stats.numAllocs != SLAB_POOL_SIZE) )
+    {
+        printf("Error in slab pool: %d", __LINE__);
+        return LE_FAULT;
+    }
+    printf("Slab pool works correctly.\n");
+
+
+    //
+    // Trim a slab pool after a burst of forced allocations.
+    //
+    le_mem_PoolRef_t trimPool = le_mem_CreateSlabPool("Trim Pool", TRIM_OBJ_SIZE, 0);
+    le_mem_ExpandPool(trimPool, 1);
+
+    size_t numTrimObjsPerSlab = le_mem_GetObjectCount(trimPool);
+    void* trimPtr[TRIM_NUM_OBJS];
+
+    for (i = 0; i < TRIM_NUM_OBJS; i++)
+    {
+        trimPtr[i] = le_mem_ForceAlloc(trimPool);
+    }
+
+    size_t numTrimObjs = le_mem_GetObjectCount(trimPool);
+
+    // Nothing can be trimmed while all the objects are in use.
+    if ( (numTrimObjs < TRIM_NUM_OBJS) || (le_mem_Trim(trimPool) != 0) )
+    {
+        printf("Error trimming slab pool: %d", __LINE__);
+        return LE_FAULT;
+    }
+
+    // Keep the last object, so its slab can't be trimmed.
+    for (i = 0; i < TRIM_NUM_OBJS - 1; i++)
+    {
+        le_mem_Release(trimPtr[i]);
+    }
+
+    size_t numTrimBytes = le_mem_Trim(trimPool);
+
+    le_mem_GetStats(trimPool, &stats);
+    if ( (numTrimBytes == 0) ||
+         (stats.numBytesReclaimed != numTrimBytes) ||
+         (le_mem_GetObjectCount(trimPool) != numTrimObjsPerSlab) ||
+         (stats.numFree != le_mem_GetObjectCount(trimPool) - 1) )
+    {
+        printf("Error trimming slab pool: %d", __LINE__);
+        return LE_FAULT;
+    }
+
+    // The pool must not be trimmed below the size it was expanded to with le_mem_ExpandPool().
+    le_mem_Release(trimPtr[TRIM_NUM_OBJS - 1]);
+
+    if ( (le_mem_Trim(trimPool) != 0) || (le_mem_GetObjectCount(trimPool) != numTrimObjsPerSlab) )
+    {
+        printf("Error trimming slab pool: %d", __LINE__);
+        return LE_FAULT;
+    }
+
+    // The remaining objects must still be usable.
+    for (i = 0; i < numTrimObjsPerSlab; i++)
+    {
+        trimPtr[i] = le_mem_AssertAlloc(trimPool);
+        memset(trimPtr[i], 0, TRIM_OBJ_SIZE);
+    }
+    for (i = 0; i < numTrimObjsPerSlab; i++)
+    {
+        le_mem_Release(trimPtr[i]);
+    }
+    printf("Slab pool trimming works correctly.\n");
+
+
+    //
+    // Variable-size pool.
+    //
+    le_mem_VarPoolRef_t varPool = le_mem_CreateVarPool("Var Pool", 100);
+
+    char* smallPtr = le_mem_VarAlloc(varPool, 1);
+    char* mediumPtr = le_mem_VarAlloc(varPool, 17);
+    char* largePtr = le_mem_VarAlloc(varPool, 100);
+    char* strPtr = le_mem_StrDup(varPool, "Hello");
+
+    memset(largePtr, 'x', 100);
+
+    if ( (strcmp(strPtr, "Hello") != 0) ||
+         (le_mem_GetObjectCount(le_mem_FindPool("Var Pool-16")) != 2) ||
+         (le_mem_GetObjectCount(le_mem_FindPool("Var Pool-32")) != 1) ||
+         (le_mem_GetObjectCount(le_mem_FindPool("Var Pool-64")) != 0) ||
+         (le_mem_GetObjectCount(le_mem_FindPool("Var Pool-100")) != 1) )
+    {
+        printf("Error in variable-size pool: %d", __LINE__);
+        return LE_FAULT;
+    }
+
+    le_mem_Release(smallPtr);
+    le_mem_Release(mediumPtr);
+    le_mem_Release(largePtr);
+    le_mem_Release(strPtr);
+
+    le_mem_GetStats(le_mem_FindPool("Var Pool-16"), &stats);
+    if ( (stats.numBlocksInUse != 0) || (stats.numFree != 2) || (stats.numAllocs != 2) )
+    {
+        printf("Error in variable-size pool: %d", __LINE__);
+        return LE_FAULT;
+    }
+    printf("Variable-size pool works correctly.\n");
+
+
     //
     // Search for pools by name.
     //
@@ -40,6 +40,11 @@ FuncImplTemplate = """
 
     {{func.resultStorage}}
 
+    $ if func.sideBufferIn or func.sideBufferOut
+    // Memfd for any large arrays
+    _SideBuf_t _sideBuf = _SIDE_BUF_INIT;
+
+    $ endif
     // Range check values, if appropriate
     $ for p in func.parmListIn
     $ if p.maxValue:
@@ -55,9 +60,18 @@ FuncImplTemplate = """
     _msgBufPtr = _msgPtr->buffer;
 
     // Pack the input parameters
+    $ if func.requestStruct
+    {{func.requestStruct}}* _requestPtr = ({{func.requestStruct}}*)_msgBufPtr;
+    _msgBufPtr += sizeof({{func.requestStruct}});
+    $ endif
     {{ func.parmListIn | printParmList("clientPack", sep="\n") | indent }}
 
+    $ if func.sideBufferIn
+    AttachSideBuf(_msgRef, &_sideBuf);
+
+    $ endif
     // Send a request to the server and get the response.
+    le_msg_SetPayloadLength(_msgRef, _msgBufPtr-(uint8_t*)_msgPtr);
     LE_DEBUG("Sending message to server and waiting for response : %ti bytes sent",
              _msgBufPtr-_msgPtr->buffer);
     _responseMsgRef = le_msg_RequestSyncResponse(_msgRef);
@@ -68,9 +82,13 @@ FuncImplTemplate = """
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
 
+    $ if func.responseStruct
+    {{func.responseStruct}}* _responsePtr = ({{func.responseStruct}}*)_msgBufPtr;
+
+    $ endif
     {% if func.type -%}
     // Unpack the result first
-    _msgBufPtr = UnpackData( _msgBufPtr, &_result, sizeof(_result) );
+    {{func.resultUnpack}}
 
     $ if func.isAddHandler:
     // Put the handler reference result into the client data object, and
@@ -85,6 +103,10 @@ FuncImplTemplate = """
     // Unpack any "out" parameters
     {{ func.parmListOut | printParmList("clientUnpack", sep="\n") | indent }}
 
+    $ if func.sideBufferOut
+    ReleaseSideBuf(&_sideBuf);
+
+    $ endif
     // Release the message object, now that all results/output has been copied.
     le_msg_ReleaseMsg(_responseMsgRef);
 
@@ -97,6 +119,9 @@ FuncImplTemplate = """
 
 
 def WriteFuncCode(func, template):
+    if func.fixedLayout:
+        print >>ClientFileText, codeGenCommon.GetFixedLayoutStr(func)
+
     funcStr = common.FormatCode(template,
                                 func=func,
                                 prototype=codeGenCommon.GetFuncPrototypeStr(func))
@@ -618,6 +643,8 @@ def WriteClientFile(headerFiles, pf, ph, genericFunctions):
 
     print >>ClientFileText, '\n' + '\n'.join('#include "%s"'%h for h in headerFiles) + '\n'
     print >>ClientFileText, codeGenCommon.DefaultPackerUnpacker
+    if codeTypes.LargeArrayThreshold:
+        print >>ClientFileText, codeGenCommon.LargeArrayPackerUnpacker
     print >>ClientFileText, common.FormatCode(ClientGenericCode)
 
     # Note that this does not need to be an ordered dictionary, unlike genericFunctions
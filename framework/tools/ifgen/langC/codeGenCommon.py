@@ -121,6 +121,307 @@ __attribute__((unused)) static void* UnpackString(void* msgBufPtr, char* dataStr
 """
 
 
+
+LargeArrayPackerUnpacker = """
+//--------------------------------------------------------------------------------------------------
+// Large Array Pack/Unpack Functions
+//
+// Array parameters bigger than _LARGE_ARRAY_THRESHOLD bytes are not copied into the message
+// buffer.  They are put in a memfd (the "side buffer"), each at a page-aligned offset, and only
+// the offset goes in the message buffer.  The memfd is sealed against any further changes and
+// sent with the message.  The receiver maps it read-only and uses the arrays in place.
+//--------------------------------------------------------------------------------------------------
+
+#include <sys/mman.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_GET_SEALS (1024 + 10)
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#define F_SEAL_WRITE 0x0008
+#endif
+
+// Seals that the receiver insists on, so the sender can't change the arrays under its feet.
+#define _SIDE_BUF_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)
+
+// Maximum number of arrays that can be mapped for writing at once.
+#define _SIDE_BUF_MAX_MAPS 4
+
+// Side buffer for the large arrays of one message.
+typedef struct
+{
+    int fd;             ///< The memfd, or -1 if there isn't one (yet).
+    size_t size;        ///< Size of the memfd contents, in bytes.
+    size_t mapCount;    ///< Number of entries in maps[].
+    struct
+    {
+        uint8_t* ptr;
+        size_t size;
+        size_t offset;  ///< Offset in the memfd.
+    }
+    maps[_SIDE_BUF_MAX_MAPS];
+}
+_SideBuf_t;
+
+#define _SIDE_BUF_INIT { .fd = -1, .size = 0, .mapCount = 0 }
+
+// Rounds the side buffer size up to the next page boundary, and returns it.
+__attribute__((unused)) static size_t NextSideArrayOffset(_SideBuf_t* sideBufPtr)
+{
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+
+    sideBufPtr->size = (sideBufPtr->size + pageSize - 1) & ~(pageSize - 1);
+    return sideBufPtr->size;
+}
+
+// Creates the memfd for a side buffer, if it doesn't have one yet.
+__attribute__((unused)) static void CreateSideBuf(_SideBuf_t* sideBufPtr)
+{
+    if (sideBufPtr->fd < 0)
+    {
+        sideBufPtr->fd = syscall(SYS_memfd_create, "le_ipc_array", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        LE_FATAL_IF(sideBufPtr->fd < 0, "Failed to create memfd (%m)");
+    }
+}
+
+// Packs an array, writing it to the side buffer if it is large.
+__attribute__((unused)) static void* PackArray(void* msgBufPtr,
+                                               _SideBuf_t* sideBufPtr,
+                                               const void* dataPtr,
+                                               size_t dataSize)
+{
+    if (dataSize <= _LARGE_ARRAY_THRESHOLD)
+    {
+        return PackData( msgBufPtr, dataPtr, dataSize );
+    }
+
+    CreateSideBuf(sideBufPtr);
+    size_t offset = NextSideArrayOffset(sideBufPtr);
+
+    size_t count = 0;
+    while (count < dataSize)
+    {
+        ssize_t result = pwrite(sideBufPtr->fd,
+                                (const uint8_t*)dataPtr + count,
+                                dataSize - count,
+                                offset + count);
+        if (result < 0)
+        {
+            LE_FATAL_IF(errno != EINTR, "Failed to write memfd (%m)");
+        }
+        else
+        {
+            count += result;
+        }
+    }
+
+    sideBufPtr->size = offset + dataSize;
+
+    return PackData( msgBufPtr, &offset, sizeof(offset) );
+}
+
+// Gets storage for an array that is to be filled in and then packed using PackAllocatedArray().
+// Large arrays are allocated in the side buffer; others use the buffer provided.
+__attribute__((unused)) static void* AllocArray(_SideBuf_t* sideBufPtr,
+                                                void* buffPtr,
+                                                size_t dataSize)
+{
+    if (dataSize <= _LARGE_ARRAY_THRESHOLD)
+    {
+        return buffPtr;
+    }
+
+    LE_FATAL_IF(sideBufPtr->mapCount >= _SIDE_BUF_MAX_MAPS, "Too many large arrays");
+
+    CreateSideBuf(sideBufPtr);
+    size_t offset = NextSideArrayOffset(sideBufPtr);
+
+    LE_FATAL_IF(ftruncate(sideBufPtr->fd, offset + dataSize) != 0,
+                "Failed to size memfd (%m)");
+
+    void* ptr = mmap(NULL, dataSize, PROT_READ | PROT_WRITE, MAP_SHARED, sideBufPtr->fd, offset);
+    LE_FATAL_IF(ptr == MAP_FAILED, "Failed to map memfd (%m)");
+
+    sideBufPtr->maps[sideBufPtr->mapCount].ptr = ptr;
+    sideBufPtr->maps[sideBufPtr->mapCount].size = dataSize;
+    sideBufPtr->maps[sideBufPtr->mapCount].offset = offset;
+    sideBufPtr->mapCount++;
+
+    sideBufPtr->size = offset + dataSize;
+
+    return ptr;
+}
+
+// Packs an array that was allocated using AllocArray().  The size may have shrunk since.
+__attribute__((unused)) static void* PackAllocatedArray(void* msgBufPtr,
+                                                        _SideBuf_t* sideBufPtr,
+                                                        const void* dataPtr,
+                                                        size_t dataSize)
+{
+    if (dataSize <= _LARGE_ARRAY_THRESHOLD)
+    {
+        return PackData( msgBufPtr, dataPtr, dataSize );
+    }
+
+    size_t i;
+    for (i = 0; i < sideBufPtr->mapCount; i++)
+    {
+        if ((dataPtr == sideBufPtr->maps[i].ptr) && (dataSize <= sideBufPtr->maps[i].size))
+        {
+            return PackData( msgBufPtr, &sideBufPtr->maps[i].offset, sizeof(size_t) );
+        }
+    }
+
+    LE_FATAL("Array size grew from allocated size to %zu bytes", dataSize);
+}
+
+// Unmaps everything and closes the memfd, if there is one.
+__attribute__((unused)) static void ReleaseSideBuf(_SideBuf_t* sideBufPtr)
+{
+    size_t i;
+    for (i = 0; i < sideBufPtr->mapCount; i++)
+    {
+        munmap(sideBufPtr->maps[i].ptr, sideBufPtr->maps[i].size);
+    }
+    sideBufPtr->mapCount = 0;
+
+    if (sideBufPtr->fd >= 0)
+    {
+        close(sideBufPtr->fd);
+        sideBufPtr->fd = -1;
+    }
+
+    sideBufPtr->size = 0;
+}
+
+// Seals the side buffer and attaches it to a message, if anything was put in it.  The side buffer
+// is then empty and can be re-used.
+__attribute__((unused)) static void AttachSideBuf(le_msg_MessageRef_t msgRef, _SideBuf_t* sideBufPtr)
+{
+    if (sideBufPtr->fd < 0)
+    {
+        return;
+    }
+
+    // The memfd can't be sealed against writing while it is mapped for writing.
+    int fd = sideBufPtr->fd;
+    sideBufPtr->fd = -1;
+    ReleaseSideBuf(sideBufPtr);
+
+    LE_FATAL_IF(fcntl(fd, F_ADD_SEALS, _SIDE_BUF_SEALS) != 0, "Failed to seal memfd (%m)");
+
+    le_msg_SetFd(msgRef, fd);
+}
+
+// Gets a pointer to a large array in the side buffer that came with a message, mapping the side
+// buffer if this is the first one.  Returns NULL if the side buffer is missing or not valid.
+__attribute__((unused)) static const void* MapSideArray(le_msg_MessageRef_t msgRef,
+                                                        _SideBuf_t* sideBufPtr,
+                                                        size_t offset,
+                                                        size_t dataSize)
+{
+    if (sideBufPtr->mapCount == 0)
+    {
+        struct stat st;
+        int fd = le_msg_GetFd(msgRef);
+
+        if (fd < 0)
+        {
+            LE_ERROR("Large array sent without memfd");
+            return NULL;
+        }
+
+        int seals = fcntl(fd, F_GET_SEALS);
+
+        if (   (seals < 0)
+            || ((seals & _SIDE_BUF_SEALS) != _SIDE_BUF_SEALS)
+            || (fstat(fd, &st) != 0)
+            || (st.st_size <= 0) )
+        {
+            LE_ERROR("Large array sent in unsealed or empty file");
+            close(fd);
+            return NULL;
+        }
+
+        void* ptr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (ptr == MAP_FAILED)
+        {
+            LE_ERROR("Failed to map memfd (%m)");
+            return NULL;
+        }
+
+        sideBufPtr->maps[0].ptr = ptr;
+        sideBufPtr->maps[0].size = st.st_size;
+        sideBufPtr->maps[0].offset = 0;
+        sideBufPtr->mapCount = 1;
+    }
+
+    if (   (offset > sideBufPtr->maps[0].size)
+        || (dataSize > sideBufPtr->maps[0].size - offset) )
+    {
+        LE_ERROR("Large array is outside memfd");
+        return NULL;
+    }
+
+    return sideBufPtr->maps[0].ptr + offset;
+}
+
+// Unpacks an array for use in place.  A small array is copied into the buffer provided; a large
+// one is left in the side buffer.  Returns NULL if the array couldn't be unpacked.
+__attribute__((unused)) static void* UnpackArrayRef(void* msgBufPtr,
+                                                    le_msg_MessageRef_t msgRef,
+                                                    _SideBuf_t* sideBufPtr,
+                                                    void* buffPtr,
+                                                    const void** dataPtrPtr,
+                                                    size_t dataSize)
+{
+    if (dataSize <= _LARGE_ARRAY_THRESHOLD)
+    {
+        *dataPtrPtr = buffPtr;
+        return UnpackData( msgBufPtr, buffPtr, dataSize );
+    }
+
+    size_t offset;
+    msgBufPtr = UnpackData( msgBufPtr, &offset, sizeof(offset) );
+
+    *dataPtrPtr = MapSideArray(msgRef, sideBufPtr, offset, dataSize);
+
+    return (*dataPtrPtr != NULL) ? msgBufPtr : NULL;
+}
+
+// Unpacks an array into the buffer provided.  Returns NULL if the array couldn't be unpacked.
+__attribute__((unused)) static void* UnpackArray(void* msgBufPtr,
+                                                 le_msg_MessageRef_t msgRef,
+                                                 _SideBuf_t* sideBufPtr,
+                                                 void* dataPtr,
+                                                 size_t dataSize)
+{
+    const void* srcPtr;
+
+    msgBufPtr = UnpackArrayRef(msgBufPtr, msgRef, sideBufPtr, dataPtr, &srcPtr, dataSize);
+
+    if ((msgBufPtr != NULL) && (srcPtr != dataPtr))
+    {
+        memcpy(dataPtr, srcPtr, dataSize);
+    }
+
+    return msgBufPtr;
+}
+"""
+
+
 #---------------------------------------------------------------------------------------------------
 
 
@@ -290,6 +591,51 @@ def GetServerAsyncFuncPrototypeStr(func):
     return funcStr.strip()
 
 
+#---------------------------------------------------------------------------------------------------
+
+
+# The fields are in the same order as they would be packed by PackData(), and the structures are
+# packed, so the message contents are the same either way.
+FixedLayoutTemplate = """
+$ if func.requestStruct
+// Layout of the message buffer for {{func.name}} requests
+typedef struct __attribute__((packed))
+{
+    {{ func.requestFields | printParmList("fieldDecl", sep="\n") | indent }}
+}
+{{func.requestStruct}};
+$ endif
+$ if func.requestStruct and func.responseStruct
+{{""}}
+$ endif
+$ if func.responseStruct
+// Layout of the message buffer for {{func.name}} responses
+typedef struct __attribute__((packed))
+{
+    $ if func.type
+    {{func.type}} _result;
+    $ endif
+    $ if func.responseFields
+    {{ func.responseFields | printParmList("fieldDecl", sep="\n") | indent }}
+    $ endif
+}
+{{func.responseStruct}};
+$ endif
+"""
+
+
+#
+# Create a string with the definitions of the fixed-layout message structures used by a function,
+# if it has any.  These are needed in both the client and the server file.
+#
+def GetFixedLayoutStr(func):
+    layoutStr = common.FormatCode(FixedLayoutTemplate, func=func)
+
+    # Remove any leading or trailing whitespace on the return string, such as newlines, so that
+    # it doesn't add extra, unintended, spaces in the generated code output.
+    return layoutStr.strip()
+
+
 
 #---------------------------------------------------------------------------------------------------
 # Output file templates/code
@@ -285,6 +285,12 @@ LocalHeaderStartTemplate = """
 //       type support has been added, this will be replaced by a more appropriate size.
 #define _MAX_MSG_SIZE {{maxMsgSize}}
 
+$ if largeArrayThreshold
+// Array parameters bigger than this many bytes are sent through a memfd, instead of being copied
+// into the message buffer.
+#define _LARGE_ARRAY_THRESHOLD {{largeArrayThreshold}}
+$ endif
+
 // Define the message type for communicating between client and server
 typedef struct
 {
@@ -316,7 +322,8 @@ def WriteLocalHeaderFile(pf, ph, hashValue, fileName, serviceName):
     print >>LocalHeaderFileText, common.FormatCode(LocalHeaderStartTemplate,
                                                    idString=hashValue,
                                                    serviceName=serviceName,
-                                                   maxMsgSize=maxMsgSize)
+                                                   maxMsgSize=maxMsgSize,
+                                                   largeArrayThreshold=codeTypes.LargeArrayThreshold)
 
     # Write out the message IDs for the functions
     for i, name in enumerate(pf):
@@ -70,6 +70,7 @@ static void AsyncResponse_{{func.name}}
     {{ handler.transferParams | printParmList("clientPack", sep="\n") | indent }}
 
     // Send the async response to the client
+    le_msg_SetPayloadLength(_msgRef, _msgBufPtr-(uint8_t*)_msgPtr);
     LE_DEBUG("Sending message to client session %p : %ti bytes sent",
              serverDataPtr->clientSessionRef,
              _msgBufPtr-_msgPtr->buffer);
@@ -111,7 +112,21 @@ static void Handle_{{func.name}}
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
 
+    $ if func.sideBufferIn
+    // Memfd for any large input arrays
+    _SideBuf_t _sideBuf = _SIDE_BUF_INIT;
+
+    $ endif
+    $ if func.sideBufferOut
+    // Memfd for any large output arrays
+    _SideBuf_t _outSideBuf = _SIDE_BUF_INIT;
+
+    $ endif
     // Unpack the input parameters from the message
+    $ if func.requestStruct
+    {{func.requestStruct}}* _requestPtr = ({{func.requestStruct}}*)_msgBufPtr;
+
+    $ endif
     {{ func.parmListIn | printParmList("serverUnpack", sep="\n\n") | indent }}
 
     {% if func.handlerName -%}
@@ -152,18 +167,33 @@ static void Handle_{{func.name}}
 
     {% endif %}
 
+    $ if func.sideBufferIn
+    // Large input arrays aren't needed anymore
+    ReleaseSideBuf(&_sideBuf);
+
+    $ endif
     // Re-use the message buffer for the response
     _msgBufPtr = _msgBufStartPtr;
 
+    $ if func.responseStruct
+    {{func.responseStruct}}* _responsePtr = ({{func.responseStruct}}*)_msgBufPtr;
+    _msgBufPtr += sizeof({{func.responseStruct}});
+
+    $ endif
     {% if func.type -%}
     // Pack the result first
-    _msgBufPtr = PackData( _msgBufPtr, &_result, sizeof(_result) );
+    {{func.resultPack}}
     {% endif %}
 
     // Pack any "out" parameters
     {{ func.parmListOut | printParmList("serverPack", sep="\n") | indent }}
 
+    $ if func.sideBufferOut
+    AttachSideBuf(_msgRef, &_outSideBuf);
+
+    $ endif
     // Return the response
+    le_msg_SetPayloadLength(_msgRef, _msgBufPtr-(uint8_t*)le_msg_GetPayloadPtr(_msgRef));
     LE_DEBUG("Sending response to client session %p : %ti bytes sent",
              le_msg_GetSession(_msgRef),
              _msgBufPtr-_msgBufStartPtr);
@@ -188,15 +218,30 @@ AsyncFuncHandlerTemplate = """
     // Ensure that this Respond function has not already been called
     LE_FATAL_IF( !le_msg_NeedsResponse(_msgRef), "Response has already been sent");
 
+    $ if func.sideBufferOut
+    // Memfd for any large output arrays
+    _SideBuf_t _outSideBuf = _SIDE_BUF_INIT;
+
+    $ endif
+    $ if func.responseStruct
+    {{func.responseStruct}}* _responsePtr = ({{func.responseStruct}}*)_msgBufPtr;
+    _msgBufPtr += sizeof({{func.responseStruct}});
+
+    $ endif
     {% if func.type -%}
     // Pack the result first
-    _msgBufPtr = PackData( _msgBufPtr, &_result, sizeof(_result) );
+    {{func.resultPack}}
     {% endif %}
 
     // Pack any "out" parameters
     {{ func.parmListOut | printParmList("asyncServerPack", sep="\n") | indent }}
 
+    $ if func.sideBufferOut
+    AttachSideBuf(_msgRef, &_outSideBuf);
+
+    $ endif
     // Return the response
+    le_msg_SetPayloadLength(_msgRef, _msgBufPtr-(uint8_t*)_msgPtr);
     LE_DEBUG("Sending response to client session %p", le_msg_GetSession(_msgRef));
     le_msg_Respond(_msgRef);
 }
@@ -209,17 +254,34 @@ static void Handle_{{func.name}}
     // Get the message buffer pointer
     __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
 
+    $ if func.sideBufferIn
+    // Memfd for any large input arrays
+    _SideBuf_t _sideBuf = _SIDE_BUF_INIT;
+
+    $ endif
     // Unpack the input parameters from the message
+    $ if func.requestStruct
+    {{func.requestStruct}}* _requestPtr = ({{func.requestStruct}}*)_msgBufPtr;
+
+    $ endif
     {{ func.parmListIn | printParmList("serverUnpack", sep="\n\n") | indent }}
 
     // Call the function
     {{func.name}} ( ({{ "ServerCmdRef_t" | addNamePrefix }})_msgRef
                     {{- func.parmListInCall | printParmList("asyncServerCallName", sep=", ", leadSep=True) }} );
+    $ if func.sideBufferIn
+
+    // Large input arrays are only valid until the function returns
+    ReleaseSideBuf(&_sideBuf);
+    $ endif
 }
 """
 
 
 def WriteHandlerCode(func, template):
+    if func.fixedLayout:
+        print >>ServerFileText, codeGenCommon.GetFixedLayoutStr(func)
+
     # The prototype parameter is only needed for the AsyncFuncHandlerTemplate, but it does no
     # harm to always include it.  It will be ignored for the other template(s).
     funcStr = common.FormatCode(template,
@@ -373,9 +435,12 @@ static le_thread_Ref_t _ServerThreadRef;
 //--------------------------------------------------------------------------------------------------
 /**
  * Client Session Reference for the current message received from a client
+ *
+ * This is thread-local, because messages may be handled by the service's worker threads
+ * (see le_msg_SetServiceWorkerPool()).
  */
 //--------------------------------------------------------------------------------------------------
-static le_msg_SessionRef_t _ClientSessionRef;
+static __thread le_msg_SessionRef_t _ClientSessionRef;
 
 
 //--------------------------------------------------------------------------------------------------
@@ -549,6 +614,8 @@ def WriteServerFile(headerFiles, pf, ph, genericFunctions, genAsync):
 
     print >>ServerFileText, '\n' + '\n'.join('#include "%s"'%h for h in headerFiles) + '\n'
     print >>ServerFileText, codeGenCommon.DefaultPackerUnpacker
+    if codeTypes.LargeArrayThreshold:
+        print >>ServerFileText, codeGenCommon.LargeArrayPackerUnpacker
     print >>ServerFileText, ServerGenericCode
 
     # Note that this does not need to be an ordered dictionary, unlike genericFunctions
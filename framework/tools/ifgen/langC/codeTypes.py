@@ -31,6 +31,20 @@ def AddNamePrefix(name):
         return name
 
 
+# Global for storing the size, in bytes, above which array parameters are sent through a memfd
+# rather than copied into the message buffer.  Zero means arrays are always copied.
+LargeArrayThreshold = 0
+
+# Maximum number of large OUT arrays that a server-side function can fill in place.  This must
+# match _SIDE_BUF_MAX_MAPS in codeGenCommon.LargeArrayPackerUnpacker.
+MaxLargeOutArrays = 4
+
+# Set the large array threshold.  This must be done before the interface is parsed.
+def SetLargeArrayThreshold(threshold):
+    global LargeArrayThreshold
+    LargeArrayThreshold = threshold
+
+
 
 #
 # Using commonTypes  ...
@@ -181,6 +195,32 @@ _msgBufPtr = PackData( _msgBufPtr, {parm.serverAddr}, {parm.numBytes} );\
 if ( {parm.value} > {parm.maxValue} ) LE_FATAL("{parm.value} > {parm.maxValue}");\
 """
 
+    # Templates for functions that use a fixed-layout message structure (see useFixedLayout()).
+    # The parameter is then a field of the request or response structure, rather than being
+    # packed after the previous parameter.
+    fieldDecl = """\
+{parm.type} {parm.name};\
+"""
+
+    fieldClientPack = """\
+_requestPtr->{parm.name} = {parm.value};\
+"""
+
+    fieldServerUnpack = """\
+{parm.serverType} {parm.serverName} = _requestPtr->{parm.name};\
+"""
+
+    fieldClientUnpack = """\
+{parm.value} = _responsePtr->{parm.name};\
+"""
+
+    fieldServerPack = """\
+_responsePtr->{parm.name} = {parm.serverName};\
+"""
+
+    # Set by useFixedLayout(), if the parameter is a field of a fixed-layout message structure.
+    isField = False
+
 
     def __init__(self, pName, pType):
 
@@ -279,6 +319,30 @@ if ( {parm.value} > {parm.maxValue} ) LE_FATAL("{parm.value} > {parm.maxValue}")
         return self.name
 
 
+    # Make this parameter a field of its function's fixed-layout message structure.  Only the
+    # PackData()/UnpackData() call in each template is replaced, since some parameters add code
+    # around it (e.g. the RemoveHandler parameter).
+    def useFixedLayout(self):
+        # The same parameter may be passed to more than one FunctionData (see codeGen.py).
+        if self.isField:
+            return
+
+        self.isField = True
+
+        if self.direction == common.DIR_IN:
+            swapList = [ ("clientPack", BaseParmData.clientPack, self.fieldClientPack),
+                         ("serverUnpack", BaseParmData.serverUnpack, self.fieldServerUnpack) ]
+        else:
+            swapList = [ ("clientUnpack", BaseParmData.clientUnpack, self.fieldClientUnpack),
+                         ("serverPack", BaseParmData.serverPack, self.fieldServerPack),
+                         ("asyncServerPack", BaseParmData.asyncServerPack, self.fieldServerPack) ]
+
+        for templateName, oldCode, newCode in swapList:
+            template = getattr(self, templateName)
+            assert oldCode in template, "%s has no default %s" % (self.name, templateName)
+            setattr(self, templateName, template.replace(oldCode, newCode))
+
+
     def __str__(self):
         return "%s %s" % (self.type, self.name)
 
@@ -323,6 +387,10 @@ le_msg_SetFd(_msgRef, {parm.parmName});\
 {parm.serverName} = le_msg_GetFd(_msgRef);\
 """
 
+    # The file descriptor is sent with the message, rather than in the message buffer.
+    def useFixedLayout(self):
+        pass
+
 
 class FileOutParmData(PointerParmData):
 
@@ -341,6 +409,10 @@ le_msg_SetFd(_msgRef, {parm.serverName});\
 le_msg_SetFd(_msgRef, {parm.serverName});
 """
 
+    # The file descriptor is sent with the message, rather than in the message buffer.
+    def useFixedLayout(self):
+        pass
+
 
 
 class ArrayParmData(BaseParmData):
@@ -397,6 +469,59 @@ _msgBufPtr = PackData( _msgBufPtr, {parm.serverAddr}Ptr, {parm.numBytes} );\
 """.format(parm=self)
 
 
+    # Send this array through the function's memfd side buffer whenever it is bigger than the
+    # large array threshold (see LargeArrayPackerUnpacker).  Only used for function parameters;
+    # handler parameters are always copied into the message buffer.
+    def useSideBuffer(self):
+        self.usesSideBuffer = True
+
+        if self.direction == common.DIR_IN:
+            self.clientPack = """\
+_msgBufPtr = PackArray( _msgBufPtr, &_sideBuf, {parm.address}, {parm.numBytes} );\
+"""
+
+            # Small arrays are copied into a stack buffer; large ones are used in place.
+            self.serverUnpack = """\
+{parm.type} {parm.name}Buff[({parm.numBytes} > _LARGE_ARRAY_THRESHOLD) ? 1 : {parm.sizeVar}];
+const {parm.type}* {parm.name};
+_msgBufPtr = UnpackArrayRef( _msgBufPtr, _msgRef, &_sideBuf,
+                             {parm.name}Buff, (const void**)&{parm.name}, {parm.numBytes} );
+if ( _msgBufPtr == NULL )
+{{
+    LE_KILL_CLIENT("Invalid array parameter '{parm.name}'");
+    ReleaseSideBuf(&_sideBuf);
+    le_msg_Respond(_msgRef);
+    return;
+}}\
+"""
+
+        else:
+            # As in __init__(), the client side and the server side use different expressions
+            # for numBytes, so pre-evaluate the templates.
+            self.numBytes = "%s*sizeof(%s)" % ('*%sPtr'%self.sizeVar, self.type)
+            self.clientUnpack = """\
+_msgBufPtr = UnpackArray( _msgBufPtr, _responseMsgRef, &_sideBuf, {parm.address}, {parm.numBytes} );
+LE_FATAL_IF(_msgBufPtr == NULL, "Invalid array parameter '{parm.name}'");\
+""".format(parm=self)
+
+            self.numBytes = "%s*sizeof(%s)" % (self.sizeVar, self.type)
+
+            # Large arrays are allocated in the side buffer, so the server-side function fills
+            # them in place.
+            self.serverParmList = """\
+{parm.type} {parm.name}Buff[({parm.numBytes} > _LARGE_ARRAY_THRESHOLD) ? 1 : {parm.sizeVar}];
+{parm.type}* {parm.name} = AllocArray( &_outSideBuf, {parm.name}Buff, {parm.numBytes} );\
+""".format(parm=self)
+
+            self.serverPack = """\
+_msgBufPtr = PackAllocatedArray( _msgBufPtr, &_outSideBuf, {parm.serverAddr}, {parm.numBytes} );\
+""".format(parm=self)
+
+            self.asyncServerPack = """\
+_msgBufPtr = PackArray( _msgBufPtr, &_outSideBuf, {parm.serverAddr}Ptr, {parm.numBytes} );\
+""".format(parm=self)
+
+
 class StringParmData(BaseParmData):
 
     def __init__(self, name, direction, maxSize=None, minSize=None):
@@ -520,6 +645,11 @@ _UNLOCK\
         self.serverUnpack = ""
 
 
+    # The handler itself is not passed down; only the contextPtr parameter is.
+    def useFixedLayout(self):
+        pass
+
+
     def setFuncName(self, funcName, funcType):
         self.funcName = funcName
         self.funcType = funcType
@@ -591,6 +721,11 @@ class BaseFunctionData(object):
 
 class FunctionData(BaseFunctionData):
 
+    # Templates for packing and unpacking the result.  These are replaced in __init__() if the
+    # function uses a fixed-layout response structure.
+    resultPack = "_msgBufPtr = PackData( _msgBufPtr, &_result, sizeof(_result) );"
+    resultUnpack = "_msgBufPtr = UnpackData( _msgBufPtr, &_result, sizeof(_result) );"
+
     def __init__(self, funcName, funcType, parmList, comment=""):
 
         # Process the parameter list before using it to init the instance.
@@ -604,6 +739,15 @@ class FunctionData(BaseFunctionData):
         self.parmListInCall = inCallList
         self.parmListOut = outList
 
+        # Decide which arrays go through the memfd side buffer, if enabled.  A message can only
+        # carry one file descriptor, so this isn't possible in a direction that already sends a
+        # file.
+        self.sideBufferIn, self.sideBufferOut = self.processLargeArrays()
+
+        # If none of the parameters have a variable size, pack them into fixed-layout request and
+        # response structures, so that each one is a single store at a known offset.
+        self.fixedLayout = self.processFixedLayout()
+
         # Extra info is needed if this function is an Add or Remove handler function, or if it
         # has a handler as a parameter (which includes Add handler functions).  If the function
         # has a handler parameter, also need to know the handler name.  If the name is None, then
@@ -619,6 +763,22 @@ class FunctionData(BaseFunctionData):
         else:
             self.resultStorage = ""
 
+        # Names of the fixed-layout structures, if they are used.  The result is always the
+        # first field of the response.
+        self.requestFields = [ p for p in self.parmListIn if p.isField ]
+        self.responseFields = [ p for p in self.parmListOut if p.isField ]
+
+        self.requestStruct = None
+        self.responseStruct = None
+
+        if self.fixedLayout:
+            if self.requestFields:
+                self.requestStruct = "_%s_Request_t" % self.name
+            if self.type or self.responseFields:
+                self.responseStruct = "_%s_Response_t" % self.name
+                self.resultPack = "_responsePtr->_result = _result;"
+                self.resultUnpack = "_result = _responsePtr->_result;"
+
 
     def processParmList(self, parmList):
         #
@@ -761,6 +921,42 @@ if ( {parm.serverName} > {parm.minValue} )
         return newParmList, inList, inCallList, outList
 
 
+    def processFixedLayout(self):
+        # Strings and arrays have to be packed one after the other, so only use a fixed layout
+        # if there are none in either direction.
+        parmList = self.parmListIn + self.parmListOut
+
+        if any( isinstance(p, (ArrayParmData, StringParmData)) for p in parmList ):
+            return False
+
+        for p in parmList:
+            p.useFixedLayout()
+
+        return True
+
+
+    def processLargeArrays(self):
+        if not LargeArrayThreshold:
+            return False, False
+
+        sideBufferIn = False
+        sideBufferOut = False
+
+        if not any( isinstance(p, FileInParmData) for p in self.parmListIn ):
+            for p in self.parmListIn:
+                if isinstance(p, ArrayParmData):
+                    p.useSideBuffer()
+                    sideBufferIn = True
+
+        if not any( isinstance(p, FileOutParmData) for p in self.parmListOut ):
+            outArrays = [ p for p in self.parmListOut if isinstance(p, ArrayParmData) ]
+            for p in outArrays[:MaxLargeOutArrays]:
+                p.useSideBuffer()
+                sideBufferOut = True
+
+        return sideBufferIn, sideBufferOut
+
+
 
 class HandlerFuncData(BaseFunctionData):
 
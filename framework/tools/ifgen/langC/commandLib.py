@@ -62,6 +62,13 @@ def AddLangArgumentGroup(parentParser):
                         default=False,
                         help='generate asynchronous-style server functions')
 
+    parser.add_argument('--large-array-threshold',
+                        dest="largeArrayThreshold",
+                        type=int,
+                        default=0,
+                        help='''send array parameters bigger than this many bytes through a memfd
+                        instead of the message buffer; defaults to 0 (never)''')
+
     parser.add_argument('--name-prefix',
                         dest="namePrefix",
                         default='',
@@ -144,6 +151,12 @@ def RunCommand(args,
 
     ProcessArguments(args)
 
+    # The large array threshold has to be set before the interface is parsed.  Client and server
+    # must agree on it, so make it part of the protocol ID.
+    if args.largeArrayThreshold > 0:
+        codeTypes.SetLargeArrayThreshold(args.largeArrayThreshold)
+        hashValue = "%s-%d" % (hashValue, args.largeArrayThreshold)
+
     # Process all the imported files first, and get the corresponding code objects
     importedCodeList = GetImportedCodeList(importList)
 
@@ -116,6 +116,9 @@ typedef struct TimerIter
     RemoteListAccess_t timerList;     ///< Timer list for the current thread in the remote process.
     thread_Obj_t currThreadObj;
     Timer_t currTimer;                ///< Current timer from the list.
+    bool isSorted;                    ///< true once all the timers have been read and sorted.
+    size_t numSortedTimers;           ///< Number of timers in SortedTimersPtr.
+    size_t nextSortedTimer;           ///< Index of the next timer to return from SortedTimersPtr.
 }
 TimerIter_t;
 
@@ -617,7 +620,14 @@ static TimerIter_Ref_t CreateTimerIter
     void
 )
 {
-    return (TimerIter_Ref_t)CreateThreadMemberObjIter(INSPECT_INSP_TYPE_TIMER);
+    TimerIter_Ref_t timerIterRef =
+        (TimerIter_Ref_t)CreateThreadMemberObjIter(INSPECT_INSP_TYPE_TIMER);
+
+    timerIterRef->isSorted = false;
+    timerIterRef->numSortedTimers = 0;
+    timerIterRef->nextSortedTimer = 0;
+
+    return timerIterRef;
 }
 
 static MutexIter_Ref_t CreateMutexIter
@@ -1203,17 +1213,41 @@ static le_dls_Link_t* GetNextThreadMemberObjLinkPtr
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Gets the next timer from the specified iterator. All timers from all thread objects are
- * considered to be on a single timer list. Therefore the out param would be NULL only when all
- * timer lists from all thread objects have been iterated.
+ * A timer read from the process-under-inspection, and the position of its thread in the thread
+ * object list.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t threadIndex;               ///< Position of the timer's thread in the thread obj list.
+    Timer_t timer;                    ///< Copy of the timer.
+}
+SortedTimer_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timers read from the process-under-inspection, sorted by thread and expiry time.  The buffer is
+ * reused every time the timers are inspected.
+ */
+//--------------------------------------------------------------------------------------------------
+static SortedTimer_t* SortedTimersPtr = NULL;
+static size_t SortedTimersCapacity = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the next timer from the specified iterator's timer lists. All timers from all thread
+ * objects are considered to be on a single timer list. Therefore the out param would be NULL only
+ * when all timer lists from all thread objects have been iterated.
  *
  * @return
  *      A timer from the iterator's list of timers.
  */
 //--------------------------------------------------------------------------------------------------
-static Timer_t* GetNextTimer
+static Timer_t* ReadNextTimer
 (
-    TimerIter_Ref_t timerIterRef ///< [IN] The iterator to get the next timer from.
+    TimerIter_Ref_t timerIterRef ///< [IN] The iterator to read the next timer from.
 )
 {
     le_dls_Link_t* remThreadMemberObjNextLinkPtr =
@@ -1239,6 +1273,113 @@ static Timer_t* GetNextTimer
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compares two timers for qsort(), ordering them by thread, then by expiry time.  Timers of the
+ * same thread with the same expiry time are in the order they were started.
+ *
+ * @return
+ *      Less than, equal to, or greater than zero if the first timer goes before, with, or after the
+ *      second.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareTimers
+(
+    const void* firstPtr,   ///< [IN] The first SortedTimer_t.
+    const void* secondPtr   ///< [IN] The second SortedTimer_t.
+)
+{
+    const SortedTimer_t* aPtr = firstPtr;
+    const SortedTimer_t* bPtr = secondPtr;
+
+    if (aPtr->threadIndex != bPtr->threadIndex)
+    {
+        return (aPtr->threadIndex < bPtr->threadIndex) ? -1 : 1;
+    }
+
+    if (le_clk_GreaterThan(aPtr->timer.expiryTime, bPtr->timer.expiryTime))
+    {
+        return 1;
+    }
+
+    if (le_clk_GreaterThan(bPtr->timer.expiryTime, aPtr->timer.expiryTime))
+    {
+        return -1;
+    }
+
+    if (aPtr->timer.startSeq == bPtr->timer.startSeq)
+    {
+        return 0;
+    }
+
+    return (aPtr->timer.startSeq < bPtr->timer.startSeq) ? -1 : 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next timer from the specified iterator.  The running timers of each thread are kept in
+ * a heap, and are listed in no particular order, so the first call reads all of the timers and
+ * sorts them, so that each thread's timers are listed in the order they will expire.
+ *
+ * @return
+ *      A timer from the iterator's list of timers, or NULL if all the timers have been iterated.
+ */
+//--------------------------------------------------------------------------------------------------
+static Timer_t* GetNextTimer
+(
+    TimerIter_Ref_t timerIterRef ///< [IN] The iterator to get the next timer from.
+)
+{
+    if (!timerIterRef->isSorted)
+    {
+        size_t threadIndex = 0;
+        le_dls_Link_t* timerListHeadPtr = NULL;
+        Timer_t* timerPtr;
+
+        timerIterRef->numSortedTimers = 0;
+        timerIterRef->nextSortedTimer = 0;
+
+        while ((timerPtr = ReadNextTimer(timerIterRef)) != NULL)
+        {
+            // Each thread has its own timer list.
+            if (timerIterRef->timerList.List.headLinkPtr != timerListHeadPtr)
+            {
+                timerListHeadPtr = timerIterRef->timerList.List.headLinkPtr;
+                threadIndex++;
+            }
+
+            if (timerIterRef->numSortedTimers == SortedTimersCapacity)
+            {
+                SortedTimersCapacity = (SortedTimersCapacity == 0) ? 16 : SortedTimersCapacity * 2;
+                SortedTimersPtr = realloc(SortedTimersPtr,
+                                          SortedTimersCapacity * sizeof(SortedTimer_t));
+                LE_ASSERT(SortedTimersPtr != NULL);
+            }
+
+            SortedTimersPtr[timerIterRef->numSortedTimers].threadIndex = threadIndex;
+            SortedTimersPtr[timerIterRef->numSortedTimers].timer = *timerPtr;
+            timerIterRef->numSortedTimers++;
+        }
+
+        if (timerIterRef->numSortedTimers > 0)
+        {
+            qsort(SortedTimersPtr, timerIterRef->numSortedTimers, sizeof(SortedTimer_t),
+                  CompareTimers);
+        }
+
+        timerIterRef->isSorted = true;
+    }
+
+    if (timerIterRef->nextSortedTimer >= timerIterRef->numSortedTimers)
+    {
+        return NULL;
+    }
+
+    return &(SortedTimersPtr[timerIterRef->nextSortedTimer++].timer);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * See GetNextTimer.
@@ -1651,6 +1792,7 @@ static ColumnInfo_t MemPoolTableInfo[] =
     {"ALLOCS",      "%*s",  NULL, "%*"PRIu64"", sizeof(uint64_t),            false, 0, true},
     {"BLK BYTES",   "%*s",  NULL, "%*zu",       sizeof(size_t),              false, 0, true},
     {"USED BYTES",  "%*s",  NULL, "%*zu",       sizeof(size_t),              false, 0, true},
+    {"RECLAIMED",   "%*s",  NULL, "%*zu",       sizeof(size_t),              false, 0, true},
     {"MEMORY POOL", "%-*s", NULL, "%-*s",       LIMIT_MAX_MEM_POOL_NAME_LEN, true,  0, true},
     {"SUB-POOL",    "%*s",  NULL, "%*s",        0,                           true,  0, true}
 };
@@ -1701,29 +1843,54 @@ static size_t SemaphoreTableInfoSize = NUM_ARRAY_MEMBERS(SemaphoreTableInfo);
 
 static ColumnInfo_t ServiceObjTableInfo[] =
 {
-    {"INTERFACE NAME", "%*s", NULL, "%*s",  LIMIT_MAX_IPC_INTERFACE_NAME_BYTES, true,  0, true},
-    {"STATE",          "%*s", NULL, "%*s",  0,                                  true,  0, true},
-    {"THREAD NAME",    "%*s", NULL, "%*s",  MAX_THREAD_NAME_SIZE,               true,  0, true},
-    {"PROTOCOL ID",    "%*s", NULL, "%*s",  LIMIT_MAX_PROTOCOL_ID_BYTES,        true,  0, false},
-    {"MAX PAYLOAD",    "%*s", NULL, "%*zu", sizeof(size_t),                     false, 0, false},
-    {"FD",             "%*s", NULL, "%*d",  sizeof(int),                        false, 0, false}
+    {"INTERFACE NAME", "%*s", NULL, "%*s",        LIMIT_MAX_IPC_INTERFACE_NAME_BYTES, true,  0, true},
+    {"STATE",          "%*s", NULL, "%*s",        0,                                  true,  0, true},
+    {"THREAD NAME",    "%*s", NULL, "%*s",        MAX_THREAD_NAME_SIZE,               true,  0, true},
+    {"PROTOCOL ID",    "%*s", NULL, "%*s",        LIMIT_MAX_PROTOCOL_ID_BYTES,        true,  0, false},
+    {"MAX PAYLOAD",    "%*s", NULL, "%*zu",       sizeof(size_t),                     false, 0, false},
+    {"FD",             "%*s", NULL, "%*d",        sizeof(int),                        false, 0, false},
+    {"TX MSGS",        "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, true},
+    {"TX BYTES",       "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, false},
+    {"RX MSGS",        "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, true},
+    {"RX BYTES",       "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, false},
+    {"MAX TXQ",        "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, true},
+    {"BACKPRESSURE",   "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, false},
+    {"RTT P50 US",     "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, false},
+    {"RTT P99 US",     "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, false}
 };
 static size_t ServiceObjTableInfoSize = NUM_ARRAY_MEMBERS(ServiceObjTableInfo);
 
 static ColumnInfo_t ClientObjTableInfo[] =
 {
-    {"INTERFACE NAME", "%*s", NULL, "%*s",  LIMIT_MAX_IPC_INTERFACE_NAME_BYTES, true,  0, true},
-    {"PROTOCOL ID",    "%*s", NULL, "%*s",  LIMIT_MAX_PROTOCOL_ID_BYTES,        true,  0, false},
-    {"MAX PAYLOAD",    "%*s", NULL, "%*zu", sizeof(size_t),                     false, 0, false},
+    {"INTERFACE NAME", "%*s", NULL, "%*s",        LIMIT_MAX_IPC_INTERFACE_NAME_BYTES, true,  0, true},
+    {"PROTOCOL ID",    "%*s", NULL, "%*s",        LIMIT_MAX_PROTOCOL_ID_BYTES,        true,  0, false},
+    {"MAX PAYLOAD",    "%*s", NULL, "%*zu",       sizeof(size_t),                     false, 0, false},
+    {"TX MSGS",        "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, true},
+    {"TX BYTES",       "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, false},
+    {"RX MSGS",        "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, true},
+    {"RX BYTES",       "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, false},
+    {"MAX TXQ",        "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, true},
+    {"BACKPRESSURE",   "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, false},
+    {"RTT P50 US",     "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, false},
+    {"RTT P99 US",     "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, false}
 };
 static size_t ClientObjTableInfoSize = NUM_ARRAY_MEMBERS(ClientObjTableInfo);
 
 static ColumnInfo_t SessionObjTableInfo[] =
 {
-    {"INTERFACE NAME", "%*s", NULL, "%*s", LIMIT_MAX_IPC_INTERFACE_NAME_BYTES, true,  0, true},
-    {"STATE",          "%*s", NULL, "%*s", 0,                                  true,  0, true},
-    {"THREAD NAME",    "%*s", NULL, "%*s", MAX_THREAD_NAME_SIZE,               true,  0, true},
-    {"FD",             "%*s", NULL, "%*d", sizeof(int),                        false, 0, false}
+    {"INTERFACE NAME", "%*s", NULL, "%*s",        LIMIT_MAX_IPC_INTERFACE_NAME_BYTES, true,  0, true},
+    {"STATE",          "%*s", NULL, "%*s",        0,                                  true,  0, true},
+    {"THREAD NAME",    "%*s", NULL, "%*s",        MAX_THREAD_NAME_SIZE,               true,  0, true},
+    {"FD",             "%*s", NULL, "%*d",        sizeof(int),                        false, 0, false},
+    {"TXQ DEPTH",      "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, false},
+    {"TX MSGS",        "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, true},
+    {"TX BYTES",       "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, false},
+    {"RX MSGS",        "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, true},
+    {"RX BYTES",       "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),                   false, 0, false},
+    {"MAX TXQ",        "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, true},
+    {"BACKPRESSURE",   "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, false},
+    {"RTT P50 US",     "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, false},
+    {"RTT P99 US",     "%*s", NULL, "%*u",        sizeof(uint32_t),                   false, 0, false}
 };
 static size_t SessionObjTableInfoSize = NUM_ARRAY_MEMBERS(SessionObjTableInfo);
 
@@ -2748,6 +2915,8 @@ static int PrintMemPoolInfo
                                                                  MemPoolTableInfoSize, &index);
         FillSizeTColField (blockSize*(poolStats.numBlocksInUse), MemPoolTableInfo,
                                                                  MemPoolTableInfoSize, &index);
+        FillSizeTColField (poolStats.numBytesReclaimed,          MemPoolTableInfo,
+                                                                 MemPoolTableInfoSize, &index);
         FillStrColField   (name,                                 MemPoolTableInfo,
                                                                  MemPoolTableInfoSize, &index);
         FillStrColField   (subPoolStr,                           MemPoolTableInfo,
@@ -2786,6 +2955,8 @@ static int PrintMemPoolInfo
                                                             MemPoolTableInfoSize, &index, &printed);
         ExportSizeTToJson (blockSize*(poolStats.numBlocksInUse), MemPoolTableInfo,
                                                             MemPoolTableInfoSize, &index, &printed);
+        ExportSizeTToJson (poolStats.numBytesReclaimed,     MemPoolTableInfo,
+                                                            MemPoolTableInfoSize, &index, &printed);
         ExportStrToJson   (name,                            MemPoolTableInfo,
                                                             MemPoolTableInfoSize, &index, &printed);
         ExportStrToJson   (subPoolStr,                      MemPoolTableInfo,
@@ -3419,6 +3590,57 @@ static void LookupThreadName
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill the IPC traffic statistics columns of a service, client interface or session table.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FillMsgStatsColFields
+(
+    msgInterface_Stats_t* statsPtr, ///< [IN] the statistics to be printed.
+    ColumnInfo_t* table,            ///< [IN] XXXTableInfo ref.
+    size_t        tableSize,        ///< [IN] XXXTableInfo size.
+    int*          indexRef          ///< [IN/OUT] iterator to parse the table.
+)
+{
+    FillUint64ColField(statsPtr->txMsgCount,        table, tableSize, indexRef);
+    FillUint64ColField(statsPtr->txByteCount,       table, tableSize, indexRef);
+    FillUint64ColField(statsPtr->rxMsgCount,        table, tableSize, indexRef);
+    FillUint64ColField(statsPtr->rxByteCount,       table, tableSize, indexRef);
+    FillUint32ColField(statsPtr->txQueueMaxDepth,   table, tableSize, indexRef);
+    FillUint32ColField(statsPtr->backPressureCount, table, tableSize, indexRef);
+    FillUint32ColField(msgInterface_GetRttPercentile(statsPtr, 50), table, tableSize, indexRef);
+    FillUint32ColField(msgInterface_GetRttPercentile(statsPtr, 99), table, tableSize, indexRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Export the IPC traffic statistics of a service, client interface or session to json.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExportMsgStatsToJson
+(
+    msgInterface_Stats_t* statsPtr, ///< [IN] the statistics to be exported.
+    ColumnInfo_t* table,            ///< [IN] XXXTableInfo ref.
+    size_t        tableSize,        ///< [IN] XXXTableInfo size.
+    int*          indexRef,         ///< [IN/OUT] iterator to parse the table.
+    bool*         printed           ///< [IN/OUT] if the first entry is printed.
+)
+{
+    ExportUint64ToJson(statsPtr->txMsgCount,        table, tableSize, indexRef, printed);
+    ExportUint64ToJson(statsPtr->txByteCount,       table, tableSize, indexRef, printed);
+    ExportUint64ToJson(statsPtr->rxMsgCount,        table, tableSize, indexRef, printed);
+    ExportUint64ToJson(statsPtr->rxByteCount,       table, tableSize, indexRef, printed);
+    ExportUint32ToJson(statsPtr->txQueueMaxDepth,   table, tableSize, indexRef, printed);
+    ExportUint32ToJson(statsPtr->backPressureCount, table, tableSize, indexRef, printed);
+    ExportUint32ToJson(msgInterface_GetRttPercentile(statsPtr, 50),
+                       table, tableSize, indexRef, printed);
+    ExportUint32ToJson(msgInterface_GetRttPercentile(statsPtr, 99),
+                       table, tableSize, indexRef, printed);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Print service object information to stdout.
@@ -3465,6 +3687,8 @@ static int PrintServiceObjInfo
                                                             ServiceObjTableInfoSize, &index);
         FillIntColField  (serviceObjRef->directorySocketFd, ServiceObjTableInfo,
                                                             ServiceObjTableInfoSize, &index);
+        FillMsgStatsColFields(&serviceObjRef->interface.stats, ServiceObjTableInfo,
+                                                               ServiceObjTableInfoSize, &index);
 
         PrintInfo(ServiceObjTableInfo, ServiceObjTableInfoSize);
         lineCount++;
@@ -3497,6 +3721,8 @@ static int PrintServiceObjInfo
                                                          ServiceObjTableInfoSize, &index, &printed);
         ExportIntToJson  (serviceObjRef->directorySocketFd, ServiceObjTableInfo,
                                                          ServiceObjTableInfoSize, &index, &printed);
+        ExportMsgStatsToJson(&serviceObjRef->interface.stats, ServiceObjTableInfo,
+                                                         ServiceObjTableInfoSize, &index, &printed);
 
         printf("]");
     }
@@ -3536,6 +3762,8 @@ static int PrintClientObjInfo
                                                            ClientObjTableInfoSize, &index);
         FillSizeTColField(protocol.maxPayloadSize,         ClientObjTableInfo,
                                                            ClientObjTableInfoSize, &index);
+        FillMsgStatsColFields(&clientObjRef->interface.stats, ClientObjTableInfo,
+                                                              ClientObjTableInfoSize, &index);
 
         PrintInfo(ClientObjTableInfo, ClientObjTableInfoSize);
         lineCount++;
@@ -3562,6 +3790,8 @@ static int PrintClientObjInfo
                                                           ClientObjTableInfoSize, &index, &printed);
         ExportSizeTToJson(protocol.maxPayloadSize,        ClientObjTableInfo,
                                                           ClientObjTableInfoSize, &index, &printed);
+        ExportMsgStatsToJson(&clientObjRef->interface.stats, ClientObjTableInfo,
+                                                          ClientObjTableInfoSize, &index, &printed);
 
         printf("]");
     }
@@ -3610,6 +3840,10 @@ static int PrintSessionObjInfo
                                                  SessionObjTableInfoSize, &index);
         FillIntColField(sessionObjRef->socketFd, SessionObjTableInfo,
                                                  SessionObjTableInfoSize, &index);
+        FillUint32ColField(sessionObjRef->txQueueDepth, SessionObjTableInfo,
+                                                        SessionObjTableInfoSize, &index);
+        FillMsgStatsColFields(&sessionObjRef->stats, SessionObjTableInfo,
+                                                     SessionObjTableInfoSize, &index);
 
         PrintInfo(SessionObjTableInfo, SessionObjTableInfoSize);
         lineCount++;
@@ -3638,6 +3872,10 @@ static int PrintSessionObjInfo
                                                  SessionObjTableInfoSize, &index, &printed);
         ExportIntToJson(sessionObjRef->socketFd, SessionObjTableInfo,
                                                  SessionObjTableInfoSize, &index, &printed);
+        ExportUint32ToJson(sessionObjRef->txQueueDepth, SessionObjTableInfo,
+                                                 SessionObjTableInfoSize, &index, &printed);
+        ExportMsgStatsToJson(&sessionObjRef->stats, SessionObjTableInfo,
+                                                 SessionObjTableInfoSize, &index, &printed);
 
         printf("]");
     }
@@ -26,6 +26,18 @@ $ log trace keyword processName/componentName
  * To disable a trace:
  * @verbatim
 $ log stoptrace keyword processName/componentName
+@endverbatim
+ *
+ * To let each logging call site in a component log 50 messages per second, in bursts of up to
+ * 200 messages:
+ * @verbatim
+$ log limit 50,200 processName/componentName
+@endverbatim
+ *
+ * To read the log messages stored by the log daemon (if persistent log storage is on), optionally
+ * filtered by time, process, component and severity level:
+ * @verbatim
+$ log read --since=10m --process=processName --level=WARNING
 @endverbatim
  *
  *
@@ -52,6 +64,7 @@ $ log stoptrace keyword processName/componentName
 #include "legato.h"
 #include "log.h"
 #include "logDaemon.h"
+#include "logStore.h"
 #include "limit.h"
 #include <ctype.h>
 
@@ -76,8 +89,8 @@ static char Command;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Pointer to the "command parameter" string.  If used, this is a log level, trace keyword,
- * or process identifier.
+ * Pointer to the "command parameter" string.  If used, this is a log level, trace keyword, rate
+ * limit or process identifier.
  **/
 //--------------------------------------------------------------------------------------------------
 static const char* CommandParamPtr = NULL;
@@ -99,6 +112,30 @@ static const char* SessionIdPtr = DEFAULT_SESSION_ID;
 static bool ErrorOccurred = false;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Options of the "read" command.  NULL if not given.
+ **/
+//--------------------------------------------------------------------------------------------------
+static const char* SinceOptPtr = NULL;
+static const char* UntilOptPtr = NULL;
+static const char* ProcessOptPtr = NULL;
+static const char* ComponentOptPtr = NULL;
+static const char* LevelOptPtr = NULL;
+static const char* DirOptPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path of the directory holding the stored log files, as reported by the Log Control Daemon.
+ **/
+//--------------------------------------------------------------------------------------------------
+static char StoreDirPath[LOG_MAX_CMD_PACKET_BYTES] = "";
+
+
+static void ReadStore(const char* dirPathPtr);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Prints help to stdout.
@@ -118,7 +155,9 @@ static void PrintHelpAndExit
         "    log level FILTER_STR [DESTINATION]\n"
         "    log trace KEYWORD_STR [DESTINATION]\n"
         "    log stoptrace KEYWORD_STR [DESTINATION]\n"
+        "    log limit LIMIT_STR [DESTINATION]\n"
         "    log forget PROCESS_NAME\n"
+        "    log read [OPTIONS]\n"
         "\n"
         "DESCRIPTION:\n"
         "    log list            Lists all processes/components registered with the\n"
@@ -142,10 +181,43 @@ static void PrintHelpAndExit
         "                        keyword is not logged.  The KEYWORD_STR is a trace\n"
         "                        keyword.\n"
         "\n"
+        "    log limit           Sets the rate limit of each logging call site.  A\n"
+        "                        call site that logs more than this suppresses the\n"
+        "                        extra messages, and logs how many it suppressed.\n"
+        "                        The LIMIT_STR must be one of the following:\n"
+        "                            RATE        RATE messages per second, in\n"
+        "                                        bursts of up to RATE messages.\n"
+        "                            RATE,BURST  RATE messages per second, in\n"
+        "                                        bursts of up to BURST messages.\n"
+        "                            off         No rate limiting.\n"
+        "                        The default is 20,100.\n"
+        "\n"
         "    log forget          Forgets all settings for processes with a given name.\n"
         "                        Future processes with that name will have default\n"
         "                        settings.\n"
         "\n"
+        "    log read            Prints the log messages kept by the log daemon's\n"
+        "                        persistent log storage, oldest first.  The log\n"
+        "                        daemon stores log messages if it is started with\n"
+        "                        LE_LOG_STORE set to the path of a directory.\n"
+        "                        The OPTIONS select the messages to print:\n"
+        "\n"
+        "        --since=TIME    Only messages logged at or after TIME.\n"
+        "        --until=TIME    Only messages logged at or before TIME.\n"
+        "                        TIME is a number of seconds since the Epoch, or\n"
+        "                        a number followed by 's', 'm', 'h' or 'd' for\n"
+        "                        that many seconds, minutes, hours or days ago.\n"
+        "        -p NAME, --process=NAME\n"
+        "                        Only messages from processes named NAME.\n"
+        "        -c NAME, --component=NAME\n"
+        "                        Only messages from components named NAME.\n"
+        "        -l FILTER_STR, --level=FILTER_STR\n"
+        "                        Only messages at least as severe as FILTER_STR\n"
+        "                        (see 'log level').\n"
+        "        -d DIR, --dir=DIR\n"
+        "                        Read the log files in DIR (e.g., copied off a\n"
+        "                        device) without asking the log daemon.\n"
+        "\n"
         "The [DESTINATION] is optional and specifies the process and component to\n"
         "send the command to.  The [DESTINATION] must be in this format:\n"
         "\n"
@@ -184,6 +256,14 @@ static void MsgReceiveHandler
 )
 {
     const char* responseStr = le_msg_GetPayloadPtr(msgRef);
+
+    // The response to a "flush store" command is the path of the log store, unless it's an error.
+    if ((Command == LOG_CMD_FLUSH_STORE) && (responseStr[0] != '*'))
+    {
+        LE_ASSERT(le_utf8_Copy(StoreDirPath, responseStr, sizeof(StoreDirPath), NULL) == LE_OK);
+        return;
+    }
+
     // Print out whatever the Log Control Daemon sent us.
     printf("%s\n", responseStr);
 
@@ -195,6 +275,7 @@ static void MsgReceiveHandler
 }
 
 
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handles the Log Control Daemon closing the IPC session.
@@ -210,6 +291,10 @@ static void SessionCloseHandler
     {
         exit(EXIT_FAILURE);
     }
+    else if (Command == LOG_CMD_FLUSH_STORE)
+    {
+        ReadStore(StoreDirPath);
+    }
     else
     {
         exit(EXIT_SUCCESS);
@@ -364,6 +449,152 @@ le_log_Level_t ParseSeverityLevel
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parses a time given on the command line: either a number of seconds since the Epoch, or a
+ * number followed by 's', 'm', 'h' or 'd' for that many seconds, minutes, hours or days ago.
+ *
+ * @return The time, in seconds since the Epoch.  Exits with an error message if the time is bad.
+ **/
+//--------------------------------------------------------------------------------------------------
+static int64_t ParseTime
+(
+    const char* timeStr
+)
+{
+    char* endPtr;
+
+    errno = 0;
+    long long value = strtoll(timeStr, &endPtr, 10);
+
+    if ((errno != 0) || (endPtr == timeStr) || (value < 0))
+    {
+        ExitWithErrorMsg("Invalid time.");
+    }
+
+    if (*endPtr == '\0')
+    {
+        return value;
+    }
+
+    if (endPtr[1] != '\0')
+    {
+        ExitWithErrorMsg("Invalid time.");
+    }
+
+    switch (*endPtr)
+    {
+        case 's':
+            break;
+
+        case 'm':
+            value *= 60;
+            break;
+
+        case 'h':
+            value *= 60 * 60;
+            break;
+
+        case 'd':
+            value *= 24 * 60 * 60;
+            break;
+
+        default:
+            ExitWithErrorMsg("Invalid time.");
+    }
+
+    return (int64_t)time(NULL) - value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints a stored log message, in the same format as log messages written to standard error.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void PrintStoredMsg
+(
+    const logStore_Record_t* recordPtr,
+    void* contextPtr // not used.
+)
+{
+    char timeStamp[32] = "";
+    time_t timestamp = (time_t)recordPtr->timestamp;
+    struct tm brokenDownTime;
+
+    if (localtime_r(&timestamp, &brokenDownTime) != NULL)
+    {
+        strftime(timeStamp, sizeof(timeStamp), "%b %e %H:%M:%S", &brokenDownTime);
+    }
+
+    // Drop the newline at the end of messages captured from standard out and standard error.
+    size_t msgLen = strlen(recordPtr->msgPtr);
+    if ((msgLen > 0) && (recordPtr->msgPtr[msgLen - 1] == '\n'))
+    {
+        msgLen--;
+    }
+
+    if (recordPtr->compNamePtr[0] == '\0')
+    {
+        printf("%s : %s | %s[%d] | %.*s\n",
+               timeStamp, recordPtr->levelStrPtr, recordPtr->procNamePtr, (int)recordPtr->pid,
+               (int)msgLen, recordPtr->msgPtr);
+    }
+    else
+    {
+        printf("%s : %s | %s[%d]/%s T=%s | %s %s() %u | %.*s\n",
+               timeStamp, recordPtr->levelStrPtr, recordPtr->procNamePtr, (int)recordPtr->pid,
+               recordPtr->compNamePtr, recordPtr->threadNamePtr, recordPtr->fileNamePtr,
+               recordPtr->funcNamePtr, recordPtr->lineNumber, (int)msgLen, recordPtr->msgPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the stored log messages selected by the "read" command's options, then exits.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ReadStore
+(
+    const char* dirPathPtr      ///< [IN] Directory holding the log files.
+)
+{
+    logStore_Filter_t filter = { .startTime = INT64_MIN,
+                                 .endTime = INT64_MAX,
+                                 .minLevel = LE_LOG_DEBUG,
+                                 .procNamePtr = ProcessOptPtr,
+                                 .compNamePtr = ComponentOptPtr };
+
+    if (SinceOptPtr != NULL)
+    {
+        filter.startTime = ParseTime(SinceOptPtr);
+    }
+
+    if (UntilOptPtr != NULL)
+    {
+        filter.endTime = ParseTime(UntilOptPtr);
+    }
+
+    if (LevelOptPtr != NULL)
+    {
+        filter.minLevel = ParseSeverityLevel(LevelOptPtr);
+        if (filter.minLevel == (le_log_Level_t)(-1))
+        {
+            ExitWithErrorMsg("Invalid log level.");
+        }
+    }
+
+    if (logStore_Read(dirPathPtr, &filter, PrintStoredMsg, NULL) != LE_OK)
+    {
+        printf("***ERROR: No log files found in '%s'.\n", dirPathPtr);
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Appends some text to the command message.
@@ -445,6 +676,32 @@ static void LogLevelArgHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function that gets called by le_arg_Scan() when a rate limit argument is seen on the command
+ * line.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void RateLimitArgHandler
+(
+    const char* rateLimit
+)
+{
+    log_RateLimit_t limit;
+
+    if (log_StrToRateLimit(rateLimit, &limit) != LE_OK)
+    {
+        ExitWithErrorMsg("Invalid rate limit.");
+    }
+
+    CommandParamPtr = rateLimit;
+
+    // Wait for an optional log session identifier next.
+    le_arg_AddPositionalCallback(SessionIdArgHandler);
+    le_arg_AllowLessPositionalArgsThanCallbacks();
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Function the gets called by le_arg_Scan() when a trace keyword argument is seen on the command
@@ -516,6 +773,13 @@ static void CommandArgHandler
         // Expect a trace keyword next.
         le_arg_AddPositionalCallback(TraceKeywordArgHandler);
     }
+    else if (strcmp(command, "limit") == 0)
+    {
+        Command = LOG_CMD_SET_RATE_LIMIT;
+
+        // Expect a rate limit next.
+        le_arg_AddPositionalCallback(RateLimitArgHandler);
+    }
     else if (strcmp(command, "list") == 0)
     {
         Command = LOG_CMD_LIST_COMPONENTS;
@@ -529,6 +793,13 @@ static void CommandArgHandler
         // This command has only a process name (or pid) as a parameter.
         le_arg_AddPositionalCallback(ProcessIdArgHandler);
     }
+    else if (strcmp(command, "read") == 0)
+    {
+        // The log daemon is asked to flush its log store and say where it is.
+        Command = LOG_CMD_FLUSH_STORE;
+
+        // This command has only options.
+    }
     else
     {
         char errorMsg[100];
@@ -551,8 +822,22 @@ COMPONENT_INIT
     // Print help and exit if the "-h" or "--help" options are given.
     le_arg_SetFlagCallback(PrintHelpAndExit, "h", "help");
 
+    // Options of the "read" command.
+    le_arg_SetStringVar(&SinceOptPtr, NULL, "since");
+    le_arg_SetStringVar(&UntilOptPtr, NULL, "until");
+    le_arg_SetStringVar(&ProcessOptPtr, "p", "process");
+    le_arg_SetStringVar(&ComponentOptPtr, "c", "component");
+    le_arg_SetStringVar(&LevelOptPtr, "l", "level");
+    le_arg_SetStringVar(&DirOptPtr, "d", "dir");
+
     le_arg_Scan();
 
+    // Log files that were copied off a device can be read without the Log Control Daemon.
+    if ((Command == LOG_CMD_FLUSH_STORE) && (DirOptPtr != NULL))
+    {
+        ReadStore(DirOptPtr);
+    }
+
     // Connect to the Log Control Daemon and allocate a message buffer to hold the command.
     le_msg_SessionRef_t sessionRef = ConnectToLogControlDaemon();
     le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
@@ -566,6 +851,7 @@ COMPONENT_INIT
         case LOG_CMD_SET_LEVEL:
         case LOG_CMD_ENABLE_TRACE:
         case LOG_CMD_DISABLE_TRACE:
+        case LOG_CMD_SET_RATE_LIMIT:
 
             AppendToCommand(msgRef, SessionIdPtr);
             AppendToCommand(msgRef, "/");
@@ -574,8 +860,9 @@ COMPONENT_INIT
             break;
 
         case LOG_CMD_LIST_COMPONENTS:
+        case LOG_CMD_FLUSH_STORE:
 
-            // This one has no arguments.
+            // These have no arguments.
 
             break;
 
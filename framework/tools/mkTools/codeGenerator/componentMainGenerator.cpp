@@ -172,11 +172,26 @@ void GenerateCLangComponentMainFile
     }
 
     // Call each of the component's client-side interfaces' initialization functions,
-    // except those that are marked [manual-start].
+    // except those that are marked [manual-start].  The connections are made in a single
+    // session open batch, so their handshakes with the Service Directory overlap.
     if (!componentPtr->clientApis.empty())
     {
+        bool hasAutoStart = false;
+        for (auto ifPtr : componentPtr->clientApis)
+        {
+            if (!(ifPtr->manualStart))
+            {
+                hasAutoStart = true;
+            }
+        }
+
         fileStream << "    // Connect client-side IPC interfaces.\n";
 
+        if (hasAutoStart)
+        {
+            fileStream << "    le_msg_StartOpenBatch();\n";
+        }
+
         for (auto ifPtr : componentPtr->clientApis)
         {
             // If not marked for manual start,
@@ -191,6 +206,11 @@ void GenerateCLangComponentMainFile
             }
         }
 
+        if (hasAutoStart)
+        {
+            fileStream << "    le_msg_FinishOpenBatch();\n";
+        }
+
         fileStream << "\n";
     }
 